@@ -74,6 +74,7 @@
 
 #include "ai.h"
 
+#include "arena.h"
 #include "array.h"
 #include "board.h"
 #include "escort.h"
@@ -137,6 +138,8 @@ static int ai_loadEquip (void);
 static void ai_taskGC( Pilot* pilot );
 static Task* ai_createTask( lua_State *L, int subtask );
 static int ai_tasktarget( lua_State *L, Task *t );
+static double ai_costOther( const Pilot *p, const Pilot *target, double d2,
+      const void *data );
 
 
 
@@ -991,6 +994,8 @@ static void ai_create( Pilot* pilot )
          env = faction_getEquipper(pilot->faction);
          func = "equip";
       }
+      /* Stats are only recomputed when the script reads them or is done. */
+      pilot_calcStatsBegin( pilot );
       nlua_getenv(env, func);
       nlua_pushenv(env);
       lua_setfenv(naevL, -2);
@@ -999,6 +1004,7 @@ static void ai_create( Pilot* pilot )
          WARN( _("Pilot '%s' equip -> '%s': %s"), pilot->name, func, lua_tostring(naevL, -1));
          lua_pop(naevL, 1);
       }
+      pilot_calcStatsEnd( pilot );
    }
 
    /* Since the pilot changes outfits and cores, we must heal him up. */
@@ -1358,33 +1364,32 @@ static int aiL_getrndpilot( lua_State *L )
  */
 static int aiL_getnearestpilot( lua_State *L )
 {
-   /*dist will be initialized to a number*/
-   /*this will only seek out pilots closer than dist*/
-   Pilot * const *pilot_stack = pilot_getAll();
-   int dist=1000;
-   int i;
-   int candidate_id = -1;
-
-   /*cycle through all the pilots and find the closest one that is not the pilot */
-
-   for (i = 0; i<array_size(pilot_stack); i++)
-   {
-       if (pilot_stack[i]->id != cur_pilot->id && vect_dist(&pilot_stack[i]->solid->pos, &cur_pilot->solid->pos) < dist)
-       {
-            dist = vect_dist(&pilot_stack[i]->solid->pos, &cur_pilot->solid->pos);
-            candidate_id = i;
-       }
-   }
+   pilotId_t candidate;
 
-   /* Last check. */
-   if (candidate_id == -1)
+   /* Only seek out pilots closer than 1000 that are not the pilot. */
+   if (!pilot_gridNearest( cur_pilot, cur_pilot->solid->pos.x,
+            cur_pilot->solid->pos.y, 1000., ai_costOther, NULL, 1.,
+            &candidate, NULL, 1 ))
       return 0;
 
    /* Actually found a pilot. */
-   lua_pushpilot(L, pilot_stack[candidate_id]->id);
+   lua_pushpilot(L, candidate);
    return 1;
 }
 
+
+/**
+ * @brief Spatial query cost of pilots other than the querying one.
+ */
+static double ai_costOther( const Pilot *p, const Pilot *target, double d2,
+      const void *data )
+{
+   (void) data;
+   if (target == p)
+      return INFINITY;
+   return d2;
+}
+
 /**
  * @brief Gets the distance from the pointer.
  *
@@ -2289,7 +2294,7 @@ static int aiL_getrndplanet( lua_State *L )
 static int aiL_getlandplanet( lua_State *L )
 {
    int *ind;
-   int i;
+   int i, n;
    LuaPlanet planet;
    Planet *p;
    int only_friend;
@@ -2301,8 +2306,9 @@ static int aiL_getlandplanet( lua_State *L )
    /* Check if we should get only friendlies. */
    only_friend = lua_toboolean(L, 1);
 
-   /* Allocate memory. */
-   ind = array_create_size( int, array_size(cur_system->planets) );
+   /* Allocate memory for this frame. */
+   ind = arena_alloc( sizeof(int) * array_size(cur_system->planets) );
+   n = 0;
 
    /* Copy friendly planet.s */
    for (i=0; i<array_size(cur_system->planets); i++) {
@@ -2318,22 +2324,19 @@ static int aiL_getlandplanet( lua_State *L )
          continue;
 
       /* Add it. */
-      array_push_back( &ind, i );
+      ind[n++] = i;
    }
 
    /* no planet to land on found */
-   if (array_size(ind)==0) {
-      array_free(ind);
+   if (n==0)
       return 0;
-   }
 
    /* we can actually get a random planet now */
-   i = RNG(0,array_size(ind)-1);
+   i = RNG(0,n-1);
    p = cur_system->planets[ind[i]];
    planet = p->id;
    lua_pushplanet(L, planet);
    cur_pilot->nav_planet = ind[i];
-   array_free(ind);
 
    return 1;
 }
@@ -2565,8 +2568,7 @@ static int aiL_nearhyptarget( lua_State *L )
 static int aiL_rndhyptarget( lua_State *L )
 {
    JumpPoint **jumps, *jiter;
-   int i, r;
-   int *id;
+   int i, r, n;
    LuaJump lj;
 
    /* No jumps in the system. */
@@ -2574,35 +2576,27 @@ static int aiL_rndhyptarget( lua_State *L )
       return 0;
 
    /* Find usable jump points. */
-   jumps = array_create_size( JumpPoint*, array_size(cur_system->jumps) );
-   id    = array_create_size( int, array_size(cur_system->jumps) );
+   jumps = arena_alloc( sizeof(JumpPoint*) * array_size(cur_system->jumps) );
+   n = 0;
    for (i=0; i < array_size(cur_system->jumps); i++) {
       jiter = &cur_system->jumps[i];
       /* We want only standard jump points to be used. */
       if (jp_isFlag(jiter, JP_HIDDEN) || jp_isFlag(jiter, JP_EXITONLY))
          continue;
-      array_push_back( &id, i );
-      array_push_back( &jumps, jiter );
+      jumps[n++] = jiter;
    }
 
    /* Check again if there's no jumps to choose (this can happen if the
     * only available jumps are exit-only or hidden). */
-   if (array_size(jumps) <= 0) {
-      array_free(jumps);
-      array_free(id);
+   if (n <= 0)
       return 0;
-   }
 
    /* Choose random jump point. */
-   r = RNG(0, array_size(jumps) - 1);
+   r = RNG(0, n - 1);
 
    lj.destid = jumps[r]->targetid;
    lj.srcid = cur_system->id;
 
-   /* Clean up. */
-   array_free(jumps);
-   array_free(id);
-
    /* Return Jump. */
    lua_pushjump( L, lj );
    return 1;
@@ -0,0 +1,231 @@
+/*
+ * See Licensing and Copyright notice in naev.h
+ */
+
+/**
+ * @file arena.c
+ *
+ * @brief Bump allocator for memory that only lives for a frame.
+ *
+ * Allocations are carved out of a single block and are never freed
+ *  individually. Instead, the whole arena is reset at the end of every
+ *  frame by main_loop(), or released back to a mark by the nested loops
+ *  of modal dialogues so memory of the frame they interrupted survives.
+ *
+ * If the block runs out, allocations fall back to malloc() until the
+ *  next reset, which then grows the block so the next frames fit.
+ *
+ * Only the main thread may use the arena.
+ */
+
+
+/** @cond */
+#include <stdlib.h>
+
+#include "naev.h"
+/** @endcond */
+
+#include "arena.h"
+
+#include "array.h"
+#include "log.h"
+
+
+#define ARENA_ALIGN        16 /**< Alignment of all allocations. */
+#define ARENA_SIZE_MIN     (256*1024) /**< Initial size of the arena. */
+
+
+static char *arena_buf = NULL; /**< Memory of the arena. */
+static size_t arena_used = 0; /**< Bytes of the arena in use. */
+static void **arena_overflow = NULL; /**< Array (array.h): Allocations that didn't fit. */
+static size_t arena_overflowBytes = 0; /**< Bytes that didn't fit since the last reset. */
+static ArenaStats arena_counters; /**< Allocation counters. */
+static unsigned long arena_frameAllocs = 0; /**< Allocations since the last reset. */
+static size_t arena_frameBytes = 0; /**< Bytes allocated since the last reset. */
+
+
+/**
+ * @brief Allocates memory that's freed at the end of the frame.
+ *
+ *    @param size Bytes to allocate.
+ *    @return Memory aligned to 16 bytes, never NULL.
+ */
+void* arena_alloc( size_t size )
+{
+   void *p;
+
+   size = (size + ARENA_ALIGN-1) & ~(size_t)(ARENA_ALIGN-1);
+
+   if (arena_buf == NULL) {
+      arena_counters.capacity = ARENA_SIZE_MIN;
+      arena_buf = malloc( arena_counters.capacity );
+      if (arena_buf == NULL)
+         ERR( _("Out of Memory") );
+      arena_overflow = array_create( void* );
+   }
+
+   arena_counters.allocs++;
+   arena_counters.bytes += size;
+   arena_frameAllocs++;
+   arena_frameBytes += size;
+
+   if (size <= arena_counters.capacity - arena_used) {
+      p = &arena_buf[ arena_used ];
+      arena_used += size;
+      arena_counters.peak = MAX( arena_counters.peak, arena_used + arena_overflowBytes );
+      return p;
+   }
+
+   /* Doesn't fit, use the heap until the arena is grown. */
+   p = malloc( size );
+   if (p == NULL)
+      ERR( _("Out of Memory") );
+   array_push_back( &arena_overflow, p );
+   arena_overflowBytes += size;
+   arena_counters.overflows++;
+   arena_counters.peak = MAX( arena_counters.peak, arena_used + arena_overflowBytes );
+   return p;
+}
+
+
+/**
+ * @brief Allocates zeroed memory that's freed at the end of the frame.
+ *
+ *    @param nmemb Number of elements.
+ *    @param size Size of each element.
+ *    @return Zeroed memory aligned to 16 bytes, never NULL.
+ */
+void* arena_calloc( size_t nmemb, size_t size )
+{
+   void *p = arena_alloc( nmemb * size );
+   memset( p, 0, nmemb * size );
+   return p;
+}
+
+
+/**
+ * @brief Formats a string into memory that's freed at the end of the frame.
+ *
+ *    @param fmt Format string.
+ *    @param ap Arguments.
+ *    @return The formatted string.
+ */
+char* arena_vprintf( const char *fmt, va_list ap )
+{
+   va_list ap2;
+   int n;
+   char *s;
+
+   va_copy( ap2, ap );
+   n = vsnprintf( NULL, 0, fmt, ap2 );
+   va_end( ap2 );
+   if (n < 0)
+      n = 0;
+
+   s = arena_alloc( n+1 );
+   vsnprintf( s, n+1, fmt, ap );
+   return s;
+}
+
+
+/**
+ * @brief Formats a string into memory that's freed at the end of the frame.
+ *
+ *    @param fmt Format string.
+ *    @return The formatted string.
+ */
+char* arena_printf( const char *fmt, ... )
+{
+   va_list ap;
+   char *s;
+
+   va_start( ap, fmt );
+   s = arena_vprintf( fmt, ap );
+   va_end( ap );
+   return s;
+}
+
+
+/**
+ * @brief Gets the current position of the arena.
+ *
+ *    @return Mark to release back to with arena_release().
+ */
+ArenaMark arena_mark (void)
+{
+   ArenaMark mark;
+   mark.used = arena_used;
+   mark.noverflow = array_size( arena_overflow );
+   return mark;
+}
+
+
+/**
+ * @brief Frees everything allocated since a mark.
+ *
+ *    @param mark Mark gotten with arena_mark().
+ */
+void arena_release( const ArenaMark *mark )
+{
+   int i;
+
+   for (i=mark->noverflow; i<array_size(arena_overflow); i++)
+      free( arena_overflow[i] );
+   if (arena_overflow != NULL)
+      array_resize( &arena_overflow, mark->noverflow );
+   arena_used = mark->used;
+}
+
+
+/**
+ * @brief Frees everything in the arena at the end of a frame.
+ *
+ * Grows the arena if the frame didn't fit.
+ */
+void arena_reset (void)
+{
+   const ArenaMark start = { .used = 0, .noverflow = 0 };
+
+   arena_release( &start );
+
+   if (arena_overflowBytes > 0) {
+      arena_counters.capacity = MAX( 2*arena_counters.capacity,
+            arena_counters.peak + ARENA_SIZE_MIN );
+      free( arena_buf );
+      arena_buf = malloc( arena_counters.capacity );
+      if (arena_buf == NULL)
+         ERR( _("Out of Memory") );
+      arena_overflowBytes = 0;
+   }
+
+   arena_counters.frame_allocs = arena_frameAllocs;
+   arena_counters.frame_bytes = arena_frameBytes;
+   arena_frameAllocs = 0;
+   arena_frameBytes = 0;
+}
+
+
+/**
+ * @brief Gets the allocation counters of the arena.
+ */
+const ArenaStats* arena_stats (void)
+{
+   return &arena_counters;
+}
+
+
+/**
+ * @brief Frees the arena.
+ */
+void arena_exit (void)
+{
+   arena_reset();
+   DEBUG( _("Frame arena: %lu allocations (%lu fell back to malloc), peak %lu of %lu bytes"),
+         arena_counters.allocs, arena_counters.overflows,
+         (unsigned long)arena_counters.peak, (unsigned long)arena_counters.capacity );
+   free( arena_buf );
+   arena_buf = NULL;
+   array_free( arena_overflow );
+   arena_overflow = NULL;
+   memset( &arena_counters, 0, sizeof(arena_counters) );
+}
@@ -0,0 +1,51 @@
+/*
+ * See Licensing and Copyright notice in naev.h
+ */
+
+#ifndef ARENA_H
+#  define ARENA_H
+
+
+/** @cond */
+#include <stdarg.h>
+#include <stddef.h>
+/** @endcond */
+
+#include "nstring.h"
+
+
+/**
+ * @brief Position in the frame arena to release back to.
+ */
+typedef struct ArenaMark_ {
+   size_t used; /**< Bytes of the arena in use. */
+   int noverflow; /**< Allocations that didn't fit in the arena. */
+} ArenaMark;
+
+
+/**
+ * @brief Frame arena allocation counters.
+ */
+typedef struct ArenaStats_ {
+   unsigned long allocs; /**< Total allocations. */
+   unsigned long overflows; /**< Total allocations that fell back to malloc(). */
+   size_t bytes; /**< Total bytes allocated. */
+   size_t peak; /**< Most bytes in use at once. */
+   size_t capacity; /**< Current size of the arena. */
+   unsigned long frame_allocs; /**< Allocations in the last frame. */
+   size_t frame_bytes; /**< Bytes allocated in the last frame. */
+} ArenaStats;
+
+
+void* arena_alloc( size_t size );
+void* arena_calloc( size_t nmemb, size_t size );
+PRINTF_FORMAT( 1, 0 ) char* arena_vprintf( const char *fmt, va_list ap );
+PRINTF_FORMAT( 1, 2 ) char* arena_printf( const char *fmt, ... );
+ArenaMark arena_mark (void);
+void arena_release( const ArenaMark *mark );
+void arena_reset (void);
+const ArenaStats* arena_stats (void);
+void arena_exit (void);
+
+
+#endif /* ARENA_H */
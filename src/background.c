@@ -355,6 +355,7 @@ void background_renderStars(const double dt, const int is_stars)
    glUniform1f(shaders.stars.scale, 1 / gl_screen.scale);
    glDrawArrays(use_lines ? GL_LINES : GL_POINTS, 0,
          is_stars ? nstars : ndust);
+   gl_screen.draw_calls++;
 
    /* Disable vertex array. */
    glDisableVertexAttribArray(shaders.stars.vertex);
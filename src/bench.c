@@ -0,0 +1,759 @@
+/*
+ * See Licensing and Copyright notice in naev.h
+ */
+
+/**
+ * @file bench.c
+ *
+ * @brief Battle benchmark.
+ *
+ * Sets up a fixed battle between two fleets in a system and runs the
+ *  simulation for a number of steps as fast as possible, reporting the
+ *  time spent in each part of the update. It's started with the
+ *  --benchmark command line option and usually run headless.
+ *
+ * There are also microbenchmarks of single subsystems, which are started
+ *  with the --microbench command line option.
+ */
+
+
+/** @cond */
+#include "SDL.h"
+
+#include "naev.h"
+/** @endcond */
+
+#include "bench.h"
+
+#include "arena.h"
+#include "array.h"
+#include "conf.h"
+#include "faction.h"
+#include "log.h"
+#include "nstring.h"
+#include "outfit.h"
+#include "physics.h"
+#include "pilot.h"
+#include "rng.h"
+#include "ship.h"
+#include "shipstats.h"
+#include "space.h"
+
+
+#define BENCH_DT        (1./60.) /**< Simulation step in seconds. */
+#define BENCH_DISTANCE  5000. /**< Distance of the fleets from the centre. */
+#define BENCH_SPACING   200. /**< Distance between ships in a fleet. */
+
+
+/**
+ * @brief Side of the battle.
+ */
+typedef struct BenchSide_ {
+   const char *faction; /**< Faction of the side. */
+   const char *ai; /**< AI of the side. */
+   factionId_t id; /**< Faction ID, set when spawning. */
+} BenchSide;
+
+
+static BenchSide bench_sides[] = {
+   { .faction = "Empire", .ai = "empire" },
+   { .faction = "Pirate", .ai = "pirate" },
+}; /**< Sides of the battle. */
+#define BENCH_NSIDES (int)(sizeof(bench_sides)/sizeof(bench_sides[0])) /**< Number of sides. */
+
+
+/**
+ * @brief Microbenchmark.
+ */
+typedef struct MicroBench_ {
+   const char *name; /**< Name used on the command line. */
+   int (*func)( void ); /**< Runs the microbenchmark and logs the results, returns 0 on success. */
+} MicroBench;
+
+
+/**
+ * @brief Body moved the way asteroids and debris were before being stored by
+ *        component.
+ */
+typedef struct BenchBody_ {
+   Vector2d pos; /**< Position. */
+   Vector2d vel; /**< Velocity. */
+} BenchBody;
+
+
+/*
+ * Microbenchmarks.
+ */
+static int bench_rng (void);
+static int bench_solids (void);
+static int bench_stats (void);
+static int bench_heat (void);
+static int bench_lod (void);
+static int bench_asteroids (void);
+static const MicroBench bench_micros[] = {
+   { .name = "rng", .func = bench_rng },
+   { .name = "solids", .func = bench_solids },
+   { .name = "stats", .func = bench_stats },
+   { .name = "heat", .func = bench_heat },
+   { .name = "lod", .func = bench_lod },
+   { .name = "asteroids", .func = bench_asteroids },
+}; /**< Available microbenchmarks. */
+#define BENCH_NMICROS (int)(sizeof(bench_micros)/sizeof(bench_micros[0])) /**< Number of microbenchmarks. */
+
+
+/*
+ * Prototypes.
+ */
+static void bench_spawn( const Ship *ship );
+static int bench_alive( factionId_t faction );
+static double bench_time( Uint64 start );
+
+
+/**
+ * @brief Spawns the fleets, facing each other across the system centre.
+ *
+ *    @param ship Ship to use for every pilot.
+ */
+static void bench_spawn( const Ship *ship )
+{
+   int i, j;
+   double dir, x, y;
+   char name[STRMAX_SHORT];
+   Vector2d pos, vel;
+   PilotFlags flags;
+
+   pilot_clearFlagsRaw( flags );
+   vect_cset( &vel, 0., 0. );
+   for (i=0; i<BENCH_NSIDES; i++) {
+      bench_sides[i].id = faction_get( bench_sides[i].faction );
+      dir = 2.*M_PI * (double)i / (double)BENCH_NSIDES;
+      for (j=0; j<conf.bench_ships; j++) {
+         /* Line the fleet up perpendicular to the direction of the enemy. */
+         x = BENCH_DISTANCE;
+         y = ((double)j - (double)(conf.bench_ships-1)/2.) * BENCH_SPACING;
+         vect_cset( &pos, x*cos(dir) - y*sin(dir), x*sin(dir) + y*cos(dir) );
+         snprintf( name, sizeof(name), "%s %d", bench_sides[i].faction, j+1 );
+         pilot_create( ship, name, bench_sides[i].id, bench_sides[i].ai,
+               fmod( dir+M_PI, 2.*M_PI ), &pos, &vel, flags, 0, 0 );
+      }
+   }
+}
+
+
+/**
+ * @brief Counts the pilots of a faction that are still fighting.
+ *
+ *    @param faction Faction to count.
+ *    @return Number of pilots alive.
+ */
+static int bench_alive( factionId_t faction )
+{
+   int i, n;
+   Pilot *const *pilots;
+
+   n = 0;
+   pilots = pilot_getAll();
+   for (i=0; i<array_size(pilots); i++)
+      if ((pilots[i]->faction == faction)
+            && !pilot_isFlag( pilots[i], PILOT_DEAD )
+            && !pilot_isFlag( pilots[i], PILOT_DELETE ))
+         n++;
+   return n;
+}
+
+
+/**
+ * @brief Runs the battle benchmark set up in the configuration.
+ *
+ *    @return 0 on success.
+ */
+int bench_run (void)
+{
+   int i, steps;
+   const char *sysname;
+   const Ship *ship;
+   UpdateTimes times;
+   Uint64 start;
+   double total, ms;
+
+   sysname = system_existsCase( conf.bench_system );
+   if (sysname == NULL) {
+      WARN( _("Benchmark system '%s' not found!"), conf.bench_system );
+      return -1;
+   }
+   ship = ship_get( conf.bench_ship );
+   if (ship == NULL) {
+      WARN( _("Benchmark ship '%s' not found!"), conf.bench_ship );
+      return -1;
+   }
+   steps = MAX( conf.bench_steps, 1 );
+
+   /* Only the fleets should be fighting. */
+   space_spawn = 0;
+   space_init( sysname );
+   bench_spawn( ship );
+   update_routine( BENCH_DT, 1 );
+
+   LOG( _("Benchmark: %d %s per side in %s for %d steps"),
+         conf.bench_ships, _(ship->name), _(sysname), steps );
+
+   memset( &times, 0, sizeof(times) );
+   update_setTimes( &times );
+   start = SDL_GetPerformanceCounter();
+   for (i=0; i<steps; i++) {
+      update_routine( BENCH_DT, 0 );
+      arena_reset();
+   }
+   total = bench_time( start );
+   update_setTimes( NULL );
+
+   ms = 1000. / (double)steps;
+   LOG( _("   space:   %.3f ms/step"), times.space * ms );
+   LOG( _("   weapons: %.3f ms/step"), times.weapons * ms );
+   LOG( _("   spfx:    %.3f ms/step"), times.spfx * ms );
+   LOG( _("   pilots:  %.3f ms/step"), times.pilots * ms );
+   LOG( _("   camera:  %.3f ms/step"), times.camera * ms );
+   LOG( _("   hooks:   %.3f ms/step"), times.hooks * ms );
+   LOG( _("   total:   %.3f ms/step (%.0f steps/s)"), total * ms,
+         (double)steps / MAX( total, 1e-9 ) );
+   for (i=0; i<BENCH_NSIDES; i++)
+      LOG( _("   %s: %d of %d alive"), _(bench_sides[i].faction),
+            bench_alive( bench_sides[i].id ), conf.bench_ships );
+
+   space_spawn = 1;
+   return 0;
+}
+
+
+/**
+ * @brief Gets the time elapsed since a performance counter value.
+ *
+ *    @param start Value of SDL_GetPerformanceCounter() to measure from.
+ *    @return Elapsed time in seconds.
+ */
+static double bench_time( Uint64 start )
+{
+   return (double)(SDL_GetPerformanceCounter() - start)
+         / (double)SDL_GetPerformanceFrequency();
+}
+
+
+/**
+ * @brief Runs a microbenchmark.
+ *
+ *    @param name Name of the microbenchmark, or "list" to list them.
+ *    @return 0 on success.
+ */
+int bench_micro( const char *name )
+{
+   int i;
+
+   if (strcmp( name, "list" ) == 0) {
+      LOG( _("Microbenchmarks:") );
+      for (i=0; i<BENCH_NMICROS; i++)
+         LOG( "   %s", bench_micros[i].name );
+      return 0;
+   }
+
+   for (i=0; i<BENCH_NMICROS; i++) {
+      if (strcmp( name, bench_micros[i].name ) != 0)
+         continue;
+      LOG( _("Microbenchmark: %s"), name );
+      return bench_micros[i].func();
+   }
+
+   WARN( _("Microbenchmark '%s' not found!"), name );
+   return -1;
+}
+
+
+#define BENCH_RNG_DRAWS    (1<<26) /**< Numbers to draw in the RNG microbenchmark. */
+/**
+ * @brief Compares the mersenne twister of the main thread with the
+ *        xoshiro256** worker streams.
+ */
+static int bench_rng (void)
+{
+   int i;
+   Uint64 start;
+   double t, sum;
+   RngStream rs;
+
+   /* The sums keep the compiler from dropping the loops. */
+   sum = 0.;
+   start = SDL_GetPerformanceCounter();
+   for (i=0; i<BENCH_RNG_DRAWS; i++)
+      sum += randfp();
+   t = bench_time( start );
+   LOG( _("   mersenne twister: %.2f ns/number (mean %.4f)"),
+         t * 1e9 / BENCH_RNG_DRAWS, sum / BENCH_RNG_DRAWS );
+
+   rngs_seed( &rs, randint() );
+   sum = 0.;
+   start = SDL_GetPerformanceCounter();
+   for (i=0; i<BENCH_RNG_DRAWS; i++)
+      sum += rngs_float( &rs );
+   t = bench_time( start );
+   LOG( _("   xoshiro256**:     %.2f ns/number (mean %.4f)"),
+         t * 1e9 / BENCH_RNG_DRAWS, sum / BENCH_RNG_DRAWS );
+
+   /* Through the regular API with a stream bound to the thread. */
+   rng_setThreadStream( &rs );
+   sum = 0.;
+   start = SDL_GetPerformanceCounter();
+   for (i=0; i<BENCH_RNG_DRAWS; i++)
+      sum += randfp();
+   t = bench_time( start );
+   rng_setThreadStream( NULL );
+   LOG( _("   bound stream:     %.2f ns/number (mean %.4f)"),
+         t * 1e9 / BENCH_RNG_DRAWS, sum / BENCH_RNG_DRAWS );
+
+   start = SDL_GetPerformanceCounter();
+   for (i=0; i<1000; i++)
+      rngs_jump( &rs );
+   t = bench_time( start );
+   LOG( _("   jump:             %.2f us/jump"), t * 1e6 / 1000. );
+   return 0;
+}
+
+
+#define BENCH_SOLIDS       16384 /**< Solids in the solid microbenchmark. */
+#define BENCH_SOLID_STEPS  60 /**< Updates in the solid microbenchmark. */
+/**
+ * @brief Compares updating solids one at a time with solid_updateBatch().
+ *
+ * Half the solids use each update method, a third of them have no speed
+ *  limit. Fails if the results differ by more than SOLID_BATCH_TOLERANCE.
+ */
+static int bench_solids (void)
+{
+   int i, k;
+   Uint64 start;
+   double tscalar, tbatch, err, e;
+   Solid *scalar, **batch;
+   Vector2d pos, vel;
+
+   scalar = malloc( BENCH_SOLIDS * sizeof(Solid) );
+   batch = malloc( BENCH_SOLIDS * sizeof(Solid*) );
+   for (i=0; i<BENCH_SOLIDS; i++) {
+      vect_cset( &pos, RNG(-10000,10000), RNG(-10000,10000) );
+      vect_pset( &vel, RNG(0,1000), RNGF()*2.*M_PI );
+      solid_init( &scalar[i], RNG(50,1000), RNGF()*2.*M_PI, &pos, &vel,
+            (i%2) ? SOLID_UPDATE_EULER : SOLID_UPDATE_RK4 );
+      scalar[i].thrust = RNG(0,50000);
+      scalar[i].dir_vel = RNG(-2,2);
+      if (i%3)
+         scalar[i].speed_max = RNG(200,600);
+      batch[i] = malloc( sizeof(Solid) );
+      *batch[i] = scalar[i];
+   }
+
+   start = SDL_GetPerformanceCounter();
+   for (k=0; k<BENCH_SOLID_STEPS; k++)
+      for (i=0; i<BENCH_SOLIDS; i++)
+         scalar[i].update( &scalar[i], BENCH_DT );
+   tscalar = bench_time( start );
+
+   start = SDL_GetPerformanceCounter();
+   for (k=0; k<BENCH_SOLID_STEPS; k++)
+      solid_updateBatch( batch, BENCH_SOLIDS, BENCH_DT );
+   tbatch = bench_time( start );
+
+   err = 0.;
+   for (i=0; i<BENCH_SOLIDS; i++) {
+      e = MAX( FABS(scalar[i].pos.x - batch[i]->pos.x) / MAX( 1., FABS(scalar[i].pos.x) ),
+            FABS(scalar[i].pos.y - batch[i]->pos.y) / MAX( 1., FABS(scalar[i].pos.y) ) );
+      err = MAX( err, e );
+      e = MAX( FABS(scalar[i].vel.x - batch[i]->vel.x) / MAX( 1., FABS(scalar[i].vel.x) ),
+            FABS(scalar[i].vel.y - batch[i]->vel.y) / MAX( 1., FABS(scalar[i].vel.y) ) );
+      err = MAX( err, e );
+      free( batch[i] );
+   }
+   free( scalar );
+   free( batch );
+
+   LOG( _("   %d solids for %d steps"), BENCH_SOLIDS, BENCH_SOLID_STEPS );
+   LOG( _("   one at a time: %.1f ns/solid"),
+         tscalar * 1e9 / (BENCH_SOLIDS * BENCH_SOLID_STEPS) );
+   LOG( _("   batched:       %.1f ns/solid"),
+         tbatch * 1e9 / (BENCH_SOLIDS * BENCH_SOLID_STEPS) );
+   LOG( _("   largest relative difference: %g"), err );
+   if (err > SOLID_BATCH_TOLERANCE) {
+      WARN( _("Batched solid update differs by more than %g!"),
+            SOLID_BATCH_TOLERANCE );
+      return -1;
+   }
+   return 0;
+}
+
+
+#define BENCH_STATS_ROUNDS 2000 /**< Times every outfit is applied in the stat microbenchmark. */
+/**
+ * @brief Compares applying the stats of all the outfits from their lists
+ *        and from their compiled operations.
+ *
+ * Fails if the resulting stats differ at all.
+ */
+static int bench_stats (void)
+{
+   int i, k, n, nops;
+   Uint64 start;
+   double tlist, tops;
+   const Outfit *outfits;
+   ShipStats slist, sops;
+
+   outfits = outfit_getAll();
+   n = array_size( outfits );
+   nops = 0;
+   for (i=0; i<n; i++)
+      nops += array_size( outfits[i].stats_ops );
+
+   /* Start over every round so the values stay in a sensible range. */
+   start = SDL_GetPerformanceCounter();
+   for (k=0; k<BENCH_STATS_ROUNDS; k++) {
+      ss_statsInit( &slist );
+      for (i=0; i<n; i++)
+         ss_statsModFromList( &slist, outfits[i].stats );
+   }
+   tlist = bench_time( start );
+
+   start = SDL_GetPerformanceCounter();
+   for (k=0; k<BENCH_STATS_ROUNDS; k++) {
+      ss_statsInit( &sops );
+      for (i=0; i<n; i++)
+         ss_statsModFromOps( &sops, outfits[i].stats_ops );
+   }
+   tops = bench_time( start );
+
+   LOG( _("   %d outfits with %d stats, %d rounds"), n, nops, BENCH_STATS_ROUNDS );
+   LOG( _("   lists:      %.1f ns/stat"),
+         tlist * 1e9 / ((double)MAX(nops,1) * BENCH_STATS_ROUNDS) );
+   LOG( _("   operations: %.1f ns/stat"),
+         tops * 1e9 / ((double)MAX(nops,1) * BENCH_STATS_ROUNDS) );
+   if (memcmp( &slist, &sops, sizeof(ShipStats) ) != 0) {
+      WARN( _("Compiled stats differ from the stat lists!") );
+      return -1;
+   }
+   return 0;
+}
+
+
+#define BENCH_HEAT_SHIPS   400 /**< Ships per side in the heat microbenchmark. */
+#define BENCH_HEAT_SETTLE  7 /**< Every this many pilots is settled before the batch in the heat microbenchmark. */
+/**
+ * @brief Compares updating the heat of pilots one at a time with the
+ *        batched pilots_heatUpdate().
+ *
+ * Every ship and active slot gets a random temperature, then the step is
+ *  done both ways from the same temperatures. Some pilots are settled with
+ *  pilot_heatSettle() before the batch runs. Fails if any temperature
+ *  differs at all.
+ */
+static int bench_heat (void)
+{
+   int i, j, n, ships, ret;
+   const char *sysname;
+   const Ship *ship;
+   Uint64 start;
+   double tsingle, tbatch, Q;
+   double *init, *ref;
+   Pilot *const *pilots;
+   Pilot *p;
+   PilotOutfitSlot *o;
+
+   sysname = system_existsCase( (conf.bench_system != NULL) ? conf.bench_system : "Sol" );
+   ship = ship_get( conf.bench_ship );
+   if ((sysname == NULL) || (ship == NULL)) {
+      WARN( _("Benchmark system or ship not found!") );
+      return -1;
+   }
+
+   ships = conf.bench_ships;
+   conf.bench_ships = BENCH_HEAT_SHIPS;
+   space_spawn = 0;
+   space_init( sysname );
+   bench_spawn( ship );
+   conf.bench_ships = ships;
+   space_spawn = 1;
+
+   /* Ship and slot temperatures of all the pilots, in order. */
+   pilots = pilot_getAll();
+   init = array_create( double );
+   for (i=0; i<array_size(pilots); i++) {
+      p = pilots[i];
+      p->heat_T = CONST_SPACE_STAR_TEMP + RNGF()*500.;
+      array_push_back( &init, p->heat_T );
+      for (j=0; j<array_size(p->outfits); j++) {
+         o = p->outfits[j];
+         o->heat_T = CONST_SPACE_STAR_TEMP + RNGF()*1000.;
+         array_push_back( &init, o->heat_T );
+      }
+   }
+   n = array_size( init );
+   ref = malloc( n * sizeof(double) );
+
+   /* One at a time, as pilot_update() used to. */
+   start = SDL_GetPerformanceCounter();
+   for (i=0; i<array_size(pilots); i++) {
+      p = pilots[i];
+      Q = 0.;
+      for (j=0; j<array_size(p->outfits); j++) {
+         o = p->outfits[j];
+         if (o->active)
+            Q += pilot_heatUpdateSlot( p, o, BENCH_DT );
+      }
+      pilot_heatUpdateShip( p, Q, BENCH_DT );
+   }
+   tsingle = bench_time( start );
+   for (i=0, n=0; i<array_size(pilots); i++) {
+      p = pilots[i];
+      ref[n++] = p->heat_T;
+      p->heat_T = init[n-1];
+      for (j=0; j<array_size(p->outfits); j++) {
+         ref[n++] = p->outfits[j]->heat_T;
+         p->outfits[j]->heat_T = init[n-1];
+      }
+   }
+
+   /* Batched, with some pilots needing their heat before the batch. */
+   start = SDL_GetPerformanceCounter();
+   for (i=0; i<array_size(pilots); i++)
+      pilot_heatQueue( pilots[i], BENCH_DT );
+   for (i=0; i<array_size(pilots); i+=BENCH_HEAT_SETTLE)
+      pilot_heatSettle( pilots[i] );
+   pilots_heatUpdate();
+   tbatch = bench_time( start );
+
+   ret = 0;
+   for (i=0, n=0; i<array_size(pilots); i++) {
+      p = pilots[i];
+      if (p->heat_T != ref[n++])
+         ret = -1;
+      for (j=0; j<array_size(p->outfits); j++)
+         if (p->outfits[j]->heat_T != ref[n++])
+            ret = -1;
+   }
+
+   LOG( _("   %d pilots with %d slots"), array_size(pilots), n - array_size(pilots) );
+   LOG( _("   one at a time: %.1f ns/pilot"), tsingle * 1e9 / array_size(pilots) );
+   LOG( _("   batched:       %.1f ns/pilot"), tbatch * 1e9 / array_size(pilots) );
+   array_free( init );
+   free( ref );
+   if (ret != 0) {
+      WARN( _("Batched heat update differs from updating pilots one at a time!") );
+      return -1;
+   }
+   return 0;
+}
+
+
+#define BENCH_LOD_SEEDS    8 /**< Battles per mode in the low detail microbenchmark. */
+#define BENCH_LOD_SHIPS    8 /**< Ships per side in the low detail microbenchmark. */
+#define BENCH_LOD_STEPS    3600 /**< Updates per battle in the low detail microbenchmark. */
+#define BENCH_LOD_TOLERANCE 3. /**< Pooled standard deviations the survivor means may differ by. */
+#define BENCH_LOD_SLACK    1. /**< Survivors the means may always differ by. */
+/**
+ * @brief Compares battles fought in full and in low detail.
+ *
+ * Fights the same seeded battles with low detail off and with every pilot
+ *  in low detail, logging the time taken and how many ships of each side
+ *  survive on average. Fails if a side's mean survivors differ between the
+ *  modes by more than BENCH_LOD_TOLERANCE pooled standard deviations plus
+ *  BENCH_LOD_SLACK ships.
+ */
+static int bench_lod (void)
+{
+   int i, j, k, mode, n, ships, ret;
+   const char *sysname;
+   const Ship *ship;
+   Uint64 start;
+   double lod, t, sum, sum2, sd, tol;
+   double mean[2][BENCH_NSIDES], var[2][BENCH_NSIDES];
+   int alive[BENCH_LOD_SEEDS][BENCH_NSIDES];
+
+   sysname = system_existsCase( (conf.bench_system != NULL) ? conf.bench_system : "Sol" );
+   ship = ship_get( conf.bench_ship );
+   if ((sysname == NULL) || (ship == NULL)) {
+      WARN( _("Benchmark system or ship not found!") );
+      return -1;
+   }
+
+   lod = conf.lod_distance;
+   ships = conf.bench_ships;
+   conf.bench_ships = BENCH_LOD_SHIPS;
+   space_spawn = 0;
+   LOG( _("   %d battles of %d %s per side for %d steps"),
+         BENCH_LOD_SEEDS, BENCH_LOD_SHIPS, _(ship->name), BENCH_LOD_STEPS );
+   for (mode=0; mode<2; mode++) {
+      /* Without a player, everything past the centre is far enough. */
+      conf.lod_distance = mode ? 1. : 0.;
+      t = 0.;
+      for (k=0; k<BENCH_LOD_SEEDS; k++) {
+         rng_seed( k+1 );
+         space_init( sysname );
+         bench_spawn( ship );
+         update_routine( BENCH_DT, 1 );
+         start = SDL_GetPerformanceCounter();
+         for (i=0; i<BENCH_LOD_STEPS; i++) {
+            update_routine( BENCH_DT, 0 );
+            arena_reset();
+         }
+         t += bench_time( start );
+         for (j=0; j<BENCH_NSIDES; j++)
+            alive[k][j] = bench_alive( bench_sides[j].id );
+      }
+      LOG( mode ? _("   low detail:  %.3f ms/step") : _("   full detail: %.3f ms/step"),
+            t * 1000. / (BENCH_LOD_SEEDS * BENCH_LOD_STEPS) );
+      for (j=0; j<BENCH_NSIDES; j++) {
+         sum = 0.;
+         for (k=0; k<BENCH_LOD_SEEDS; k++)
+            sum += alive[k][j];
+         mean[mode][j] = sum / BENCH_LOD_SEEDS;
+         sum2 = 0.;
+         for (k=0; k<BENCH_LOD_SEEDS; k++) {
+            n = alive[k][j];
+            sum2 += (n - mean[mode][j]) * (n - mean[mode][j]);
+         }
+         var[mode][j] = sum2 / (BENCH_LOD_SEEDS-1);
+         LOG( _("      %s: %.2f +- %.2f alive"), _(bench_sides[j].faction),
+               mean[mode][j], sqrt( var[mode][j] ) );
+      }
+   }
+   conf.lod_distance = lod;
+   conf.bench_ships = ships;
+   space_spawn = 1;
+
+   /* Both modes fight the same number of battles, so the pooled variance is the plain average. */
+   ret = 0;
+   for (j=0; j<BENCH_NSIDES; j++) {
+      sd = sqrt( (var[0][j] + var[1][j]) / 2. );
+      tol = BENCH_LOD_TOLERANCE * sd + BENCH_LOD_SLACK;
+      if (fabs( mean[1][j] - mean[0][j] ) > tol) {
+         WARN( _("%s survivors differ by %.2f in low detail, over the tolerance of %.2f!"),
+               _(bench_sides[j].faction), fabs( mean[1][j] - mean[0][j] ), tol );
+         ret = -1;
+      }
+   }
+   return ret;
+}
+
+
+#define BENCH_ASTEROIDS       50000 /**< Asteroids in the asteroid microbenchmark. */
+#define BENCH_ASTEROID_STEPS  600 /**< Updates in the asteroid microbenchmark. */
+#define BENCH_ASTEROID_FRAME  150. /**< Speed of the frame of reference debris move in. */
+/**
+ * @brief Times the update of a dense asteroid field.
+ *
+ * Checks that asteroid_motionUpdate() moves asteroids, in a still frame of
+ *  reference, and debris, in a moving one, exactly like moving each body
+ *  on its own did, and fails otherwise. Then fills the first asteroid field
+ *  found with BENCH_ASTEROIDS asteroids and runs the space update on its
+ *  own.
+ */
+static int bench_asteroids (void)
+{
+   int i, k, f, nb, ret;
+   Uint64 start;
+   double t, tref, tmotion, fx, fy;
+   StarSystem *systems, *sys;
+   AsteroidAnchor *field;
+   AsteroidMotion m;
+   BenchBody *ref;
+
+   ret = 0;
+   m.x = malloc( BENCH_ASTEROIDS * sizeof(double) );
+   m.y = malloc( BENCH_ASTEROIDS * sizeof(double) );
+   m.vx = malloc( BENCH_ASTEROIDS * sizeof(double) );
+   m.vy = malloc( BENCH_ASTEROIDS * sizeof(double) );
+   ref = malloc( BENCH_ASTEROIDS * sizeof(BenchBody) );
+   for (f=0; f<2; f++) {
+      /* Asteroids move in a still frame, debris with the player. */
+      fx = f ? BENCH_ASTEROID_FRAME * cos(1.) : 0.;
+      fy = f ? BENCH_ASTEROID_FRAME * sin(1.) : 0.;
+      for (i=0; i<BENCH_ASTEROIDS; i++) {
+         vect_cset( &ref[i].pos, RNG(-10000,10000), RNG(-10000,10000) );
+         vect_pset( &ref[i].vel, RNGF()*20., RNGF()*2.*M_PI );
+         m.x[i] = ref[i].pos.x;
+         m.y[i] = ref[i].pos.y;
+         m.vx[i] = ref[i].vel.x;
+         m.vy[i] = ref[i].vel.y;
+      }
+
+      start = SDL_GetPerformanceCounter();
+      for (k=0; k<BENCH_ASTEROID_STEPS; k++) {
+         for (i=0; i<BENCH_ASTEROIDS; i++) {
+            if (f) {
+               ref[i].pos.x += (ref[i].vel.x-fx) * BENCH_DT;
+               ref[i].pos.y += (ref[i].vel.y-fy) * BENCH_DT;
+            }
+            else {
+               ref[i].pos.x += ref[i].vel.x * BENCH_DT;
+               ref[i].pos.y += ref[i].vel.y * BENCH_DT;
+            }
+         }
+      }
+      tref = bench_time( start );
+
+      start = SDL_GetPerformanceCounter();
+      for (k=0; k<BENCH_ASTEROID_STEPS; k++)
+         asteroid_motionUpdate( &m, BENCH_ASTEROIDS, fx, fy, BENCH_DT );
+      tmotion = bench_time( start );
+
+      LOG( f ? _("   debris one at a time:    %.2f ns/body")
+            : _("   asteroids one at a time: %.2f ns/body"),
+            tref * 1e9 / ((double)BENCH_ASTEROIDS * BENCH_ASTEROID_STEPS) );
+      LOG( f ? _("   debris by component:     %.2f ns/body")
+            : _("   asteroids by component:  %.2f ns/body"),
+            tmotion * 1e9 / ((double)BENCH_ASTEROIDS * BENCH_ASTEROID_STEPS) );
+      for (i=0; i<BENCH_ASTEROIDS; i++) {
+         if ((m.x[i] != ref[i].pos.x) || (m.y[i] != ref[i].pos.y)) {
+            WARN( f ? _("Debris %d moved to (%.17g, %.17g) instead of (%.17g, %.17g)!")
+                  : _("Asteroid %d moved to (%.17g, %.17g) instead of (%.17g, %.17g)!"),
+                  i, m.x[i], m.y[i], ref[i].pos.x, ref[i].pos.y );
+            ret = -1;
+            break;
+         }
+      }
+   }
+   free( m.x );
+   free( m.y );
+   free( m.vx );
+   free( m.vy );
+   free( ref );
+   if (ret != 0)
+      return ret;
+
+   sys = NULL;
+   systems = system_getAll();
+   for (i=0; i<array_size(systems); i++) {
+      if (array_size(systems[i].asteroids) > 0) {
+         sys = &systems[i];
+         break;
+      }
+   }
+   if (sys == NULL) {
+      WARN( _("No system with asteroids found!") );
+      return -1;
+   }
+
+   field = &sys->asteroids[0];
+   nb = field->nb;
+   field->nb = BENCH_ASTEROIDS;
+   space_spawn = 0;
+   space_init( sys->name );
+
+   start = SDL_GetPerformanceCounter();
+   for (i=0; i<BENCH_ASTEROID_STEPS; i++)
+      space_update( BENCH_DT );
+   t = bench_time( start );
+
+   LOG( _("   %d asteroids in %s for %d steps"), BENCH_ASTEROIDS,
+         _(sys->name), BENCH_ASTEROID_STEPS );
+   LOG( _("   update: %.3f ms/step (%.1f ns/asteroid)"),
+         t * 1000. / BENCH_ASTEROID_STEPS,
+         t * 1e9 / ((double)BENCH_ASTEROIDS * BENCH_ASTEROID_STEPS) );
+
+   field->nb = nb;
+   space_spawn = 1;
+   return 0;
+}
@@ -0,0 +1,13 @@
+/*
+ * See Licensing and Copyright notice in naev.h
+ */
+
+#ifndef BENCH_H
+#  define BENCH_H
+
+
+int bench_run (void);
+int bench_micro( const char *name );
+
+
+#endif /* BENCH_H */
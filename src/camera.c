@@ -34,6 +34,10 @@ static double camera_Y     = 0.; /**< Y position of camera. */
 /* Old is used to compensate pilot movement. */
 static double old_X        = 0.; /**< Old X positiion. */
 static double old_Y        = 0.; /**< Old Y position. */
+/* Previous is used to draw between updates. */
+static double prev_X       = 0.; /**< X position of camera before the last update. */
+static double prev_Y       = 0.; /**< Y position of camera before the last update. */
+static double camera_alpha = 1.; /**< Fraction of the way from the previous position to draw at. */
 /* Target is used why flying over with a target set. */
 static double target_Z     = 0.; /**< Target zoom. */
 static double target_X     = 0.; /**< Target X position. */
@@ -118,8 +122,14 @@ double cam_getZoomTarget (void)
  */
 void cam_getPos( double *x, double *y )
 {
-   *x = camera_X;
-   *y = camera_Y;
+   /* Don't sweep over jumps. */
+   if (pow2(camera_X-prev_X) + pow2(camera_Y-prev_Y) > pow2(SOLID_INTERP_SNAP)) {
+      *x = camera_X;
+      *y = camera_Y;
+      return;
+   }
+   *x = prev_X + camera_alpha*(camera_X - prev_X);
+   *y = prev_Y + camera_alpha*(camera_Y - prev_Y);
 }
 
 
@@ -145,6 +155,8 @@ void cam_setTargetPilot( unsigned int follow, int soft_over )
             camera_Y = y;
             old_X = x;
             old_Y = y;
+            prev_X = x;
+            prev_Y = y;
          }
       }
       camera_fly = 0;
@@ -173,6 +185,8 @@ void cam_setTargetPos( double x, double y, int soft_over )
       camera_Y = y;
       old_X    = x;
       old_Y    = y;
+      prev_X   = x;
+      prev_Y   = y;
       camera_fly = 0;
    }
    else {
@@ -211,6 +225,8 @@ void cam_update( double dt )
    /* Calculate differential. */
    dx    = old_X;
    dy    = old_Y;
+   prev_X = camera_X;
+   prev_Y = camera_Y;
 
    /* Going to position. */
    p   = NULL;
@@ -257,6 +273,18 @@ void cam_update( double dt )
 }
 
 
+/**
+ * @brief Sets where the camera is drawn between its last two updates.
+ *
+ *    @param alpha Fraction of the way from the previous update to the
+ *           last, 1 to use the real position.
+ */
+void cam_interpolate( double alpha )
+{
+   camera_alpha = alpha;
+}
+
+
 /**
  * @brief Updates the camera flying to a position.
  */
@@ -33,6 +33,7 @@ void cam_setTargetPos( double x, double y, int soft_over );
  * Update.
  */
 void cam_update( double dt );
+void cam_interpolate( double alpha );
 
 
 #endif /* CAMERA_H */
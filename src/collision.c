@@ -15,12 +15,21 @@
 
 #include "collision.h"
 
+#include "array.h"
+#include "dcache.h"
 #include "log.h"
+#include "ndata.h"
+#include "nxml.h"
+
+
+static DataCache *poly_cache = NULL; /**< Cache of loaded polygon files. */
 
 
 /*
  * Prototypes
  */
+static CollPoly* PolygonFromCache( const char *data, size_t size );
+static void PolygonToCache( const char *file, const CollPoly *polygons );
 static int pointInPolygon( const CollPoly* at, const Vector2d* ap,
       float x, float y );
 static int LineOnPolygon( const CollPoly* at, const Vector2d* ap,
@@ -85,6 +94,196 @@ void LoadPolygon( CollPoly* polygon, xmlNodePtr node )
 }
 
 
+/**
+ * @brief Opens the binary cache of polygon files.
+ *
+ * While open, polygon files loaded with LoadPolygonFile() are taken from
+ *  the cache if possible, and added to it otherwise.
+ */
+void PolygonCacheOpen (void)
+{
+   const char *dirs[] = { SHIP_POLYGON_PATH, OUTFIT_POLYGON_PATH, NULL };
+
+   if (poly_cache == NULL)
+      poly_cache = dcache_open( "polygons", dirs );
+}
+
+
+/**
+ * @brief Closes the binary cache of polygon files, writing it if needed.
+ */
+void PolygonCacheClose (void)
+{
+   dcache_close( poly_cache );
+   poly_cache = NULL;
+}
+
+
+/**
+ * @brief Loads polygons from their cached form.
+ *
+ * The cached form is the number of polygons followed by each polygon as
+ *  its number of points, bounds, and X and Y coordinates.
+ *
+ *    @param data Cached data.
+ *    @param size Size of data.
+ *    @return Array (array.h) of polygons, or NULL if the data is invalid.
+ */
+static CollPoly* PolygonFromCache( const char *data, size_t size )
+{
+   uint32_t i, n, npt;
+   size_t pos, len;
+   float bounds[4];
+   CollPoly *polygons, *polygon;
+
+   if (size < sizeof(uint32_t))
+      return NULL;
+   memcpy( &n, data, sizeof(uint32_t) );
+   pos = sizeof(uint32_t);
+
+   polygons = array_create_size( CollPoly, n );
+   for (i=0; i<n; i++) {
+      if (size - pos < sizeof(uint32_t) + sizeof(bounds))
+         break;
+      memcpy( &npt, &data[pos], sizeof(uint32_t) );
+      pos += sizeof(uint32_t);
+      memcpy( bounds, &data[pos], sizeof(bounds) );
+      pos += sizeof(bounds);
+      len = (size_t)npt * sizeof(float);
+      if ((size - pos) / 2 < len)
+         break;
+
+      polygon = &array_grow( &polygons );
+      polygon->npt = npt;
+      polygon->xmin = bounds[0];
+      polygon->xmax = bounds[1];
+      polygon->ymin = bounds[2];
+      polygon->ymax = bounds[3];
+      polygon->x = malloc( MAX( len, sizeof(float) ) );
+      polygon->y = malloc( MAX( len, sizeof(float) ) );
+      memcpy( polygon->x, &data[pos], len );
+      pos += len;
+      memcpy( polygon->y, &data[pos], len );
+      pos += len;
+   }
+
+   /* Truncated data, don't trust any of it. */
+   if (i < n) {
+      for (i=0; i<(uint32_t)array_size(polygons); i++) {
+         free( polygons[i].x );
+         free( polygons[i].y );
+      }
+      array_free( polygons );
+      return NULL;
+   }
+
+   return polygons;
+}
+
+
+/**
+ * @brief Adds polygons to the polygon cache.
+ *
+ *    @param file Polygon file the polygons were loaded from.
+ *    @param polygons Array (array.h) of polygons.
+ */
+static void PolygonToCache( const char *file, const CollPoly *polygons )
+{
+   int i;
+   uint32_t n, npt;
+   size_t size, pos, len;
+   float bounds[4];
+   char *data;
+
+   size = sizeof(uint32_t);
+   for (i=0; i<array_size(polygons); i++)
+      size += sizeof(uint32_t) + sizeof(bounds)
+            + 2 * (size_t)polygons[i].npt * sizeof(float);
+
+   data = malloc( size );
+   n = array_size(polygons);
+   memcpy( data, &n, sizeof(uint32_t) );
+   pos = sizeof(uint32_t);
+   for (i=0; i<array_size(polygons); i++) {
+      npt = polygons[i].npt;
+      bounds[0] = polygons[i].xmin;
+      bounds[1] = polygons[i].xmax;
+      bounds[2] = polygons[i].ymin;
+      bounds[3] = polygons[i].ymax;
+      len = (size_t)npt * sizeof(float);
+      memcpy( &data[pos], &npt, sizeof(uint32_t) );
+      pos += sizeof(uint32_t);
+      memcpy( &data[pos], bounds, sizeof(bounds) );
+      pos += sizeof(bounds);
+      memcpy( &data[pos], polygons[i].x, len );
+      pos += len;
+      memcpy( &data[pos], polygons[i].y, len );
+      pos += len;
+   }
+
+   dcache_put( poly_cache, file, data, size );
+   free( data );
+}
+
+
+/**
+ * @brief Loads all the polygons of a polygon file.
+ *
+ *    @param file Path of the polygon XML file.
+ *    @param size_hint Expected number of polygons.
+ *    @return Array (array.h) of polygons, or NULL if the file contains
+ *            no polygons.
+ */
+CollPoly* LoadPolygonFile( const char *file, int size_hint )
+{
+   CollPoly *polygons;
+   xmlDocPtr doc;
+   xmlNodePtr node, cur;
+   const char *data;
+   size_t size;
+
+   /* Try the cache first. */
+   data = dcache_get( poly_cache, file, &size );
+   if (data != NULL) {
+      polygons = PolygonFromCache( data, size );
+      if (polygons != NULL)
+         return polygons;
+   }
+
+   /* Load the XML. */
+   doc = xml_parsePhysFS( file );
+   if (doc == NULL)
+      return NULL;
+
+   node = doc->xmlChildrenNode; /* First polygon node */
+   if (node == NULL) {
+      xmlFreeDoc(doc);
+      WARN(_("Malformed %s file: does not contain elements"), file);
+      return NULL;
+   }
+
+   polygons = NULL;
+   do { /* load the polygon data */
+      if (xml_isNode(node,"polygons")) {
+         cur = node->children;
+         polygons = array_create_size( CollPoly, size_hint );
+         do {
+            if (xml_isNode(cur,"polygon"))
+               LoadPolygon( &array_grow( &polygons ), cur );
+         } while (xml_nextNode(cur));
+      }
+   } while (xml_nextNode(node));
+
+   xmlFreeDoc(doc);
+
+   if ((polygons != NULL) && (poly_cache != NULL)
+         && (data == NULL))
+      PolygonToCache( file, polygons );
+
+   return polygons;
+}
+
+
 /**
  * @brief Checks whether or not two sprites collide.
  *
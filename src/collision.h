@@ -30,6 +30,9 @@ typedef struct CollPoly_ {
 
 /* Loads a polygon data from xml. */
 void LoadPolygon( CollPoly* polygon, xmlNodePtr node );
+CollPoly* LoadPolygonFile( const char *file, int size_hint );
+void PolygonCacheOpen (void);
+void PolygonCacheClose (void);
 
 /* Returns 1 if collision is detected */
 int CollideSprite( const glTexture* at, const int asx, const int asy, const Vector2d* ap,
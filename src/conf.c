@@ -110,6 +110,15 @@ static void print_usage( void )
    LOG(_("   -s f, --svol f        sets the sound volume to f"));
    LOG(_("   -d, --datapath        adds a new datapath to be mounted (i.e., appends it to the search path for game assets)"));
    LOG(_("   -X, --scale           defines the scale factor"));
+   LOG(_("   --headless            runs without showing a window or playing sound"));
+   LOG(_("   --benchmark s         runs a headless battle benchmark in system s and exits"));
+   LOG(_("   --bench-ship s        sets the ship model fighting in the benchmark"));
+   LOG(_("   --bench-ships n       sets the number of ships on each side of the benchmark"));
+   LOG(_("   --bench-steps n       sets the number of updates to run in the benchmark"));
+   LOG(_("   --microbench s        runs the headless microbenchmark s (\"list\" lists them) and exits"));
+   LOG(_("   --lod-distance f      simulates pilots farther than f from the player in less detail"));
+   LOG(_("   --record f            records the random seed, frame times and input to file f"));
+   LOG(_("   --replay f            replays a run recorded in file f headless and exits"));
 #ifdef DEBUGGING
    LOG(_("   --devmode             enables dev mode perks like the editors"));
 #endif /* DEBUGGING */
@@ -169,6 +178,11 @@ void conf_setDefaults (void)
    /* Input */
    input_setDefault(LAYOUT_WASD);
 
+   /* Benchmark. */
+   conf.bench_ship  = strdup( BENCH_SHIP_DEFAULT );
+   conf.bench_ships = BENCH_SHIPS_DEFAULT;
+   conf.bench_steps = BENCH_STEPS_DEFAULT;
+
    /* Debugging. */
    conf.fpu_except   = 0; /* Causes many issues. */
 
@@ -193,6 +207,8 @@ void conf_setGameplayDefaults (void)
    conf.dt_mod = DT_MOD_DEFAULT;
    conf.autonav_reset_speed = AUTONAV_RESET_SPEED_DEFAULT;
    conf.autonav_ignore_passive = AUTONAV_IGNORE_PASSIVE_DEFAULT;
+   conf.save_compress = SAVE_COMPRESS_DEFAULT;
+   conf.lod_distance = LOD_DISTANCE_DEFAULT;
 }
 
 
@@ -248,6 +264,7 @@ void conf_setVideoDefaults (void)
    conf.colorblind_mode = COLORBLIND_MODE_DEFAULT;
    conf.bg_brightness = BG_BRIGHTNESS_DEFAULT;
    conf.gamma_correction = GAMMA_CORRECTION_DEFAULT;
+   conf.texture_cache = TEXTURE_CACHE_DEFAULT;
 
    /* FPS. */
    conf.fps_show = SHOW_FPS_DEFAULT;
@@ -270,6 +287,11 @@ void conf_cleanup (void)
    free(conf.dev_save_sys);
    free(conf.dev_save_map);
    free(conf.dev_save_asset);
+   free(conf.bench_system);
+   free(conf.bench_ship);
+   free(conf.microbench);
+   free(conf.record);
+   free(conf.replay);
 
    /* Clear memory. */
    memset( &conf, 0, sizeof(conf) );
@@ -351,6 +373,7 @@ int conf_loadConfig ( const char* file )
       conf_loadInt(lEnv, "colorblind_mode", conf.colorblind_mode);
       conf_loadFloat( lEnv, "bg_brightness", conf.bg_brightness );
       conf_loadFloat( lEnv, "gamma_correction", conf.gamma_correction );
+      conf_loadInt( lEnv, "texture_cache", conf.texture_cache );
 
       /* FPS */
       conf_loadBool( lEnv, "showfps", conf.fps_show );
@@ -406,6 +429,8 @@ int conf_loadConfig ( const char* file )
       conf_loadFloat( lEnv, "mouse_doubleclick", conf.mouse_doubleclick );
       conf_loadFloat( lEnv, "autonav_abort", conf.autonav_reset_speed );
       conf_loadInt(lEnv, "autonav_ignore_passive", conf.autonav_ignore_passive);
+      conf_loadFloat( lEnv, "lod_distance", conf.lod_distance );
+      conf_loadBool( lEnv, "save_compress", conf.save_compress );
       conf_loadBool( lEnv, "devmode", conf.devmode );
       conf_loadBool( lEnv, "devautosave", conf.devautosave );
       conf_loadBool( lEnv, "conf_nosave", conf.nosave );
@@ -553,6 +578,15 @@ void conf_parseCLI( int argc, char** argv )
       { "mvol", required_argument, 0, 'm' },
       { "svol", required_argument, 0, 's' },
       { "scale", required_argument, 0, 'X' },
+      { "headless", no_argument, 0, 'L' },
+      { "benchmark", required_argument, 0, 'B' },
+      { "bench-ship", required_argument, 0, 'b' },
+      { "bench-ships", required_argument, 0, 'n' },
+      { "bench-steps", required_argument, 0, 't' },
+      { "microbench", required_argument, 0, 'u' },
+      { "lod-distance", required_argument, 0, 'l' },
+      { "record", required_argument, 0, 'r' },
+      { "replay", required_argument, 0, 'R' },
 #ifdef DEBUGGING
       { "devmode", no_argument, 0, 'D' },
 #endif /* DEBUGGING */
@@ -616,6 +650,41 @@ void conf_parseCLI( int argc, char** argv )
          case 'X':
             conf.scalefactor = atof(optarg);
             break;
+         case 'L':
+            conf.headless = 1;
+            break;
+         case 'B':
+            free(conf.bench_system);
+            conf.bench_system = strdup(optarg);
+            conf.headless = 1;
+            break;
+         case 'b':
+            free(conf.bench_ship);
+            conf.bench_ship = strdup(optarg);
+            break;
+         case 'n':
+            conf.bench_ships = atoi(optarg);
+            break;
+         case 't':
+            conf.bench_steps = atoi(optarg);
+            break;
+         case 'u':
+            free(conf.microbench);
+            conf.microbench = strdup(optarg);
+            conf.headless = 1;
+            break;
+         case 'l':
+            conf.lod_distance = atof(optarg);
+            break;
+         case 'r':
+            free(conf.record);
+            conf.record = strdup(optarg);
+            break;
+         case 'R':
+            free(conf.replay);
+            conf.replay = strdup(optarg);
+            conf.headless = 1;
+            break;
 #ifdef DEBUGGING
          case 'D':
             conf.devmode = 1;
@@ -637,6 +706,16 @@ void conf_parseCLI( int argc, char** argv )
       free(conf.ndata);
       conf.ndata = strdup( argv[ optind ] );
    }
+
+   /* Nothing is seen or heard when headless, so don't wait on the display
+    * or change the user's configuration. */
+   if (conf.headless) {
+      conf.nosound = 1;
+      conf.fullscreen = 0;
+      conf.vsync = 0;
+      conf.fps_max = 0;
+      conf.nosave = 1;
+   }
 }
 
 
@@ -904,6 +983,10 @@ int conf_saveConfig ( const char* file )
    conf_saveFloat("gamma_correction",conf.gamma_correction);
    conf_saveEmptyLine();
 
+   conf_saveComment(_("Video memory in MiB to keep unused textures in so they don't have to be loaded again. 0 disables it."));
+   conf_saveInt("texture_cache",conf.texture_cache);
+   conf_saveEmptyLine();
+
    /* FPS */
    conf_saveComment(_("Display a frame rate counter"));
    conf_saveBool("showfps",conf.fps_show);
@@ -1021,6 +1104,14 @@ int conf_saveConfig ( const char* file )
    conf_saveBool("autonav_ignore_passive", conf.autonav_ignore_passive);
    conf_saveEmptyLine();
 
+   conf_saveComment(_("Distance from the player past which pilots are simulated in less detail (0 disables)."));
+   conf_saveFloat("lod_distance",conf.lod_distance);
+   conf_saveEmptyLine();
+
+   conf_saveComment(_("Whether to compress saved games (uncompressed ones still load)."));
+   conf_saveBool("save_compress",conf.save_compress);
+   conf_saveEmptyLine();
+
    conf_saveComment(_("Enables developer mode (universe editor and the likes)"));
    conf_saveBool("devmode",conf.devmode);
    conf_saveEmptyLine();
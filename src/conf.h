@@ -25,6 +25,8 @@
 #define DT_MOD_DEFAULT 1. /**< conf.dt_mod */
 #define AUTONAV_RESET_SPEED_DEFAULT 1. /**< conf.autonav_reset_speed */
 #define AUTONAV_IGNORE_PASSIVE_DEFAULT 1 /**< conf.autonav_ignore_passive */
+#define SAVE_COMPRESS_DEFAULT 1 /**< conf.save_compress */
+#define LOD_DISTANCE_DEFAULT 0. /**< conf.lod_distance */
 /* Video option defaults */
 #define RESOLUTION_W_DEFAULT RESOLUTION_W_MIN /**< conf.width */
 #define RESOLUTION_H_DEFAULT RESOLUTION_H_MIN /**< conf.height */
@@ -46,6 +48,7 @@
 #define MAP_OVERLAY_OPACITY_DEFAULT 0.55 /**< conf.map_overlay_opacity */
 #define ZOOM_FAR_DEFAULT 0.5 /**< conf.zoom_far */
 #define ZOOM_NEAR_DEFAULT 1. /**< conf.zoom_near */
+#define TEXTURE_CACHE_DEFAULT 128 /**< conf.texture_cache */
 /* Audio option defaults */
 #define MUTE_SOUND_DEFAULT 0 /**< conf.nosound */
 #define USE_EFX_DEFAULT 1 /**< conf.al_efx */
@@ -59,6 +62,10 @@
 #define FONT_SIZE_SMALL_DEFAULT 11 /**< conf.font_size_small */
 /* Debugging option defaults */
 #define REDIRECT_FILE_DEFAULT 1 /**< conf.redirect_file */
+/* Benchmark option defaults */
+#define BENCH_SHIP_DEFAULT "Lancelot" /**< conf.bench_ship */
+#define BENCH_SHIPS_DEFAULT 20 /**< conf.bench_ships */
+#define BENCH_STEPS_DEFAULT 3600 /**< conf.bench_steps */
 /* Editor option defaults */
 #define DEV_SAVE_SYSTEM_DEFAULT "../dat/ssys/" /**< conf.dev_save_sys */
 #define DEV_SAVE_ASSET_DEFAULT "../dat/assets/" /**< conf.dev_save_asset */
@@ -112,6 +119,7 @@ typedef struct PlayerConf_s {
     */
    double autonav_reset_speed;
    int autonav_ignore_passive; /**< Whether to ignore passive enemies. */
+   double lod_distance; /**< Distance from the player past which pilots are simulated in low detail, 0 to disable. */
 
    /* Video options */
    int width; /**< Width of the window to use. */
@@ -136,6 +144,7 @@ typedef struct PlayerConf_s {
    double map_overlay_opacity; /**< Map overlay opacity. */
    double zoom_far; /**< Far zoom distance (smaller is further) */
    double zoom_near; /**< Near zoom distance (larger is closer) */
+   int texture_cache; /**< Memory in MiB to keep unused textures in, 0 to disable. */
 
    /* Audio options */
    int nosound; /**< Whether to disable all audio. */
@@ -164,10 +173,21 @@ typedef struct PlayerConf_s {
 
    /* Misc. */
    int nosave; /**< Disables conf saving. */
+   int save_compress; /**< Whether to compress saved games. */
    int devmode; /**< Developer mode. */
    int devautosave; /**< Developer mode autosave. */
    char *lastversion; /**< The last version the game was ran in. */
 
+   /* Headless and benchmark. */
+   int headless; /**< Run without showing a window or playing sound. */
+   char *bench_system; /**< System to run the battle benchmark in, or NULL. */
+   char *bench_ship; /**< Ship model fighting in the benchmark. */
+   int bench_ships; /**< Ships on each side of the benchmark. */
+   int bench_steps; /**< Updates to run in the benchmark. */
+   char *microbench; /**< Microbenchmark to run, or NULL. */
+   char *record; /**< File to record the run to, or NULL. */
+   char *replay; /**< File to replay a recorded run from, or NULL. */
+
    /* Debugging. */
    int redirect_file; /**< Whether to redirect logs and errors to files. */
    int fpu_except; /**< Enable FPU exceptions? */
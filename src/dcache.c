@@ -0,0 +1,394 @@
+/*
+ * See Licensing and Copyright notice in naev.h
+ */
+
+/**
+ * @file dcache.c
+ *
+ * @brief Binary cache of plain data derived from ndata.
+ *
+ * Some data is expensive to derive from the XML in ndata but is plain
+ *  data once loaded. The data cache stores such data in a single binary
+ *  file in the PhysicsFS write directory so it can be used directly on
+ *  the next start instead of being parsed again. Currently only the
+ *  collision polygons are cached: the outfit, ship and universe stacks
+ *  hold textures, Lua state and pointers into each other, so they can't
+ *  be stored this way.
+ *
+ * Each cache is keyed by a hash of the names, sizes and modification
+ *  times of all the files in the ndata directories it's derived from.
+ *  If anything in those directories changes, the whole cache is
+ *  considered stale and is rebuilt from whatever gets put into it.
+ *
+ * The file only uses offsets relative to its start, so it's loaded with
+ *  a single read and entries are used in place without any fixups:
+ *
+ *  - DataCacheHeader
+ *  - DataCacheEntry[nentries], sorted by name
+ *  - Names and data, each data block aligned to DCACHE_ALIGN bytes.
+ */
+
+
+/** @cond */
+#include <stdint.h>
+#include "physfs.h"
+
+#include "naev.h"
+/** @endcond */
+
+#include "dcache.h"
+
+#include "array.h"
+#include "log.h"
+#include "md5.h"
+#include "ndata.h"
+#include "nfile.h"
+#include "nstring.h"
+
+
+#define DCACHE_MAGIC       "NAIKDC1" /**< Magic string (including the NUL) identifying cache files. */
+#define DCACHE_BYTEORDER   0x01020304 /**< Detects caches written with another byte order. */
+#define DCACHE_ALIGN       8 /**< Alignment of the data blocks. */
+#define DCACHE_PATH        "cache" /**< Directory of the write directory to store caches in. */
+
+
+/**
+ * @brief Header of a cache file.
+ */
+typedef struct DataCacheHeader_ {
+   char magic[8]; /**< Must be DCACHE_MAGIC. */
+   uint32_t byteorder; /**< Must be DCACHE_BYTEORDER. */
+   uint32_t nentries; /**< Number of entries. */
+   md5_byte_t key[16]; /**< Hash of the ndata files the cache was built from. */
+} DataCacheHeader;
+
+
+/**
+ * @brief Entry of a cache file.
+ */
+typedef struct DataCacheEntry_ {
+   uint32_t name; /**< Offset of the NUL-terminated name. */
+   uint32_t data; /**< Offset of the data. */
+   uint32_t size; /**< Size of the data. */
+} DataCacheEntry;
+
+
+/**
+ * @brief Entry added to a cache since it was opened.
+ */
+typedef struct DataCacheNew_ {
+   char *name; /**< Name of the entry. */
+   void *data; /**< Copy of the data. */
+   size_t size; /**< Size of the data. */
+} DataCacheNew;
+
+
+/**
+ * @brief Opened cache.
+ */
+struct DataCache_ {
+   char *path; /**< Path of the cache file. */
+   md5_byte_t key[16]; /**< Hash of the current ndata files. */
+   char *buf; /**< Contents of the cache file, NULL if missing or stale. */
+   size_t bufsize; /**< Size of buf. */
+   const DataCacheEntry *entries; /**< Entries of buf. */
+   uint32_t nentries; /**< Number of entries in buf. */
+   DataCacheNew *added; /**< Array (array.h): Entries added with dcache_put(). */
+};
+
+
+/*
+ * Prototypes.
+ */
+static void dcache_key( const char *const *dirs, md5_byte_t key[16] );
+static int dcache_validate( DataCache *dc );
+static const char* dcache_name( const DataCache *dc, uint32_t i );
+static int dcache_cmpNew( const void *p1, const void *p2 );
+static void dcache_write( DataCache *dc );
+
+
+/**
+ * @brief Computes the key of a set of ndata directories.
+ *
+ *    @param dirs NULL-terminated list of directories.
+ *    @param[out] key Hash of the directories.
+ */
+static void dcache_key( const char *const *dirs, md5_byte_t key[16] )
+{
+   int i, j;
+   char **files;
+   PHYSFS_Stat stat;
+   int64_t meta[2];
+   md5_state_t md5;
+
+   md5_init( &md5 );
+   for (i=0; dirs[i]!=NULL; i++) {
+      files = ndata_listRecursive( dirs[i] );
+      for (j=0; j<array_size(files); j++) {
+         md5_append( &md5, (md5_byte_t*)files[j], strlen(files[j])+1 );
+         if (PHYSFS_stat( files[j], &stat )) {
+            meta[0] = stat.modtime;
+            meta[1] = stat.filesize;
+            md5_append( &md5, (md5_byte_t*)meta, sizeof(meta) );
+         }
+         free( files[j] );
+      }
+      array_free( files );
+   }
+   md5_finish( &md5, key );
+}
+
+
+/**
+ * @brief Opens a data cache.
+ *
+ * The cache file is loaded if it exists and its key matches the current
+ *  state of the directories, otherwise the cache starts out empty.
+ *
+ *    @param name Name of the cache file.
+ *    @param dirs NULL-terminated list of ndata directories the cached data
+ *           is derived from.
+ *    @return The opened cache, close with dcache_close().
+ */
+DataCache* dcache_open( const char *name, const char *const *dirs )
+{
+   DataCache *dc;
+
+   dc = calloc( 1, sizeof(DataCache) );
+   asprintf( &dc->path, "%s/"DCACHE_PATH"/%s", PHYSFS_getWriteDir(), name );
+   dc->added = array_create( DataCacheNew );
+   dcache_key( dirs, dc->key );
+
+   if (nfile_fileExists( dc->path )) {
+      dc->buf = nfile_readFile( &dc->bufsize, dc->path );
+      if ((dc->buf != NULL) && dcache_validate( dc )) {
+         DEBUG( _("Data cache '%s' is stale, rebuilding"), name );
+         free( dc->buf );
+         dc->buf = NULL;
+         dc->entries = NULL;
+         dc->nentries = 0;
+      }
+   }
+
+   return dc;
+}
+
+
+/**
+ * @brief Checks that a loaded cache file is usable.
+ *
+ *    @param dc Cache with the file loaded into buf.
+ *    @return 0 if the cache is valid.
+ */
+static int dcache_validate( DataCache *dc )
+{
+   uint32_t i;
+   const DataCacheHeader *hdr;
+   const DataCacheEntry *e;
+   size_t tbl;
+
+   if (dc->bufsize < sizeof(DataCacheHeader))
+      return -1;
+   hdr = (const DataCacheHeader*) dc->buf;
+   if ((memcmp( hdr->magic, DCACHE_MAGIC, sizeof(hdr->magic) ) != 0)
+         || (hdr->byteorder != DCACHE_BYTEORDER)
+         || (memcmp( hdr->key, dc->key, sizeof(dc->key) ) != 0))
+      return -1;
+
+   /* Everything must be in bounds so lookups never have to check. */
+   tbl = sizeof(DataCacheHeader) + (size_t)hdr->nentries*sizeof(DataCacheEntry);
+   if (tbl > dc->bufsize)
+      return -1;
+   e = (const DataCacheEntry*) &dc->buf[ sizeof(DataCacheHeader) ];
+   for (i=0; i<hdr->nentries; i++) {
+      if ((e[i].name < tbl) || (e[i].name >= dc->bufsize)
+            || (memchr( &dc->buf[e[i].name], '\0',
+                  dc->bufsize - e[i].name ) == NULL))
+         return -1;
+      if ((e[i].data < tbl) || (e[i].data > dc->bufsize)
+            || (e[i].size > dc->bufsize - e[i].data))
+         return -1;
+   }
+
+   dc->entries = e;
+   dc->nentries = hdr->nentries;
+   return 0;
+}
+
+
+/**
+ * @brief Gets the name of a loaded entry.
+ */
+static const char* dcache_name( const DataCache *dc, uint32_t i )
+{
+   return &dc->buf[ dc->entries[i].name ];
+}
+
+
+/**
+ * @brief Gets an entry from the cache.
+ *
+ *    @param dc Cache to get entry from.
+ *    @param key Name of the entry.
+ *    @param[out] size Size of the data.
+ *    @return The data (aligned to 8 bytes and owned by the cache), or NULL
+ *            if it isn't cached.
+ */
+const void* dcache_get( const DataCache *dc, const char *key, size_t *size )
+{
+   uint32_t lo, hi, mid;
+   int cmp;
+
+   if (dc == NULL)
+      return NULL;
+
+   lo = 0;
+   hi = dc->nentries;
+   while (lo < hi) {
+      mid = lo + (hi-lo)/2;
+      cmp = strcmp( key, dcache_name( dc, mid ) );
+      if (cmp == 0) {
+         *size = dc->entries[mid].size;
+         return &dc->buf[ dc->entries[mid].data ];
+      }
+      else if (cmp < 0)
+         hi = mid;
+      else
+         lo = mid+1;
+   }
+   return NULL;
+}
+
+
+/**
+ * @brief Adds an entry to the cache.
+ *
+ * The entry will be written when the cache is closed. It should only be
+ *  used for entries that dcache_get() didn't find.
+ *
+ *    @param dc Cache to add entry to.
+ *    @param key Name of the entry.
+ *    @param data Data to store (copied).
+ *    @param size Size of data.
+ */
+void dcache_put( DataCache *dc, const char *key, const void *data, size_t size )
+{
+   DataCacheNew *n;
+
+   if (dc == NULL)
+      return;
+
+   n = &array_grow( &dc->added );
+   n->name = strdup( key );
+   n->size = size;
+   n->data = malloc( size );
+   memcpy( n->data, data, size );
+}
+
+
+/**
+ * @brief Compares new entries by name for qsort.
+ */
+static int dcache_cmpNew( const void *p1, const void *p2 )
+{
+   const DataCacheNew *n1, *n2;
+   n1 = (const DataCacheNew*) p1;
+   n2 = (const DataCacheNew*) p2;
+   return strcmp( n1->name, n2->name );
+}
+
+
+/**
+ * @brief Writes a cache which had entries added.
+ *
+ *    @param dc Cache to write.
+ */
+static void dcache_write( DataCache *dc )
+{
+   uint32_t i;
+   int j;
+   DataCacheNew *all;
+   DataCacheHeader *hdr;
+   DataCacheEntry *e;
+   char *buf;
+   size_t len, pos, n;
+
+   /* Merge the still valid loaded entries with the new ones. */
+   all = array_create_size( DataCacheNew, dc->nentries + array_size(dc->added) );
+   for (i=0; i<dc->nentries; i++) {
+      DataCacheNew *c = &array_grow( &all );
+      c->name = (char*) dcache_name( dc, i );
+      c->data = &dc->buf[ dc->entries[i].data ];
+      c->size = dc->entries[i].size;
+   }
+   for (j=0; j<array_size(dc->added); j++)
+      array_push_back( &all, dc->added[j] );
+   qsort( all, array_size(all), sizeof(DataCacheNew), dcache_cmpNew );
+
+   /* Lay out the file. */
+   n = array_size(all);
+   len = sizeof(DataCacheHeader) + n*sizeof(DataCacheEntry);
+   for (j=0; j<array_size(all); j++) {
+      len += strlen( all[j].name ) + 1;
+      len = (len + DCACHE_ALIGN-1) & ~(size_t)(DCACHE_ALIGN-1);
+      len += all[j].size;
+   }
+   if (len > UINT32_MAX) {
+      WARN( _("Data cache '%s' is too large to write"), dc->path );
+      array_free( all );
+      return;
+   }
+
+   buf = calloc( 1, len );
+   hdr = (DataCacheHeader*) buf;
+   memcpy( hdr->magic, DCACHE_MAGIC, sizeof(hdr->magic) );
+   hdr->byteorder = DCACHE_BYTEORDER;
+   hdr->nentries = n;
+   memcpy( hdr->key, dc->key, sizeof(hdr->key) );
+   e = (DataCacheEntry*) &buf[ sizeof(DataCacheHeader) ];
+   pos = sizeof(DataCacheHeader) + n*sizeof(DataCacheEntry);
+   for (j=0; j<array_size(all); j++) {
+      e[j].name = pos;
+      strcpy( &buf[pos], all[j].name );
+      pos += strlen( all[j].name ) + 1;
+      pos = (pos + DCACHE_ALIGN-1) & ~(size_t)(DCACHE_ALIGN-1);
+      e[j].data = pos;
+      e[j].size = all[j].size;
+      memcpy( &buf[pos], all[j].data, all[j].size );
+      pos += all[j].size;
+   }
+   array_free( all );
+
+   if (PHYSFS_mkdir( DCACHE_PATH ) == 0)
+      WARN( _("Unable to create data cache directory '%s/%s': %s"), PHYSFS_getWriteDir(),
+            DCACHE_PATH, PHYSFS_getErrorByCode( PHYSFS_getLastErrorCode() ) );
+   else
+      nfile_writeFile( buf, len, dc->path );
+   free( buf );
+}
+
+
+/**
+ * @brief Closes a data cache, writing it if entries were added.
+ *
+ *    @param dc Cache to close.
+ */
+void dcache_close( DataCache *dc )
+{
+   int i;
+
+   if (dc == NULL)
+      return;
+
+   if (array_size(dc->added) > 0)
+      dcache_write( dc );
+
+   for (i=0; i<array_size(dc->added); i++) {
+      free( dc->added[i].name );
+      free( dc->added[i].data );
+   }
+   array_free( dc->added );
+   free( dc->buf );
+   free( dc->path );
+   free( dc );
+}
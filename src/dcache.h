@@ -0,0 +1,24 @@
+/*
+ * See Licensing and Copyright notice in naev.h
+ */
+
+#ifndef DCACHE_H
+#  define DCACHE_H
+
+
+/** @cond */
+#include <stddef.h>
+/** @endcond */
+
+
+struct DataCache_;
+typedef struct DataCache_ DataCache; /**< Binary cache of data derived from ndata. */
+
+
+DataCache* dcache_open( const char *name, const char *const *dirs );
+const void* dcache_get( const DataCache *dc, const char *key, size_t *size );
+void dcache_put( DataCache *dc, const char *key, const void *data, size_t size );
+void dcache_close( DataCache *dc );
+
+
+#endif /* DCACHE_H */
@@ -35,6 +35,7 @@
 #include "nstring.h"
 #include "opengl.h"
 #include "pause.h"
+#include "replay.h"
 #include "toolkit.h"
 
 
@@ -1021,7 +1022,7 @@ static int toolkit_loop( int *loop_done, dialogue_update_t *du )
       /* Loop first so exit condition is checked before next iteration. */
       main_loop( 0 );
 
-      while (!naev_isQuit() && SDL_PollEvent(&event)) { /* event loop */
+      while (!naev_isQuit() && replay_pollEvent(&event)) { /* event loop */
          if (event.type == SDL_QUIT) {
             if (menu_askQuit()) {
                naev_quit(); /* Quit is handled here */
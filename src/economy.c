@@ -69,6 +69,29 @@ static cs *econ_G = NULL; /**< Admittance matrix. */
 int *econ_comm = NULL; /**< Commodities to calculate. */
 
 
+/*
+ * Batched price evaluation cache.
+ */
+static const Commodity *econ_batchCom = NULL; /**< Commodity the batch is gathered for. */
+static int econ_batchValid = 0; /**< Whether the gathered batch data is valid. */
+static int *econ_batchPlanet = NULL; /**< Array (array.h): Planet IDs of the batch. */
+static double *econ_batchBase = NULL; /**< Array (array.h): Base prices. */
+static double *econ_batchSysVar = NULL; /**< Array (array.h): System variations. */
+static double *econ_batchSysPeriod = NULL; /**< Array (array.h): System periods. */
+static double *econ_batchPlanetVar = NULL; /**< Array (array.h): Planet variations. */
+static double *econ_batchPlanetPeriod = NULL; /**< Array (array.h): Planet periods. */
+static credits_t *econ_batchPrice = NULL; /**< Array (array.h): Prices indexed by planet ID. */
+static ntime_t econ_batchTime = 0; /**< Time the prices were evaluated at. */
+static int econ_batchPriceValid = 0; /**< Whether econ_batchPrice is valid. */
+
+
+/*
+ * Prototypes.
+ */
+static void economy_batchGather( const Commodity *com );
+static void economy_batchFree (void);
+
+
 
 /**
  * @brief Gets the price of a good on a planet in a system.
@@ -142,6 +165,160 @@ credits_t economy_getPriceAtTime( const Commodity *com,
    return (credits_t) (price+0.5);/* +0.5 to round */
 }
 
+/**
+ * @brief Gathers the price parameters of a commodity on all planets
+ *  into contiguous arrays for batched evaluation.
+ *
+ *    @param com Commodity to gather price parameters of.
+ */
+static void economy_batchGather( const Commodity *com )
+{
+   int i, j;
+   Planet *planets;
+   Planet *p;
+   CommodityPrice *commPrice;
+
+   if (econ_batchPlanet == NULL) {
+      econ_batchPlanet = array_create( int );
+      econ_batchBase = array_create( double );
+      econ_batchSysVar = array_create( double );
+      econ_batchSysPeriod = array_create( double );
+      econ_batchPlanetVar = array_create( double );
+      econ_batchPlanetPeriod = array_create( double );
+      econ_batchPrice = array_create( credits_t );
+   }
+   array_resize( &econ_batchPlanet, 0 );
+   array_resize( &econ_batchBase, 0 );
+   array_resize( &econ_batchSysVar, 0 );
+   array_resize( &econ_batchSysPeriod, 0 );
+   array_resize( &econ_batchPlanetVar, 0 );
+   array_resize( &econ_batchPlanetPeriod, 0 );
+
+   planets = planet_getAll();
+   for (i=0; i<array_size(planets); i++) {
+      p = &planets[i];
+      for (j=0; j<array_size(p->commodities); j++)
+         if (p->commodities[j] == com)
+            break;
+      if (j >= array_size(p->commodities))
+         continue;
+
+      commPrice = &p->commodityPrice[j];
+      array_push_back( &econ_batchPlanet, p->id );
+      array_push_back( &econ_batchBase, commPrice->price );
+      array_push_back( &econ_batchSysVar, commPrice->sysVariation );
+      array_push_back( &econ_batchSysPeriod, commPrice->sysPeriod );
+      array_push_back( &econ_batchPlanetVar, commPrice->planetVariation );
+      array_push_back( &econ_batchPlanetPeriod, commPrice->planetPeriod );
+   }
+
+   /* Planets that don't sell the commodity are marked with -1. */
+   array_resize( &econ_batchPrice, array_size(planets) );
+   for (i=0; i<array_size(econ_batchPrice); i++)
+      econ_batchPrice[i] = -1;
+
+   econ_batchCom = com;
+   econ_batchValid = 1;
+   econ_batchPriceValid = 0;
+}
+
+
+/**
+ * @brief Frees the batched price evaluation data.
+ */
+static void economy_batchFree (void)
+{
+   array_free( econ_batchPlanet );
+   array_free( econ_batchBase );
+   array_free( econ_batchSysVar );
+   array_free( econ_batchSysPeriod );
+   array_free( econ_batchPlanetVar );
+   array_free( econ_batchPlanetPeriod );
+   array_free( econ_batchPrice );
+   econ_batchPlanet = NULL;
+   econ_batchBase = NULL;
+   econ_batchSysVar = NULL;
+   econ_batchSysPeriod = NULL;
+   econ_batchPlanetVar = NULL;
+   econ_batchPlanetPeriod = NULL;
+   econ_batchPrice = NULL;
+   economy_clearPriceCache();
+}
+
+
+/**
+ * @brief Invalidates the batched price cache.
+ *
+ * Must be called whenever planet commodity prices or the planet stack
+ *  change.
+ */
+void economy_clearPriceCache (void)
+{
+   econ_batchCom = NULL;
+   econ_batchValid = 0;
+   econ_batchPriceValid = 0;
+}
+
+
+/**
+ * @brief Gets the price of a good on all planets at a given time.
+ *
+ * Prices are evaluated in a single pass over contiguous arrays and
+ *  cached, so repeated calls for the same commodity and time are
+ *  essentially free.
+ *
+ *    @param com Commodity to get prices of.
+ *    @param tme Time to get prices at, eg as returned by ntime_get().
+ *    @return Array (array.h) of prices indexed by planet ID, with -1 for
+ *       planets which don't sell the commodity. Owned by the economy
+ *       and only valid until the next call.
+ */
+const credits_t *economy_getPricesAtTime( const Commodity *com, ntime_t tme )
+{
+   int i, n;
+   double t;
+   double price;
+   double *base, *sysVar, *sysPeriod, *planetVar, *planetPeriod;
+
+   if ((econ_batchCom != com) || !econ_batchValid
+         || (array_size(econ_batchPrice) != array_size(planet_getAll())))
+      economy_batchGather( com );
+   else if (econ_batchPriceValid && (econ_batchTime == tme))
+      return econ_batchPrice;
+
+   /* Same formula as economy_getPriceAtTime(). */
+   t = ntime_convertSeconds(tme) / NT_HOUR_SECONDS;
+   n = array_size(econ_batchPlanet);
+   base = econ_batchBase;
+   sysVar = econ_batchSysVar;
+   sysPeriod = econ_batchSysPeriod;
+   planetVar = econ_batchPlanetVar;
+   planetPeriod = econ_batchPlanetPeriod;
+   for (i=0; i<n; i++) {
+      price = (base[i] + sysVar[i] * sin(2 * M_PI * t / sysPeriod[i])
+            + planetVar[i] * sin(2 * M_PI * t / planetPeriod[i]));
+      econ_batchPrice[econ_batchPlanet[i]] = (credits_t) (price+0.5);
+   }
+
+   econ_batchTime = tme;
+   econ_batchPriceValid = 1;
+   return econ_batchPrice;
+}
+
+
+/**
+ * @brief Gets the current price of a good on all planets.
+ *
+ *    @param com Commodity to get prices of.
+ *    @return Array (array.h) of prices indexed by planet ID, see
+ *       economy_getPricesAtTime().
+ */
+const credits_t *economy_getPrices( const Commodity *com )
+{
+   return economy_getPricesAtTime( com, ntime_get() );
+}
+
+
 /**
  * @brief Gets the average price of a good on a planet.
  *
@@ -303,6 +480,9 @@ int economy_refresh (void)
    if (econ_initialized == 0)
       return 0;
 
+   /* Planets may have changed. */
+   economy_clearPriceCache();
+
    /* Initialize the prices. */
    economy_update( 0 );
 
@@ -330,6 +510,9 @@ void economy_destroy (void)
 {
    int i;
 
+   /* Free the batched price cache. */
+   economy_batchFree();
+
    /* Must be initialized. */
    if (!econ_initialized)
       return;
@@ -595,6 +778,10 @@ void economy_initialiseCommodityPrices(void)
    StarSystem *sys;
    Commodity *com;
    CommodityModifier *this, *next;
+
+   /* Prices are about to change. */
+   economy_clearPriceCache();
+
    /* First use planet attributes to set prices and variability */
    for (k=0; k<array_size(systems_stack); k++) {
       sys = &systems_stack[k];
@@ -654,6 +841,8 @@ void economy_initialiseCommodityPrices(void)
 void economy_initialiseSingleSystem( StarSystem *sys, Planet *planet )
 {
    int i;
+
+   economy_clearPriceCache();
    for ( i=0; i<array_size(planet->commodities); i++ ) {
       economy_calcPrice(planet, planet->commodities[i], &planet->commodityPrice[i]);
    }
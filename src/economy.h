@@ -30,6 +30,9 @@ void economy_destroy (void);
 int economy_getAveragePlanetPrice( const Commodity *com, const Planet *p, credits_t *mean, double *std);
 credits_t economy_getPrice( const Commodity *com, const StarSystem *sys, const Planet *p );
 credits_t economy_getPriceAtTime( const Commodity *com, const StarSystem *sys, const Planet *p, ntime_t t );
+const credits_t *economy_getPrices( const Commodity *com );
+const credits_t *economy_getPricesAtTime( const Commodity *com, ntime_t t );
+void economy_clearPriceCache (void);
 
 /*
  * Calculating the sinusoidal economy values
@@ -86,7 +86,7 @@ static Event_t *event_active     = NULL; /**< Active events. */
  */
 static unsigned int event_genID (void);
 static int event_cmp( const void* a, const void* b );
-static int event_parseFile( const char* file );
+static int event_parseFile( const XmlFile *xf );
 static int event_parseXML( EventData *temp, const xmlNodePtr parent );
 static void event_freeData( EventData *event );
 static int event_create( int dataid, unsigned int *id );
@@ -492,15 +492,19 @@ int events_load (void)
 {
    int    i;
    char **event_files;
+   XmlFile *docs;
 
-   /* Run over events. */
+   /* Run over events, reading the headers in parallel. */
    event_files = ndata_listRecursive( EVENT_DATA_PATH );
    event_data  = array_create_size( EventData, array_size( event_files ) );
-   for ( i = 0; i < array_size( event_files ); i++ ) {
+   docs = xml_parsePhysFSList( event_files, "</event>" );
+   for ( i = 0; i < array_size( docs ); i++ ) {
       if (!naev_pollQuit())
-         event_parseFile(event_files[i]);
-      free( event_files[ i ] );
+         event_parseFile( &docs[i] );
    }
+   xml_freeFileList( docs );
+   for ( i = 0; i < array_size( event_files ); i++ )
+      free( event_files[ i ] );
    array_free( event_files );
    array_shrink( &event_data );
 
@@ -515,14 +519,14 @@ int events_load (void)
 
 /**
  * @brief Parses an event file.
+ *
+ *    @param xf Event file as read by xml_parsePhysFSList().
  */
-static int event_parseFile( const char* file )
+static int event_parseFile( const XmlFile *xf )
 {
-   size_t bufsize;
    xmlNodePtr node;
-   xmlDocPtr doc;
-   char *filebuf;
-   const char *pos, *start_pos;
+   const char *pos;
+   const char *file;
    EventData *temp;
 
 #ifdef DEBUGGING
@@ -530,40 +534,33 @@ static int event_parseFile( const char* file )
    int ret;
 #endif /* DEBUGGING */
 
-   /* Load string. */
-   filebuf = ndata_read( file, &bufsize );
-   if (filebuf == NULL) {
-      WARN(_("Unable to read data from '%s'"), file);
-      return -1;
-   }
-
-   /* Skip if no XML. */
-   pos = strnstr( filebuf, "</event>", bufsize );
-   if (pos==NULL) {
-      pos = strnstr( filebuf, "function create", bufsize );
-      if ((pos != NULL) && !strncmp(pos,"--common",bufsize))
-         WARN(_("Event '%s' has create function but no XML header!"), file);
-      free(filebuf);
-      return 0;
-   }
-
-   /* Separate XML header and Lua. */
-   start_pos = strnstr( filebuf, "<?xml ", bufsize );
-   pos = strnstr( filebuf, "--]]", bufsize );
-   if (pos == NULL || start_pos == NULL) {
-      WARN(_("Event file '%s' has missing XML header!"), file);
-      return -1;
-   }
-
-   /* Parse the header. */
-   doc = xmlParseMemory( start_pos, pos-start_pos );
-   if (doc == NULL) {
-      WARN(_("Unable to parse document XML header for Event '%s'"), file);
-      return -1;
+   file = xf->filename;
+   switch (xf->status) {
+      case XMLFILE_NOREAD:
+         WARN(_("Unable to read data from '%s': %s"), file, xf->error);
+         return -1;
+
+      /* Skip if no XML. */
+      case XMLFILE_NOHEADER:
+         pos = strnstr( xf->buf, "function create", xf->bufsize );
+         if ((pos != NULL) && !strncmp(pos,"--common",xf->bufsize))
+            WARN(_("Event '%s' has create function but no XML header!"), file);
+         return 0;
+
+      case XMLFILE_BADHEADER:
+         WARN(_("Event file '%s' has missing XML header!"), file);
+         return -1;
+
+      case XMLFILE_NOPARSE:
+         WARN(_("Unable to parse document XML header for Event '%s'"), file);
+         return -1;
+
+      case XMLFILE_OK:
+         break;
    }
 
    /* Get the root node. */
-   node = doc->xmlChildrenNode;
+   node = xf->doc->xmlChildrenNode;
    if (!xml_isNode(node,XML_EVENT_TAG)) {
       WARN(_("Malformed '%s' file: missing root element '%s'"), file, XML_EVENT_TAG);
       return -1;
@@ -571,7 +568,7 @@ static int event_parseFile( const char* file )
 
    temp = &array_grow(&event_data);
    event_parseXML( temp, node );
-   temp->lua = strdup(filebuf);
+   temp->lua = strdup(xf->buf);
    temp->sourcefile = strdup(file);
 
 #ifdef DEBUGGING
@@ -585,10 +582,6 @@ static int event_parseFile( const char* file )
    }
 #endif /* DEBUGGING */
 
-   /* Clean up. */
-   xmlFreeDoc(doc);
-   free(filebuf);
-
    return 0;
 }
 
@@ -1219,6 +1219,7 @@ static void gl_fontRenderStartH( const glFontStash* stsh, const gl_Matrix4 *H, c
    else
       col = c;
 
+   gl_batchFlush();
    glUseProgram(shaders.font.program);
    gl_uniformAColor(shaders.font.color, col, a);
    if (outlineR == 0.)
@@ -1446,6 +1447,7 @@ static int gl_fontRenderGlyph( glFontStash* stsh, uint32_t ch, const glColour *c
 
    /* Draw the element. */
    glDrawArrays( GL_TRIANGLE_STRIP, glyph->vbo_id, 4 );
+   gl_screen.draw_calls++;
 
    /* Translate matrix. */
    gl_Matrix4_Translate(&font_projection_mat, glyph->adv_x/scale, 0, 0);
@@ -19,6 +19,7 @@
 #include "gui.h"
 
 #include "ai.h"
+#include "arena.h"
 #include "camera.h"
 #include "comm.h"
 #include "conf.h"
@@ -389,10 +390,9 @@ void player_message( const char *fmt, ... )
 
    /* Add the new one */
    va_start( ap, fmt );
-   vasprintf( &buf, fmt, ap );
+   buf = arena_vprintf( fmt, ap );
    va_end( ap );
    player_messageRaw( buf );
-   free( buf );
 }
 
 
@@ -451,8 +451,8 @@ static void gui_renderPlanetTarget (void)
          return;
       }
 
-      x = ast->pos.x;
-      y = ast->pos.y;
+      x = field->motion.x[ast->id];
+      y = field->motion.y[ast->id];
       r = at->gfxs[ast->gfxID]->w * 0.5;
       gui_renderTargetReticles( &shaders.targetship, x, y, r, 0., c );
    }
@@ -892,6 +892,7 @@ void gui_render( double dt )
 
       /* Draw. */
       glDrawArrays( GL_TRIANGLE_STRIP, 0, 4 );
+      gl_screen.draw_calls++;
 
       /* Clear state. */
       glDisableVertexAttribArray( shaders.jump.vertex );
@@ -1425,6 +1426,7 @@ void gui_renderAsteroid(const Asteroid* a, RadarShape shape,
    double x, y, r, sx, sy;
    double px, py;
    const glColour *col;
+   const AsteroidAnchor *field;
 
    /* Skip invisible asteroids */
    if (a->appearing == ASTEROID_INVISIBLE)
@@ -1441,13 +1443,14 @@ void gui_renderAsteroid(const Asteroid* a, RadarShape shape,
    targeted = ((i == player.p->nav_asteroid) && (j == player.p->nav_anchor));
 
    /* Get position. */
+   field = &cur_system->asteroids[j];
    if (overlay) {
-      x = (a->pos.x / res);
-      y = (a->pos.y / res);
+      x = (field->motion.x[i] / res);
+      y = (field->motion.y[i] / res);
    }
    else {
-      x = ((a->pos.x - player.p->solid->pos.x) / res);
-      y = ((a->pos.y - player.p->solid->pos.y) / res);
+      x = ((field->motion.x[i] - player.p->solid->pos.x) / res);
+      y = ((field->motion.y[i] - player.p->solid->pos.y) / res);
    }
 
    /* Get size. */
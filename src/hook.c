@@ -55,6 +55,7 @@ typedef struct HookQueue_s {
    HookParam hparam[ HOOK_MAX_PARAM ]; /**< Parameters. */
 } HookQueue_t;
 static HookQueue_t *hook_queue   = NULL; /**< The hook queue. */
+static HookQueue_t *hook_queueFree = NULL; /**< Queued hooks that were run, kept for reuse. */
 static int hook_atomic           = 0; /**< Whether or not hooks should be queued. */
 static ntime_t hook_time_accum   = 0; /**< Time accumulator. */
 
@@ -147,6 +148,23 @@ int hook_load( xmlNodePtr parent );
 static Mission *hook_getMission( Hook *hook );
 
 
+/**
+ * @brief Gets a cleared queued hook, reusing one that was run if possible.
+ */
+static HookQueue_t *hq_new (void)
+{
+   HookQueue_t *hq;
+
+   if (hook_queueFree == NULL)
+      return calloc( 1, sizeof(HookQueue_t) );
+
+   hq = hook_queueFree;
+   hook_queueFree = hq->next;
+   memset( hq, 0, sizeof(HookQueue_t) );
+   return hq;
+}
+
+
 /**
  * Adds a hook to the queue.
  */
@@ -168,12 +186,14 @@ static int hq_add( HookQueue_t *hq )
 
 
 /**
- * @brief Frees a queued hook.
+ * @brief Frees a queued hook, keeping it for reuse.
  */
 static void hq_free( HookQueue_t *hq )
 {
    free(hq->stack);
-   free(hq);
+   hq->stack = NULL;
+   hq->next = hook_queueFree;
+   hook_queueFree = hq;
 }
 
 
@@ -188,6 +208,11 @@ static void hq_clear (void)
       hook_queue = hq->next;
       hq_free( hq );
    }
+   while (hook_queueFree != NULL) {
+      hq = hook_queueFree;
+      hook_queueFree = hq->next;
+      free( hq );
+   }
 }
 
 
@@ -1001,7 +1026,7 @@ int hooks_runParamDeferred( const char* stack, HookParam *param )
    if ((player.p == NULL) || player_isFlag(PLAYER_DESTROYED))
       return 0;
 
-   hq = calloc( 1, sizeof(HookQueue_t) );
+   hq = hq_new();
    hq->stack = strdup(stack);
    i         = 0;
    if (param != NULL) {
@@ -169,6 +169,12 @@ const int input_numbinds = ( sizeof( keybind_info ) / sizeof( keybind_info[ 0 ]
 static Keybind *input_paste;
 
 
+/*
+ * Input clock, runs on the frame time so replays see the same timings.
+ */
+static double input_time = 0.; /**< Real time input was updated for, in seconds. */
+
+
 /*
  * accel hacks
  */
@@ -203,6 +209,7 @@ extern double player_right; /**< player.c */
 /*
  * Prototypes.
  */
+static Uint32 input_ticks (void);
 static void input_key( int keynum, double value, double kabs, int repeat );
 static void input_clickZoom( double modifier );
 static void input_clickevent( SDL_Event* event );
@@ -744,13 +751,31 @@ SDL_Keymod input_translateMod( SDL_Keymod mod )
 }
 
 
+/**
+ * @brief Gets the time of the input clock.
+ *
+ * Used instead of SDL_GetTicks() so key repeats, double taps and double
+ *  clicks only depend on the frame times, which replays control.
+ *
+ *    @return Milliseconds the input was updated for.
+ */
+static Uint32 input_ticks (void)
+{
+   return (Uint32) (input_time * 1000.);
+}
+
+
 /**
  * @brief Handles key repeating.
+ *
+ *    @param dt Real time elapsed since the last update.
  */
 void input_update( double dt )
 {
    Uint32 t;
 
+   input_time += dt;
+
    if (input_mouseTimer > 0.) {
       input_mouseTimer -= dt;
 
@@ -767,7 +792,7 @@ void input_update( double dt )
          return;
 
       /* Get time. */
-      t = SDL_GetTicks();
+      t = input_ticks();
 
       /* Should be repeating. */
       if (repeat_keyTimer + conf.repeat_delay + repeat_keyCounter*conf.repeat_freq > t)
@@ -809,7 +834,7 @@ static void input_key( int keynum, double value, double kabs, int repeat )
    if (conf.repeat_delay != 0) {
       if ((value == KEY_PRESS) && !repeat) {
          repeat_key = keynum;
-         repeat_keyTimer = SDL_GetTicks();
+         repeat_keyTimer = input_ticks();
          repeat_keyCounter = 0;
       }
       else if (value == KEY_RELEASE) {
@@ -843,7 +868,7 @@ static void input_key( int keynum, double value, double kabs, int repeat )
          }
 
          /* double tap accel = afterburn! */
-         t = SDL_GetTicks();
+         t = input_ticks();
          if (conf.doubletap_afterburn && (value == KEY_PRESS)
                && INGAME() && NOHYP() && NODEAD()
                && (t-input_accelLast <= AFTERBURNER_SENSITIVITY))
@@ -1432,7 +1457,7 @@ static void input_clickevent( SDL_Event* event )
          }
 
          /* double tap accel = afterburn! */
-         t = SDL_GetTicks();
+         t = input_ticks();
          if (conf.doubletap_afterburn && (event->type == SDL_MOUSEBUTTONDOWN)
                && INGAME() && NOHYP() && NODEAD()
                && (t-input_accelLast <= AFTERBURNER_SENSITIVITY))
@@ -1767,7 +1792,7 @@ void input_clicked( void *clicked )
       return;
 
    input_lastClicked = clicked;
-   input_mouseClickLast = SDL_GetTicks();
+   input_mouseClickLast = input_ticks();
 }
 
 
@@ -1785,7 +1810,7 @@ int input_isDoubleClick( void *clicked )
    /* Most recent time that constitutes a valid double-click. */
    threshold = input_mouseClickLast + (int)(conf.mouse_doubleclick * 1000);
 
-   if ((SDL_GetTicks() <= threshold) && (clicked == input_lastClicked))
+   if ((input_ticks() <= threshold) && (clicked == input_lastClicked))
       return 1;
 
    return 0;
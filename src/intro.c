@@ -27,6 +27,7 @@
 #include "music.h"
 #include "ndata.h"
 #include "nstring.h"
+#include "replay.h"
 #include "toolkit.h"
 
 
@@ -226,7 +227,7 @@ static void intro_event_handler( int *stop, double *offset, double *vel )
 {
    SDL_Event event;           /* user key-press, mouse-push, etc. */
 
-   while (SDL_PollEvent(&event)) {
+   while (replay_pollEvent(&event)) {
       if (event.type == SDL_QUIT) {
          naev_quit();
          continue;
@@ -641,6 +641,8 @@ ImageArrayCell *outfits_imageArrayCells( const Outfit **outfits, int *noutfits )
       for (i=0; i<*noutfits; i++) {
          o = outfits[i];
 
+         /* Start loading all the icons instead of as they get drawn. */
+         gl_texPrefetch( o->gfx_store );
          coutfits[i].image = gl_dupTexture( o->gfx_store );
          coutfits[i].caption = strdup( _(o->name) );
          coutfits[i].quantity = player_outfitOwned(o);
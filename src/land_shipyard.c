@@ -145,6 +145,8 @@ void shipyard_open( unsigned int wid )
    else {
       for (i=0; i<nships; i++) {
          cships[i].caption = strdup( _(shipyard_list[i]->name) );
+         /* Start loading all the images instead of as they get drawn. */
+         gl_texPrefetch( shipyard_list[i]->gfx_store );
          cships[i].image = gl_dupTexture(shipyard_list[i]->gfx_store);
          cships[i].layers = gl_copyTexArray( shipyard_list[i]->gfx_overlays, &cships[i].nlayers );
          if (shipyard_list[i]->rarity > 0) {
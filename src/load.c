@@ -10,6 +10,8 @@
 
 
 /** @cond */
+#include <libxml/xmlreader.h>
+#include <zlib.h>
 #include "physfs.h"
 
 #include "naev.h"
@@ -49,6 +51,9 @@
 #define BUTTON_WIDTH ((LOAD_WIDTH-80) / 3) /**< Button width. */
 #define BUTTON_HEIGHT 30 /**< Button height. */
 
+#define LOAD_STREAM_CHUNK  16384 /**< Bytes read from a saved game at a time. */
+#define LOAD_INDEX         "saves/index.xml" /**< Index of the load menu information. */
+
 
 /**
  * @brief Struct containing a file's name and stat structure.
@@ -59,6 +64,31 @@ typedef struct filedata {
 } filedata_t;
 
 
+/**
+ * @brief Stream reading a saved game, which may be gzip compressed.
+ */
+typedef struct LoadStream_ {
+   PHYSFS_File *f; /**< File being read. */
+   int gzip; /**< Whether the file is gzip compressed. */
+   z_stream z; /**< Decompression state. */
+   unsigned char in[LOAD_STREAM_CHUNK]; /**< Compressed data read. */
+} LoadStream;
+
+
+/**
+ * @brief Load menu information of a save in the save index.
+ *
+ * The entry is only used while the file's size and modification time
+ *  match, otherwise the save is parsed again.
+ */
+typedef struct LoadIndex_ {
+   char *file; /**< Name of the save in the saves directory. */
+   PHYSFS_sint64 size; /**< Size of the save when indexed. */
+   PHYSFS_sint64 modtime; /**< Modification time of the save when indexed. */
+   nsave_t save; /**< Load menu information, without the path. */
+} LoadIndex;
+
+
 static nsave_t *load_saves = NULL; /**< Array of save.s */
 extern int save_loaded; /**< From save.c */
 
@@ -88,117 +118,182 @@ static void load_menu_update( unsigned int wid, char *str );
 static void load_menu_close( unsigned int wdw, char *str );
 static void load_menu_load( unsigned int wdw, char *str );
 static void load_menu_delete( unsigned int wdw, char *str );
+static void load_loadVersion( nsave_t *save, xmlNodePtr parent );
+static void load_loadPlayer( nsave_t *save, xmlNodePtr parent );
+static int load_loadReader( nsave_t *save, xmlTextReaderPtr reader,
+      const char *path );
 static int load_load( nsave_t *save, const char *path );
+static void load_freeSave( nsave_t *ns );
+static LoadIndex* load_indexRead (void);
+static LoadIndex* load_indexFind( LoadIndex *index, const char *file );
+static int load_indexCompare( const void *p1, const void *p2 );
+static int load_indexDocument( xmlTextWriterPtr writer,
+      const LoadIndex *index );
+static void load_indexWrite( const LoadIndex *index );
+static void load_indexFree( LoadIndex *index );
 static int load_gameInternal( const char* file, const char* version );
 static int load_enumerateCallback( void* data, const char* origdir, const char* fname );
 static int load_sortCompare( const void *p1, const void *p2 );
+static LoadStream* load_streamOpen( const char *path );
+static int load_streamRead( void *ctx, char *buf, int len );
+static int load_streamClose( void *ctx );
 static xmlDocPtr load_xml_parsePhysFS( const char* filename );
 
 
 /**
- * @brief Loads an individual save.
- * @param[out] save Structure to populate.
- * @param path PhysicsFS path (i.e., relative path starting with "saves/").
+ * @brief Loads the version information of a save.
+ *
+ *    @param[out] save Structure to populate.
+ *    @param parent The "version" node.
  */
-static int load_load( nsave_t *save, const char *path )
+static void load_loadVersion( nsave_t *save, xmlNodePtr parent )
 {
-   xmlDocPtr doc;
-   xmlNodePtr root, parent, node, cur;
+   xmlNodePtr node;
+
+   node = parent->xmlChildrenNode;
+   do {
+      xmlr_strd(node, "naev", save->version);
+      xmlr_strd(node, "data", save->data);
+      xmlr_strd(node, "annotation", save->name);
+      xmlr_strd(node, "player_name", save->player_name);
+   } while (xml_nextNode(node));
+}
+
+
+/**
+ * @brief Loads the player information of a save.
+ *
+ *    @param[out] save Structure to populate.
+ *    @param parent The "player" node.
+ */
+static void load_loadPlayer( nsave_t *save, xmlNodePtr parent )
+{
+   xmlNodePtr node, cur;
    int cycles, periods, stu;
    int years, days, seconds;
 
+   /* Get name (old method, used as a backup). */
+   if (save->name == NULL) {
+      xmlr_attr_strd(parent, "name", save->name);
+   }
+   /* Parse rest. */
+   node = parent->xmlChildrenNode;
+   do {
+      xml_onlyNodes(node);
+
+      /* Player info. */
+      xmlr_strd(node, "location", save->planet);
+      xmlr_strd(node, "location_system", save->system);
+      xmlr_ulong(node, "credits", save->credits);
+
+      /* Time. */
+      if (xml_isNode(node, "time")) {
+         cur = node->xmlChildrenNode;
+         cycles = periods = stu = 0;
+         years = days = seconds = -1;
+         do {
+            /* Compatibility for old saves. */
+            xmlr_int(cur, "SCU", cycles);
+            xmlr_int(cur, "STP", periods);
+            xmlr_int(cur, "STU", stu);
+            /* Modern save data. */
+            xmlr_int(cur, "years", years);
+            xmlr_int(cur, "days", days);
+            xmlr_int(cur, "seconds", seconds);
+         } while (xml_nextNode(cur));
+
+         /* Use the old format data if and only if the new format
+          * data is unavailable. */
+         if (years == -1)
+            years = cycles;
+         if (days == -1)
+            days = periods / NT_DAY_HOURS;
+         if (seconds == -1)
+            seconds = stu;
+
+         save->date = ntime_create(years, days, seconds);
+         continue;
+      }
+
+      /* Ship info. */
+      if (xml_isNode(node, "ship")) {
+         xmlr_attr_strd(node, "name", save->shipname);
+         xmlr_attr_strd(node, "model", save->shipmodel);
+         continue;
+      }
+   } while (xml_nextNode(node));
+}
+
+
+/**
+ * @brief Loads the load menu information of a save from an XML reader.
+ *
+ * Only the information shown in the load menu is needed, so the save is
+ *  streamed and only the "version" and "player" elements are expanded
+ *  into a tree. The rest of the save is skipped without being built.
+ *
+ *    @param[out] save Structure to populate.
+ *    @param reader Reader of the save, freed when done.
+ *    @param path Path of the save.
+ *    @return 0 on success.
+ */
+static int load_loadReader( nsave_t *save, xmlTextReaderPtr reader,
+      const char *path )
+{
+   xmlNodePtr node;
+   const xmlChar *name;
+   int ret, found;
+
    memset( save, 0, sizeof(nsave_t) );
 
-   /* Load the XML. */
-   doc = load_xml_parsePhysFS( path );
-   if (doc == NULL) {
-      WARN( _("Unable to parse save path '%s'."), path);
-      return -1;
-   }
-   root = doc->xmlChildrenNode; /* base node */
-   if (root == NULL) {
+   /* Find the base node. */
+   do {
+      ret = xmlTextReaderRead( reader );
+   } while ((ret == 1) && (xmlTextReaderNodeType( reader )
+         != XML_READER_TYPE_ELEMENT));
+   if ((ret != 1) || xmlTextReaderIsEmptyElement( reader )) {
       WARN( _("Unable to get child node of save '%s'."), path);
-      xmlFreeDoc(doc);
+      xmlFreeTextReader( reader );
       return -1;
    }
 
    /* Save path. */
    save->path = strdup(path);
 
-   /* Iterate inside the naev_save. */
-   parent = root->xmlChildrenNode;
-   do {
-      xml_onlyNodes(parent);
-
-      /* Info. */
-      if (xml_isNode(parent, "version")) {
-         node = parent->xmlChildrenNode;
-         do {
-            xmlr_strd(node, "naev", save->version);
-            xmlr_strd(node, "data", save->data);
-            xmlr_strd(node, "annotation", save->name);
-            xmlr_strd(node, "player_name", save->player_name);
-         } while (xml_nextNode(node));
+   /* Iterate inside the naev_save, stopping once everything is found. */
+   found = 0;
+   ret = xmlTextReaderRead( reader );
+   while ((ret == 1) && (found != 3)
+         && (xmlTextReaderDepth( reader ) > 0)) {
+      if (xmlTextReaderNodeType( reader ) != XML_READER_TYPE_ELEMENT) {
+         ret = xmlTextReaderRead( reader );
          continue;
       }
 
-      else if (xml_isNode(parent, "player")) {
-         /* Get name (old method, used as a backup). */
-         if (save->name == NULL) {
-            xmlr_attr_strd(parent, "name", save->name);
-         }
-         /* Parse rest. */
-         node = parent->xmlChildrenNode;
-         do {
-            xml_onlyNodes(node);
-
-            /* Player info. */
-            xmlr_strd(node, "location", save->planet);
-            xmlr_strd(node, "location_system", save->system);
-            xmlr_ulong(node, "credits", save->credits);
-
-            /* Time. */
-            if (xml_isNode(node, "time")) {
-               cur = node->xmlChildrenNode;
-               cycles = periods = stu = 0;
-               years = days = seconds = -1;
-               do {
-                  /* Compatibility for old saves. */
-                  xmlr_int(cur, "SCU", cycles);
-                  xmlr_int(cur, "STP", periods);
-                  xmlr_int(cur, "STU", stu);
-                  /* Modern save data. */
-                  xmlr_int(cur, "years", years);
-                  xmlr_int(cur, "days", days);
-                  xmlr_int(cur, "seconds", seconds);
-               } while (xml_nextNode(cur));
-
-               /* Use the old format data if and only if the new format
-                * data is unavailable. */
-               if (years == -1)
-                  years = cycles;
-               if (days == -1)
-                  days = periods / NT_DAY_HOURS;
-               if (seconds == -1)
-                  seconds = stu;
-
-               save->date = ntime_create(years, days, seconds);
-               continue;
-            }
-
-            /* Ship info. */
-            if (xml_isNode(node, "ship")) {
-               xmlr_attr_strd(node, "name", save->shipname);
-               xmlr_attr_strd(node, "model", save->shipmodel);
-               continue;
-            }
-         } while (xml_nextNode(node));
-         continue;
+      name = xmlTextReaderConstName( reader );
+      node = NULL;
+      if (xmlStrEqual( name, (const xmlChar*)"version" )
+            || xmlStrEqual( name, (const xmlChar*)"player" ))
+         node = xmlTextReaderExpand( reader );
+
+      /* Info. */
+      if ((node != NULL) && xml_isNode(node, "version")) {
+         load_loadVersion( save, node );
+         found |= 1;
+      }
+      else if ((node != NULL) && xml_isNode(node, "player")) {
+         load_loadPlayer( save, node );
+         found |= 2;
       }
-   } while (xml_nextNode(parent));
+
+      /* Skip over the element and its children. */
+      ret = xmlTextReaderNext( reader );
+   }
+   if (ret == -1)
+      WARN( _("Error while parsing save '%s'."), path);
 
    /* Clean up. */
-   xmlFreeDoc(doc);
+   xmlFreeTextReader( reader );
 
    /* Fallback for old saves which didn't have player_name defined. */
    if (save->player_name == NULL)
@@ -208,6 +303,288 @@ static int load_load( nsave_t *save, const char *path )
 }
 
 
+/**
+ * @brief Loads an individual save.
+ * @param[out] save Structure to populate.
+ * @param path PhysicsFS path (i.e., relative path starting with "saves/").
+ */
+static int load_load( nsave_t *save, const char *path )
+{
+   xmlTextReaderPtr reader;
+   LoadStream *ls;
+
+   /* Open the stream, the reader closes it. */
+   ls = load_streamOpen( path );
+   reader = (ls != NULL) ? xmlReaderForIO( load_streamRead,
+         load_streamClose, ls, path, NULL, 0 ) : NULL;
+   if (reader == NULL) {
+      memset( save, 0, sizeof(nsave_t) );
+      WARN( _("Unable to parse save path '%s'."), path);
+      return -1;
+   }
+
+   return load_loadReader( save, reader, path );
+}
+
+
+/**
+ * @brief Reads the save index.
+ *
+ *    @return The index entries (array.h) sorted by file name, empty if
+ *            there is no usable index.
+ */
+static LoadIndex* load_indexRead (void)
+{
+   LoadIndex *index, *e;
+   xmlDocPtr doc;
+   xmlNodePtr root, node, cur;
+
+   index = array_create( LoadIndex );
+   if (!PHYSFS_exists( LOAD_INDEX ))
+      return index;
+
+   doc = xml_parsePhysFS( LOAD_INDEX );
+   if (doc == NULL)
+      return index;
+   root = doc->xmlChildrenNode;
+   if (!xml_isNode(root, "save_index")) {
+      xmlFreeDoc(doc);
+      return index;
+   }
+
+   node = root->xmlChildrenNode;
+   do {
+      xml_onlyNodes(node);
+      if (!xml_isNode(node, "save"))
+         continue;
+
+      e = &array_grow( &index );
+      memset( e, 0, sizeof(LoadIndex) );
+      xmlr_attr_strd(node, "file", e->file);
+      xmlr_attr_long_def(node, "size", e->size, -1);
+      xmlr_attr_long_def(node, "modtime", e->modtime, -1);
+      cur = node->xmlChildrenNode;
+      do {
+         xml_onlyNodes(cur);
+         xmlr_strd(cur, "name", e->save.name);
+         xmlr_strd(cur, "player_name", e->save.player_name);
+         xmlr_strd(cur, "version", e->save.version);
+         xmlr_strd(cur, "data", e->save.data);
+         xmlr_strd(cur, "planet", e->save.planet);
+         xmlr_strd(cur, "system", e->save.system);
+         xmlr_long(cur, "date", e->save.date);
+         xmlr_ulong(cur, "credits", e->save.credits);
+         xmlr_strd(cur, "shipname", e->save.shipname);
+         xmlr_strd(cur, "shipmodel", e->save.shipmodel);
+      } while (xml_nextNode(cur));
+
+      /* Entries without the required information can't be used. */
+      if ((e->file == NULL) || (e->save.name == NULL)
+            || (e->save.player_name == NULL)) {
+         free( e->file );
+         load_freeSave( &e->save );
+         array_erase( &index, e, e+1 );
+      }
+   } while (xml_nextNode(node));
+   xmlFreeDoc(doc);
+
+   qsort( index, array_size(index), sizeof(LoadIndex), load_indexCompare );
+   return index;
+}
+
+
+/**
+ * @brief Compares save index entries by file name.
+ */
+static int load_indexCompare( const void *p1, const void *p2 )
+{
+   const LoadIndex *e1, *e2;
+   e1 = (const LoadIndex*) p1;
+   e2 = (const LoadIndex*) p2;
+   return strcmp( e1->file, e2->file );
+}
+
+
+/**
+ * @brief Finds a save in a sorted save index.
+ *
+ *    @param index Index to search.
+ *    @param file Name of the save in the saves directory.
+ *    @return The entry of the save, or NULL if not indexed.
+ */
+static LoadIndex* load_indexFind( LoadIndex *index, const char *file )
+{
+   LoadIndex key;
+   key.file = (char*) file;
+   return bsearch( &key, index, array_size(index), sizeof(LoadIndex),
+         load_indexCompare );
+}
+
+
+/**
+ * @brief Writes the save index document.
+ *
+ *    @param writer XML writer to use.
+ *    @param index Entries to write.
+ *    @return 0 on success.
+ */
+static int load_indexDocument( xmlTextWriterPtr writer,
+      const LoadIndex *index )
+{
+   const LoadIndex *e;
+   int i;
+
+   xmlw_start(writer);
+   xmlw_startElem(writer, "save_index");
+   for (i=0; i<array_size(index); i++) {
+      e = &index[i];
+      xmlw_startElem(writer, "save");
+      xmlw_attr(writer, "file", "%s", e->file);
+      xmlw_attr(writer, "size", "%"PRId64, (int64_t)e->size);
+      xmlw_attr(writer, "modtime", "%"PRId64, (int64_t)e->modtime);
+      xmlw_elem(writer, "name", "%s", e->save.name);
+      xmlw_elem(writer, "player_name", "%s", e->save.player_name);
+      if (e->save.version != NULL)
+         xmlw_elem(writer, "version", "%s", e->save.version);
+      if (e->save.data != NULL)
+         xmlw_elem(writer, "data", "%s", e->save.data);
+      if (e->save.planet != NULL)
+         xmlw_elem(writer, "planet", "%s", e->save.planet);
+      if (e->save.system != NULL)
+         xmlw_elem(writer, "system", "%s", e->save.system);
+      if (e->save.shipname != NULL)
+         xmlw_elem(writer, "shipname", "%s", e->save.shipname);
+      if (e->save.shipmodel != NULL)
+         xmlw_elem(writer, "shipmodel", "%s", e->save.shipmodel);
+      xmlw_elem(writer, "date", "%"PRId64, e->save.date);
+      xmlw_elem(writer, "credits", "%"PRIu64, e->save.credits);
+      xmlw_endElem(writer); /* "save" */
+   }
+   xmlw_endElem(writer); /* "save_index" */
+   xmlw_done(writer);
+   return 0;
+}
+
+
+/**
+ * @brief Writes the save index.
+ *
+ *    @param index Entries to write.
+ */
+static void load_indexWrite( const LoadIndex *index )
+{
+   xmlBufferPtr buf;
+   xmlTextWriterPtr writer;
+   char path[PATH_MAX];
+   int ret;
+
+   buf = xmlBufferCreate();
+   writer = (buf != NULL) ? xmlNewTextWriterMemory(buf, 0) : NULL;
+   if (writer == NULL) {
+      WARN(_("Unable to create the save index writer"));
+      xmlBufferFree(buf);
+      return;
+   }
+   xmlw_setParams(writer);
+   ret = load_indexDocument( writer, index );
+   xmlFreeTextWriter(writer);
+
+   /* The index is only a cache, so it's not backed up. */
+   snprintf( path, sizeof(path), "%s/%s", PHYSFS_getWriteDir(), LOAD_INDEX );
+   if ((ret != 0) || (nfile_writeFileAtomic(
+            (const char*)xmlBufferContent(buf), xmlBufferLength(buf),
+            path, NULL ) != 0))
+      WARN(_("Unable to write save index '%s'"), path);
+   xmlBufferFree(buf);
+}
+
+
+/**
+ * @brief Frees a save index.
+ */
+static void load_indexFree( LoadIndex *index )
+{
+   int i;
+   for (i=0; i<array_size(index); i++) {
+      free( index[i].file );
+      load_freeSave( &index[i].save );
+   }
+   array_free( index );
+}
+
+
+/**
+ * @brief Updates the save index with a save that was just written.
+ *
+ * Keeps the load menu from having to parse the save again.
+ *
+ *    @param file Name of the save in the saves directory.
+ *    @param backup Whether the previous save was kept at file.backup.
+ *    @param data Serialized save that was written.
+ *    @param len Length of data.
+ */
+void load_indexUpdate( const char *file, int backup, const char *data,
+      size_t len )
+{
+   char path[PATH_MAX], *bfile;
+   PHYSFS_Stat stat;
+   xmlTextReaderPtr reader;
+   LoadIndex *index, *e, n;
+   int ok;
+
+   snprintf( path, sizeof(path), "saves/%s", file );
+   if (!PHYSFS_stat( path, &stat ))
+      return;
+   memset( &n, 0, sizeof(n) );
+   reader = (len <= INT_MAX) ? xmlReaderForMemory( data, len, path, NULL, 0 ) : NULL;
+   ok = (reader != NULL) && (load_loadReader( &n.save, reader, path ) == 0);
+   if (ok) {
+      free( n.save.path );
+      n.save.path = NULL;
+      n.file      = strdup( file );
+      n.size      = stat.filesize;
+      n.modtime   = stat.modtime;
+   }
+   else
+      load_freeSave( &n.save );
+
+   index = load_indexRead();
+   if (backup) {
+      /* The previous save is now the backup, replacing the old backup. */
+      asprintf( &bfile, "%s.backup", file );
+      e = load_indexFind( index, bfile );
+      if (e != NULL) {
+         free( e->file );
+         load_freeSave( &e->save );
+         array_erase( &index, e, e+1 );
+      }
+      e = load_indexFind( index, file );
+      if (e != NULL) {
+         free( e->file );
+         e->file = bfile;
+      }
+      else
+         free( bfile );
+      /* Renaming may have moved the entry in the order. */
+      qsort( index, array_size(index), sizeof(LoadIndex), load_indexCompare );
+   }
+
+   /* Drop the stale entry of the overwritten save. If the new one couldn't
+    * be parsed, the next refresh parses it from the file instead. */
+   e = load_indexFind( index, file );
+   if (e != NULL) {
+      free( e->file );
+      load_freeSave( &e->save );
+      array_erase( &index, e, e+1 );
+   }
+   if (ok)
+      array_push_back( &index, n );
+
+   load_indexWrite( index );
+   load_indexFree( index );
+}
+
+
 /**
  * @brief Loads or refreshes saved games.
  *
@@ -217,13 +594,17 @@ int load_refresh(void)
 {
    char buf[PATH_MAX];
    filedata_t *files, tmp;
+   LoadIndex *index, *nindex, *e, *n;
    size_t len;
-   int i, ok;
+   int i, ok, dirty;
    nsave_t *ns;
 
    if (load_saves != NULL)
       load_free();
 
+   /* Make sure the last save is on disk. */
+   save_wait();
+
    /* load the saves */
    files = array_create( filedata_t );
    PHYSFS_enumerate( "saves", load_enumerateCallback, &files );
@@ -252,21 +633,51 @@ int load_refresh(void)
       files[i+1]  = tmp;
    }
 
-   /* Allocate and parse. */
+   /* Allocate and parse, using the index for saves that haven't changed
+    * since they were indexed. */
    ok = 0;
    ns = NULL;
+   index = load_indexRead();
+   nindex = array_create_size( LoadIndex, array_size(files) );
+   dirty = 0;
    load_saves = array_create_size( nsave_t, array_size(files) );
    for (i=0; i<array_size(files); i++) {
       if (!ok)
          ns = &array_grow( &load_saves );
       snprintf(buf, sizeof(buf), "saves/%s", files[i].name);
-      ok = load_load(ns, buf);
+      e = load_indexFind( index, files[i].name );
+      if ((e != NULL) && (e->size == files[i].stat.filesize)
+            && (e->modtime == files[i].stat.modtime)) {
+         /* Take the strings from the index entry. */
+         *ns = e->save;
+         memset( &e->save, 0, sizeof(nsave_t) );
+         ns->path = strdup(buf);
+         ok = 0;
+      }
+      else {
+         ok = load_load(ns, buf);
+         dirty = 1;
+      }
+      if (!ok) {
+         n = &array_grow( &nindex );
+         n->file    = files[i].name;
+         n->size    = files[i].stat.filesize;
+         n->modtime = files[i].stat.modtime;
+         n->save    = *ns;
+      }
    }
 
    /* If the save was invalid, array is 1 member too large. */
    if (ok)
       array_resize( &load_saves, array_size(load_saves)-1 );
 
+   /* Rewrite the index if it's missing anything or has removed saves.
+    * The new entries only borrow the strings. */
+   if (dirty || (array_size(nindex) != array_size(index)))
+      load_indexWrite( nindex );
+   array_free( nindex );
+   load_indexFree( index );
+
    /* Clean up memory. */
    for (i=0; i<array_size(files); i++)
       free( files[i].name );
@@ -333,26 +744,32 @@ static int load_sortCompare( const void *p1, const void *p2 )
 }
 
 
+/**
+ * @brief Frees the strings of a save.
+ */
+static void load_freeSave( nsave_t *ns )
+{
+   free(ns->path);
+   free(ns->name);
+   free(ns->player_name);
+   free(ns->version);
+   free(ns->data);
+   free(ns->planet);
+   free(ns->system);
+   free(ns->shipname);
+   free(ns->shipmodel);
+}
+
+
 /**
  * @brief Frees loaded save stuff.
  */
 void load_free (void)
 {
    int i;
-   nsave_t *ns;
 
-   for (i=0; i<array_size(load_saves); i++) {
-      ns = &load_saves[i];
-      free(ns->path);
-      free(ns->name);
-      free(ns->player_name);
-      free(ns->version);
-      free(ns->data);
-      free(ns->planet);
-      free(ns->system);
-      free(ns->shipname);
-      free(ns->shipmodel);
-   }
+   for (i=0; i<array_size(load_saves); i++)
+      load_freeSave( &load_saves[i] );
    array_free( load_saves );
    load_saves = NULL;
 }
@@ -729,6 +1146,9 @@ static int load_gameInternal( const char* file, const char* version )
    Planet *pnt;
    int version_diff = (version!=NULL) ? naev_versionCompare(version) : 0;
 
+   /* Make sure the last save is on disk. */
+   save_wait();
+
    /* Make sure it exists. */
    if (!PHYSFS_exists( file )) {
       dialogue_alert( _("Saved game file seems to have been deleted.") );
@@ -816,12 +1236,113 @@ err:
 
 
 /**
- * @brief Temporary (hopefully) wrapper around xml_parsePhysFS in support of gzipped XML (like .ns files).
+ * @brief Opens a saved game for streaming.
+ *
+ * Compressed saves are told apart from plain XML by the gzip magic bytes,
+ *  so both can be read.
+ *
+ *    @param path PhysicsFS path of the saved game.
+ *    @return The stream, or NULL on error. Close with load_streamClose().
  */
-static xmlDocPtr load_xml_parsePhysFS( const char* filename )
+static LoadStream* load_streamOpen( const char *path )
 {
-   char buf[PATH_MAX];
+   PHYSFS_File *f;
+   LoadStream *ls;
+   unsigned char magic[2];
+
+   f = PHYSFS_openRead( path );
+   if (f == NULL)
+      return NULL;
+
+   ls = calloc( 1, sizeof(LoadStream) );
+   ls->f = f;
+   if ((PHYSFS_readBytes( f, magic, sizeof(magic) ) == sizeof(magic))
+         && (magic[0] == 0x1f) && (magic[1] == 0x8b)) {
+      /* 16 added to the window bits selects the gzip wrapper. */
+      if (inflateInit2( &ls->z, 15+16 ) != Z_OK) {
+         load_streamClose( ls );
+         return NULL;
+      }
+      ls->gzip = 1;
+   }
+   PHYSFS_seek( f, 0 );
+   return ls;
+}
 
-   snprintf( buf, sizeof(buf), "%s/%s", PHYSFS_getWriteDir(), filename);
-   return xmlParseFile( buf );
+
+/**
+ * @brief Reads from a saved game stream, for libxml2.
+ *
+ *    @param ctx Stream to read from.
+ *    @param buf Buffer to read into.
+ *    @param len Size of buf.
+ *    @return Number of bytes read, 0 at the end and -1 on error.
+ */
+static int load_streamRead( void *ctx, char *buf, int len )
+{
+   LoadStream *ls;
+   PHYSFS_sint64 n;
+   int ret;
+
+   ls = (LoadStream*) ctx;
+   if (!ls->gzip)
+      return PHYSFS_readBytes( ls->f, buf, len );
+
+   ls->z.next_out  = (Bytef*) buf;
+   ls->z.avail_out = len;
+   while (ls->z.avail_out == (uInt)len) {
+      if (ls->z.avail_in == 0) {
+         n = PHYSFS_readBytes( ls->f, ls->in, sizeof(ls->in) );
+         if (n < 0)
+            return -1;
+         else if (n == 0)
+            break;
+         ls->z.next_in  = ls->in;
+         ls->z.avail_in = n;
+      }
+      ret = inflate( &ls->z, Z_NO_FLUSH );
+      if (ret == Z_STREAM_END)
+         break;
+      else if (ret != Z_OK)
+         return -1;
+   }
+   return len - ls->z.avail_out;
+}
+
+
+/**
+ * @brief Closes a saved game stream.
+ *
+ *    @param ctx Stream to close.
+ *    @return 0 on success.
+ */
+static int load_streamClose( void *ctx )
+{
+   LoadStream *ls;
+
+   ls = (LoadStream*) ctx;
+   if (ls->gzip)
+      inflateEnd( &ls->z );
+   PHYSFS_close( ls->f );
+   free( ls );
+   return 0;
+}
+
+
+/**
+ * @brief Parses a saved game, which may be gzip compressed.
+ *
+ *    @param filename PhysicsFS path of the saved game.
+ *    @return The parsed document, or NULL on error.
+ */
+static xmlDocPtr load_xml_parsePhysFS( const char* filename )
+{
+   LoadStream *ls;
+
+   ls = load_streamOpen( filename );
+   if (ls == NULL)
+      return NULL;
+   /* The stream is closed by libxml2, even on failure. */
+   return xmlReadIO( load_streamRead, load_streamClose, ls, filename,
+         NULL, 0 );
 }
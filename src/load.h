@@ -45,6 +45,8 @@ int load_gameFile( const char* file );
 int load_game( nsave_t *ns );
 
 int load_refresh(void);
+void load_indexUpdate( const char *file, int backup, const char *data,
+      size_t len );
 void load_free (void);
 const nsave_t *load_getList (void);
 
@@ -399,15 +399,17 @@ void map_open (void)
 static void map_update_commod_av_price()
 {
    Commodity *c;
-   int i,j,k;
+   int i,j;
    StarSystem *sys;
    Planet *p;
+   const credits_t *prices;
    if (cur_commod == -1 || map_selected == -1) {
       commod_av_gal_price = 0;
       return;
    }
    c = commod_known[cur_commod];
    if ( cur_commod_mode == 0 ) {
+      prices = economy_getPrices(c);
       double totPrice = 0;
       int totPriceCnt = 0;
       for (i=0; i<array_size(systems_stack); i++) {
@@ -423,15 +425,10 @@ static void map_update_commod_av_price()
             double thisPrice;
             for (j=0; j<array_size(sys->planets); j++) {
                p = sys->planets[j];
-               if (planet_isKnown(p)) {
-                  for (k=0; k<array_size(p->commodities); k++) {
-                     if (p->commodities[k] == c) {
-                        thisPrice = economy_getPrice(c, sys, p);
-                        sumPrice += thisPrice;
-                        sumCnt += 1;
-                        break;
-                     }
-                  }
+               if (planet_isKnown(p) && (prices[p->id] >= 0)) {
+                  thisPrice = prices[p->id];
+                  sumPrice += thisPrice;
+                  sumCnt += 1;
                }
             }
             if (sumCnt > 0) {
@@ -1211,6 +1208,7 @@ void map_renderSystemEnvironment( double x, double y, int editor, double alpha )
          glEnableVertexAttribArray( shaders.nebula_map.vertex );
          gl_vboActivateAttribOffset( gl_squareVBO, shaders.nebula_map.vertex, 0, 2, GL_FLOAT, 0 );
          glDrawArrays( GL_TRIANGLE_STRIP, 0, 4 );
+         gl_screen.draw_calls++;
 
          /* Clean up. */
          glDisableVertexAttribArray( shaders.nebula_map.vertex );
@@ -1302,6 +1300,7 @@ void map_renderJumps( double x, double y, double r, int editor)
             vertex[17] = 1.;
             gl_vboSubData(map_vbo, 0, sizeof(GLfloat) * 3*(2+4), vertex);
             glDrawArrays(GL_LINE_STRIP, 0, 3);
+            gl_screen.draw_calls++;
 
             /* Draw the line for the dest system. */
             dir = ANGLE(sys->pos.x - jsys->pos.x, sys->pos.y - jsys->pos.y);
@@ -1325,6 +1324,7 @@ void map_renderJumps( double x, double y, double r, int editor)
             vertex[17] = 1.;
             gl_vboSubData(map_vbo, 0, sizeof(GLfloat) * 3*(2+4), vertex);
             glDrawArrays(GL_LINE_STRIP, 0, 3);
+            gl_screen.draw_calls++;
          }
          else {
             /* Draw the lines. */
@@ -1348,6 +1348,7 @@ void map_renderJumps( double x, double y, double r, int editor)
             vertex[17] = 0.8;
             gl_vboSubData(map_vbo, 0, sizeof(GLfloat) * 3*(2+4), vertex);
             glDrawArrays(GL_LINE_STRIP, 0, 3);
+            gl_screen.draw_calls++;
          }
       }
       gl_endSmoothProgram();
@@ -1555,6 +1556,7 @@ static void map_renderPath( double x, double y, double a, double alpha )
          gl_vboActivateAttribOffset( map_vbo, shaders.smooth.vertex_color,
                sizeof(GLfloat) * 2*6, 4, GL_FLOAT, 0 );
          glDrawArrays( GL_TRIANGLE_STRIP, 0, 6 );
+         gl_screen.draw_calls++;
          gl_endSmoothProgram();
 
          sys0 = sys1;
@@ -1740,10 +1742,11 @@ void map_renderCommod( double bx, double by, double x, double y,
       double w, double h, double r, int editor)
 {
    double cx, cy, tx, ty;
-   int i, j, k;
+   int i, j;
    StarSystem *sys;
    Planet *p;
    Commodity *c;
+   const credits_t *prices;
    glColour ccol;
    double best, worst, maxPrice, minPrice, curMaxPrice, curMinPrice, thisPrice;
 
@@ -1753,6 +1756,9 @@ void map_renderCommod( double bx, double by, double x, double y,
       return;
 
    c = commod_known[cur_commod];
+
+   /* Prices of all planets, only recalculated when time advances. */
+   prices = economy_getPrices(c);
    /* showing price difference to selected system */
    if (cur_commod_mode == 1) {
       /* Get commodity price in selected system.  If selected system is
@@ -1761,15 +1767,11 @@ void map_renderCommod( double bx, double by, double x, double y,
       curMaxPrice = 0.;
       curMinPrice = 0.;
       sys = system_getIndex(map_selected);
-      if ((sys == cur_system) && landed) {
-         for (k=0; k<array_size(land_planet->commodities); k++) {
-            if (land_planet->commodities[k] == c) {
-               /* current planet has the commodity of interest */
-               curMinPrice = economy_getPrice(c, sys, land_planet);
-               curMaxPrice = curMinPrice;
-               break;
-            }
-         }
+      if ((sys == cur_system) && landed
+            && (prices[land_planet->id] >= 0)) {
+         /* current planet has the commodity of interest */
+         curMinPrice = prices[land_planet->id];
+         curMaxPrice = curMinPrice;
       }
 
       if (curMinPrice == 0.) {
@@ -1780,17 +1782,12 @@ void map_renderCommod( double bx, double by, double x, double y,
             maxPrice = 0;
             for (j=0; j<array_size(sys->planets); j++) {
                p = sys->planets[j];
-               if (planet_isKnown(p)) {
-                  for (k=0; k<array_size(p->commodities); k++) {
-                     if (p->commodities[k] == c) {
-                        thisPrice = economy_getPrice(c, sys, p);
-                        if (thisPrice > maxPrice)
-                           maxPrice = thisPrice;
-                        if ((minPrice == 0) || (thisPrice < minPrice))
-                           minPrice = thisPrice;
-                        break;
-                     }
-                  }
+               if (planet_isKnown(p) && (prices[p->id] >= 0)) {
+                  thisPrice = prices[p->id];
+                  if (thisPrice > maxPrice)
+                     maxPrice = thisPrice;
+                  if ((minPrice == 0) || (thisPrice < minPrice))
+                     minPrice = thisPrice;
                }
             }
             if (maxPrice == 0) {
@@ -1832,17 +1829,12 @@ void map_renderCommod( double bx, double by, double x, double y,
             maxPrice = 0;
             for (j=0; j<array_size(sys->planets); j++) {
                p = sys->planets[j];
-               if (planet_isKnown(p)) {
-                  for (k=0; k<array_size(p->commodities); k++) {
-                     if (p->commodities[k] == c) {
-                        thisPrice = economy_getPrice(c, sys, p);
-                        if (thisPrice > maxPrice)
-                           maxPrice = thisPrice;
-                        if ((minPrice == 0) || (thisPrice < minPrice))
-                           minPrice = thisPrice;
-                        break;
-                     }
-                  }
+               if (planet_isKnown(p) && (prices[p->id] >= 0)) {
+                  thisPrice = prices[p->id];
+                  if (thisPrice > maxPrice)
+                     maxPrice = thisPrice;
+                  if ((minPrice == 0) || (thisPrice < minPrice))
+                     minPrice = thisPrice;
                }
             }
 
@@ -1909,15 +1901,10 @@ void map_renderCommod( double bx, double by, double x, double y,
             int sumCnt = 0;
             for (j=0 ; j<array_size(sys->planets); j++) {
                p = sys->planets[j];
-               if (planet_isKnown(p)) {
-                  for (k=0; k<array_size(p->commodities); k++) {
-                     if (p->commodities[k] == c) {
-                        thisPrice = economy_getPrice(c, sys, p);
-                        sumPrice += thisPrice;
-                        sumCnt += 1;
-                        break;
-                     }
-                  }
+               if (planet_isKnown(p) && (prices[p->id] >= 0)) {
+                  thisPrice = prices[p->id];
+                  sumPrice += thisPrice;
+                  sumCnt += 1;
                }
             }
 
@@ -74,7 +74,7 @@ static int mission_matchFaction( MissionData* misn, int faction );
 static int mission_location( const char *loc );
 /* Loading. */
 static int missions_cmp( const void *a, const void *b );
-static int mission_parseFile( const char* file );
+static int mission_parseFile( const XmlFile *xf );
 static int mission_parseXML( MissionData *temp, const xmlNodePtr parent );
 static int missions_parseActive( xmlNodePtr parent );
 /* Hilighting. */
@@ -962,19 +962,23 @@ int missions_load (void)
 {
    int i;
    char **mission_files;
+   XmlFile *docs;
 
    /* Allocate player missions. */
    for (i=0; i<MISSION_MAX; i++)
       player_missions[i] = calloc(1, sizeof(Mission));
 
-   /* Run over missions. */
+   /* Run over missions, reading the headers in parallel. */
    mission_files = ndata_listRecursive( MISSION_DATA_PATH );
    mission_stack = array_create_size( MissionData, array_size( mission_files ) );
-   for ( i = 0; i < array_size( mission_files ); i++ ) {
+   docs = xml_parsePhysFSList( mission_files, "</mission>" );
+   for ( i = 0; i < array_size( docs ); i++ ) {
       if (!naev_pollQuit())
-         mission_parseFile(mission_files[i]);
-      free( mission_files[i] );
+         mission_parseFile( &docs[i] );
    }
+   xml_freeFileList( docs );
+   for ( i = 0; i < array_size( mission_files ); i++ )
+      free( mission_files[i] );
    array_free( mission_files );
    array_shrink(&mission_stack);
 
@@ -989,14 +993,14 @@ int missions_load (void)
 
 /**
  * @brief Parses a single mission.
+ *
+ *    @param xf Mission file as read by xml_parsePhysFSList().
  */
-static int mission_parseFile( const char* file )
+static int mission_parseFile( const XmlFile *xf )
 {
-   xmlDocPtr doc;
    xmlNodePtr node;
-   size_t bufsize;
-   char *filebuf;
-   const char *pos, *start_pos;
+   const char *pos;
+   const char *file;
    MissionData *temp;
 
 #ifdef DEBUGGING
@@ -1004,39 +1008,32 @@ static int mission_parseFile( const char* file )
    int ret;
 #endif /* DEBUGGING */
 
-   /* Load string. */
-   filebuf = ndata_read( file, &bufsize );
-   if (filebuf == NULL) {
-      WARN(_("Unable to read data from '%s'"), file);
-      return -1;
-   }
+   file = xf->filename;
+   switch (xf->status) {
+      case XMLFILE_NOREAD:
+         WARN(_("Unable to read data from '%s': %s"), file, xf->error);
+         return -1;
+
+      /* Skip if no XML. */
+      case XMLFILE_NOHEADER:
+         pos = strnstr( xf->buf, "function create", xf->bufsize );
+         if ((pos != NULL) && !strncmp(pos,"--common",xf->bufsize))
+            WARN(_("Mission '%s' has create function but no XML header!"), file);
+         return 0;
 
-   /* Skip if no XML. */
-   pos = strnstr( filebuf, "</mission>", bufsize );
-   if (pos==NULL) {
-      pos = strnstr( filebuf, "function create", bufsize );
-      if ((pos != NULL) && !strncmp(pos,"--common",bufsize))
-         WARN(_("Mission '%s' has create function but no XML header!"), file);
-      free(filebuf);
-      return 0;
-   }
+      case XMLFILE_BADHEADER:
+         WARN(_("Mission file '%s' has missing XML header!"), file);
+         return -1;
 
-   /* Separate XML header and Lua. */
-   start_pos = strnstr( filebuf, "<?xml ", bufsize );
-   pos = strnstr( filebuf, "--]]", bufsize );
-   if (pos == NULL || start_pos == NULL) {
-      WARN(_("Mission file '%s' has missing XML header!"), file);
-      return -1;
-   }
+      case XMLFILE_NOPARSE:
+         WARN(_("Unable to parse document XML header for Mission '%s'"), file);
+         return -1;
 
-   /* Parse the header. */
-   doc = xmlParseMemory( start_pos, pos-start_pos);
-   if (doc == NULL) {
-      WARN(_("Unable to parse document XML header for Mission '%s'"), file);
-      return -1;
+      case XMLFILE_OK:
+         break;
    }
 
-   node = doc->xmlChildrenNode;
+   node = xf->doc->xmlChildrenNode;
    if (!xml_isNode(node,XML_MISSION_TAG)) {
       ERR( _("Malformed XML header for '%s' mission: missing root element '%s'"), file, XML_MISSION_TAG );
       return -1;
@@ -1044,7 +1041,7 @@ static int mission_parseFile( const char* file )
 
    temp = &array_grow(&mission_stack);
    mission_parseXML( temp, node );
-   temp->lua = strdup(filebuf);
+   temp->lua = strdup(xf->buf);
    temp->sourcefile = strdup(file);
 
 #ifdef DEBUGGING
@@ -1058,10 +1055,6 @@ static int mission_parseFile( const char* file )
    }
 #endif /* DEBUGGING */
 
-   /* Clean up. */
-   xmlFreeDoc(doc);
-   free(filebuf);
-
    return 0;
 }
 
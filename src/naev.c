@@ -29,8 +29,11 @@
 /** @endcond */
 
 #include "ai.h"
+#include "arena.h"
 #include "background.h"
+#include "bench.h"
 #include "camera.h"
+#include "collision.h"
 #include "cond.h"
 #include "conf.h"
 #include "console.h"
@@ -72,8 +75,11 @@
 #include "pilot.h"
 #include "player.h"
 #include "player_gui.h"
+#include "profile.h"
 #include "render.h"
+#include "replay.h"
 #include "rng.h"
+#include "save.h"
 #include "semver.h"
 #include "ship.h"
 #include "slots.h"
@@ -96,8 +102,11 @@ static double loading_r = 0.; /**< Just to provide some randomness. */
 static glTexture *loading = NULL; /**< Loading screen. */
 static glFont loading_font; /**< Loading font. */
 static char *loading_txt = NULL; /**< Loading text to display. */
+static const char *loading_stage = NULL; /**< Loading stage being timed. */
+static Uint32 loading_stage_ms = 0; /**< Start time of the loading stage. */
 static SDL_Surface *naev_icon = NULL; /**< Icon. */
 static int fps_skipped = 0; /**< Skipped last frame? */
+static int main_depth = 0; /**< Nesting depth of main_loop(). */
 /* Version stuff. */
 static semver_t version_binary; /**< Naev binary version. */
 static char version_human[STRMAX_SHORT]; /**< Human readable version. */
@@ -113,7 +122,16 @@ static double fps_cur = 0.; /**< FPS accumulator to trigger change. */
 static double fps_x =  15.; /**< FPS X position. */
 static double fps_y = -15.; /**< FPS Y position. */
 
+#define UPDATE_RATE  60. /**< Updates per real second, unless time goes by faster than dt_max allows. */
 const double dt_max = 1./30.; /**< Max dt per frame (denominator is min FPS). */
+static double update_accum = 0.; /**< Game time left over to simulate in the next frames. */
+static double update_alpha = 1.; /**< How far rendering is between the last two updates. */
+static int update_interpolated = 0; /**< Whether things are drawn between updates right now. */
+
+static UpdateTimes *update_times = NULL; /**< Accumulates update timings if not NULL. */
+/** Adds the time since the last mark to a field of update_times. */
+#define UPDATE_MARK( field ) \
+   if (update_times != NULL) update_times->field += update_elapsed( &last )
 
 /*
  * prototypes
@@ -129,9 +147,13 @@ static void window_caption (void);
 static void fps_init (void);
 static double fps_elapsed (void);
 static void fps_control (void);
+static double update_elapsed( Uint64 *last );
+static double update_step (void);
 static void update_all (void);
+static void update_interpolate( double alpha );
 /* Misc. */
 static void loadscreen_render( double done, const char *msg );
+static void loadscreen_stage( double done, const char *msg );
 void main_loop( int update ); /* dialogue.c */
 
 
@@ -183,6 +205,7 @@ int naev_pollQuit(void)
 int main( int argc, char** argv )
 {
    char conf_file_path[PATH_MAX], **search_path, **p;
+   int ret = EXIT_SUCCESS;
    SDL_Event event;
 
 #ifdef DEBUGGING
@@ -302,6 +325,10 @@ int main( int argc, char** argv )
    /* random numbers */
    rng_init();
 
+   /* Recording or replaying a run, needs the seed before anything uses it. */
+   if (replay_init())
+      ERR( _("Failed to set up recording or replaying.") );
+
    /*
     * OpenGL
     */
@@ -384,10 +411,23 @@ int main( int argc, char** argv )
    /* Unload load screen. */
    loadscreen_unload();
 
-   /* Start menu. */
-   menu_main();
+   /* Run the benchmark instead of the game if requested. */
+   if (conf.bench_system != NULL) {
+      if (bench_run())
+         ret = EXIT_FAILURE;
+      quit = 1;
+   }
+   else if (conf.microbench != NULL) {
+      if (bench_micro( conf.microbench ))
+         ret = EXIT_FAILURE;
+      quit = 1;
+   }
+   else {
+      /* Start menu. */
+      menu_main();
 
-   LOG( _( "Reached main menu" ) );
+      LOG( _( "Reached main menu" ) );
+   }
 
    fps_init(); /* initializes the time_ms */
 
@@ -400,7 +440,7 @@ int main( int argc, char** argv )
 
    /* primary loop */
    while (!quit) {
-      while (!quit && SDL_PollEvent(&event)) { /* event loop */
+      while (!quit && replay_pollEvent(&event)) { /* event loop */
          if (event.type == SDL_QUIT) {
             if (quit || menu_askQuit()) {
                quit = 1; /* quit is handled here */
@@ -418,8 +458,16 @@ int main( int argc, char** argv )
       main_loop( 1 );
    }
 
-   /* Save configuration. */
-   conf_saveConfig(conf_file_path);
+   /* Finish the recording or check the replay while the pilots exist. */
+   if (replay_exit())
+      ret = EXIT_FAILURE;
+
+   /* Finish writing the saved game. */
+   save_wait();
+
+   /* Save configuration, headless mode overrides it. */
+   if (!conf.headless)
+      conf_saveConfig(conf_file_path);
 
    /* data unloading */
    unload_all();
@@ -446,6 +494,7 @@ int main( int argc, char** argv )
    gl_exit(); /* Kills video output */
    sound_exit(); /* Kills the sound */
    news_exit(); /* Destroys the news. */
+   arena_exit(); /* Frees the frame arena. */
 
    /* Has to be run last or it will mess up sound settings. */
    conf_cleanup(); /* Free some memory the configuration allocated. */
@@ -470,7 +519,7 @@ int main( int argc, char** argv )
 
    /* all is well */
    debug_enableLeakSanitizer();
-   return 0;
+   return ret;
 }
 
 
@@ -601,6 +650,30 @@ void loadscreen_render( double done, const char *msg )
 }
 
 
+/**
+ * @brief Renders the load screen for a new loading stage, reporting how
+ *  long the previous stage took.
+ *
+ *    @param done Amount done (1. == completed).
+ *    @param msg Loading screen message of the new stage, or NULL to only
+ *           finish timing the previous stage.
+ */
+static void loadscreen_stage( double done, const char *msg )
+{
+   Uint32 t;
+
+   t = SDL_GetTicks();
+   if (loading_stage != NULL)
+      DEBUG( _("%s done in %u ms"), loading_stage,
+            (unsigned int)(t - loading_stage_ms) );
+
+   loading_stage = msg;
+   loading_stage_ms = t;
+   if (msg != NULL)
+      loadscreen_render( done, msg );
+}
+
+
 /**
  * @brief Frees the loading screen.
  */
@@ -619,50 +692,59 @@ static void loadscreen_unload (void)
 #define LOADING_STAGES     16. /**< Amount of loading stages. */
 void load_all (void)
 {
+   Uint32 t0;
+
+   t0 = SDL_GetTicks();
+
    /* We can do fast stuff here. */
    sp_load();
 
    /* order is very important as they're interdependent */
-   loadscreen_render(1./LOADING_STAGES, _("Loading Commodities…"));
+   loadscreen_stage(1./LOADING_STAGES, _("Loading Commodities…"));
    commodity_load(); /* dep for space */
 
-   loadscreen_render(2./LOADING_STAGES, _("Loading Special Effects…"));
+   loadscreen_stage(2./LOADING_STAGES, _("Loading Special Effects…"));
    spfx_load(); /* no dep */
 
-   loadscreen_render(3./LOADING_STAGES, _("Loading Damage Types…"));
+   loadscreen_stage(3./LOADING_STAGES, _("Loading Damage Types…"));
    dtype_load(); /* dep for outfits */
 
-   loadscreen_render(4./LOADING_STAGES, _("Loading Outfits…"));
+   /* Outfits and ships take their collision polygons from the cache. */
+   PolygonCacheOpen();
+
+   loadscreen_stage(4./LOADING_STAGES, _("Loading Outfits…"));
    outfit_load(); /* dep for ships, factions */
 
-   loadscreen_render(5./LOADING_STAGES, _("Loading Ships…"));
+   loadscreen_stage(5./LOADING_STAGES, _("Loading Ships…"));
    ships_load(); /* no dep */
 
-   loadscreen_render(6./LOADING_STAGES, _("Loading Factions…"));
+   PolygonCacheClose();
+
+   loadscreen_stage(6./LOADING_STAGES, _("Loading Factions…"));
    factions_load(); /* dep for space, missions, AI */
 
-   loadscreen_render(7./LOADING_STAGES, _("Loading Events…"));
+   loadscreen_stage(7./LOADING_STAGES, _("Loading Events…"));
    events_load(); /* no dep */
 
-   loadscreen_render(8./LOADING_STAGES, _("Loading Missions…"));
+   loadscreen_stage(8./LOADING_STAGES, _("Loading Missions…"));
    missions_load(); /* no dep */
 
-   loadscreen_render(9./LOADING_STAGES, _("Loading AI…"));
+   loadscreen_stage(9./LOADING_STAGES, _("Loading AI…"));
    ai_load(); /* no dep */
 
-   loadscreen_render(11./LOADING_STAGES, _("Loading Techs…"));
+   loadscreen_stage(11./LOADING_STAGES, _("Loading Techs…"));
    tech_load(); /* dep for space */
 
-   loadscreen_render(12./LOADING_STAGES, _("Loading the Universe…"));
+   loadscreen_stage(12./LOADING_STAGES, _("Loading the Universe…"));
    space_load();
 
-   loadscreen_render(13./LOADING_STAGES, _("Loading the UniDiffs…"));
+   loadscreen_stage(13./LOADING_STAGES, _("Loading the UniDiffs…"));
    diff_loadAvailable();
 
-   loadscreen_render(14./LOADING_STAGES, _("Populating Maps…"));
+   loadscreen_stage(14./LOADING_STAGES, _("Populating Maps…"));
    outfit_mapParse();
 
-   loadscreen_render(15./LOADING_STAGES, _("Initializing Details…"));
+   loadscreen_stage(15./LOADING_STAGES, _("Initializing Details…"));
    player_guiInit();
    background_init();
    map_load();
@@ -670,7 +752,10 @@ void load_all (void)
    pilots_init();
    weapon_init();
    player_init(); /* Initialize player stuff. */
+   loadscreen_stage(1., NULL);
    loadscreen_render(1., _("Loading Completed!"));
+   DEBUG( _("Loaded all data in %u ms"),
+         (unsigned int)(SDL_GetTicks() - t0) );
 }
 /**
  * @brief Unloads all data, simplifies main().
@@ -683,6 +768,7 @@ void unload_all (void)
    gui_free(); /* cleans up the player's GUI */
    weapon_exit(); /* destroys all active weapons */
    pilots_free(); /* frees the pilots, they were locked up :( */
+   solid_exit(); /* frees the memory of the solids */
    cond_exit(); /* destroy conditional subsystem. */
    land_exit(); /* Destroys landing vbo and friends. */
    npc_clear(); /* In case exiting while landed. */
@@ -710,6 +796,15 @@ void unload_all (void)
  */
 void main_loop( int update )
 {
+   ArenaMark mark;
+
+   /* Start a new profiler frame. */
+   profile_frame();
+
+   /* Nested loops must keep what the frame they interrupted allocated. */
+   mark = arena_mark();
+   main_depth++;
+
    /*
     * Control FPS.
     */
@@ -735,6 +830,9 @@ void main_loop( int update )
    /* Safe hook should be run every frame regardless of whether game is paused or not. */
    hooks_run( "safe" );
 
+   /* Report saves written in the background. */
+   save_update();
+
    /* Checks to see if we want to land. */
    space_checkLand();
 
@@ -742,11 +840,22 @@ void main_loop( int update )
     * Handle render.
     */
    if (!quit) {
+      /* Upload textures that finished loading in the background. */
+      gl_texUpdate();
       /* Clear buffer. */
+      update_interpolate( update_alpha );
       render_all( game_dt, real_dt );
+      update_interpolate( 1. );
       /* Draw buffer. */
       SDL_GL_SwapWindow( gl_screen.window );
    }
+
+   /* Free the transient allocations of the frame. */
+   main_depth--;
+   if (main_depth == 0)
+      arena_reset();
+   else
+      arena_release( &mark );
 }
 
 
@@ -871,6 +980,7 @@ static void fps_control (void)
 
    /* dt in s */
    real_dt  = fps_elapsed();
+   replay_frame( &real_dt ); /* Recorded runs use the recorded frame times. */
    game_dt  = real_dt * dt_mod; /* Apply the modifier. */
 
    /* if fps is limited */
@@ -924,7 +1034,11 @@ void display_fps( const double dt )
    if (conf.fps_show) {
       gl_print( NULL, x, y, NULL, _("%.2f FPS"), fps );
       y -= gl_defFont.h + 5.;
+      gl_print( NULL, x, y, NULL, n_("%u draw call", "%u draw calls",
+               gl_screen.draw_calls_last), gl_screen.draw_calls_last );
+      y -= gl_defFont.h + 5.;
    }
+   y = profile_render( x, y );
 
    if ((player.p != NULL) && !player_isFlag(PLAYER_DESTROYED) &&
          !player_isFlag(PLAYER_CREATING)
@@ -952,53 +1066,94 @@ void display_fps( const double dt )
 }
 
 
+/**
+ * @brief Gets the game time simulated by each update.
+ *
+ * Every update simulates the same time no matter the frame rate. Updates
+ *  happen UPDATE_RATE times per real second, so time compression makes
+ *  them longer until they reach dt_max and more frequent from there on.
+ *
+ *    @return Length of an update in game seconds.
+ */
+static double update_step (void)
+{
+   return MIN( dt_max, dt_mod / UPDATE_RATE );
+}
+
+
 /**
  * @brief Updates the game itself (player flying around and friends).
  *
+ * The game is simulated in steps of update_step(), carrying the time
+ *  left over to the next frame. Rendering then draws everything between
+ *  its last two steps so motion stays smooth at any frame rate.
+ *
  *    @brief Mainly uses game dt.
  */
 static void update_all (void)
 {
-   int i, n;
-   double nf, microdt, accumdt;
+   double step, mod;
 
    if ((real_dt > 0.25) && (fps_skipped==0)) { /* slow timers down and rerun calculations */
       fps_skipped = 1;
       return;
    }
-   else if (game_dt > dt_max) {
-      /* FPS is too low to maintain accurate collision detection. To
-       * avoid problems with this, we update in increments. */
-
-      /* Number of frames. */
-      nf = ceil(game_dt / dt_max);
-      microdt = game_dt / nf;
-      n  = (int) nf;
-
-      /* Update as much as needed, evenly. */
-      accumdt = 0.;
-      for (i=0; i<n; i++) {
-         update_routine( microdt, 0 );
-         /* OK, so we need a bit of hackish logic here in case we are chopping up a
-          * very large dt and it turns out time compression changes so we're now
-          * updating in "normal time compression" zone. This amounts to many updates
-          * being run when time compression has changed and thus can cause, say, the
-          * player to exceed their target position or get mauled by an enemy ship.
-          */
-         accumdt += microdt;
-         if (accumdt > dt_mod*real_dt)
-            break;
-      }
 
-      /* Note we don't touch game_dt so that fps_display works well */
+   mod  = dt_mod;
+   step = update_step();
+   update_accum += game_dt;
+   while ((step > 0.) && (update_accum >= step)) {
+      update_routine( step, 0 );
+      update_accum -= step;
+
+      /* Time compression may change during the update, such as when an
+       * enemy shows up during autonav. Whatever is left of the frame must
+       * then go by at the new rate, or the player could overshoot their
+       * target position or get mauled by the enemy. */
+      if (dt_mod != mod) {
+         update_accum *= dt_mod / mod;
+         mod  = dt_mod;
+         step = update_step();
+      }
    }
-   else /* Standard, just update with the last dt */
-      update_routine( game_dt, 0 );
+   update_alpha = (step > 0.) ? update_accum / step : 1.;
 
+   /* Note we don't touch game_dt so that fps_display works well */
    fps_skipped = 0;
 }
 
 
+/**
+ * @brief Moves what's drawn between the last two updates, or back.
+ *
+ * The spatial grid and the sensor cache are invalidated both ways, so what
+ *  the renderer asks about the drawn positions is never answered from the
+ *  real ones, nor remembered for the next update.
+ *
+ *    @param alpha Fraction of the way from the previous update to the
+ *           last, 1 to put everything back where it really is.
+ */
+static void update_interpolate( double alpha )
+{
+   if (alpha >= 1.) {
+      if (!update_interpolated)
+         return;
+      solid_interpolateEnd();
+      cam_interpolate( 1. );
+      pilot_gridDirty();
+      pilot_ewCacheClear();
+      update_interpolated = 0;
+      return;
+   }
+   pilots_interpolate( alpha );
+   weapons_interpolate( alpha );
+   cam_interpolate( alpha );
+   pilot_gridDirty();
+   pilot_ewCacheClear();
+   update_interpolated = 1;
+}
+
+
 /**
  * @brief Actually runs the updates
  *
@@ -1008,24 +1163,49 @@ static void update_all (void)
 void update_routine( double dt, int enter_sys )
 {
    HookParam h[3];
+   Uint64 last = 0;
+
+   if (update_times != NULL)
+      last = SDL_GetPerformanceCounter();
+
+   /* Remember where everything was to draw between updates. */
+   pilots_savePrev();
+   weapons_savePrev();
 
    if (!enter_sys) {
+      PROFILE_BEGIN( PROFILE_HOOKS );
       hook_exclusionStart();
 
       /* Update time. */
       ntime_update( dt );
+      PROFILE_END( PROFILE_HOOKS );
    }
+   UPDATE_MARK( hooks );
 
    /* Update engine stuff. */
+   PROFILE_BEGIN( PROFILE_SPACE );
    space_update(dt);
+   PROFILE_END( PROFILE_SPACE );
+   UPDATE_MARK( space );
+   PROFILE_BEGIN( PROFILE_WEAPONS );
    weapons_update(dt);
+   PROFILE_END( PROFILE_WEAPONS );
+   UPDATE_MARK( weapons );
+   PROFILE_BEGIN( PROFILE_SPFX );
    spfx_update(dt, real_dt);
+   PROFILE_END( PROFILE_SPFX );
+   UPDATE_MARK( spfx );
+   PROFILE_BEGIN( PROFILE_PILOTS );
    pilots_update(dt);
+   PROFILE_END( PROFILE_PILOTS );
+   UPDATE_MARK( pilots );
 
    /* Update camera. */
    cam_update( dt );
+   UPDATE_MARK( camera );
 
    if (!enter_sys) {
+      PROFILE_BEGIN( PROFILE_HOOKS );
       hook_exclusionEnd( dt );
 
       /* Hook set up. */
@@ -1036,7 +1216,35 @@ void update_routine( double dt, int enter_sys )
       h[2].type = HOOK_PARAM_SENTINEL;
       /* Run the update hook. */
       hooks_runParam( "update", h );
+      PROFILE_END( PROFILE_HOOKS );
    }
+   UPDATE_MARK( hooks );
+}
+
+
+/**
+ * @brief Gets the seconds elapsed since a performance counter value.
+ *
+ *    @param[in,out] last Counter value to measure from, set to the current one.
+ *    @return Seconds elapsed.
+ */
+static double update_elapsed( Uint64 *last )
+{
+   Uint64 now = SDL_GetPerformanceCounter();
+   double elapsed = (double)(now - *last) / (double)SDL_GetPerformanceFrequency();
+   *last = now;
+   return elapsed;
+}
+
+
+/**
+ * @brief Sets where update_routine() accumulates the time spent in each part.
+ *
+ *    @param times Timings to add to, or NULL to stop timing.
+ */
+void update_setTimes( UpdateTimes *times )
+{
+   update_times = times;
 }
 
 
@@ -75,6 +75,19 @@
 #endif
 
 
+/**
+ * @brief Time spent in each part of update_routine(), in seconds.
+ */
+typedef struct UpdateTimes_ {
+   double space; /**< Updating the system. */
+   double weapons; /**< Updating weapons. */
+   double spfx; /**< Updating special effects. */
+   double pilots; /**< Updating pilots. */
+   double camera; /**< Updating the camera. */
+   double hooks; /**< Updating time and running hooks. */
+} UpdateTimes;
+
+
 /*
  * Misc stuff.
  */
@@ -84,6 +97,7 @@ void display_fps( const double dt );
 void naev_resize(int force);
 void naev_toggleFullscreen (void);
 void update_routine( double dt, int enter_sys );
+void update_setTimes( UpdateTimes *times );
 char *naev_version( int long_version );
 int naev_versionCompare( const char *version );
 void naev_quit (void);
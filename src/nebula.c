@@ -203,6 +203,7 @@ static void nebu_renderBackground( const double dt )
    glEnableVertexAttribArray( shaders.nebula_background.vertex );
    gl_vboActivateAttribOffset( gl_squareVBO, shaders.nebula_background.vertex, 0, 2, GL_FLOAT, 0 );
    glDrawArrays( GL_TRIANGLE_STRIP, 0, 4 );
+   gl_screen.draw_calls++;
    nebu_blitFBO();
 
    /* Clean up. */
@@ -235,6 +236,7 @@ static void nebu_blitFBO (void)
 
       /* Draw. */
       glDrawArrays( GL_TRIANGLE_STRIP, 0, 4 );
+      gl_screen.draw_calls++;
 
       /* Clear state. */
       glDisableVertexAttribArray( shaders.texture.vertex );
@@ -296,6 +298,7 @@ void nebu_renderOverlay( const double dt )
    glEnableVertexAttribArray(shaders.nebula.vertex);
    gl_vboActivateAttribOffset( gl_squareVBO, shaders.nebula.vertex, 0, 2, GL_FLOAT, 0 );
    glDrawArrays( GL_TRIANGLE_STRIP, 0, 4 );
+   gl_screen.draw_calls++;
    nebu_blitFBO();
 
    /* Clean up. */
@@ -26,9 +26,11 @@
 #include <sys/types.h>
 #include <unistd.h>
 #include <errno.h>
+#include <fcntl.h>
 #include <libgen.h>
 #endif /* HAS_POSIX */
 #if WIN32
+#include <io.h>
 #include <windows.h>
 #endif /* WIN32 */
 /** @endcond */
@@ -588,6 +590,113 @@ int nfile_writeFile( const char *data, size_t len, const char *path )
 }
 
 
+/**
+ * @brief Writes a file so it's never left partially written.
+ *
+ * The data is written to a temporary file which is flushed to disk and then
+ *  renamed over the file, so the file either has its old or its new
+ *  contents even if the game or system crashes. Doesn't log, so it can be
+ *  used from other threads; errno is set on failure.
+ *
+ *    @param data Pointer to the data to write.
+ *    @param len The size of data.
+ *    @param path Path of the file.
+ *    @param backup Path to keep the previous contents at, or NULL. If the
+ *           file exists and its contents can't be kept there, the write
+ *           fails without replacing it.
+ *    @return 0 on success, -1 on error.
+ */
+int nfile_writeFileAtomic( const char *data, size_t len, const char *path,
+      const char *backup )
+{
+   char tmp[PATH_MAX];
+   size_t n, pos;
+   FILE *file;
+   int err;
+#if HAS_POSIX
+   char dir[PATH_MAX];
+   int fd;
+#endif /* HAS_POSIX */
+
+   if ((path == NULL)
+         || (snprintf( tmp, sizeof(tmp), "%s.tmp", path ) >= (int)sizeof(tmp))) {
+      errno = ENAMETOOLONG;
+      return -1;
+   }
+
+   /* Write the temporary file. */
+   file = fopen( tmp, "wb" );
+   if (file == NULL)
+      return -1;
+   for (n=0; n<len; n+=pos) {
+      pos = fwrite( &data[n], 1, len-n, file );
+      if (pos <= 0)
+         goto err_close;
+   }
+
+   /* Make sure it's on disk before replacing the old file. */
+   if (fflush( file ) != 0)
+      goto err_close;
+#if HAS_POSIX
+   if (fsync( fileno( file ) ) != 0)
+      goto err_close;
+#elif WIN32
+   if (_commit( _fileno( file ) ) != 0)
+      goto err_close;
+#endif /* HAS_POSIX */
+   if (fclose( file ) == EOF)
+      goto err_remove;
+
+   /* Replace the file. */
+#if HAS_POSIX
+   if (backup != NULL) {
+      /* Fail rather than replace the previous contents without keeping them. */
+      if ((unlink( backup ) != 0) && (errno != ENOENT))
+         goto err_remove;
+      /* Some file systems can't link, so the file gets moved there instead. */
+      if ((link( path, backup ) != 0) && (errno != ENOENT)
+            && (rename( path, backup ) != 0))
+         goto err_remove;
+   }
+   if (rename( tmp, path ) != 0)
+      goto err_remove;
+
+   /* Make the rename itself durable. */
+   snprintf( dir, sizeof(dir), "%s", path );
+   fd = open( dirname( dir ), O_RDONLY );
+   if (fd >= 0) {
+      fsync( fd );
+      close( fd );
+   }
+#elif WIN32
+   if (!ReplaceFile( path, tmp, backup, REPLACEFILE_IGNORE_MERGE_ERRORS,
+            NULL, NULL )) {
+      /* Only a missing file may be replaced without keeping the backup. */
+      if (((backup != NULL) && (GetFileAttributes( path ) != INVALID_FILE_ATTRIBUTES))
+            || !MoveFileEx( tmp, path,
+               MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH )) {
+         errno = EIO;
+         goto err_remove;
+      }
+   }
+#else
+#error "Feature needs implementation on this Operating System for Naikari to work."
+#endif /* HAS_POSIX */
+
+   return 0;
+
+err_close:
+   err = errno;
+   fclose( file );
+   errno = err;
+err_remove:
+   err = errno;
+   remove( tmp );
+   errno = err;
+   return -1;
+}
+
+
 /**
  * @brief Checks to see if a character is used to separate files in a path.
  *
@@ -42,6 +42,7 @@
 #include "nlua_vec2.h"
 #include "nluadef.h"
 #include "nstring.h"
+#include "profile.h"
 
 
 lua_State *naevL = NULL;
@@ -698,7 +699,9 @@ int nlua_pcall( nlua_env env, int nargs, int nresults ) {
    prev_env = __NLUA_CURENV;
    __NLUA_CURENV = env;
 
+   PROFILE_BEGIN( PROFILE_LUA );
    ret = lua_pcall(naevL, nargs, nresults, errf);
+   PROFILE_END( PROFILE_LUA );
 
    __NLUA_CURENV = prev_env;
 
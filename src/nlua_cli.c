@@ -19,10 +19,15 @@
 #include "log.h"
 #include "mission.h"
 #include "nluadef.h"
+#include "profile.h"
 
 
 /* CLI */
+static int cliL_profile( lua_State *L );
+static int cliL_trace( lua_State *L );
 static const luaL_Reg cli_methods[] = {
+   {"profile", cliL_profile},
+   {"trace", cliL_trace},
    {0,0}
 }; /**< CLI Lua methods. */
 
@@ -39,3 +44,61 @@ int nlua_loadCLI( nlua_env env )
    return 0;
 }
 
+
+
+/**
+ * @brief Bindings for the console.
+ *
+ * @luamod cli
+ */
+
+
+/**
+ * @brief Shows or hides the frame profiler breakdown under the FPS.
+ *
+ * @usage cli.profile() -- Toggles the breakdown
+ *    @luatparam[opt] boolean show Whether to show the breakdown, toggles
+ *       it if omitted.
+ *    @luatreturn boolean Whether the breakdown is now shown.
+ * @luafunc profile
+ */
+static int cliL_profile( lua_State *L )
+{
+#if PROFILING
+   int show;
+
+   if (lua_isnoneornil(L,1))
+      show = !profile_isShown();
+   else
+      show = lua_toboolean(L,1);
+   profile_show( show );
+   lua_pushboolean( L, show );
+   return 1;
+#else /* PROFILING */
+   NLUA_ERROR( L, _("The profiler is not compiled in.") );
+   return 0;
+#endif /* PROFILING */
+}
+
+
+/**
+ * @brief Traces frames with the profiler.
+ *
+ * The trace is written as Chrome trace event JSON to the traces
+ *  directory of the write location once the frames have passed.
+ *
+ * @usage cli.trace( 300 ) -- Traces the next 300 frames
+ *    @luatparam[opt=120] number frames Number of frames to trace.
+ * @luafunc trace
+ */
+static int cliL_trace( lua_State *L )
+{
+#if PROFILING
+   if (profile_trace( luaL_optinteger(L,1,120) ))
+      NLUA_ERROR( L, _("A trace is already running.") );
+   return 0;
+#else /* PROFILING */
+   NLUA_ERROR( L, _("The profiler is not compiled in.") );
+   return 0;
+#endif /* PROFILING */
+}
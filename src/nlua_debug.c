@@ -17,14 +17,18 @@
 
 #include "nlua_debug.h"
 
+#include "console.h"
 #include "debug.h"
 #include "nluadef.h"
+#include "opengl_tex.h"
 
 /* Debug metatable methods. */
 
 static int debugL_showEmitters( lua_State *L );
+static int debugL_textures( lua_State *L );
 static const luaL_Reg debugL_methods[] = {
    { "showEmitters", debugL_showEmitters },
+   { "textures", debugL_textures },
    {0,0}
 }; /**< Debug metatable methods. */
 
@@ -78,3 +82,18 @@ static int debugL_showEmitters( lua_State *L )
 
    return 0;
 }
+
+
+/**
+ * @brief Prints the texture memory usage by category to the console.
+ *
+ * @usage debug.textures()
+ *
+ * @luafunc textures
+ */
+static int debugL_textures( lua_State *L )
+{
+   (void) L;
+   gl_texUsage( cli_addMessage );
+   return 0;
+}
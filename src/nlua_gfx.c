@@ -338,6 +338,7 @@ static int gfxL_renderTexH( lua_State *L )
 
    /* Draw. */
    glDrawArrays( GL_TRIANGLE_STRIP, 0, 4 );
+   gl_screen.draw_calls++;
 
    /* Clear state. */
    glDisableVertexAttribArray( shader->VertexPosition );
@@ -418,6 +418,8 @@ static int outfitL_limit( lua_State *L )
 static int outfitL_icon( lua_State *L )
 {
    const Outfit *o = luaL_validoutfit(L,1);
+   /* Lua may use the texture data directly, so it has to be loaded. */
+   gl_texLoad( o->gfx_store );
    lua_pushtex( L, gl_dupTexture( o->gfx_store ) );
    return 1;
 }
@@ -530,7 +532,7 @@ static int outfitL_getShipStat( lua_State *L )
    ShipStats ss;
    const Outfit *o = luaL_validoutfit(L,1);
    ss_statsInit( &ss );
-   ss_statsModFromList( &ss, o->stats );
+   ss_statsModFromOps( &ss, o->stats_ops );
    const char *str = luaL_optstring(L,2,NULL);
    int internal      = lua_toboolean(L,3);
    ss_statsGetLua( L, &ss, str, internal );
@@ -18,6 +18,7 @@
 #include "nlua_pilot.h"
 
 #include "ai.h"
+#include "arena.h"
 #include "array.h"
 #include "camera.h"
 #include "credits.h"
@@ -55,6 +56,7 @@ extern Pilot *cur_pilot;
 static Task *pilotL_newtask( lua_State *L, Pilot* p, const char *task );
 static int outfit_compareActive( const void *slot1, const void *slot2 );
 static int pilotL_setFlagWrapper( lua_State *L, int flag );
+static Pilot* luaL_validpilotRaw( lua_State *L, int ind );
 
 
 /* Pilot metatable methods. */
@@ -341,6 +343,9 @@ static int pilotL_setFlagWrapper( lua_State *L, int flag )
    else
       pilot_rmFlag( p, flag );
 
+   /* Flags like visibility change what pilots see. */
+   pilot_ewCacheClear();
+
    return 0;
 }
 
@@ -394,6 +399,28 @@ Pilot* luaL_validpilot( lua_State *L, int ind )
 {
    Pilot *p;
 
+   p = luaL_validpilotRaw( L, ind );
+
+   /* Stats may have been changed during a batch, make them readable. */
+   pilot_calcStatsFlush( p );
+
+   return p;
+}
+/**
+ * @brief Makes sure the pilot is valid without updating the stats if they
+ *        are waiting for the end of a batch.
+ *
+ * Lets consecutive outfit changes from Lua be applied with a single stat
+ *  recomputation.
+ *
+ *    @param L State currently running.
+ *    @param ind Index of the pilot to validate.
+ *    @return The pilot (doesn't return if fails - raises Lua error ).
+ */
+static Pilot* luaL_validpilotRaw( lua_State *L, int ind )
+{
+   Pilot *p;
+
    /* Get the pilot. */
    p  = pilot_get(luaL_checkpilot(L,ind));
    if (p==NULL) {
@@ -818,7 +845,7 @@ static int pilotL_toggleSpawn(lua_State *L)
  */
 static int pilotL_getPilots(lua_State *L)
 {
-   int i, j, k, d;
+   int i, j, k, d, n;
    LuaFaction *factions;
    Pilot * const *pilot_stack;
 
@@ -830,17 +857,26 @@ static int pilotL_getPilots(lua_State *L)
    /* Check for belonging to faction. */
    if (lua_istable(L,1) || lua_isfaction(L,1)) {
       if (lua_isfaction(L,1)) {
-         factions = array_create(LuaFaction);
-         array_push_back( &factions, lua_tofaction(L,1) );
+         factions = arena_alloc( sizeof(LuaFaction) );
+         factions[0] = lua_tofaction(L,1);
+         n = 1;
       }
       else {
-         /* Get table length and preallocate. */
-         factions = array_create_size(LuaFaction, lua_objlen(L, 1));
+         /* Count the factions and allocate for this frame. */
+         n = 0;
+         lua_pushnil(L);
+         while (lua_next(L, -2) != 0) {
+            if (lua_isfaction(L,-1))
+               n++;
+            lua_pop(L,1);
+         }
+         factions = arena_alloc( sizeof(LuaFaction) * n );
          /* Load up the table. */
+         n = 0;
          lua_pushnil(L);
          while (lua_next(L, -2) != 0) {
             if (lua_isfaction(L,-1))
-               array_push_back( &factions, lua_tofaction(L, -1) );
+               factions[n++] = lua_tofaction(L, -1);
             lua_pop(L,1);
          }
       }
@@ -849,7 +885,7 @@ static int pilotL_getPilots(lua_State *L)
       lua_newtable(L);
       k = 1;
       for (i=0; i<array_size(pilot_stack); i++) {
-         for (j=0; j<array_size(factions); j++) {
+         for (j=0; j<n; j++) {
             if ((pilot_stack[i]->faction == factions[j]) &&
                   (d || !pilot_isDisabled(pilot_stack[i])) &&
                   !pilot_isFlag(pilot_stack[i], PILOT_DELETE)) {
@@ -859,9 +895,6 @@ static int pilotL_getPilots(lua_State *L)
             }
          }
       }
-
-      /* clean up. */
-      array_free( factions );
    }
    else if ((lua_isnil(L,1)) || (lua_gettop(L) == 0)) {
       /* Now put all the matching pilots in a table. */
@@ -1281,6 +1314,7 @@ static int pilotL_weapset(lua_State *L)
    /* Parse parameters. */
    all = 0;
    p = luaL_validpilot(L,1);
+   pilot_heatSettle( p );
    if (lua_gettop(L) > 1) {
       if (lua_isnumber(L,2))
          id = luaL_checkinteger(L,2) - 1;
@@ -1600,6 +1634,7 @@ static int pilotL_weapsetHeat(lua_State *L)
    /* Parse parameters. */
    all = 0;
    p   = luaL_validpilot(L,1);
+   pilot_heatSettle( p );
    if (lua_gettop(L) > 1) {
       if (lua_isnumber(L,2))
          id = luaL_checkinteger(L,2) - 1;
@@ -1724,6 +1759,7 @@ static int pilotL_actives(lua_State *L)
    /* Parse parameters. */
    p     = luaL_validpilot(L,1);
    sort  = lua_toboolean(L,2);
+   pilot_heatSettle( p );
 
    k = 0;
    lua_newtable(L);
@@ -2128,7 +2164,8 @@ static int pilotL_temp(lua_State *L)
    /* Parse parameters */
    p     = luaL_validpilot(L,1);
 
-   /* Push direction. */
+   /* Push temperature. */
+   pilot_heatSettle( p );
    lua_pushnumber( L, p->heat_T );
    return 1;
 }
@@ -2216,6 +2253,9 @@ static int pilotL_setPosition(lua_State *L)
 
    /* Warp pilot to new position. */
    p->solid->pos = *vec;
+   solid_savePrev( p->solid );
+   pilot_gridDirty();
+   pilot_ewCacheClear();
 
    /* Update if necessary. */
    if (pilot_isPlayer(p))
@@ -2814,14 +2854,15 @@ static int pilotL_outfitAdd(lua_State *L)
    NLUA_CHECKRW(L);
 
    /* Get parameters. */
-   p = luaL_validpilot(L, 1);
+   p = luaL_validpilotRaw(L, 1);
    o = luaL_validoutfit(L, 2);
    q = luaL_optinteger(L, 3, 1);
    bypass_cpu = lua_toboolean(L, 4);
    bypass_slot = lua_toboolean(L, 5);
 
-   /* Add outfit. */
+   /* Add outfit, recomputing the stats only once. */
    added = 0;
+   pilot_calcStatsBegin( p );
    for (i=0; i<array_size(p->outfits); i++) {
       /* Must still have to add outfit. */
       if (q <= 0)
@@ -2853,14 +2894,17 @@ static int pilotL_outfitAdd(lua_State *L)
       ret = pilot_addOutfitRaw(p, o, p->outfits[i]);
       pilot_calcStats( p );
 
-      /* Add ammo if needed. */
-      if ((ret==0) && (outfit_ammo(o) != NULL))
+      /* Add ammo if needed, the outfit may change the capacity. */
+      if ((ret==0) && (outfit_ammo(o) != NULL)) {
+         pilot_calcStatsFlush( p );
          pilot_addAmmo( p, p->outfits[i], outfit_ammo(o), pilot_maxAmmoO(p,o) );
+      }
 
       /* We added an outfit. */
       q--;
       added++;
    }
+   pilot_calcStatsEnd( p );
 
    /* Update the weapon sets. */
    if ((added > 0) && p->autoweap)
@@ -2906,7 +2950,7 @@ static int pilotL_outfitRm(lua_State *L)
 
    /* Get parameters. */
    removed = 0;
-   p = luaL_validpilot(L, 1);
+   p = luaL_validpilotRaw(L, 1);
    q = luaL_optinteger(L, 3, 1);
 
    if (lua_isstring(L,2)) {
@@ -2939,7 +2983,8 @@ static int pilotL_outfitRm(lua_State *L)
    if (!matched) {
       o = luaL_validoutfit(L,2);
 
-      /* Remove the outfit outfit. */
+      /* Remove the outfit outfit, recomputing the stats only once. */
+      pilot_calcStatsBegin( p );
       for (i=0; i<array_size(p->outfits); i++) {
          /* Must still need to remove. */
          if (q <= 0)
@@ -2967,6 +3012,7 @@ static int pilotL_outfitRm(lua_State *L)
             }
          }
       }
+      pilot_calcStatsEnd( p );
    }
 
    /* Update equipment window if operating on the player's pilot. */
@@ -3189,6 +3235,7 @@ static int pilotL_setTemp(lua_State *L)
    kelvins = MAX(kelvins, CONST_SPACE_STAR_TEMP);
 
    /* Handle pilot ship. */
+   pilot_heatSettle( p );
    p->heat_T = kelvins;
 
    /* Handle pilot outfits (maybe). */
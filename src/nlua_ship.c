@@ -558,7 +558,10 @@ static int shipL_price( lua_State *L )
 static int shipL_gfxTarget( lua_State *L )
 {
    const Ship *s = luaL_validship(L,1);
-   glTexture *tex = gl_dupTexture( s->gfx_target );
+   glTexture *tex;
+   /* Lua may use the texture data directly, so it has to be loaded. */
+   gl_texLoad( s->gfx_target );
+   tex = gl_dupTexture( s->gfx_target );
    if (tex == NULL) {
       WARN(_("Unable to get ship target graphic for '%s'."), s->name);
       return 0;
@@ -582,7 +585,10 @@ static int shipL_gfxTarget( lua_State *L )
 static int shipL_gfx( lua_State *L )
 {
    const Ship *s = luaL_validship(L,1);
-   glTexture *tex = gl_dupTexture( s->gfx_space );
+   glTexture *tex;
+   /* Lua may use the texture data directly, so it has to be loaded. */
+   gl_texLoad( s->gfx_space );
+   tex = gl_dupTexture( s->gfx_space );
    if (tex == NULL) {
       WARN(_("Unable to get ship graphic for '%s'."), s->name);
       return 0;
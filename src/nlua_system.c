@@ -726,6 +726,7 @@ static int systemL_asteroid( lua_State *L )
 static int systemL_asteroidPos( lua_State *L )
 {
    int field, ast;
+   Vector2d pos, vel;
 
    field = luaL_checkint(L,1);
    ast   = luaL_checkint(L,2);
@@ -740,8 +741,10 @@ static int systemL_asteroidPos( lua_State *L )
       return 0;
    }
 
-   lua_pushvector(L, cur_system->asteroids[field].asteroids[ast].pos);
-   lua_pushvector(L, cur_system->asteroids[field].asteroids[ast].vel);
+   asteroid_getPos( &cur_system->asteroids[field].asteroids[ast], &pos );
+   asteroid_getVel( &cur_system->asteroids[field].asteroids[ast], &vel );
+   lua_pushvector(L, pos);
+   lua_pushvector(L, vel);
    return 2;
 }
 
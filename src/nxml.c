@@ -13,10 +13,20 @@
 #include "naev.h"
 /** @endcond */
 
+#include "physfs.h"
+
 #include "nxml.h"
 
+#include "array.h"
 #include "ndata.h"
 #include "nstring.h"
+#include "threadpool.h"
+
+
+/*
+ * Prototypes.
+ */
+static int xml_parseFileWorker( void *data );
 
 
 /**
@@ -95,6 +105,163 @@ xmlDocPtr xml_parsePhysFS( const char* filename )
    return doc;
 }
 
+/**
+ * @brief Reads a file of a xml_parsePhysFSList() batch into its buffer.
+ *
+ * Like ndata_read(), but doesn't log so it can run on a worker thread. On
+ *  failure the reason is stored in the error of the XmlFile.
+ *
+ *    @param xf XmlFile to read.
+ *    @return 0 on success.
+ */
+static int xml_readFile( XmlFile *xf )
+{
+   PHYSFS_File *file;
+   PHYSFS_sint64 len, n, pos;
+
+   file = PHYSFS_openRead( xf->filename );
+   if (file == NULL) {
+      xf->error = PHYSFS_getErrorByCode( PHYSFS_getLastErrorCode() );
+      return -1;
+   }
+   len = PHYSFS_fileLength( file );
+   if (len == -1) {
+      xf->error = PHYSFS_getErrorByCode( PHYSFS_getLastErrorCode() );
+      PHYSFS_close( file );
+      return -1;
+   }
+   xf->buf = malloc( len+1 );
+   if (xf->buf == NULL) {
+      xf->error = PHYSFS_getErrorByCode( PHYSFS_ERR_OUT_OF_MEMORY );
+      PHYSFS_close( file );
+      return -1;
+   }
+   xf->buf[len] = '\0';
+
+   for (n=0; n<len; n+=pos) {
+      pos = PHYSFS_readBytes( file, &xf->buf[n], len-n );
+      if (pos <= 0) {
+         xf->error = PHYSFS_getErrorByCode( PHYSFS_getLastErrorCode() );
+         PHYSFS_close( file );
+         free( xf->buf );
+         xf->buf = NULL;
+         return -1;
+      }
+   }
+   PHYSFS_close( file );
+   xf->bufsize = len;
+   return 0;
+}
+
+
+/**
+ * @brief Reads and parses a single file of a xml_parsePhysFSList() batch.
+ *
+ * Runs on a worker thread, so it must not log or touch anything but its
+ *  own XmlFile.
+ *
+ *    @param data XmlFile to fill out.
+ *    @return 0 on success.
+ */
+static int xml_parseFileWorker( void *data )
+{
+   XmlFile *xf;
+   const char *start_pos, *pos;
+
+   xf = (XmlFile*) data;
+
+   if (xml_readFile( xf )) {
+      xf->status = XMLFILE_NOREAD;
+      return -1;
+   }
+
+   /* Whole file is XML. */
+   if (xf->header == NULL) {
+      xf->doc = xmlParseMemory( xf->buf, xf->bufsize );
+      free( xf->buf );
+      xf->buf = NULL;
+      xf->status = (xf->doc == NULL) ? XMLFILE_NOPARSE : XMLFILE_OK;
+      return (xf->status == XMLFILE_OK) ? 0 : -1;
+   }
+
+   /* Lua file with XML header, the Lua is kept for the caller. */
+   if (strnstr( xf->buf, xf->header, xf->bufsize ) == NULL) {
+      xf->status = XMLFILE_NOHEADER;
+      return 0;
+   }
+   start_pos = strnstr( xf->buf, "<?xml ", xf->bufsize );
+   pos = strnstr( xf->buf, "--]]", xf->bufsize );
+   if ((pos == NULL) || (start_pos == NULL)) {
+      xf->status = XMLFILE_BADHEADER;
+      return -1;
+   }
+   xf->doc = xmlParseMemory( start_pos, pos-start_pos );
+   xf->status = (xf->doc == NULL) ? XMLFILE_NOPARSE : XMLFILE_OK;
+   return (xf->status == XMLFILE_OK) ? 0 : -1;
+}
+
+
+/**
+ * @brief Reads and parses a list of files concurrently on the threadpool.
+ *
+ * Only reading and parsing is done in parallel; the results are returned
+ *  in the same order as the input so callers can process them on the
+ *  main thread deterministically. Nothing is logged for failed files;
+ *  callers are expected to check the status of each file and report
+ *  failures, with the error for files that couldn't be read.
+ *
+ *    @param files Array (array.h) of PhysicsFS paths to read.
+ *    @param header If non-NULL, files are Lua files with an XML header
+ *           ending with this closing tag (e.g. "</mission>"), and only
+ *           that header is parsed.
+ *    @return Array (array.h) of XmlFile matching files, must be freed
+ *            with xml_freeFileList().
+ */
+XmlFile* xml_parsePhysFSList( char **files, const char *header )
+{
+   int i;
+   XmlFile *list;
+   ThreadQueue *queue;
+
+   list = array_create_size( XmlFile, array_size(files) );
+   for (i=0; i<array_size(files); i++) {
+      XmlFile *xf = &array_grow( &list );
+      memset( xf, 0, sizeof(XmlFile) );
+      xf->filename = files[i];
+      xf->header = header;
+   }
+
+   /* vpool_wait() would never return for an empty queue. */
+   if (array_size(list) == 0)
+      return list;
+
+   /* Enqueue only once the list won't be reallocated anymore. */
+   queue = vpool_create();
+   for (i=0; i<array_size(list); i++)
+      vpool_enqueue( queue, xml_parseFileWorker, &list[i] );
+   vpool_wait( queue );
+
+   return list;
+}
+
+
+/**
+ * @brief Frees a list returned by xml_parsePhysFSList().
+ *
+ *    @param list List to free.
+ */
+void xml_freeFileList( XmlFile *list )
+{
+   int i;
+
+   for (i=0; i<array_size(list); i++) {
+      xmlFreeDoc( list[i].doc );
+      free( list[i].buf );
+   }
+   array_free( list );
+}
+
+
 int xmlw_saveTime( xmlTextWriterPtr writer, const char *name, time_t t )
 {
    xmlw_elem( writer, name, "%lu", t );
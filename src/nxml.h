@@ -148,10 +148,38 @@ do {if (xmlTextWriterEndDocument(w) < 0) { \
    ERR("xmlw: unable to end document"); return -1; } } while (0)
 
 
+/**
+ * @brief Status of a file read by xml_parsePhysFSList().
+ */
+typedef enum XmlFileStatus_ {
+   XMLFILE_OK, /**< File was read and parsed. */
+   XMLFILE_NOREAD, /**< File could not be read. */
+   XMLFILE_NOPARSE, /**< File was read but is not valid XML. */
+   XMLFILE_NOHEADER, /**< Lua file has no XML header at all. */
+   XMLFILE_BADHEADER, /**< Lua file has a malformed XML header. */
+} XmlFileStatus;
+
+
+/**
+ * @brief XML file read and parsed on the threadpool.
+ */
+typedef struct XmlFile_ {
+   const char *filename; /**< Path of the file (not owned). */
+   const char *header; /**< Closing tag of the XML header in a Lua file, or NULL if the whole file is XML. */
+   char *buf; /**< Contents of the file, only kept if header is set. */
+   size_t bufsize; /**< Size of buf. */
+   xmlDocPtr doc; /**< Parsed document, or NULL if status isn't XMLFILE_OK. */
+   XmlFileStatus status; /**< Result of reading the file. */
+   const char *error; /**< Why the file couldn't be read if status is XMLFILE_NOREAD. */
+} XmlFile;
+
+
 /*
  * Functions for generic complex reading.
  */
 xmlDocPtr xml_parsePhysFS( const char* filename );
+XmlFile* xml_parsePhysFSList( char **files, const char *header );
+void xml_freeFileList( XmlFile *list );
 glTexture* xml_parseTexture( xmlNodePtr node,
       const char *path, int defsx, int defsy,
       const unsigned int flags );
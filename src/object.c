@@ -447,6 +447,7 @@ static void object_renderMesh( const Object *object, int part, GLfloat alpha )
    glBindTexture(GL_TEXTURE_2D, material->map_Kd == NULL ? oneTexture->texture : material->map_Kd->texture);
 
    glDrawArrays(GL_TRIANGLES, 0, mesh->num_corners);
+   gl_screen.draw_calls++;
 }
 
 
@@ -469,6 +470,7 @@ void object_renderSolidPart( const Object *object, const Solid *solid, const cha
       return;
    */
 
+   gl_batchFlush();
    glUseProgram(shaders.material.program);
 
    projection = gl_view_matrix;
@@ -269,7 +269,8 @@ static int gl_createWindow( unsigned int flags )
 {
    int ret;
 
-   flags |= SDL_WINDOW_SHOWN | SDL_WINDOW_ALLOW_HIGHDPI;
+   flags |= SDL_WINDOW_ALLOW_HIGHDPI;
+   flags |= conf.headless ? SDL_WINDOW_HIDDEN : SDL_WINDOW_SHOWN;
    if (conf.resizable)
       flags |= SDL_WINDOW_RESIZABLE;
    if (conf.borderless)
@@ -536,6 +537,9 @@ void gl_viewport( int x, int y, int w, int h )
 {
    gl_Matrix4 proj;
 
+   /* Queued sprites use the old projection. */
+   gl_batchFlush();
+
    proj = gl_Matrix4_Ortho( 0., /* Left edge. */
             gl_screen.nw, /* Right edge. */
             0., /* Bottom edge. */
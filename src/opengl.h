@@ -70,6 +70,8 @@ typedef struct glInfo_ {
    GLuint current_fbo; /**< Current framebuffer. */
    GLuint fbo[2]; /**< Framebuffers. */
    GLuint fbo_tex[2]; /**< Texture for framebuffers. */
+   unsigned int draw_calls; /**< Draw calls issued in the current frame. */
+   unsigned int draw_calls_last; /**< Draw calls issued in the last frame. */
 } glInfo;
 extern glInfo gl_screen; /* local structure set with gl_init and co */
 
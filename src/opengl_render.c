@@ -27,6 +27,8 @@
 
 
 /** @cond */
+#include <stddef.h>
+
 #include "naev.h"
 /** @endcond */
 
@@ -42,6 +44,19 @@
 
 
 #define OPENGL_RENDER_VBO_SIZE      256 /**< Size of VBO. */
+#define OPENGL_BATCH_SIZE           1024 /**< Maximum sprites per batched draw. */
+
+
+/**
+ * @brief Vertex of a batched sprite.
+ */
+typedef struct glBatchVertex_ {
+   GLfloat x; /**< X position on the screen. */
+   GLfloat y; /**< Y position on the screen. */
+   GLfloat s; /**< X position within the texture. */
+   GLfloat t; /**< Y position within the texture. */
+   glColour c; /**< Colour to use. */
+} glBatchVertex;
 
 
 static gl_vbo *gl_renderVBO = 0; /**< VBO for rendering stuff. */
@@ -53,12 +68,23 @@ static gl_vbo *gl_triangleVBO = 0;
 static int gl_renderVBOtexOffset = 0; /**< VBO texture offset. */
 static int gl_renderVBOcolOffset = 0; /**< VBO colour offset. */
 
+static int gl_batchDepth = 0; /**< Nesting depth of gl_batchBegin(). */
+static GLuint gl_batchTex = 0; /**< Texture of the queued sprites. */
+static int gl_batchN = 0; /**< Number of queued sprites. */
+static glBatchVertex gl_batchVertex[6*OPENGL_BATCH_SIZE]; /**< Queued sprites. */
+static gl_vbo *gl_batchVBO = NULL; /**< VBO queued sprites are drawn from. */
+
 /*
  * prototypes
  */
+static void gl_batchSprite( const glTexture* texture,
+      double x, double y, double w, double h,
+      double tx, double ty, double tw, double th,
+      const glColour *c, double angle );
 
 void gl_beginSolidProgram(gl_Matrix4 projection, const glColour *c)
 {
+   gl_batchFlush();
    glUseProgram(shaders.solid.program);
    glEnableVertexAttribArray(shaders.solid.vertex);
    gl_uniformColor(shaders.solid.color, c);
@@ -75,6 +101,7 @@ void gl_endSolidProgram (void)
 
 void gl_beginSmoothProgram(gl_Matrix4 projection)
 {
+   gl_batchFlush();
    glUseProgram(shaders.smooth.program);
    glEnableVertexAttribArray(shaders.smooth.vertex);
    glEnableVertexAttribArray(shaders.smooth.vertex_color);
@@ -145,10 +172,12 @@ void gl_renderRectH( const gl_Matrix4 *H, const glColour *c, int filled )
    if (filled) {
       gl_vboActivateAttribOffset( gl_squareVBO, shaders.solid.vertex, 0, 2, GL_FLOAT, 0 );
       glDrawArrays( GL_TRIANGLE_STRIP, 0, 4 );
+      gl_screen.draw_calls++;
    }
    else {
       gl_vboActivateAttribOffset( gl_squareEmptyVBO, shaders.solid.vertex, 0, 2, GL_FLOAT, 0 );
       glDrawArrays( GL_LINE_STRIP, 0, 5 );
+      gl_screen.draw_calls++;
    }
    gl_endSolidProgram();
 }
@@ -164,6 +193,7 @@ void gl_renderRectH( const gl_Matrix4 *H, const glColour *c, int filled )
  */
 void gl_renderCross( double x, double y, double r, const glColour *c )
 {
+   gl_batchFlush();
    glUseProgram(shaders.crosshairs.program);
    glUniform1f(shaders.crosshairs.paramf, 2.);
    gl_renderShader(x, y, r, r, 0., &shaders.crosshairs, c, 1);
@@ -193,6 +223,7 @@ void gl_renderTriangleEmpty( double x, double y, double a, double s, double leng
    gl_beginSolidProgram(projection, c);
    gl_vboActivateAttribOffset( gl_triangleVBO, shaders.solid.vertex, 0, 2, GL_FLOAT, 0 );
    glDrawArrays( GL_LINE_STRIP, 0, 4 );
+   gl_screen.draw_calls++;
    gl_endSolidProgram();
 }
 
@@ -220,6 +251,18 @@ void gl_blitTexture(  const glTexture* texture,
 {
    gl_Matrix4 projection, tex_mat;
 
+   /* Lazy textures are drawn once loaded. */
+   if (texture->lazy != NULL) {
+      gl_texPrefetch( texture );
+      return;
+   }
+
+   /* Queue the sprite when batching. */
+   if (gl_batchDepth > 0) {
+      gl_batchSprite( texture, x, y, w, h, tx, ty, tw, th, c, angle );
+      return;
+   }
+
    glUseProgram(shaders.texture.program);
 
    /* Bind the texture. */
@@ -260,6 +303,7 @@ void gl_blitTexture(  const glTexture* texture,
 
    /* Draw. */
    glDrawArrays( GL_TRIANGLE_STRIP, 0, 4 );
+   gl_screen.draw_calls++;
 
    /* Clear state. */
    glDisableVertexAttribArray( shaders.texture.vertex );
@@ -314,6 +358,14 @@ void gl_blitTextureInterpolate(  const glTexture* ta,
 
    gl_Matrix4 projection, tex_mat;
 
+   /* Lazy textures are drawn once loaded. */
+   if ((ta->lazy != NULL) || (tb->lazy != NULL)) {
+      gl_texPrefetch( ta );
+      gl_texPrefetch( tb );
+      return;
+   }
+
+   gl_batchFlush();
    glUseProgram(shaders.texture_interpolate.program);
 
    /* Bind the textures. */
@@ -349,6 +401,7 @@ void gl_blitTextureInterpolate(  const glTexture* ta,
 
    /* Draw. */
    glDrawArrays( GL_TRIANGLE_STRIP, 0, 4 );
+   gl_screen.draw_calls++;
 
    /* Clear state. */
    glDisableVertexAttribArray( shaders.texture_interpolate.vertex );
@@ -360,6 +413,141 @@ void gl_blitTextureInterpolate(  const glTexture* ta,
 }
 
 
+/**
+ * @brief Queues a sprite to be drawn with the current batch.
+ *
+ * Takes the same parameters as gl_blitTexture().
+ */
+static void gl_batchSprite( const glTexture* texture,
+      double x, double y, double w, double h,
+      double tx, double ty, double tw, double th,
+      const glColour *c, double angle )
+{
+   static const int corners[6] = { 0, 1, 2, 1, 3, 2 };
+   glBatchVertex *v;
+   double px[4], py[4], ps[4], pt[4];
+   double hw, hh, ca, sa, dx, dy;
+   int i;
+
+   /* Sprites with a different texture start a new batch. */
+   if ((gl_batchN > 0) && ((texture->texture != gl_batchTex)
+            || (gl_batchN >= OPENGL_BATCH_SIZE)))
+      gl_batchFlush();
+   gl_batchTex = texture->texture;
+
+   if (c == NULL)
+      c = &cWhite;
+
+   /* Corners in the order (0,0), (1,0), (0,1), (1,1). */
+   if (angle == 0.) {
+      px[0] = px[2] = x;
+      px[1] = px[3] = x + w;
+      py[0] = py[1] = y;
+      py[2] = py[3] = y + h;
+   }
+   else {
+      hw = w / 2.;
+      hh = h / 2.;
+      ca = cos( angle );
+      sa = sin( angle );
+      for (i=0; i<4; i++) {
+         dx = (i & 1) ? hw : -hw;
+         dy = (i & 2) ? hh : -hh;
+         px[i] = x + hw + ca*dx - sa*dy;
+         py[i] = y + hh + sa*dx + ca*dy;
+      }
+   }
+   for (i=0; i<4; i++) {
+      ps[i] = tx + ((i & 1) ? tw : 0.);
+      pt[i] = ty + ((i & 2) ? th : 0.);
+      if (texture->flags & OPENGL_TEX_VFLIP)
+         pt[i] = 1. - pt[i];
+   }
+
+   v = &gl_batchVertex[ 6*gl_batchN ];
+   for (i=0; i<6; i++) {
+      v[i].x = px[ corners[i] ];
+      v[i].y = py[ corners[i] ];
+      v[i].s = ps[ corners[i] ];
+      v[i].t = pt[ corners[i] ];
+      v[i].c = *c;
+   }
+   gl_batchN++;
+}
+
+
+/**
+ * @brief Starts batching blits.
+ *
+ * Until the matching gl_batchEnd(), gl_blitTexture() and the functions
+ *  built on it queue their sprites, and consecutive sprites sharing a
+ *  texture are drawn together in a single draw call. Batches may be
+ *  nested.
+ *
+ * Drawing anything else while batching requires a gl_batchFlush() first
+ *  to keep the drawing order, which the other functions in this file do
+ *  themselves.
+ */
+void gl_batchBegin (void)
+{
+   gl_batchDepth++;
+}
+
+
+/**
+ * @brief Stops batching blits, drawing any queued sprites.
+ */
+void gl_batchEnd (void)
+{
+   gl_batchFlush();
+   gl_batchDepth--;
+}
+
+
+/**
+ * @brief Draws the queued sprites.
+ *
+ * The current shader program is kept.
+ */
+void gl_batchFlush (void)
+{
+   GLint program;
+
+   if (gl_batchN == 0)
+      return;
+
+   glGetIntegerv( GL_CURRENT_PROGRAM, &program );
+   glUseProgram(shaders.texture_batch.program);
+   glBindTexture(GL_TEXTURE_2D, gl_batchTex);
+
+   gl_vboData( gl_batchVBO, sizeof(glBatchVertex) * 6*gl_batchN,
+         gl_batchVertex );
+   glEnableVertexAttribArray( shaders.texture_batch.vertex );
+   glEnableVertexAttribArray( shaders.texture_batch.vertex_tex );
+   glEnableVertexAttribArray( shaders.texture_batch.vertex_color );
+   gl_vboActivateAttribOffset( gl_batchVBO, shaders.texture_batch.vertex,
+         offsetof(glBatchVertex, x), 2, GL_FLOAT, sizeof(glBatchVertex) );
+   gl_vboActivateAttribOffset( gl_batchVBO, shaders.texture_batch.vertex_tex,
+         offsetof(glBatchVertex, s), 2, GL_FLOAT, sizeof(glBatchVertex) );
+   gl_vboActivateAttribOffset( gl_batchVBO, shaders.texture_batch.vertex_color,
+         offsetof(glBatchVertex, c), 4, GL_FLOAT, sizeof(glBatchVertex) );
+   gl_Matrix4_Uniform(shaders.texture_batch.projection, gl_view_matrix);
+
+   /* Draw. */
+   glDrawArrays( GL_TRIANGLES, 0, 6*gl_batchN );
+   gl_screen.draw_calls++;
+
+   /* Clear state. */
+   glDisableVertexAttribArray( shaders.texture_batch.vertex );
+   glDisableVertexAttribArray( shaders.texture_batch.vertex_tex );
+   glDisableVertexAttribArray( shaders.texture_batch.vertex_color );
+   gl_checkErr();
+   glUseProgram( program );
+
+   gl_batchN = 0;
+}
+
+
 /**
  * @brief Converts in-game coordinates to screen coordinates.
  *
@@ -716,6 +904,7 @@ void gl_renderShader( double x, double y, double w, double h, double r, const Si
  */
 void gl_renderShaderH( const SimpleShader *shd, const gl_Matrix4 *H, const glColour *c, int center )
 {
+   gl_batchFlush();
    glEnableVertexAttribArray(shd->vertex);
    gl_vboActivateAttribOffset( center ? gl_circleVBO : gl_squareVBO, shd->vertex, 0, 2, GL_FLOAT, 0 );
 
@@ -725,6 +914,7 @@ void gl_renderShaderH( const SimpleShader *shd, const gl_Matrix4 *H, const glCol
    gl_Matrix4_Uniform(shd->projection, *H);
 
    glDrawArrays( GL_TRIANGLE_STRIP, 0, 4 );
+   gl_screen.draw_calls++;
 
    glDisableVertexAttribArray(shd->vertex);
    glUseProgram(0);
@@ -768,6 +958,7 @@ void gl_drawCircleH( const gl_Matrix4 *H, const glColour *c, int filled )
    // TODO handle shearing and different x/y scaling
    GLfloat r = H->m[0][0] / gl_view_matrix.m[0][0];
 
+   gl_batchFlush();
    glUseProgram( shaders.circle.program );
    glUniform2f( shaders.circle.dimensions, r, r );
    glUniform1i( shaders.circle.parami, filled );
@@ -814,6 +1005,7 @@ void gl_drawCirclePartialH( const gl_Matrix4 *H, const glColour *c, double angle
    GLfloat r = H->m[0][0] / gl_view_matrix.m[0][0];
 
    /* Draw. */
+   gl_batchFlush();
    glUseProgram( shaders.circle_partial.program );
 
    glEnableVertexAttribArray( shaders.circle_partial.vertex );
@@ -829,6 +1021,7 @@ void gl_drawCirclePartialH( const gl_Matrix4 *H, const glColour *c, double angle
 
    /* Draw. */
    glDrawArrays( GL_TRIANGLE_STRIP, 0, 4 );
+   gl_screen.draw_calls++;
 
    /* Clear state. */
    glDisableVertexAttribArray( shaders.circle_partial.vertex );
@@ -855,6 +1048,7 @@ void gl_drawLine( const double x1, const double y1,
    a = atan2( y2-y1, x2-x1 );
    s = sqrt( (x2-x1)*(x2-x1) + (y2-y1)*(y2-y1) );
 
+   gl_batchFlush();
    glUseProgram(shaders.sdfsolid.program);
    glUniform1f(shaders.sdfsolid.paramf, 1.); /* No outline. */
    gl_renderShader( (x1+x2)/2., (y1+y2)/2., s/2.+0.5, 1.0, a, &shaders.sdfsolid, c, 1 );
@@ -876,6 +1070,7 @@ void gl_clipRect( int x, int y, int w, int h )
    ry = (y + gl_screen.y) / gl_screen.myscale;
    rw = w / gl_screen.mxscale;
    rh = h / gl_screen.myscale;
+   gl_batchFlush();
    glScissor( rx, ry, rw, rh );
    glEnable( GL_SCISSOR_TEST );
 }
@@ -887,6 +1082,7 @@ void gl_clipRect( int x, int y, int w, int h )
 void gl_unclipRect (void)
 {
    glDisable( GL_SCISSOR_TEST );
+   gl_batchFlush();
    glScissor( 0, 0, gl_screen.rw, gl_screen.rh );
 }
 
@@ -905,6 +1101,7 @@ int gl_initRender (void)
          OPENGL_RENDER_VBO_SIZE*(2 + 2 + 4), NULL );
    gl_renderVBOtexOffset = sizeof(GLfloat) * OPENGL_RENDER_VBO_SIZE*2;
    gl_renderVBOcolOffset = sizeof(GLfloat) * OPENGL_RENDER_VBO_SIZE*(2+2);
+   gl_batchVBO = gl_vboCreateStream( sizeof(gl_batchVertex), NULL );
 
    vertex[0] = 0.;
    vertex[1] = 0.;
@@ -972,5 +1169,7 @@ void gl_exitRender (void)
    gl_vboDestroy( gl_squareEmptyVBO );
    gl_vboDestroy( gl_lineVBO );
    gl_vboDestroy( gl_triangleVBO );
+   gl_vboDestroy( gl_batchVBO );
    gl_renderVBO = NULL;
+   gl_batchVBO = NULL;
 }
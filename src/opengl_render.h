@@ -31,6 +31,10 @@ void gl_screenToGameCoords( double *nx, double *ny, int bx, int by );
 /*
  * Rendering.
  */
+/* batching */
+void gl_batchBegin (void);
+void gl_batchEnd (void);
+void gl_batchFlush (void);
 /* blits texture */
 void gl_blitTexture(  const glTexture* texture,
       const double x, const double y,
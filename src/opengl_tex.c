@@ -26,18 +26,31 @@
 #include "nfile.h"
 #include "nstring.h"
 #include "opengl.h"
+#include "threadpool.h"
+
+
+#define OPENGL_TEX_UPLOAD_BUDGET 0.002 /**< Time in seconds to spend uploading prefetched textures per frame. */
+#define OPENGL_TEX_HASH_MIN   256 /**< Minimum number of buckets of the texture hash map. */
 
 
 /*
  * graphic list
  */
 /**
- * @brief Represents a node in the texture list.
+ * @brief Represents a node in the texture hash map.
+ *
+ * Textures loaded from files that aren't used anymore are kept around in a
+ *  least recently used list as long as they fit in the texture cache
+ *  budget.
  */
 typedef struct glTexList_ {
-   struct glTexList_ *next; /**< Next in linked list */
+   struct glTexList_ *next; /**< Next in the hash bucket */
+   struct glTexList_ *lru_prev; /**< Previous (less recently used) unused texture. */
+   struct glTexList_ *lru_next; /**< Next (more recently used) unused texture. */
    glTexture *tex; /**< associated texture */
+   uint32_t hash; /**< Hash of the texture name. */
    int used; /**< counts how many times texture is being used */
+   int cache; /**< Whether it may be kept once unused, only if it can be loaded again by name. */
    /* TODO We currently treat images with different number of sprites as
     * different images, i.e., they get reloaded and use more memory. However,
     * it should be possible to do something fancier and share the texture to
@@ -45,7 +58,31 @@ typedef struct glTexList_ {
    int sx; /**< X sprites */
    int sy; /**< Y sprites */
 } glTexList;
-static glTexList* texture_list = NULL; /**< Texture list. */
+static glTexList **texture_hash = NULL; /**< Buckets of the texture hash map. */
+static uint32_t texture_nbuckets = 0; /**< Number of buckets, a power of two. */
+static uint32_t texture_count = 0; /**< Number of textures in the hash map. */
+static glTexList *texture_lru_first = NULL; /**< Least recently used unused texture. */
+static glTexList *texture_lru_last = NULL; /**< Most recently used unused texture. */
+static size_t texture_lru_mem = 0; /**< Memory used by the unused textures. */
+
+
+/**
+ * @brief Pending load of a lazily loaded texture.
+ *
+ * Once queued, the worker thread owns surface and trans until it posts
+ *  done.
+ */
+typedef struct glTexLazy_ {
+   glTexture *tex; /**< Texture to load into. */
+   char *path; /**< Path of the image to load. */
+   glTexFilter filter; /**< Creates the surface from the image, may be NULL. */
+   void *data; /**< Data for the filter. */
+   SDL_sem *done; /**< Posted when decoded, NULL if not queued. */
+   SDL_Surface *surface; /**< Decoded surface, NULL on failure. */
+   uint8_t *trans; /**< Transparency map if requested. */
+   char digest[33]; /**< Digest to cache the transparency map by, empty to not cache it. */
+} glTexLazy;
+static glTexLazy **lazy_queue = NULL; /**< Array (array.h): Loads queued on the threadpool. */
 
 
 /*
@@ -55,14 +92,35 @@ static glTexList* texture_list = NULL; /**< Texture list. */
 static int SDL_IsTrans( SDL_Surface* s, int x, int y );
 static uint8_t* SDL_MapTrans( SDL_Surface* s, int w, int h );
 static size_t gl_transSize( const int w, const int h );
+static int gl_transDigest( SDL_RWops *rw, char digest[33] );
+static uint8_t* gl_transCacheRead( const char *digest, int w, int h );
+static void gl_transCacheWrite( const char *digest, const uint8_t *trans, int w, int h );
+static uint8_t* gl_loadTrans( SDL_Surface *surface, SDL_RWops *rw,
+      int w, int h );
+static int gl_imageSize( SDL_RWops *rw, int *w, int *h );
 /* glTexture */
 static GLuint gl_texParameters( unsigned int flags );
 static GLuint gl_loadSurface( SDL_Surface* surface, unsigned int flags, int freesur );
 static glTexture* gl_loadNewImage( const char* path, unsigned int flags );
 static glTexture* gl_loadNewImageRWops( const char *path, SDL_RWops *rw, unsigned int flags );
+/* Lazy loading. */
+static int gl_lazyDecode( void *data );
+static void gl_lazyWait( glTexLazy *lazy );
+static void gl_lazyUpload( glTexLazy *lazy );
+static void gl_lazyFree( glTexLazy *lazy );
 /* List. */
-static glTexture* gl_texExists( const char* path, int sx, int sy );
-static int gl_texAdd( glTexture *tex, int sx, int sy );
+static uint32_t gl_texHash( const char *name );
+static glTexList* gl_texFind( const glTexture *tex );
+static void gl_texRehash( uint32_t nbuckets );
+static glTexture* gl_texExists( const char* path, int sx, int sy,
+      unsigned int flags );
+static int gl_texAdd( glTexture *tex, int sx, int sy, int cache );
+static void gl_texSetSprites( glTexture *tex, int sx, int sy );
+static size_t gl_texMemory( const glTexture *tex );
+static void gl_texDestroy( glTexture *tex );
+static void gl_texRemove( glTexList *node );
+static void gl_lruRemove( glTexList *node );
+static void gl_lruEvict( size_t budget );
 
 
 /**
@@ -120,7 +178,7 @@ static int SDL_IsTrans( SDL_Surface* s, int x, int y )
  *    @param s Surface to map it's transparency.
  *    @param w Width to map.
  *    @param h Height to map.
- *    @return 0 on success.
+ *    @return The transparency map or NULL if out of memory.
  */
 static uint8_t* SDL_MapTrans( SDL_Surface* s, int w, int h )
 {
@@ -137,10 +195,8 @@ static uint8_t* SDL_MapTrans( SDL_Surface* s, int w, int h )
    /* alloc memory for just enough bits to hold all the data we need */
    size = gl_transSize(w, h);
    t = malloc(size);
-   if (t==NULL) {
-      WARN(_("Out of Memory"));
+   if (t==NULL)
       return NULL;
-   }
    memset(t, 0, size); /* important, must be set to zero */
 
    /* Check each pixel individually. */
@@ -166,6 +222,56 @@ static size_t gl_transSize( const int w, const int h )
 }
 
 
+/**
+ * @brief Reads the size of an image from its header without decoding it.
+ *
+ * Only PNG and WebP images are supported.
+ *
+ *    @param rw RWops positioned at the start of the image.
+ *    @param[out] w Width of the image.
+ *    @param[out] h Height of the image.
+ *    @return 0 on success.
+ */
+static int gl_imageSize( SDL_RWops *rw, int *w, int *h )
+{
+   uint8_t b[30];
+   uint32_t bits;
+
+   if (SDL_RWread( rw, b, sizeof(b), 1 ) != 1)
+      return -1;
+
+   /* PNG: the IHDR chunk always comes right after the signature. */
+   if ((memcmp( b, "\x89PNG\r\n\x1a\n", 8 ) == 0)
+         && (memcmp( &b[12], "IHDR", 4 ) == 0)) {
+      *w = (b[16]<<24) | (b[17]<<16) | (b[18]<<8) | b[19];
+      *h = (b[20]<<24) | (b[21]<<16) | (b[22]<<8) | b[23];
+      return 0;
+   }
+
+   /* WebP: RIFF container where the first chunk holds the size. */
+   if ((memcmp( b, "RIFF", 4 ) != 0) || (memcmp( &b[8], "WEBP", 4 ) != 0))
+      return -1;
+   if (memcmp( &b[12], "VP8X", 4 ) == 0) {
+      *w = 1 + (b[24] | (b[25]<<8) | (b[26]<<16));
+      *h = 1 + (b[27] | (b[28]<<8) | (b[29]<<16));
+      return 0;
+   }
+   if ((memcmp( &b[12], "VP8L", 4 ) == 0) && (b[20] == 0x2f)) {
+      bits = b[21] | (b[22]<<8) | (b[23]<<16) | ((uint32_t)b[24]<<24);
+      *w = 1 + (bits & 0x3fff);
+      *h = 1 + ((bits >> 14) & 0x3fff);
+      return 0;
+   }
+   if ((memcmp( &b[12], "VP8 ", 4 ) == 0)
+         && (b[23] == 0x9d) && (b[24] == 0x01) && (b[25] == 0x2a)) {
+      *w = (b[26] | (b[27]<<8)) & 0x3fff;
+      *h = (b[28] | (b[29]<<8)) & 0x3fff;
+      return 0;
+   }
+   return -1;
+}
+
+
 /**
  * @brief Sets default texture parameters.
  */
@@ -271,10 +377,11 @@ glTexture* gl_loadImageData( float *data, int w, int h, int sx, int sy, const ch
    texture->srw   = texture->sw / texture->w;
    texture->srh   = texture->sh / texture->h;
 
-   /* Add to list. */
+   /* Add to list. Data textures and render targets can't be looked up
+    * again, so they aren't cached. */
    if (name != NULL) {
       texture->name = strdup(name);
-      gl_texAdd( texture, sx, sy );
+      gl_texAdd( texture, sx, sy, 0 );
    }
 
    return texture;
@@ -327,6 +434,136 @@ static GLuint gl_loadSurface( SDL_Surface* surface, unsigned int flags, int free
 }
 
 
+/**
+ * @brief Hashes the image file a transparency map is cached by.
+ *
+ * Doesn't log so it can run on the threadpool.
+ *
+ *    @param rw RWops containing data to hash.
+ *    @param[out] digest Hex digest of the data.
+ *    @return 0 on success.
+ */
+static int gl_transDigest( SDL_RWops *rw, char digest[33] )
+{
+   size_t i, pngsize;
+   char *data;
+   md5_state_t md5;
+   md5_byte_t md5val[16];
+
+   pngsize = SDL_RWseek( rw, 0, SEEK_END );
+   SDL_RWseek( rw, 0, SEEK_SET );
+
+   data = malloc(pngsize);
+   if (data == NULL)
+      return -1;
+   SDL_RWread( rw, data, pngsize, 1 );
+   md5_init( &md5 );
+   md5_append( &md5, (md5_byte_t*)data, pngsize );
+   md5_finish( &md5, md5val );
+   free(data);
+
+   for (i=0; i<16; i++)
+      snprintf( &digest[i * 2], 3, "%02x", md5val[i] );
+   return 0;
+}
+
+
+/**
+ * @brief Reads a cached transparency map.
+ *
+ *    @param digest Digest of the image file.
+ *    @param w Width of the map.
+ *    @param h Height of the map.
+ *    @return The transparency map or NULL if it isn't cached.
+ */
+static uint8_t* gl_transCacheRead( const char *digest, int w, int h )
+{
+   size_t filesize;
+   uint8_t *trans;
+   char cachefile[PATH_MAX];
+
+   snprintf( cachefile, sizeof(cachefile), "%scollisions/%s",
+         nfile_cachePath(), digest );
+   if (!nfile_fileExists(cachefile))
+      return NULL;
+
+   trans = (uint8_t*)nfile_readFile( &filesize, cachefile );
+   /* Consider cached data invalid if the length doesn't match. */
+   if ((trans != NULL) && (gl_transSize(w, h) != filesize)) {
+      free(trans);
+      trans = NULL;
+   }
+   return trans;
+}
+
+
+/**
+ * @brief Caches a transparency map unless it already is.
+ *
+ *    @param digest Digest of the image file.
+ *    @param trans Transparency map to cache.
+ *    @param w Width of the map.
+ *    @param h Height of the map.
+ */
+static void gl_transCacheWrite( const char *digest, const uint8_t *trans, int w, int h )
+{
+   char dirpath[PATH_MAX], cachefile[PATH_MAX];
+
+   snprintf( dirpath, sizeof(dirpath), "%s/%s", nfile_cachePath(), "collisions/" );
+   snprintf( cachefile, sizeof(cachefile), "%scollisions/%s",
+         nfile_cachePath(), digest );
+   if (nfile_fileExists(cachefile))
+      return;
+   nfile_dirMakeExist( dirpath );
+   nfile_writeFile( (const char*)trans, gl_transSize(w, h), cachefile );
+}
+
+
+/**
+ * @brief Gets the transparency map of a surface.
+ *
+ * Maps are cached by the hash of the image file they were made from, since
+ *  generating them is slow for big images.
+ *
+ *    @param surface Surface to map.
+ *    @param rw RWops containing data to hash, or NULL to skip the cache.
+ *    @param w Width to map.
+ *    @param h Height to map.
+ *    @return The transparency map.
+ */
+static uint8_t* gl_loadTrans( SDL_Surface *surface, SDL_RWops *rw,
+      int w, int h )
+{
+   uint8_t *trans;
+   char digest[33];
+   int cache;
+
+   trans = NULL;
+   cache = 0;
+   if (rw != NULL) {
+      if (gl_transDigest( rw, digest ))
+         WARN(_("Out of Memory"));
+      else {
+         cache = 1;
+         /* Attempt to find a cached transparency map. */
+         trans = gl_transCacheRead( digest, w, h );
+         if (trans != NULL)
+            return trans;
+      }
+   }
+
+   SDL_LockSurface(surface);
+   trans = SDL_MapTrans( surface, w, h );
+   SDL_UnlockSurface(surface);
+   if (trans == NULL)
+      WARN(_("Out of Memory"));
+   else if (cache)
+      gl_transCacheWrite( digest, trans, w, h );
+
+   return trans;
+}
+
+
 /**
  * @brief Wrapper for gl_loadImagePad that includes transparency mapping.
  *
@@ -345,16 +582,10 @@ glTexture* gl_loadImagePadTrans( const char *name, SDL_Surface* surface, SDL_RWo
       unsigned int flags, int w, int h, int sx, int sy, int freesur )
 {
    glTexture *texture;
-   size_t i, filesize;
-   size_t cachesize, pngsize;
    uint8_t *trans;
-   char *cachefile, *data;
-   char digest[33];
-   md5_state_t md5;
-   md5_byte_t *md5val;
 
    if ((name != NULL) && !(flags & OPENGL_TEX_SKIPCACHE)) {
-      texture = gl_texExists( name, sx, sy );
+      texture = gl_texExists( name, sx, sy, flags );
       if (texture != NULL) {
          if (freesur)
             SDL_FreeSurface( surface );
@@ -365,73 +596,13 @@ glTexture* gl_loadImagePadTrans( const char *name, SDL_Surface* surface, SDL_RWo
    if (flags & OPENGL_TEX_MAPTRANS)
       flags ^= OPENGL_TEX_MAPTRANS;
 
-   /* Appropriate size for the transparency map, see SDL_MapTrans */
-   cachesize = gl_transSize(w, h);
-
-   cachefile = NULL;
-   trans     = NULL;
-
-   if (rw != NULL) {
-      md5val = malloc(16);
-      md5_init(&md5);
-
-      pngsize = SDL_RWseek( rw, 0, SEEK_END );
-      SDL_RWseek( rw, 0, SEEK_SET );
-
-      data = malloc(pngsize);
-      if (data == NULL)
-         WARN(_("Out of Memory"));
-      else {
-         SDL_RWread( rw, data, pngsize, 1 );
-         md5_append( &md5, (md5_byte_t*)data, pngsize );
-         free(data);
-      }
-      md5_finish( &md5, md5val );
-
-      for (i=0; i<16; i++)
-         snprintf( &digest[i * 2], 3, "%02x", md5val[i] );
-      free(md5val);
-
-      asprintf( &cachefile, "%scollisions/%s",
-         nfile_cachePath(), digest );
-
-      /* Attempt to find a cached transparency map. */
-      if (nfile_fileExists(cachefile)) {
-         trans = (uint8_t*)nfile_readFile( &filesize, cachefile );
-
-         /* Consider cached data invalid if the length doesn't match. */
-         if (trans != NULL && cachesize != (unsigned int)filesize) {
-            free(trans);
-            trans = NULL;
-         }
-         /* Cached data matches, no need to overwrite. */
-         else {
-            free(cachefile);
-            cachefile = NULL;
-         }
-      }
-   }
-   else {
-      /* We could hash raw pixel data here, but that's slower than just
-       * generating the map from scratch.
-       */
+   /* We could hash raw pixel data here, but that's slower than just
+    * generating the map from scratch.
+    */
+   if (rw == NULL)
       WARN(_("Texture '%s' has no RWops"), name);
-   }
 
-   if (trans == NULL) {
-      SDL_LockSurface(surface);
-      trans = SDL_MapTrans( surface, w, h );
-      SDL_UnlockSurface(surface);
-
-      if (cachefile != NULL) {
-         /* Cache newly-generated transparency map. */
-         char dirpath[PATH_MAX];
-         snprintf( dirpath, sizeof(dirpath), "%s/%s", nfile_cachePath(), "collisions/" );
-         nfile_dirMakeExist( dirpath );
-         nfile_writeFile( (char*)trans, cachesize, cachefile );
-         free(cachefile);
-      }
-   }
+   trans = gl_loadTrans( surface, rw, w, h );
 
    texture = gl_loadImagePad( name, surface, flags, w, h, sx, sy, freesur );
    texture->trans = trans;
@@ -459,7 +630,7 @@ glTexture* gl_loadImagePad( const char *name, SDL_Surface* surface,
 
    /* Make sure doesn't already exist. */
    if ((name != NULL) && !(flags & OPENGL_TEX_SKIPCACHE)) {
-      texture = gl_texExists( name, sx, sy );
+      texture = gl_texExists( name, sx, sy, flags );
       if (texture != NULL)
          return texture;
    }
@@ -486,7 +657,7 @@ glTexture* gl_loadImagePad( const char *name, SDL_Surface* surface,
 
    if (name != NULL) {
       texture->name = strdup(name);
-      gl_texAdd( texture, sx, sy );
+      gl_texAdd( texture, sx, sy, 1 );
    }
    else
       texture->name = NULL;
@@ -508,30 +679,99 @@ glTexture* gl_loadImage( SDL_Surface* surface, unsigned int flags )
 }
 
 
+/**
+ * @brief Hashes a texture name (FNV-1a).
+ */
+static uint32_t gl_texHash( const char *name )
+{
+   uint32_t h = 2166136261u;
+   for (; *name != '\0'; name++) {
+      h ^= (unsigned char) *name;
+      h *= 16777619u;
+   }
+   return h;
+}
+
+
+/**
+ * @brief Finds the hash map node of a texture.
+ *
+ *    @param tex Texture to find.
+ *    @return The node, or NULL if the texture isn't in the hash map.
+ */
+static glTexList* gl_texFind( const glTexture *tex )
+{
+   glTexList *cur;
+
+   if ((tex->name == NULL) || (texture_nbuckets == 0))
+      return NULL;
+
+   cur = texture_hash[ gl_texHash( tex->name ) & (texture_nbuckets-1) ];
+   for (; cur!=NULL; cur=cur->next)
+      if (cur->tex == tex)
+         return cur;
+   return NULL;
+}
+
+
+/**
+ * @brief Resizes the texture hash map.
+ *
+ *    @param nbuckets New number of buckets, must be a power of two.
+ */
+static void gl_texRehash( uint32_t nbuckets )
+{
+   uint32_t i;
+   glTexList **buckets, *cur, *next;
+
+   buckets = calloc( nbuckets, sizeof(glTexList*) );
+   for (i=0; i<texture_nbuckets; i++) {
+      for (cur=texture_hash[i]; cur!=NULL; cur=next) {
+         next = cur->next;
+         cur->next = buckets[ cur->hash & (nbuckets-1) ];
+         buckets[ cur->hash & (nbuckets-1) ] = cur;
+      }
+   }
+   free( texture_hash );
+   texture_hash = buckets;
+   texture_nbuckets = nbuckets;
+}
+
+
 /**
  * @brief Check to see if a texture matching a path already exists.
  *
+ * A lazy texture that is found gets loaded unless flags allow it to stay
+ *  lazy.
+ *
  *    @param path Path to the texture.
  *    @param sx X sprites.
  *    @param sy Y sprites.
+ *    @param flags Flags the texture is wanted with.
  *    @return The texture, or NULL if none was found.
  */
-static glTexture* gl_texExists( const char* path, int sx, int sy )
+static glTexture* gl_texExists( const char* path, int sx, int sy,
+      unsigned int flags )
 {
    glTexList *cur;
+   uint32_t hash;
 
    /* Null does never exist. */
-   if (path==NULL)
+   if ((path==NULL) || (texture_nbuckets == 0))
       return NULL;
 
    /* check to see if it already exists */
-   if (texture_list != NULL) {
-      for (cur=texture_list; cur!=NULL; cur=cur->next) {
-         if ((strcmp(path,cur->tex->name)==0) &&
-               (cur->sx==sx) && (cur->sy==sy)) {
-            cur->used += 1;
-            return cur->tex;
-         }
+   hash = gl_texHash( path );
+   for (cur=texture_hash[hash & (texture_nbuckets-1)]; cur!=NULL; cur=cur->next) {
+      if ((cur->hash==hash) && (cur->sx==sx) && (cur->sy==sy)
+            && (strcmp(path,cur->tex->name)==0)) {
+         /* Bring it back from the cache of unused textures. */
+         if (cur->used <= 0)
+            gl_lruRemove( cur );
+         cur->used += 1;
+         if (!(flags & OPENGL_TEX_LAZY))
+            gl_texLoad( cur->tex );
+         return cur->tex;
       }
    }
 
@@ -540,30 +780,140 @@ static glTexture* gl_texExists( const char* path, int sx, int sy )
 
 
 /**
- * @brief Adds a texture to the list under the name of path.
+ * @brief Adds a texture to the hash map under the name of path.
+ *
+ *    @param tex Texture to add.
+ *    @param sx X sprites.
+ *    @param sy Y sprites.
+ *    @param cache Whether to keep the texture in the cache once unused.
  */
-static int gl_texAdd( glTexture *tex, int sx, int sy )
+static int gl_texAdd( glTexture *tex, int sx, int sy, int cache )
 {
-   glTexList *new, *last = texture_list;
+   glTexList *new;
+   uint32_t b;
+
+   if (texture_count >= texture_nbuckets)
+      gl_texRehash( MAX( OPENGL_TEX_HASH_MIN, 2*texture_nbuckets ) );
 
    /* Create the new node */
-   new = malloc( sizeof(glTexList) );
-   new->next = NULL;
+   new = calloc( 1, sizeof(glTexList) );
    new->used = 1;
    new->tex  = tex;
+   new->hash = gl_texHash( tex->name );
    new->sx   = sx;
    new->sy   = sy;
+   new->cache = cache;
+
+   b = new->hash & (texture_nbuckets-1);
+   new->next = texture_hash[b];
+   texture_hash[b] = new;
+   texture_count++;
+
+   return 0;
+}
 
-   if (texture_list == NULL) /* special condition - creating new list */
-      texture_list = new;
-   else {
-      while (last->next != NULL)
-         last = last->next;
 
-      last->next = new;
+/**
+ * @brief Changes the number of sprites a texture is cached under.
+ */
+static void gl_texSetSprites( glTexture *tex, int sx, int sy )
+{
+   glTexList *node = gl_texFind( tex );
+   if (node == NULL)
+      return;
+   node->sx = sx;
+   node->sy = sy;
+}
+
+
+/**
+ * @brief Estimates the video memory used by a texture.
+ *
+ *    @param tex Texture to get memory of.
+ *    @return Memory used in bytes (0 if not loaded).
+ */
+static size_t gl_texMemory( const glTexture *tex )
+{
+   size_t mem;
+
+   if (tex->texture == 0)
+      return 0;
+
+   /* All textures are stored with 8-bit RGBA, mipmaps add a third. */
+   mem = (size_t)tex->w * (size_t)tex->h * 4;
+   if (tex->flags & OPENGL_TEX_MIPMAPS)
+      mem += mem / 3;
+   return mem;
+}
+
+
+/**
+ * @brief Frees the data of a texture.
+ */
+static void gl_texDestroy( glTexture *tex )
+{
+   gl_lazyFree( tex->lazy );
+   glDeleteTextures( 1, &tex->texture );
+   free(tex->trans);
+   free(tex->name);
+   free(tex);
+}
+
+
+/**
+ * @brief Removes a node from the hash map and frees it and its texture.
+ */
+static void gl_texRemove( glTexList *node )
+{
+   glTexList **cur;
+
+   for (cur=&texture_hash[node->hash & (texture_nbuckets-1)]; *cur!=NULL;
+         cur=&(*cur)->next) {
+      if (*cur == node) {
+         *cur = node->next;
+         break;
+      }
    }
+   texture_count--;
 
-   return 0;
+   gl_texDestroy( node->tex );
+   free( node );
+}
+
+
+/**
+ * @brief Removes an unused texture from the least recently used list.
+ */
+static void gl_lruRemove( glTexList *node )
+{
+   if (node->lru_prev != NULL)
+      node->lru_prev->lru_next = node->lru_next;
+   else
+      texture_lru_first = node->lru_next;
+   if (node->lru_next != NULL)
+      node->lru_next->lru_prev = node->lru_prev;
+   else
+      texture_lru_last = node->lru_prev;
+   node->lru_prev = NULL;
+   node->lru_next = NULL;
+   texture_lru_mem -= gl_texMemory( node->tex );
+}
+
+
+/**
+ * @brief Frees least recently used unused textures until they fit a budget.
+ *
+ *    @param budget Memory in bytes unused textures may use.
+ */
+static void gl_lruEvict( size_t budget )
+{
+   glTexList *node;
+
+   while ((texture_lru_first != NULL) && (texture_lru_mem > budget)) {
+      node = texture_lru_first;
+      gl_lruRemove( node );
+      gl_texRemove( node );
+   }
 }
 
 
@@ -582,7 +932,7 @@ glTexture* gl_newImage( const char* path, const unsigned int flags )
 
    /* Check if it already exists. */
    if (!(flags & OPENGL_TEX_SKIPCACHE)) {
-      t = gl_texExists( path, 1, 1 );
+      t = gl_texExists( path, 1, 1, flags );
       if (t != NULL)
          return t;
    }
@@ -610,7 +960,7 @@ glTexture* gl_newImageRWops( const char* path, SDL_RWops *rw, const unsigned int
 
    /* Check if it already exists. */
    if (!(flags & OPENGL_TEX_SKIPCACHE)) {
-      t = gl_texExists( path, 1, 1 );
+      t = gl_texExists( path, 1, 1, flags );
       if (t != NULL)
          return t;
    }
@@ -631,6 +981,7 @@ static glTexture* gl_loadNewImage( const char* path, const unsigned int flags )
 {
    glTexture *texture;
    SDL_RWops *rw;
+   int w, h;
 
    if (path==NULL) {
       WARN(_("Trying to load image from NULL path."));
@@ -644,7 +995,17 @@ static glTexture* gl_loadNewImage( const char* path, const unsigned int flags )
       return NULL;
    }
 
-   texture = gl_loadNewImageRWops( path, rw, flags );
+   /* Lazy textures only need the size for now. */
+   if (flags & OPENGL_TEX_LAZY) {
+      if (gl_imageSize( rw, &w, &h ) == 0) {
+         SDL_RWclose( rw );
+         return gl_newLazy( path, path, w, h, 1, 1,
+               flags | OPENGL_TEX_VFLIP | OPENGL_TEX_SKIPCACHE, NULL, NULL );
+      }
+      SDL_RWseek( rw, 0, RW_SEEK_SET );
+   }
+
+   texture = gl_loadNewImageRWops( path, rw, flags & ~OPENGL_TEX_LAZY );
 
    SDL_RWclose( rw );
    return texture;
@@ -705,7 +1066,7 @@ glTexture* gl_newSprite( const char* path, const int sx, const int sy,
 
    /* Check if it already exists. */
    if (!(flags & OPENGL_TEX_SKIPCACHE)) {
-      texture = gl_texExists( path, sx, sy );
+      texture = gl_texExists( path, sx, sy, flags );
       if (texture != NULL)
          return texture;
    }
@@ -715,14 +1076,14 @@ glTexture* gl_newSprite( const char* path, const int sx, const int sy,
    if (texture == NULL)
       return NULL;
 
-   /* will possibly overwrite an existing textur properties
-    * so we have to load same texture always the same sprites */
+   /* Fresh texture, so it's only used here. */
    texture->sx    = (double) sx;
    texture->sy    = (double) sy;
    texture->sw    = texture->w / texture->sx;
    texture->sh    = texture->h / texture->sy;
    texture->srw   = texture->sw / texture->w;
    texture->srh   = texture->sh / texture->h;
+   gl_texSetSprites( texture, sx, sy );
    return texture;
 }
 
@@ -744,7 +1105,7 @@ glTexture* gl_newSpriteRWops( const char* path, SDL_RWops *rw,
 
    /* Check if it already exists. */
    if (!(flags & OPENGL_TEX_SKIPCACHE)) {
-      texture = gl_texExists( path, sx, sy );
+      texture = gl_texExists( path, sx, sy, flags );
       if (texture != NULL)
          return texture;
    }
@@ -754,14 +1115,14 @@ glTexture* gl_newSpriteRWops( const char* path, SDL_RWops *rw,
    if (texture == NULL)
       return NULL;
 
-   /* will possibly overwrite an existing textur properties
-    * so we have to load same texture always the same sprites */
+   /* Fresh texture, so it's only used here. */
    texture->sx    = (double) sx;
    texture->sy    = (double) sy;
    texture->sw    = texture->w / texture->sx;
    texture->sh    = texture->h / texture->sy;
    texture->srw   = texture->sw / texture->w;
    texture->srh   = texture->sh / texture->h;
+   gl_texSetSprites( texture, sx, sy );
    return texture;
 }
 
@@ -769,41 +1130,45 @@ glTexture* gl_newSpriteRWops( const char* path, SDL_RWops *rw,
 /**
  * @brief Frees a texture.
  *
+ * Textures loaded from files that aren't used anymore are kept in a cache
+ *  so they don't have to be loaded again, until they no longer fit in the
+ *  conf.texture_cache budget. Others are freed right away.
+ *
  *    @param texture Texture to free. (If NULL, function does nothing.)
  */
 void gl_freeTexture( glTexture* texture )
 {
-   glTexList *cur, *last;
+   glTexList *cur;
+   size_t mem;
 
    if (texture == NULL)
       return;
 
    /* see if we can find it in stack */
-   last = NULL;
-   for (cur=texture_list; cur!=NULL; cur=cur->next) {
-      if (cur->tex == texture) { /* found it */
-         cur->used--;
-         if (cur->used <= 0) { /* not used anymore */
-            /* free the texture */
-            glDeleteTextures( 1, &texture->texture );
-            free(texture->trans);
-            free(texture->name);
-            free(texture);
-
-            /* free the list node */
-            if (last == NULL) { /* case there's no texture before it */
-               if (cur->next != NULL)
-                  texture_list = cur->next;
-               else /* case it's the last texture */
-                  texture_list = NULL;
-            }
-            else
-               last->next = cur->next;
-            free(cur);
-         }
-         return; /* we already found it so we can exit */
+   cur = gl_texFind( texture );
+   if (cur != NULL) {
+      cur->used--;
+      if (cur->used > 0)
+         return;
+
+      /* Keep it in the cache if it's loaded and the cache is enabled. */
+      mem = gl_texMemory( texture );
+      if ((conf.texture_cache <= 0) || (mem == 0) || !cur->cache) {
+         gl_texRemove( cur );
+         gl_checkErr();
+         return;
       }
-      last = cur;
+      cur->lru_prev = texture_lru_last;
+      cur->lru_next = NULL;
+      if (texture_lru_last != NULL)
+         texture_lru_last->lru_next = cur;
+      else
+         texture_lru_first = cur;
+      texture_lru_last = cur;
+      texture_lru_mem += mem;
+      gl_lruEvict( (size_t)conf.texture_cache << 20 );
+      gl_checkErr();
+      return;
    }
 
    /* Not found */
@@ -811,10 +1176,7 @@ void gl_freeTexture( glTexture* texture )
       WARN(_("Attempting to free texture '%s' not found in stack!"), texture->name);
 
    /* Free anyways */
-   glDeleteTextures( 1, &texture->texture );
-   free(texture->trans);
-   free(texture->name);
-   free(texture);
+   gl_texDestroy( texture );
 
    gl_checkErr();
 }
@@ -835,13 +1197,12 @@ glTexture* gl_dupTexture( glTexture *texture )
       return NULL;
 
    /* check to see if it already exists */
-   if (texture_list != NULL) {
-      for (cur=texture_list; cur!=NULL; cur=cur->next) {
-         if (texture == cur->tex) {
-            cur->used += 1;
-            return cur->tex;
-         }
-      }
+   cur = gl_texFind( texture );
+   if (cur != NULL) {
+      if (cur->used <= 0)
+         gl_lruRemove( cur );
+      cur->used += 1;
+      return cur->tex;
    }
 
    /* Invalid texture. */
@@ -850,6 +1211,268 @@ glTexture* gl_dupTexture( glTexture *texture )
 }
 
 
+/**
+ * @brief Creates a texture whose image data is only loaded when needed.
+ *
+ * The texture can be used right away as it has all its dimensions, but it
+ *  only gets drawn once loaded. Drawing it prefetches it, use gl_texLoad()
+ *  when the data is needed right away.
+ *
+ *    @param name Name of the texture for deduplication, may be NULL.
+ *    @param path Path of the image to load.
+ *    @param w Width of the texture.
+ *    @param h Height of the texture.
+ *    @param sx X sprites.
+ *    @param sy Y sprites.
+ *    @param flags Flags to use.
+ *    @param filter Creates the texture from the image, NULL to use the image.
+ *    @param data Data to pass to the filter, must outlive the texture.
+ *    @return The lazy texture.
+ */
+glTexture* gl_newLazy( const char *name, const char *path, int w, int h,
+      int sx, int sy, unsigned int flags, glTexFilter filter, void *data )
+{
+   glTexture *texture;
+   glTexLazy *lazy;
+
+   flags |= OPENGL_TEX_LAZY;
+
+   /* Make sure doesn't already exist. */
+   if ((name != NULL) && !(flags & OPENGL_TEX_SKIPCACHE)) {
+      texture = gl_texExists( name, sx, sy, flags );
+      if (texture != NULL)
+         return texture;
+   }
+
+   lazy = calloc( 1, sizeof(glTexLazy) );
+   lazy->path   = strdup( path );
+   lazy->filter = filter;
+   lazy->data   = data;
+
+   texture = calloc( 1, sizeof(glTexture) );
+   texture->w     = (double) w;
+   texture->h     = (double) h;
+   texture->sx    = (double) sx;
+   texture->sy    = (double) sy;
+   texture->sw    = texture->w / texture->sx;
+   texture->sh    = texture->h / texture->sy;
+   texture->srw   = texture->sw / texture->w;
+   texture->srh   = texture->sh / texture->h;
+   texture->flags = flags;
+   texture->lazy  = lazy;
+   lazy->tex      = texture;
+
+   if (name != NULL) {
+      texture->name = strdup(name);
+      gl_texAdd( texture, sx, sy, 1 );
+   }
+
+   return texture;
+}
+
+
+/**
+ * @brief Decodes the image of a lazy texture.
+ *
+ * Runs on the threadpool when prefetching, so it must not use OpenGL or
+ *  log.
+ *
+ *    @param data Lazy load to decode.
+ *    @return 0 on success.
+ */
+static int gl_lazyDecode( void *data )
+{
+   glTexLazy *lazy;
+   const glTexture *tex;
+   SDL_RWops *rw;
+   SDL_Surface *surface, *filtered;
+
+   lazy = (glTexLazy*) data;
+   tex  = lazy->tex;
+
+   surface = NULL;
+   rw = PHYSFSRWOPS_openRead( lazy->path );
+   if (rw != NULL) {
+      surface = IMG_Load_RW( rw, 0 );
+      if ((surface != NULL) && (lazy->filter != NULL)) {
+         filtered = lazy->filter( surface, lazy->data );
+         SDL_FreeSurface( surface );
+         surface = filtered;
+      }
+      /* The image must match the size read from the header. */
+      if ((surface != NULL) && ((surface->w != (int)tex->w)
+               || (surface->h != (int)tex->h))) {
+         SDL_FreeSurface( surface );
+         surface = NULL;
+      }
+      /* The map is made in memory, gl_lazyUpload() caches it. Filtered
+       * images can't use the cache as it's keyed by the file. */
+      if ((surface != NULL) && (tex->flags & OPENGL_TEX_MAPTRANS)) {
+         if ((lazy->filter == NULL) && gl_transDigest( rw, lazy->digest ))
+            lazy->digest[0] = '\0';
+         SDL_LockSurface( surface );
+         lazy->trans = SDL_MapTrans( surface, surface->w, surface->h );
+         SDL_UnlockSurface( surface );
+      }
+      SDL_RWclose( rw );
+   }
+   lazy->surface = surface;
+
+   if (lazy->done != NULL)
+      SDL_SemPost( lazy->done );
+   return (surface == NULL);
+}
+
+
+/**
+ * @brief Waits for a queued lazy load and takes it off the queue.
+ */
+static void gl_lazyWait( glTexLazy *lazy )
+{
+   int i;
+
+   SDL_SemWait( lazy->done );
+   for (i=0; i<array_size(lazy_queue); i++) {
+      if (lazy_queue[i] == lazy) {
+         array_erase( &lazy_queue, &lazy_queue[i], &lazy_queue[i+1] );
+         break;
+      }
+   }
+   SDL_DestroySemaphore( lazy->done );
+   lazy->done = NULL;
+}
+
+
+/**
+ * @brief Uploads a decoded lazy texture and frees the lazy load.
+ */
+static void gl_lazyUpload( glTexLazy *lazy )
+{
+   glTexture *tex = lazy->tex;
+
+   if (lazy->surface == NULL)
+      WARN(_("Unable to load image '%s'."), lazy->path );
+   else {
+      if (tex->flags & OPENGL_TEX_MAPTRANS) {
+         if (lazy->trans == NULL)
+            WARN(_("Out of Memory"));
+         else if (lazy->digest[0] != '\0')
+            gl_transCacheWrite( lazy->digest, lazy->trans,
+                  lazy->surface->w, lazy->surface->h );
+      }
+      tex->texture = gl_loadSurface( lazy->surface, tex->flags, 1 );
+   }
+   tex->trans  = lazy->trans;
+   tex->flags &= ~(OPENGL_TEX_LAZY | OPENGL_TEX_MAPTRANS);
+   tex->lazy   = NULL;
+
+   free( lazy->path );
+   free( lazy );
+}
+
+
+/**
+ * @brief Frees a lazy load without uploading it.
+ *
+ *    @param lazy Lazy load to free. (If NULL, function does nothing.)
+ */
+static void gl_lazyFree( glTexLazy *lazy )
+{
+   if (lazy == NULL)
+      return;
+
+   if (lazy->done != NULL)
+      gl_lazyWait( lazy );
+   if (lazy->surface != NULL)
+      SDL_FreeSurface( lazy->surface );
+   free( lazy->trans );
+   free( lazy->path );
+   free( lazy );
+}
+
+
+/**
+ * @brief Starts decoding a lazy texture in the background.
+ *
+ * The texture gets uploaded by gl_texUpdate() once decoded.
+ *
+ *    @param texture Texture to prefetch. (Does nothing if NULL or loaded.)
+ */
+void gl_texPrefetch( const glTexture *texture )
+{
+   glTexLazy *lazy;
+
+   if ((texture == NULL) || (texture->lazy == NULL))
+      return;
+
+   /* Already queued. */
+   lazy = texture->lazy;
+   if (lazy->done != NULL)
+      return;
+
+   lazy->done = SDL_CreateSemaphore( 0 );
+   if (lazy_queue == NULL)
+      lazy_queue = array_create( glTexLazy* );
+   array_push_back( &lazy_queue, lazy );
+   threadpool_newJob( gl_lazyDecode, lazy );
+}
+
+
+/**
+ * @brief Loads a lazy texture right away.
+ *
+ *    @param texture Texture to load. (Does nothing if NULL or loaded.)
+ */
+void gl_texLoad( glTexture *texture )
+{
+   glTexLazy *lazy;
+
+   if ((texture == NULL) || (texture->lazy == NULL))
+      return;
+
+   lazy = texture->lazy;
+   if (lazy->done != NULL)
+      gl_lazyWait( lazy );
+   else
+      gl_lazyDecode( lazy );
+   gl_lazyUpload( lazy );
+}
+
+
+/**
+ * @brief Uploads prefetched textures that finished decoding.
+ *
+ * Should be called once per frame. Stops once it has used up its time
+ *  budget so big batches of prefetches don't cause stutters.
+ */
+void gl_texUpdate (void)
+{
+   int i;
+   Uint64 start, budget;
+   glTexLazy *lazy;
+
+   if (array_size(lazy_queue) == 0)
+      return;
+
+   start  = SDL_GetPerformanceCounter();
+   budget = OPENGL_TEX_UPLOAD_BUDGET * SDL_GetPerformanceFrequency();
+   for (i=0; i<array_size(lazy_queue); i++) {
+      lazy = lazy_queue[i];
+      if (SDL_SemTryWait( lazy->done ) != 0)
+         continue;
+
+      array_erase( &lazy_queue, &lazy_queue[i], &lazy_queue[i+1] );
+      i--;
+      SDL_DestroySemaphore( lazy->done );
+      lazy->done = NULL;
+      gl_lazyUpload( lazy );
+
+      if (SDL_GetPerformanceCounter() - start >= budget)
+         break;
+   }
+}
+
+
 /**
  * @brief Checks to see if a pixel is transparent in a texture.
  *
@@ -940,22 +1563,126 @@ glTexture** gl_copyTexArray( glTexture **tex, int *n )
  */
 int gl_initTextures (void)
 {
+   /* Image loaders get initialized on first use otherwise, which isn't
+    * safe once lazy textures get decoded on the threadpool. */
+   IMG_Init( IMG_INIT_PNG | IMG_INIT_WEBP );
    return 0;
 }
 
 
+/**
+ * @brief Prints the texture memory usage by category.
+ *
+ * The category of a texture is the start of its path, like "gfx/ship".
+ *  Textures without a path are generated.
+ *
+ *    @param print Function to print each line with.
+ */
+void gl_texUsage( void (*print)( const char *line ) )
+{
+   typedef struct TexUsage_ {
+      char name[64]; /**< Category name. */
+      int count; /**< Number of textures. */
+      int unused; /**< Number of cached unused textures. */
+      int lazy; /**< Number of textures not loaded yet. */
+      size_t mem; /**< Memory used. */
+   } TexUsage;
+   TexUsage *usage, *u, total;
+   glTexList *cur;
+   const char *name, *end;
+   char line[256];
+   uint32_t b;
+   int i, len;
+
+   usage = array_create( TexUsage );
+   memset( &total, 0, sizeof(total) );
+   for (b=0; b<texture_nbuckets; b++) {
+      for (cur=texture_hash[b]; cur!=NULL; cur=cur->next) {
+         /* Use up to the second directory of the path as category. */
+         name = cur->tex->name;
+         end  = strchr( name, '/' );
+         if (end != NULL)
+            end = strchr( end+1, '/' );
+         if (end == NULL) {
+            name = _("generated");
+            len  = strlen( name );
+         }
+         else
+            len = MIN( end - name, (int)sizeof(u->name)-1 );
+
+         u = NULL;
+         for (i=0; i<array_size(usage); i++) {
+            if ((strncmp( usage[i].name, name, len ) == 0)
+                  && (usage[i].name[len] == '\0')) {
+               u = &usage[i];
+               break;
+            }
+         }
+         if (u == NULL) {
+            u = &array_grow( &usage );
+            memset( u, 0, sizeof(TexUsage) );
+            strncpy( u->name, name, len );
+         }
+
+         u->count++;
+         u->unused += (cur->used <= 0);
+         u->lazy   += (cur->tex->lazy != NULL);
+         u->mem    += gl_texMemory( cur->tex );
+         total.count++;
+         total.unused += (cur->used <= 0);
+         total.lazy   += (cur->tex->lazy != NULL);
+         total.mem    += gl_texMemory( cur->tex );
+      }
+   }
+
+   print( _("Texture memory by category:") );
+   for (i=0; i<array_size(usage); i++) {
+      snprintf( line, sizeof(line),
+            _("   %-20s %5d textures (%d unused, %d not loaded) %8.1f MiB"),
+            usage[i].name, usage[i].count, usage[i].unused,
+            usage[i].lazy, (double)usage[i].mem / (1<<20) );
+      print( line );
+   }
+   snprintf( line, sizeof(line),
+         _("   %-20s %5d textures (%d unused, %d not loaded) %8.1f MiB"),
+         _("total"), total.count, total.unused, total.lazy,
+         (double)total.mem / (1<<20) );
+   print( line );
+   snprintf( line, sizeof(line),
+         _("Unused texture cache: %.1f of %d MiB"),
+         (double)texture_lru_mem / (1<<20), conf.texture_cache );
+   print( line );
+
+   array_free( usage );
+}
+
+
 /**
  * @brief Cleans up the opengl texture subsystem.
  */
 void gl_exitTextures (void)
 {
+   uint32_t i;
    glTexList *tex;
 
+   /* Unused textures are only cached, not leaked. */
+   gl_lruEvict( 0 );
+
+   array_free( lazy_queue );
+   lazy_queue = NULL;
+   IMG_Quit();
+
    /* Make sure there's no texture leak */
-   if (texture_list != NULL) {
+   if (texture_count > 0) {
       DEBUG(_("Texture leak detected!"));
-      for (tex=texture_list; tex!=NULL; tex=tex->next)
-         DEBUG( n_( "   '%s' opened %d time", "   '%s' opened %d times", tex->used ), tex->tex->name, tex->used );
+      for (i=0; i<texture_nbuckets; i++)
+         for (tex=texture_hash[i]; tex!=NULL; tex=tex->next)
+            DEBUG( n_( "   '%s' opened %d time", "   '%s' opened %d times", tex->used ), tex->tex->name, tex->used );
+   }
+   else {
+      free( texture_hash );
+      texture_hash = NULL;
+      texture_nbuckets = 0;
    }
 }
 
@@ -31,6 +31,22 @@
 #define OPENGL_TEX_MIPMAPS    (1<<1) /**< Creates mipmaps. */
 #define OPENGL_TEX_VFLIP      (1<<2) /**< Assume loaded from an image (where positive y means down). */
 #define OPENGL_TEX_SKIPCACHE  (1<<3) /**< Skip caching checks and create new texture. */
+#define OPENGL_TEX_LAZY       (1<<4) /**< Only load the image data when first used. */
+
+
+struct glTexLazy_;
+
+
+/**
+ * @brief Creates the surface of a lazily loaded texture from a loaded image.
+ *
+ * Runs on a worker thread, so it must not use OpenGL or log.
+ *
+ *    @param surface Image loaded from the texture's path.
+ *    @param data Data passed when creating the texture.
+ *    @return New surface to upload (surface gets freed by the caller).
+ */
+typedef SDL_Surface* (*glTexFilter)( SDL_Surface *surface, void *data );
 
 /**
  * @brief Abstraction for rendering sprite sheets.
@@ -55,6 +71,7 @@ typedef struct glTexture_ {
    /* data */
    GLuint texture; /**< the opengl texture itself */
    uint8_t* trans; /**< maps the transparency */
+   struct glTexLazy_ *lazy; /**< Pending load of a lazy texture, NULL once loaded. */
 
    /* properties */
    uint8_t flags; /**< flags used for texture properties */
@@ -82,8 +99,17 @@ glTexture* gl_newSprite( const char* path, const int sx, const int sy,
       const unsigned int flags );
 glTexture* gl_newSpriteRWops( const char* path, SDL_RWops *rw,
    const int sx, const int sy, const unsigned int flags );
+glTexture* gl_newLazy( const char *name, const char *path, int w, int h,
+      int sx, int sy, unsigned int flags, glTexFilter filter, void *data );
 glTexture* gl_dupTexture( glTexture *texture );
 
+/*
+ * Lazy loading.
+ */
+void gl_texPrefetch( const glTexture *texture );
+void gl_texLoad( glTexture *texture );
+void gl_texUpdate( void );
+
 /*
  * Clean up.
  */
@@ -101,6 +127,7 @@ int gl_isTrans( const glTexture* t, const int x, const int y );
 void gl_getSpriteFromDir( int* x, int* y, const glTexture* t, const double dir );
 glTexture** gl_copyTexArray( glTexture **tex, int *n );
 glTexture** gl_addTexArray( glTexture **tex, int *n, glTexture *t );
+void gl_texUsage( void (*print)( const char *line ) );
 
 
 #endif /* OPENGL_TEX_H */
@@ -65,7 +65,7 @@ static void outfit_launcherDesc( Outfit* o );
 /* parsing */
 static int outfit_loadDir( char *dir );
 static int outfit_parseDamage( Damage *dmg, xmlNodePtr node );
-static int outfit_parse( Outfit* temp, const char* file );
+static int outfit_parse( Outfit* temp, xmlDocPtr doc );
 static void outfit_parseSBolt( Outfit* temp, const xmlNodePtr parent );
 static void outfit_parseSBeam( Outfit* temp, const xmlNodePtr parent );
 static void outfit_parseSLauncher( Outfit* temp, const xmlNodePtr parent );
@@ -1077,9 +1077,7 @@ static int outfit_parseDamage( Damage *dmg, xmlNodePtr node )
 static int outfit_loadPLG( Outfit *temp, char *buf, unsigned int bolt )
 {
    char *file;
-   CollPoly *polygon;
-   xmlDocPtr doc;
-   xmlNodePtr node, cur;
+   CollPoly *polygons;
 
    asprintf( &file, "%s%s.xml", OUTFIT_POLYGON_PATH, buf );
 
@@ -1092,54 +1090,14 @@ that can be found in Naev's artwork repo."), file);
       return 0;
    }
 
-   /* Load the XML. */
-   doc  = xml_parsePhysFS( file );
-
-   if (doc == NULL) {
-      free(file);
-      return 0;
-   }
-
-   node = doc->xmlChildrenNode; /* First polygon node */
-   if (node == NULL) {
-      xmlFreeDoc(doc);
-      WARN(_("Malformed %s file: does not contain elements"), file);
-      free(file);
-      return 0;
-   }
+   /* Load the polygons. */
+   polygons = LoadPolygonFile( file, 36 );
+   if (bolt)
+      temp->u.blt.polygon = polygons;
+   else /* Second case: outfit is an ammo */
+      temp->u.amm.polygon = polygons;
 
    free(file);
-
-   if (bolt) {
-      do { /* load the polygon data */
-         if (xml_isNode(node,"polygons")) {
-            cur = node->children;
-            temp->u.blt.polygon = array_create_size( CollPoly, 36 );
-            do {
-               if (xml_isNode(cur,"polygon")) {
-                  polygon = &array_grow( &temp->u.blt.polygon );
-                  LoadPolygon( polygon, cur );
-               }
-            } while (xml_nextNode(cur));
-         }
-      } while (xml_nextNode(node));
-   }
-   else {
-      do { /* Second case: outfit is an ammo */
-         if (xml_isNode(node,"polygons")) {
-            cur = node->children;
-            temp->u.amm.polygon = array_create_size( CollPoly, 36 );
-            do {
-               if (xml_isNode(cur,"polygon")) {
-                  polygon = &array_grow( &temp->u.amm.polygon );
-                  LoadPolygon( polygon, cur );
-               }
-            } while (xml_nextNode(cur));
-         }
-      } while (xml_nextNode(node));
-   }
-
-   xmlFreeDoc(doc);
    return 0;
 }
 
@@ -1205,7 +1163,7 @@ static void outfit_parseSBolt( Outfit* temp, const xmlNodePtr parent )
       if (xml_isNode(node,"gfx")) {
          temp->u.blt.gfx_space = xml_parseTexture( node,
                OUTFIT_GFX_PATH"space/%s", 6, 6,
-               OPENGL_TEX_MAPTRANS | OPENGL_TEX_MIPMAPS );
+               OPENGL_TEX_MAPTRANS | OPENGL_TEX_MIPMAPS | OPENGL_TEX_LAZY );
          xmlr_attr_strd(node, "spin", buf);
          if (buf != NULL) {
             outfit_setProp( temp, OUTFIT_PROP_WEAP_SPIN );
@@ -1216,6 +1174,10 @@ static void outfit_parseSBolt( Outfit* temp, const xmlNodePtr parent )
          buf = xml_get(node);
          outfit_loadPLG( temp, buf, 1 );
 
+         /* Sprite collisions need the transparency map right away. */
+         if (array_size(temp->u.blt.polygon) == 0)
+            gl_texLoad( temp->u.blt.gfx_space );
+
          /* Validity check: there must be 1 polygon per sprite. */
          if (array_size(temp->u.blt.polygon) != 36) {
             WARN(_("Outfit '%s': the number of collision polygons is wrong.\n \
@@ -1227,7 +1189,7 @@ static void outfit_parseSBolt( Outfit* temp, const xmlNodePtr parent )
       if (xml_isNode(node,"gfx_end")) {
          temp->u.blt.gfx_end = xml_parseTexture( node,
                OUTFIT_GFX_PATH"space/%s", 6, 6,
-               OPENGL_TEX_MAPTRANS | OPENGL_TEX_MIPMAPS );
+               OPENGL_TEX_MAPTRANS | OPENGL_TEX_MIPMAPS | OPENGL_TEX_LAZY );
          continue;
       }
 
@@ -1757,7 +1719,7 @@ static void outfit_parseSAmmo( Outfit* temp, const xmlNodePtr parent )
       if (xml_isNode(node,"gfx")) {
          temp->u.amm.gfx_space = xml_parseTexture( node,
                OUTFIT_GFX_PATH"space/%s", 6, 6,
-               OPENGL_TEX_MAPTRANS | OPENGL_TEX_MIPMAPS );
+               OPENGL_TEX_MAPTRANS | OPENGL_TEX_MIPMAPS | OPENGL_TEX_LAZY );
          xmlr_attr_float(node, "spin", temp->u.amm.spin);
          if (temp->u.amm.spin != 0)
             outfit_setProp( temp, OUTFIT_PROP_WEAP_SPIN );
@@ -1765,6 +1727,10 @@ static void outfit_parseSAmmo( Outfit* temp, const xmlNodePtr parent )
          buf = xml_get(node);
          outfit_loadPLG( temp, buf, 0 );
 
+         /* Sprite collisions need the transparency map right away. */
+         if (array_size(temp->u.amm.polygon) == 0)
+            gl_texLoad( temp->u.amm.gfx_space );
+
          /* Validity check: there must be 1 polygon per sprite. */
          if (array_size(temp->u.amm.polygon) != 36) {
             WARN(_("Outfit '%s': the number of collision polygons is wrong.\n \
@@ -2337,10 +2303,10 @@ if (o) WARN(_("Outfit '%s' should not have '%s' element"), temp->name, s)
  * @brief Parses and returns Outfit from parent node.
 
  *    @param temp Outfit to load into.
- *    @param file Path to the XML file (relative to base directory).
+ *    @param doc Parsed XML document of the outfit (freed by the caller).
  *    @return 0 on success.
  */
-static int outfit_parse( Outfit* temp, const char* file )
+static int outfit_parse( Outfit* temp, xmlDocPtr doc )
 {
    xmlNodePtr cur, ccur, node, parent;
    char *prop, *desc_extra;
@@ -2348,10 +2314,6 @@ static int outfit_parse( Outfit* temp, const char* file )
    int group, l;
    ShipStatList *ll, *tail;
 
-   xmlDocPtr doc = xml_parsePhysFS( file );
-   if (doc == NULL)
-      return -1;
-
    parent = doc->xmlChildrenNode; /* first system node */
    if (parent == NULL) {
       ERR( _("Malformed '%s' file: does not contain elements"), OUTFIT_DATA_PATH );
@@ -2394,7 +2356,8 @@ static int outfit_parse( Outfit* temp, const char* file )
             }
             else if (xml_isNode(cur,"gfx_store")) {
                temp->gfx_store = xml_parseTexture( cur,
-                     OUTFIT_GFX_PATH"store/%s", 1, 1, OPENGL_TEX_MIPMAPS );
+                     OUTFIT_GFX_PATH"store/%s", 1, 1,
+                     OPENGL_TEX_MIPMAPS | OPENGL_TEX_LAZY );
                continue;
             }
             else if (xml_isNode(cur,"gfx_overlays")) {
@@ -2404,7 +2367,8 @@ static int outfit_parse( Outfit* temp, const char* file )
                   xml_onlyNodes(ccur);
                   if (xml_isNode(ccur,"gfx_overlay"))
                      array_push_back( &temp->gfx_overlays,
-                           xml_parseTexture( ccur, OVERLAY_GFX_PATH"%s", 1, 1, OPENGL_TEX_MIPMAPS ) );
+                           xml_parseTexture( ccur, OVERLAY_GFX_PATH"%s", 1, 1,
+                              OPENGL_TEX_MIPMAPS | OPENGL_TEX_LAZY ) );
                } while (xml_nextNode(ccur));
                continue;
             }
@@ -2545,7 +2509,8 @@ if (o) WARN( _("Outfit '%s' missing/invalid '%s' element"), temp->name, s) /**<
    MELEMENT(temp->description==NULL,"description");
 #undef MELEMENT
 
-   xmlFreeDoc(doc);
+   /* Stats are applied often, compile them once. */
+   temp->stats_ops = ss_listCompile( temp->stats );
 
    return 0;
 }
@@ -2560,20 +2525,41 @@ if (o) WARN( _("Outfit '%s' missing/invalid '%s' element"), temp->name, s) /**<
 static int outfit_loadDir( char *dir )
 {
    int i, n, ret;
-   char **outfit_files;
+   char **outfit_files, **xml_files;
+   XmlFile *docs;
 
    outfit_files = ndata_listRecursive( dir );
-   for ( i = 0; i < array_size( outfit_files ); i++ ) {
-      if (!naev_pollQuit() && ndata_matchExt(outfit_files[i], "xml")) {
-         ret = outfit_parse( &array_grow(&outfit_stack), outfit_files[i] );
-         if (ret < 0) {
-            n = array_size(outfit_stack);
-            array_erase( &outfit_stack, &outfit_stack[n-1], &outfit_stack[n] );
-         }
+   xml_files = array_create_size( char*, array_size(outfit_files) );
+   for (i=0; i<array_size(outfit_files); i++)
+      if (ndata_matchExt(outfit_files[i], "xml"))
+         array_push_back( &xml_files, outfit_files[i] );
+
+   /* Read and parse the XML in parallel, then load in file order. */
+   docs = xml_parsePhysFSList( xml_files, NULL );
+   for (i=0; i<array_size(docs); i++) {
+      if (naev_pollQuit())
+         break;
+      if (docs[i].status == XMLFILE_NOREAD) {
+         WARN( _("Unable to read data from '%s': %s"), docs[i].filename,
+               docs[i].error );
+         continue;
+      }
+      else if (docs[i].status != XMLFILE_OK) {
+         WARN( _("Unable to parse document '%s'"), docs[i].filename );
+         continue;
+      }
+      ret = outfit_parse( &array_grow(&outfit_stack), docs[i].doc );
+      if (ret < 0) {
+         n = array_size(outfit_stack);
+         array_erase( &outfit_stack, &outfit_stack[n-1], &outfit_stack[n] );
       }
-      free( outfit_files[i] );
    }
+   xml_freeFileList( docs );
+
+   for (i=0; i<array_size(outfit_files); i++)
+      free( outfit_files[i] );
    array_free( outfit_files );
+   array_free( xml_files );
 
    /* Reduce size. */
    array_shrink( &outfit_stack );
@@ -2862,6 +2848,7 @@ void outfit_free (void)
 
       /* Free stats. */
       ss_free( o->stats );
+      array_free( o->stats_ops );
 
       if (outfit_isAmmo(o)) {
          /* Free collision polygons. */
@@ -347,6 +347,7 @@ typedef struct Outfit_ {
 
    /* Stats. */
    ShipStatList *stats; /**< Stat list. */
+   ShipStatOp *stats_ops; /**< Array (array.h): Stat list compiled for applying it. */
 
    /* Type dependent */
    OutfitType type; /**< Type of the outfit. */
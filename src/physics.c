@@ -11,9 +11,38 @@
 #include "naev.h"
 /** @endcond */
 
+#include "array.h"
 #include "log.h"
 #include "nstring.h"
 #include "physics.h"
+#include "pool.h"
+
+
+#define SOLID_POOL_SLAB    256 /**< Solids allocated at once. */
+#define SOLID_BATCH        64 /**< Solids integrated together by solid_updateBatch(). */
+
+
+/**
+ * @brief Real state of a solid being drawn interpolated.
+ */
+typedef struct SolidInterp_ {
+   Solid *s; /**< Interpolated solid. */
+   Vector2d pos; /**< Real position of the solid. */
+   Vector2d ipos; /**< Interpolated position of the solid. */
+} SolidInterp;
+
+
+static Pool *solid_pool = NULL; /**< Memory of the solids created with solid_create(). */
+static SolidInterp *solid_interp = NULL; /**< Array (array.h): Solids currently interpolated. */
+
+
+/*
+ * Prototypes.
+ */
+static void solid_update_euler (Solid *obj, const double dt);
+static void solid_update_rk4 (Solid *obj, const double dt);
+static void solid_batchEuler( Solid *const *solids, int n, const double dt );
+static void solid_batchRK4( Solid *const *solids, int n, const double dt );
 
 
 /*
@@ -426,6 +455,240 @@ static void solid_update_rk4 (Solid *obj, const double dt)
 }
 
 
+/**
+ * @brief Updates solids with the Euler method from a structure of arrays.
+ *
+ * Does the same calculations as solid_update_euler() in the same order,
+ *  so the results are identical unless the compiler contracts them
+ *  differently (see SOLID_BATCH_TOLERANCE).
+ *
+ *    @param solids Solids to update, all using the Euler method.
+ *    @param n Number of solids (at most SOLID_BATCH).
+ *    @param dt Time step.
+ */
+static void solid_batchEuler( Solid *const *solids, int n, const double dt )
+{
+   int i;
+   double px[SOLID_BATCH], py[SOLID_BATCH], vx[SOLID_BATCH], vy[SOLID_BATCH];
+   double ax[SOLID_BATCH], ay[SOLID_BATCH];
+   double old_dir, diff, dest_diff, cdir, sdir;
+   Solid *obj;
+
+   /* Rotation is branchy, so it is done one solid at a time. */
+   for (i=0; i<n; i++) {
+      obj = solids[i];
+      old_dir = obj->dir;
+      diff = obj->dir_vel * dt;
+      obj->dir += diff;
+
+      if (isfinite(obj->dir_dest)
+            && (((dest_diff = angle_diff(old_dir, obj->dir_dest)) == 0.)
+               || (((diff < 0.) == (dest_diff < 0.))
+                  && (ABS(diff) >= ABS(dest_diff))))) {
+         obj->dir = obj->dir_dest;
+      }
+      obj->dir_dest = INFINITY;
+
+      if (obj->dir >= 2*M_PI)
+         obj->dir -= 2*M_PI;
+      if (obj->dir < 0.)
+         obj->dir += 2*M_PI;
+
+      sdir = sin(obj->dir);
+      cdir = cos(obj->dir);
+      ax[i] = obj->thrust*cdir / obj->mass;
+      ay[i] = obj->thrust*sdir / obj->mass;
+      px[i] = obj->pos.x;
+      py[i] = obj->pos.y;
+      vx[i] = obj->vel.x;
+      vy[i] = obj->vel.y;
+   }
+
+   /* Straight line arithmetic the compiler can vectorize. */
+   for (i=0; i<n; i++) {
+      px[i] += vx[i]*dt + 0.5*ax[i] * dt*dt;
+      py[i] += vy[i]*dt + 0.5*ay[i] * dt*dt;
+      vx[i] += ax[i]*dt;
+      vy[i] += ay[i]*dt;
+   }
+
+   for (i=0; i<n; i++) {
+      vect_cset( &solids[i]->vel, vx[i], vy[i] );
+      vect_cset( &solids[i]->pos, px[i], py[i] );
+   }
+}
+
+
+/**
+ * @brief Updates solids with the Runge-Kutta method from a structure of
+ *        arrays.
+ *
+ * All the solids take their substeps in lockstep, solids which need fewer
+ *  substeps than others just stop moving once they are done. To keep the
+ *  substep loop free of calls to libm:
+ *
+ *  - The direction is rotated with a rotation matrix each substep instead
+ *    of calling cos() and sin().
+ *  - The speed limit force is applied along -v/|v| instead of going
+ *    through the angle of the velocity.
+ *
+ * Both are mathematically the same as solid_update_rk4() but round
+ *  differently, see SOLID_BATCH_TOLERANCE.
+ *
+ *    @param solids Solids to update, all using the Runge-Kutta method.
+ *    @param n Number of solids (at most SOLID_BATCH).
+ *    @param dt Time step.
+ */
+static void solid_batchRK4( Solid *const *solids, int n, const double dt )
+{
+   int i, k, N, maxN, vint;
+   int nstep[SOLID_BATCH];
+   double px[SOLID_BATCH], py[SOLID_BATCH], vx[SOLID_BATCH], vy[SOLID_BATCH];
+   double dir[SOLID_BATCH], dvel[SOLID_BATCH], th[SOLID_BATCH], smax[SOLID_BATCH];
+   double h[SOLID_BATCH], cdir[SOLID_BATCH], sdir[SOLID_BATCH];
+   double crot[SOLID_BATCH], srot[SOLID_BATCH], old_dir[SOLID_BATCH];
+   double hk, ax, ay, tx, ty, vmod, f, c, s, dirdiff, dirdestdiff;
+   Solid *obj;
+
+   /* Gather. */
+   maxN = 0;
+   for (i=0; i<n; i++) {
+      obj = solids[i];
+      px[i] = obj->pos.x;
+      py[i] = obj->pos.y;
+      vx[i] = obj->vel.x;
+      vy[i] = obj->vel.y;
+      dir[i] = old_dir[i] = obj->dir;
+      dvel[i] = obj->dir_vel;
+      th[i] = obj->thrust / obj->mass;
+      smax[i] = obj->speed_max;
+
+      /* Same number of substeps as solid_update_rk4(). */
+      if (dt > RK4_MIN_H)
+         N = (int)(dt / RK4_MIN_H);
+      else
+         N = 1;
+      vint = (int) MOD( vx[i], vy[i] )/100.;
+      if (N < vint)
+         N = vint;
+      nstep[i] = N;
+      maxN = MAX( maxN, N );
+      h[i] = dt / (double)N;
+
+      cdir[i] = cos( dir[i] );
+      sdir[i] = sin( dir[i] );
+      crot[i] = cos( dvel[i] * h[i] );
+      srot[i] = sin( dvel[i] * h[i] );
+   }
+
+   /* Substeps, all solids at once. */
+   for (k=0; k<maxN; k++) {
+      for (i=0; i<n; i++) {
+         /* Finished solids take empty steps. */
+         hk = (k < nstep[i]) ? h[i] : 0.;
+
+         ax = th[i]*cdir[i];
+         ay = th[i]*sdir[i];
+
+         /* Limit the speed. */
+         vmod = sqrt( vx[i]*vx[i] + vy[i]*vy[i] );
+         f = ((smax[i] >= 0.) && (vmod > smax[i])) ?
+               -3. * (vmod - smax[i]) / vmod : 0.;
+         ax += f * vx[i];
+         ay += f * vy[i];
+
+         tx = vx[i];
+         tx += 2.*vx[i] + hk*tx;
+         tx += 2.*vx[i] + hk*tx;
+         tx += vx[i] + hk*tx;
+         tx *= hk/6.;
+         px[i] += tx;
+         vx[i] += ax * hk;
+
+         ty = vy[i];
+         ty += 2.*(vy[i] + hk/2.*ty);
+         ty += 2.*(vy[i] + hk/2.*ty);
+         ty += vy[i] + hk*ty;
+         ty *= hk/6.;
+         py[i] += ty;
+         vy[i] += ay * hk;
+
+         /* Rotate. */
+         dir[i] += dvel[i] * hk;
+         c = (k < nstep[i]) ? cdir[i]*crot[i] - sdir[i]*srot[i] : cdir[i];
+         s = (k < nstep[i]) ? sdir[i]*crot[i] + cdir[i]*srot[i] : sdir[i];
+         cdir[i] = c;
+         sdir[i] = s;
+      }
+   }
+
+   /* Scatter. */
+   for (i=0; i<n; i++) {
+      obj = solids[i];
+      vect_cset( &obj->vel, vx[i], vy[i] );
+      vect_cset( &obj->pos, px[i], py[i] );
+
+      obj->dir = dir[i];
+      dirdiff = dvel[i] * h[i] * (double)nstep[i];
+      if (isfinite(obj->dir_dest)
+            && (((dirdestdiff = angle_diff(old_dir[i], obj->dir_dest)) == 0)
+               || (((dirdiff < 0) == (dirdestdiff < 0))
+                  && (ABS(dirdiff) >= ABS(dirdestdiff))))) {
+         obj->dir = obj->dir_dest;
+      }
+      obj->dir_dest = INFINITY;
+
+      if (obj->dir >= 2.*M_PI)
+         obj->dir -= 2.*M_PI;
+      else if (obj->dir < 0.)
+         obj->dir += 2.*M_PI;
+   }
+}
+
+
+/**
+ * @brief Updates many solids at once.
+ *
+ * Gives the same results as calling the update method of each solid (see
+ *  SOLID_BATCH_TOLERANCE), but works on batches laid out as structures
+ *  of arrays so the compiler can vectorize the integration and there is
+ *  no indirect call per solid.
+ *
+ *    @param solids Solids to update.
+ *    @param n Number of solids.
+ *    @param dt Time step.
+ */
+void solid_updateBatch( Solid *const *solids, int n, const double dt )
+{
+   int i, neuler, nrk4;
+   Solid *euler[SOLID_BATCH], *rk4[SOLID_BATCH];
+
+   neuler = nrk4 = 0;
+   for (i=0; i<n; i++) {
+      if (solids[i]->update == solid_update_euler) {
+         euler[neuler++] = solids[i];
+         if (neuler == SOLID_BATCH) {
+            solid_batchEuler( euler, neuler, dt );
+            neuler = 0;
+         }
+      }
+      else if (solids[i]->update == solid_update_rk4) {
+         rk4[nrk4++] = solids[i];
+         if (nrk4 == SOLID_BATCH) {
+            solid_batchRK4( rk4, nrk4, dt );
+            nrk4 = 0;
+         }
+      }
+      else
+         solids[i]->update( solids[i], dt );
+   }
+   if (neuler > 0)
+      solid_batchEuler( euler, neuler, dt );
+   if (nrk4 > 0)
+      solid_batchRK4( rk4, nrk4, dt );
+}
+
+
 /**
  * @brief Gets the maximum speed of any object with speed and thrust.
  */
@@ -476,6 +739,7 @@ void solid_init( Solid* dest, const double mass, const double dir,
       vectnull( &dest->pos );
    else
       dest->pos = *pos;
+   dest->pos_prev = dest->pos;
 
    /* Misc. */
    dest->speed_max = -1.; /* Negative is invalid. */
@@ -510,9 +774,10 @@ void solid_init( Solid* dest, const double mass, const double dir,
 Solid* solid_create( const double mass, const double dir,
       const Vector2d* pos, const Vector2d* vel, int update )
 {
-   Solid* dyn = malloc(sizeof(Solid));
-   if (dyn==NULL)
-      ERR(_("Out of Memory"));
+   Solid* dyn;
+   if (solid_pool == NULL)
+      solid_pool = pool_create( sizeof(Solid), SOLID_POOL_SLAB );
+   dyn = pool_alloc( solid_pool );
    solid_init( dyn, mass, dir, pos, vel, update );
    return dyn;
 }
@@ -525,6 +790,87 @@ Solid* solid_create( const double mass, const double dir,
  */
 void solid_free( Solid* src )
 {
-   free(src);
+   pool_free( solid_pool, src );
+}
+
+
+/**
+ * @brief Frees the memory of all solids, which must have been freed already.
+ */
+void solid_exit (void)
+{
+   pool_destroy( solid_pool, NULL );
+   solid_pool = NULL;
+   array_free( solid_interp );
+   solid_interp = NULL;
+}
+
+
+/**
+ * @brief Remembers the current position of a solid as the start of the
+ *        next update.
+ *
+ * Should be called once per update before anything moves the solid, and
+ *  after teleporting it so it doesn't get drawn flying there.
+ *
+ *    @param s Solid to save.
+ */
+void solid_savePrev( Solid *s )
+{
+   s->pos_prev = s->pos;
+}
+
+
+/**
+ * @brief Moves a solid between its positions of the last two updates for
+ *        drawing.
+ *
+ * The real position is restored by solid_interpolateEnd(), which must be
+ *  called before the solid is updated or freed.
+ *
+ *    @param s Solid to interpolate.
+ *    @param alpha Fraction of the way from the previous position to the
+ *           current one.
+ */
+void solid_interpolate( Solid *s, double alpha )
+{
+   double dx, dy;
+   SolidInterp *si;
+
+   dx = s->pos.x - s->pos_prev.x;
+   dy = s->pos.y - s->pos_prev.y;
+   if ((alpha >= 1.) || (pow2(dx)+pow2(dy) > pow2(SOLID_INTERP_SNAP)))
+      return;
+
+   if (solid_interp == NULL)
+      solid_interp = array_create( SolidInterp );
+   si = &array_grow( &solid_interp );
+   si->s = s;
+   si->pos = s->pos;
+   s->pos.x = s->pos_prev.x + alpha*dx;
+   s->pos.y = s->pos_prev.y + alpha*dy;
+   si->ipos = s->pos;
+}
+
+
+/**
+ * @brief Puts all the interpolated solids back where they really are.
+ *
+ * Solids that were moved in the meantime, such as by a render hook, are
+ *  left where they were moved to.
+ */
+void solid_interpolateEnd (void)
+{
+   int i;
+   SolidInterp *si;
+
+   if (solid_interp == NULL)
+      return;
+   for (i=array_size(solid_interp)-1; i>=0; i--) {
+      si = &solid_interp[i];
+      if ((si->s->pos.x == si->ipos.x) && (si->s->pos.y == si->ipos.y))
+         si->s->pos = si->pos;
+   }
+   array_erase( &solid_interp, array_begin(solid_interp), array_end(solid_interp) );
 }
 
@@ -31,6 +31,20 @@
  */
 #define SOLID_UPDATE_RK4      0 /**< Default Runge-Kutta 3-4 update. */
 #define SOLID_UPDATE_EULER    1 /**< Simple Euler update. */
+/**
+ * @brief Maximum relative difference between solid_updateBatch() and the
+ *        update method of a solid over a second of updates.
+ *
+ * Differences come from rounding, the batched Runge-Kutta update
+ *  rotates the direction incrementally instead of calling cos() and
+ *  sin() for every substep.
+ */
+#define SOLID_BATCH_TOLERANCE 1e-9
+/**
+ * @brief Largest distance a solid can move in an update and still be
+ *        interpolated, anything farther is considered a teleport.
+ */
+#define SOLID_INTERP_SNAP     500.
 
 
 /**
@@ -76,6 +90,7 @@ typedef struct Solid_ {
    double dir_dest; /**< Direction solid wants to face in rad. */
    Vector2d vel; /**< Velocity of the solid. */
    Vector2d pos; /**< Position of the solid. */
+   Vector2d pos_prev; /**< Position at the start of the last update, for interpolating. */
    double thrust; /**< Relative X force, basically simplified for our thrust model. */
    double speed_max; /**< Maximum speed. */
    void (*update)( struct Solid_*, const double ); /**< Update method. */
@@ -91,6 +106,11 @@ void solid_init( Solid* dest, const double mass, const double dir,
 Solid* solid_create( const double mass, const double dir,
       const Vector2d* pos, const Vector2d* vel, int update );
 void solid_free( Solid* src );
+void solid_updateBatch( Solid *const *solids, int n, const double dt );
+void solid_savePrev( Solid *s );
+void solid_interpolate( Solid *s, double alpha );
+void solid_interpolateEnd (void);
+void solid_exit (void);
 
 
 #endif /* PHYSICS_H */
@@ -47,6 +47,8 @@
 #include "pause.h"
 #include "player.h"
 #include "player_autonav.h"
+#include "pool.h"
+#include "profile.h"
 #include "rng.h"
 #include "weapon.h"
 
@@ -59,6 +61,7 @@ static pilotId_t pilot_id = PLAYER_ID; /**< Stack of pilot ids to assure uniquen
 
 /* stack of pilots */
 static Pilot **pilot_stack = NULL; /**< All the pilots in space. */
+static Pool *pilot_pool = NULL; /**< Memory of all the pilots. */
 
 
 /* misc */
@@ -80,13 +83,13 @@ static void pilot_hyperspace( Pilot* pilot, double dt );
 static void pilot_refuel( Pilot *p, double dt );
 /* Clean up. */
 static void pilot_dead(Pilot* p, pilotId_t killer);
-/* Targeting. */
-static int pilot_validEnemy( const Pilot* p, const Pilot* target );
 /* Misc. */
 static void pilot_setCommMsg( Pilot *p, const char *s );
 static int pilot_getStackPos(const pilotId_t id);
 static void pilot_init_trails( Pilot* p );
 static int pilot_trail_generated( Pilot* p, int generator );
+static void pilot_clear( Pilot *p );
+static void pilot_freeArrays( void *obj );
 
 
 /**
@@ -264,7 +267,7 @@ int pilot_validTarget( const Pilot* p, const Pilot* target )
  *    @param target Pilot to see if is a valid enemy of the reference.
  *    @return 1 if it is valid, 0 otherwise.
  */
-static int pilot_validEnemy( const Pilot* p, const Pilot* target )
+int pilot_validEnemy( const Pilot* p, const Pilot* target )
 {
    /* Should either be hostile by faction or by player. */
    if (!(areEnemies(p->faction, target->faction)
@@ -297,6 +300,83 @@ static int pilot_validEnemy( const Pilot* p, const Pilot* target )
 }
 
 
+/**
+ * @brief Spatial query cost of valid enemies.
+ */
+static double pilot_costEnemy( const Pilot *p, const Pilot *target,
+      double d2, const void *data )
+{
+   (void) data;
+   if (!pilot_validEnemy( p, target ))
+      return INFINITY;
+   return d2;
+}
+
+
+/**
+ * @brief Spatial query cost of valid enemies within a mass range.
+ *
+ * The data is the lower and upper bound of the mass.
+ */
+static double pilot_costEnemySize( const Pilot *p, const Pilot *target,
+      double d2, const void *data )
+{
+   const double *mass = data;
+   if ((target->solid->mass < mass[0]) || (target->solid->mass > mass[1]))
+      return INFINITY;
+   return pilot_costEnemy( p, target, d2, NULL );
+}
+
+
+/**
+ * @brief Spatial query cost of valid enemies by heuristic.
+ *
+ * The data is the mass, health, damage and range factors.
+ */
+static double pilot_costEnemyHeuristic( const Pilot *p, const Pilot *target,
+      double d2, const void *data )
+{
+   const double *f = data;
+   if (!pilot_validEnemy( p, target ))
+      return INFINITY;
+   return f[3] * d2
+         + FABS( pilot_relsize( p, target ) - f[0] )
+         + FABS( pilot_relhp(   p, target ) - f[1] )
+         + FABS( pilot_reldps(  p, target ) - f[2] );
+}
+
+
+/**
+ * @brief Spatial query cost of targets for pilot_getNearestPos().
+ *
+ * The data is whether disabled pilots are allowed.
+ */
+static double pilot_costTarget( const Pilot *p, const Pilot *target,
+      double d2, const void *data )
+{
+   int disabled = *(const int*) data;
+
+   /* Must not be self. */
+   if (target == p)
+      return INFINITY;
+
+   /* Player doesn't select escorts (unless disabled is active). */
+   if (!disabled && (p->faction == FACTION_PLAYER)
+         && (target->faction == FACTION_PLAYER))
+      return INFINITY;
+
+   /* Shouldn't be disabled. */
+   if (!disabled && pilot_isDisabled(target))
+      return INFINITY;
+
+   /* Must be a valid target. */
+   if (!pilot_validTarget( p, target ))
+      return INFINITY;
+
+   return d2;
+}
+
+
 /**
  * @brief Gets the nearest enemy to the pilot.
  *
@@ -306,23 +386,10 @@ static int pilot_validEnemy( const Pilot* p, const Pilot* target )
 pilotId_t pilot_getNearestEnemy(const Pilot* p)
 {
    pilotId_t tp;
-   int i;
-   double d, td;
-
-   tp = 0;
-   d  = 0.;
-   for (i=0; i<array_size(pilot_stack); i++) {
 
-      if (!pilot_validEnemy( p, pilot_stack[i] ))
-         continue;
-
-      /* Check distance. */
-      td = vect_dist2(&pilot_stack[i]->solid->pos, &p->solid->pos);
-      if (!tp || (td < d)) {
-         d  = td;
-         tp = pilot_stack[i]->id;
-      }
-   }
+   if (!pilot_gridNearest( p, p->solid->pos.x, p->solid->pos.y, -1.,
+            pilot_costEnemy, NULL, 1., &tp, NULL, 1 ))
+      return 0;
    return tp;
 }
 
@@ -338,27 +405,11 @@ pilotId_t pilot_getNearestEnemy_size(const Pilot* p, double target_mass_LB,
       double target_mass_UB)
 {
    pilotId_t tp;
-   int i;
-   double d, td;
-
-   tp = 0;
-   d  = 0.;
-   for (i=0; i<array_size(pilot_stack); i++) {
-
-      if (!pilot_validEnemy( p, pilot_stack[i] ))
-         continue;
-
-      if (pilot_stack[i]->solid->mass < target_mass_LB || pilot_stack[i]->solid->mass > target_mass_UB)
-         continue;
-
-      /* Check distance. */
-      td = vect_dist2(&pilot_stack[i]->solid->pos, &p->solid->pos);
-      if (!tp || (td < d)) {
-         d = td;
-         tp = pilot_stack[i]->id;
-      }
-   }
+   double mass[2] = { target_mass_LB, target_mass_UB };
 
+   if (!pilot_gridNearest( p, p->solid->pos.x, p->solid->pos.y, -1.,
+            pilot_costEnemySize, mass, 1., &tp, NULL, 1 ))
+      return 0;
    return tp;
 }
 
@@ -377,32 +428,14 @@ pilotId_t pilot_getNearestEnemy_heuristic(const Pilot* p,
       double damage_factor, double range_factor)
 {
    pilotId_t tp;
-   int i;
-   double temp, current_heuristic_value;
-   Pilot *target;
-
-   current_heuristic_value = 10000.;
-
-   tp = 0;
-   for (i=0; i<array_size(pilot_stack); i++) {
-      target = pilot_stack[i];
-
-      if (!pilot_validEnemy( p, target ))
-         continue;
-
-      /* Check distance. */
-      temp = range_factor *
-               vect_dist2( &target->solid->pos, &p->solid->pos )
-            + FABS( pilot_relsize( p, target ) - mass_factor )
-            + FABS( pilot_relhp(   p, target ) - health_factor )
-            + FABS( pilot_reldps(  p, target ) - damage_factor );
-
-      if ((tp == 0) || (temp < current_heuristic_value)) {
-         current_heuristic_value = temp;
-         tp = target->id;
-      }
-   }
+   double f[4] = { mass_factor, health_factor, damage_factor, range_factor };
 
+   /* The other terms are never negative, so the distance term bounds the
+    * heuristic from below and far away cells can be skipped. */
+   if (!pilot_gridNearest( p, p->solid->pos.x, p->solid->pos.y, -1.,
+            pilot_costEnemyHeuristic, f, MAX( range_factor, 0. ),
+            &tp, NULL, 1 ))
+      return 0;
    return tp;
 }
 
@@ -538,36 +571,12 @@ pilotId_t *pilot_getRecursiveFollowers(const Pilot *p)
 double pilot_getNearestPos(const Pilot *p, pilotId_t *tp,
       double x, double y, int disabled)
 {
-   int i;
-   double d, td;
-
-   *tp = PLAYER_ID;
-   d  = 0;
-   for (i=0; i<array_size(pilot_stack); i++) {
-
-      /* Must not be self. */
-      if (pilot_stack[i] == p)
-         continue;
-
-      /* Player doesn't select escorts (unless disabled is active). */
-      if (!disabled && (p->faction == FACTION_PLAYER)
-            && (pilot_stack[i]->faction == FACTION_PLAYER))
-         continue;
-
-      /* Shouldn't be disabled. */
-      if (!disabled && pilot_isDisabled(pilot_stack[i]))
-         continue;
+   double d;
 
-      /* Must be a valid target. */
-      if (!pilot_validTarget( p, pilot_stack[i] ))
-         continue;
-
-      /* Minimum distance. */
-      td = pow2(x-pilot_stack[i]->solid->pos.x) + pow2(y-pilot_stack[i]->solid->pos.y);
-      if (((*tp==PLAYER_ID) || (td < d))) {
-         d = td;
-         *tp = pilot_stack[i]->id;
-      }
+   if (!pilot_gridNearest( p, x, y, -1., pilot_costTarget, &disabled, 1.,
+            tp, &d, 1 )) {
+      *tp = PLAYER_ID;
+      return 0.;
    }
    return d;
 }
@@ -946,9 +955,10 @@ void pilot_cooldown( Pilot *p )
 
    /* Disable active outfits. */
    if (pilot_outfitOffAll( p ) > 0)
-      pilot_calcStats( p );
+      pilot_calcStatsActive( p );
 
    /* Calculate the ship's overall heat. */
+   pilot_heatSettle( p );
    heat_capacity = p->heat_C;
    heat_mean = p->heat_T * p->heat_C;
    for (i=0; i<array_size(p->outfits); i++) {
@@ -1754,7 +1764,7 @@ void pilot_updateDisable(Pilot* p, const pilotId_t shooter)
 
       /* Disable active outfits. */
       if (pilot_outfitOffAll( p ) > 0)
-         pilot_calcStats( p );
+         pilot_calcStatsActive( p );
 
       pilot_setFlag( p,PILOT_DISABLED ); /* set as disabled */
       /* Run hook */
@@ -1874,14 +1884,20 @@ void pilot_explode( double x, double y, double radius, const Damage *dmg, const
    double rx, ry;
    double dist, rad2;
    Pilot *p;
+   pilotId_t *hit;
    Solid s; /* Only need to manipulate mass and vel. */
    Damage ddmg;
 
    rad2 = radius*radius;
    ddmg = *dmg;
 
-   for (i=0; i<array_size(pilot_stack); i++) {
-      p = pilot_stack[i];
+   /* Ship size is taken into account, so look a bit further. */
+   hit = pilot_gridRadius( parent, x, y,
+         sqrt( rad2 + pow2( pilot_gridMaxSize() ) ), NULL, NULL );
+   for (i=0; i<array_size(hit); i++) {
+      p = pilot_get( hit[i] );
+      if (p == NULL)
+         continue;
 
       /* Calculate a bit. */
       rx = p->solid->pos.x - x;
@@ -1910,6 +1926,7 @@ void pilot_explode( double x, double y, double radius, const Damage *dmg, const
             spfx_shake( pow2(ddmg.damage) / pow2(100.) );
       }
    }
+   array_free( hit );
 }
 
 
@@ -2081,7 +2098,6 @@ void pilot_update( Pilot* pilot, double dt )
    char buf[16];
    PilotOutfitSlot *o;
    double angle;
-   double Q;
    Damage dmg;
    double rtmass;
    double stress_falloff;
@@ -2121,10 +2137,10 @@ void pilot_update( Pilot* pilot, double dt )
    for (i=0; i<MAX_AI_TIMERS; i++)
       if (pilot->timer[i] > 0.)
          pilot->timer[i] -= dt;
-   /* Update heat. */
+   /* Update outfits. */
    angle = -1.;
-   Q = 0.;
    changed = 0; /* Whether state changed, processed at the end. */
+   pilot_calcStatsBegin( pilot ); /* Reloads only change the mass once. */
    for (i=0; i<array_size(pilot->outfits); i++) {
       o = pilot->outfits[i];
       reload_time = 0;
@@ -2210,17 +2226,16 @@ void pilot_update( Pilot* pilot, double dt )
          }
       }
 
-      /* Handle heat. */
-      if (!cooling)
-         Q  += pilot_heatUpdateSlot( pilot, o, dt );
-
       /* Handle lockons. */
       pilot_lockUpdateSlot(pilot, o, target, &angle, dt);
    }
+   pilot_calcStatsEnd( pilot );
 
-   /* Global heat. */
+   /* Heat, the ship and its slots are updated together with all the other
+    * pilots by pilots_heatUpdate() at the end of the step, unless something
+    * needs the heat before that and settles it. */
    if (!cooling)
-      pilot_heatUpdateShip( pilot, Q, dt );
+      pilot_heatQueue( pilot, dt );
    else
       pilot_heatUpdateCooldown( pilot );
 
@@ -2348,6 +2363,7 @@ void pilot_update( Pilot* pilot, double dt )
              */
             pilot->solid->speed_max = 0.;
             pilot->solid->update( pilot->solid, dt );
+            pilot_gridMoved( pilot );
 
             if (VMOD(pilot->solid->vel) < 1e-1) {
                vectnull( &pilot->solid->vel ); /* Forcibly zero velocity. */
@@ -2388,7 +2404,7 @@ void pilot_update( Pilot* pilot, double dt )
 
       /* Must recalculate stats because something changed state. */
       if (changed)
-         pilot_calcStats(pilot);
+         pilot_calcStatsActive(pilot);
    }
 
    /* purpose fallthrough to get the movement like disabled */
@@ -2400,6 +2416,7 @@ void pilot_update( Pilot* pilot, double dt )
 
       /* update the solid */
       pilot->solid->update( pilot->solid, dt );
+      pilot_gridMoved( pilot );
       gl_getSpriteFromDir( &pilot->tsx, &pilot->tsy,
             pilot->ship->gfx_space, pilot->solid->dir );
 
@@ -2493,8 +2510,10 @@ void pilot_update( Pilot* pilot, double dt )
          pilot->engine_glow = 0.;
    }
 
-   /* Update the solid, must be run after limit_speed. */
+   /* Update the solid, must be run after limit_speed. Hooks run later in
+    * the update may already query the grid. */
    pilot->solid->update( pilot->solid, dt );
+   pilot_gridMoved( pilot );
    gl_getSpriteFromDir( &pilot->tsx, &pilot->tsy,
          pilot->ship->gfx_space, pilot->solid->dir );
 
@@ -3002,7 +3021,7 @@ static void pilot_init(Pilot* pilot, const Ship* ship, const char* name,
    ShipOutfitSlot *ship_list[] = { ship->outfit_structure, ship->outfit_utility, ship->outfit_weapon };
 
    /* Clear memory. */
-   memset(pilot, 0, sizeof(Pilot));
+   pilot_clear( pilot );
 
    if (pilot_isFlagRaw(flags, PILOT_PLAYER)) /* Set player ID. TODO should probably be fixed to something better someday. */
       pilot->id = PLAYER_ID;
@@ -3041,6 +3060,12 @@ static void pilot_init(Pilot* pilot, const Ship* ship, const char* name,
    pilot->ship = ship;
    pilot->name = strdup((name == NULL) ? _(ship->name) : name);
 
+   /* Ship graphics are lazy, sprite collisions need them right away. */
+   if (array_size(ship->polygon) == 0)
+      ship_gfxLoad( ship );
+   else
+      ship_gfxPrefetch( ship );
+
    /* faction */
    pilot->faction = faction;
 
@@ -3055,11 +3080,18 @@ static void pilot_init(Pilot* pilot, const Ship* ship, const char* name,
    pilot_calcStats(pilot);
    pilot->stress = 0.; /* No stress. */
 
-   /* Allocate outfit memory. */
-   pilot->outfits = array_create(PilotOutfitSlot*);
+   /* Allocate outfit memory, reusing the arrays of a previous pilot. */
+   if (pilot->outfits == NULL)
+      pilot->outfits = array_create(PilotOutfitSlot*);
    /* First pass copy data. */
    for (i=0; i<3; i++) {
-      *pilot_list_ptr[i] = array_create_size( PilotOutfitSlot, array_size(ship_list[i]) );
+      /* Reserve all the slots so pointers to them stay valid. */
+      if (*pilot_list_ptr[i] == NULL)
+         *pilot_list_ptr[i] = array_create_size( PilotOutfitSlot, array_size(ship_list[i]) );
+      else {
+         array_resize( pilot_list_ptr[i], array_size(ship_list[i]) );
+         array_clear( *pilot_list_ptr[i] );
+      }
       for (j=0; j<array_size(ship_list[i]); j++) {
          slot = &array_grow( pilot_list_ptr[i] );
          memset( slot, 0, sizeof(PilotOutfitSlot) );
@@ -3073,7 +3105,6 @@ static void pilot_init(Pilot* pilot, const Ship* ship, const char* name,
             pilot_addOutfitRaw( pilot, slot->sslot->data, slot );
       }
    }
-   array_shrink( &pilot->outfits );
 
    /* We must set the weapon auto in case some of the outfits had a default
     * weapon equipped. */
@@ -3182,7 +3213,6 @@ static void pilot_init_trails( Pilot* p )
    for (int g=0; g<n; g++)
       if (pilot_trail_generated( p, g ))
          array_push_back( &p->trail, spfx_trail_create( p->ship->trail_emitters[g].trail_spec ) );
-   array_shrink( &p->trail );
 }
 
 
@@ -3203,15 +3233,12 @@ pilotId_t pilot_create(const Ship* ship, const char* name,
    Pilot *dyn, **p;
 
    /* Allocate pilot memory. */
-   dyn = malloc(sizeof(Pilot));
-   if (dyn == NULL) {
-      WARN(_("Unable to allocate memory"));
-      return 0;
-   }
+   dyn = pool_alloc( pilot_pool );
 
    /* Set the pilot in the stack -- must be there before initializing */
    p = &array_grow( &pilot_stack );
    *p = dyn;
+   pilot_gridDirty();
 
    /* Initialize the pilot. */
    pilot_init( dyn, ship, name, faction, ai, dir, pos, vel, flags, dockpilot, dockslot );
@@ -3237,11 +3264,7 @@ Pilot* pilot_createEmpty(const Ship* ship, const char* name,
       factionId_t faction, const char *ai, PilotFlags flags)
 {
    Pilot* dyn;
-   dyn = malloc(sizeof(Pilot));
-   if (dyn == NULL) {
-      WARN(_("Unable to allocate memory"));
-      return 0;
-   }
+   dyn = pool_alloc( pilot_pool );
    pilot_setFlagRaw( flags, PILOT_EMPTY );
    pilot_init( dyn, ship, name, faction, ai, 0., NULL, NULL, flags, 0, 0 );
    return dyn;
@@ -3366,11 +3389,6 @@ void pilot_free( Pilot* p )
 
    pilot_weapSetFree(p);
 
-   array_free(p->outfits);
-   array_free(p->outfit_structure);
-   array_free(p->outfit_utility);
-   array_free(p->outfit_weapon);
-
    pilot_cargoRmAll( p, 1 );
 
    /* Clean up data. */
@@ -3396,13 +3414,59 @@ void pilot_free( Pilot* p )
       p->trail[i]->ontop = 0;
       spfx_trail_remove( p->trail[i] );
    }
-   array_free(p->trail);
 
-#ifdef DEBUGGING
+   /* The outfit and trail arrays are kept for the next pilot. */
+   pilot_clear( p );
+   pool_free( pilot_pool, p );
+}
+
+
+/**
+ * @brief Zeroes a pilot, keeping its outfit and trail arrays emptied for reuse.
+ *
+ *    @param p Pilot to clear.
+ */
+static void pilot_clear( Pilot *p )
+{
+   PilotOutfitSlot **outfits = p->outfits;
+   PilotOutfitSlot *outfit_structure = p->outfit_structure;
+   PilotOutfitSlot *outfit_utility = p->outfit_utility;
+   PilotOutfitSlot *outfit_weapon = p->outfit_weapon;
+   Trail_spfx **trail = p->trail;
+
    memset( p, 0, sizeof(Pilot) );
-#endif /* DEBUGGING */
 
-   free(p);
+   p->outfits = outfits;
+   p->outfit_structure = outfit_structure;
+   p->outfit_utility = outfit_utility;
+   p->outfit_weapon = outfit_weapon;
+   p->trail = trail;
+   if (p->outfits != NULL)
+      array_clear( p->outfits );
+   if (p->outfit_structure != NULL)
+      array_clear( p->outfit_structure );
+   if (p->outfit_utility != NULL)
+      array_clear( p->outfit_utility );
+   if (p->outfit_weapon != NULL)
+      array_clear( p->outfit_weapon );
+   if (p->trail != NULL)
+      array_clear( p->trail );
+}
+
+
+/**
+ * @brief Frees the arrays kept by a pilot in the pool.
+ *
+ *    @param obj Pilot to free arrays of.
+ */
+static void pilot_freeArrays( void *obj )
+{
+   Pilot *p = obj;
+   array_free(p->outfits);
+   array_free(p->outfit_structure);
+   array_free(p->outfit_utility);
+   array_free(p->outfit_weapon);
+   array_free(p->trail);
 }
 
 
@@ -3439,6 +3503,7 @@ void pilot_destroy(Pilot* p)
    /* pilot is eliminated */
    pilot_free(p);
    array_erase( &pilot_stack, &pilot_stack[i], &pilot_stack[i+1] );
+   pilot_gridDirty();
 }
 
 
@@ -3448,6 +3513,7 @@ void pilot_destroy(Pilot* p)
 void pilots_init (void)
 {
    pilot_stack = array_create_size( Pilot*, PILOT_SIZE_MIN );
+   pilot_pool = pool_create( sizeof(Pilot), PILOT_SIZE_MIN );
 }
 
 
@@ -3472,7 +3538,12 @@ void pilots_free (void)
    }
    array_free(pilot_stack);
    pilot_stack = NULL;
+   pilot_gridFree();
+   pilot_ewCacheFree();
+   pilots_heatFree();
    player.p = NULL;
+   pool_destroy( pilot_pool, pilot_freeArrays );
+   pilot_pool = NULL;
 }
 
 
@@ -3523,6 +3594,7 @@ void pilots_clean( int persist )
          pilot_free(pilot_stack[i]);
    }
    array_erase(&pilot_stack, &pilot_stack[persist_count], array_end(pilot_stack));
+   pilot_gridDirty();
 
    /* Clear global hooks. */
    pilots_clearGlobalHooks();
@@ -3564,6 +3636,7 @@ void pilots_cleanAll (void)
       player.p = NULL;
    }
    array_erase( &pilot_stack, array_begin(pilot_stack), array_end(pilot_stack) );
+   pilot_gridDirty();
 }
 
 
@@ -3591,6 +3664,7 @@ void pilots_update( double dt )
    }
 
    /* Now update all the pilots. */
+   PROFILE_BEGIN( PROFILE_AI );
    for (i=0; i<array_size(pilot_stack); i++) {
       p = pilot_stack[i];
 
@@ -3623,9 +3697,15 @@ void pilots_update( double dt )
             !pilot_isFlag(p, PILOT_REFUELBOARDING) &&
             /* Must not be landing nor taking off. */
             !pilot_isFlag(p, PILOT_LANDING) &&
-            !pilot_isFlag(p, PILOT_TAKEOFF))
-         p->think(p, dt);
+            !pilot_isFlag(p, PILOT_TAKEOFF)) {
+         /* Far away pilots can get by with less. */
+         if (pilot_lodCheck(p))
+            pilot_lodThink(p, dt);
+         else
+            p->think(p, dt);
+      }
    }
+   PROFILE_END( PROFILE_AI );
 
    /* Now update all the pilots. */
    for (i=0; i<array_size(pilot_stack); i++) {
@@ -3640,9 +3720,43 @@ void pilots_update( double dt )
          continue;
 
       /* Just update the pilot. */
-      if (p->update) /* update */
+      if (p->update) { /* update */
          p->update( p, dt );
+         pilot_gridMoved( p );
+      }
    }
+
+   /* Heat of all the pilots that were updated and not settled since. */
+   pilots_heatUpdate();
+
+   /* Pilots moved, the spatial index is rebuilt on the next query and
+    * sensor checks must be done again. */
+   pilot_gridDirty();
+   pilot_ewCacheClear();
+}
+
+
+/**
+ * @brief Remembers where all the pilots are before an update.
+ */
+void pilots_savePrev (void)
+{
+   int i;
+   for (i=0; i<array_size(pilot_stack); i++)
+      solid_savePrev( pilot_stack[i]->solid );
+}
+
+
+/**
+ * @brief Moves all the pilots between their last two updates for drawing.
+ *
+ *    @param alpha Fraction of the way from the previous update to the last.
+ */
+void pilots_interpolate( double alpha )
+{
+   int i;
+   for (i=0; i<array_size(pilot_stack); i++)
+      solid_interpolate( pilot_stack[i]->solid, alpha );
 }
 
 
@@ -3654,6 +3768,7 @@ void pilots_update( double dt )
 void pilots_render( double dt )
 {
    int i;
+   gl_batchBegin();
    for (i=0; i<array_size(pilot_stack); i++) {
 
       /* Invisible, not doing anything. */
@@ -3663,6 +3778,7 @@ void pilots_render( double dt )
       if (pilot_stack[i]->render != NULL) /* render */
          pilot_stack[i]->render(pilot_stack[i], dt);
    }
+   gl_batchEnd();
 }
 
 
@@ -3719,7 +3835,7 @@ void pilot_clearTimers( Pilot *pilot )
 
    /* Must recalculate stats. */
    if (n > 0)
-      pilot_calcStats( pilot );
+      pilot_calcStatsActive( pilot );
 }
 
 
@@ -276,10 +276,15 @@ typedef struct Pilot_ {
    double cdelay;    /**< Duration a full active cooldown takes. */
    double ctimer;    /**< Remaining cooldown time. */
    double heat_start; /**< Temperature at the start of a cooldown. */
+   int heat_queued;  /**< Index in the heat queue plus one, 0 if the heat is up to date. */
 
    /* Ship statistics. */
    ShipStats intrinsic_stats; /**< Intrinsic statistics to the ship create on the fly. */
    ShipStats stats;  /**< Pilot's copy of ship statistics. */
+   ShipStats stats_passive; /**< Statistics of the ship and the outfits that can't be turned on or off. */
+   int stats_passive_ok; /**< Whether stats_passive is up to date. */
+   int stats_batch;  /**< Nesting level of pilot_calcStatsBegin(). */
+   int stats_dirty;  /**< Whether stats changed during the batch. */
 
    /* Associated functions */
    void (*think)(struct Pilot_*, const double); /**< AI thinking for the pilot */
@@ -352,6 +357,8 @@ typedef struct Pilot_ {
    double sbonus;    /**< Shield regeneration bonus. */
    double dtimer;    /**< Disable timer. */
    double dtimer_accum; /**< Accumulated disable timer. */
+   double lod_timer; /**< Time until the next AI think in low detail. */
+   double lod_dir; /**< Direction the AI last wanted to face in low detail, INFINITY if none. */
    int hail_pos;     /**< Hail animation position. */
    int lockons;      /**< Stores how many seeking weapons are targeting pilot */
    int projectiles;      /**< Stores how many weapons are after the pilot */
@@ -369,6 +376,8 @@ typedef struct Pilot_ {
 #include "pilot_outfit.h"
 #include "pilot_weapon.h"
 #include "pilot_ew.h"
+#include "pilot_grid.h"
+#include "pilot_lod.h"
 
 
 /*
@@ -395,6 +404,7 @@ double pilot_getNearestAng(const Pilot *p, pilotId_t *tp, double ang,
 int pilot_getJumps( const Pilot* p );
 const glColour* pilot_getColour( const Pilot* p );
 int pilot_validTarget( const Pilot* p, const Pilot* target );
+int pilot_validEnemy( const Pilot* p, const Pilot* target );
 
 /* non-lua wrappers */
 double pilot_relsize( const Pilot* cur_pilot, const Pilot* p );
@@ -478,6 +488,8 @@ void pilot_setTurn( Pilot *p, double turn );
  */
 void pilot_update( Pilot* pilot, double dt );
 void pilots_update( double dt );
+void pilots_savePrev (void);
+void pilots_interpolate( double alpha );
 void pilots_render( double dt );
 void pilots_renderOverlay( double dt );
 void pilot_render( Pilot* pilot, const double dt );
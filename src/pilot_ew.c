@@ -7,6 +7,12 @@
  * @file pilot_ew.c
  *
  * @brief Pilot electronic warfare information.
+ *
+ * Whether a pilot sees another is asked many times per frame by the AI,
+ *  targeting, weapons, the GUI and Lua. The answers are memoized in a
+ *  hash table of pilot pairs which is invalidated with
+ *  pilot_ewCacheClear() whenever pilots move or their visibility flags
+ *  change.
  */
 
 
@@ -24,6 +30,122 @@
 #include "space.h"
 
 
+#define EW_CACHE_MIN    1024 /**< Initial number of slots of the sensor cache. */
+
+
+/**
+ * @brief Memoized result of pilot_inRangePilot().
+ */
+typedef struct EWCacheEntry_ {
+   pilotId_t p; /**< Pilot looking. */
+   pilotId_t target; /**< Pilot looked at. */
+   unsigned int gen; /**< Generation the entry was stored in, stale if not current. */
+   int res; /**< Result of the check. */
+   double dist; /**< Distance between the pilots. */
+} EWCacheEntry;
+
+
+static EWCacheEntry *ew_cache = NULL; /**< Open addressing hash table of results. */
+static int ew_cacheSize = 0; /**< Number of slots, a power of two. */
+static int ew_cacheUsed = 0; /**< Slots used by the current generation. */
+static unsigned int ew_cacheGen = 1; /**< Current generation. */
+static unsigned long ew_cacheHits = 0; /**< Lookups answered from the cache. */
+static unsigned long ew_cacheMisses = 0; /**< Lookups that had to be computed. */
+
+
+/*
+ * Prototypes.
+ */
+static int pilot_inRangePilotCompute( const Pilot *p, const Pilot *target,
+      double *dist );
+static EWCacheEntry* pilot_ewCacheSlot( pilotId_t p, pilotId_t target );
+static void pilot_ewCacheGrow (void);
+
+
+/**
+ * @brief Invalidates all the memoized sensor results.
+ */
+void pilot_ewCacheClear (void)
+{
+   ew_cacheUsed = 0;
+   ew_cacheGen++;
+   /* Generation wrapped around, old entries could look current. */
+   if (ew_cacheGen == 0) {
+      if (ew_cache != NULL)
+         memset( ew_cache, 0, ew_cacheSize * sizeof(EWCacheEntry) );
+      ew_cacheGen = 1;
+   }
+}
+
+
+/**
+ * @brief Frees the sensor cache.
+ */
+void pilot_ewCacheFree (void)
+{
+   free( ew_cache );
+   ew_cache = NULL;
+   ew_cacheSize = 0;
+   ew_cacheUsed = 0;
+}
+
+
+/**
+ * @brief Gets the cache statistics.
+ *
+ *    @param[out] hits Lookups answered from the cache since the start.
+ *    @param[out] misses Lookups that had to be computed since the start.
+ */
+void pilot_ewCacheStats( unsigned long *hits, unsigned long *misses )
+{
+   *hits = ew_cacheHits;
+   *misses = ew_cacheMisses;
+}
+
+
+/**
+ * @brief Finds the slot of a pilot pair, either its entry or the free slot
+ *        to store it in.
+ */
+static EWCacheEntry* pilot_ewCacheSlot( pilotId_t p, pilotId_t target )
+{
+   unsigned int h;
+   EWCacheEntry *e;
+
+   h = (p * 0x9E3779B1U) ^ (target * 0x85EBCA77U);
+   h ^= h >> 15;
+   for (;;h++) {
+      e = &ew_cache[ h & (ew_cacheSize-1) ];
+      if (e->gen != ew_cacheGen)
+         return e;
+      if ((e->p == p) && (e->target == target))
+         return e;
+   }
+}
+
+
+/**
+ * @brief Doubles the size of the sensor cache, keeping current entries.
+ */
+static void pilot_ewCacheGrow (void)
+{
+   int i, oldsize;
+   EWCacheEntry *old, *e;
+
+   old = ew_cache;
+   oldsize = ew_cacheSize;
+   ew_cacheSize = (oldsize > 0) ? 2*oldsize : EW_CACHE_MIN;
+   ew_cache = calloc( ew_cacheSize, sizeof(EWCacheEntry) );
+   for (i=0; i<oldsize; i++) {
+      if (old[i].gen != ew_cacheGen)
+         continue;
+      e = pilot_ewCacheSlot( old[i].p, old[i].target );
+      *e = old[i];
+   }
+   free( old );
+}
+
+
 
 /**
  * @brief Check to see if a position is in range of the pilot.
@@ -57,6 +179,38 @@ int pilot_inRange( const Pilot *p, double x, double y )
  *    @return 1 if they are in range, 0 if they aren't and -1 if they are detected fuzzily.
  */
 int pilot_inRangePilot( const Pilot *p, const Pilot *target, double *dist)
+{
+   EWCacheEntry *e;
+
+   /* Keep the load factor under a half. */
+   if (2*(ew_cacheUsed+1) > ew_cacheSize)
+      pilot_ewCacheGrow();
+
+   e = pilot_ewCacheSlot( p->id, target->id );
+   if (e->gen == ew_cacheGen) {
+      ew_cacheHits++;
+      if (dist != NULL)
+         *dist = e->dist;
+      return e->res;
+   }
+
+   ew_cacheMisses++;
+   ew_cacheUsed++;
+   e->p = p->id;
+   e->target = target->id;
+   e->gen = ew_cacheGen;
+   e->res = pilot_inRangePilotCompute( p, target, &e->dist );
+   if (dist != NULL)
+      *dist = e->dist;
+   return e->res;
+}
+
+
+/**
+ * @brief Does the actual sensor check of pilot_inRangePilot().
+ */
+static int pilot_inRangePilotCompute( const Pilot *p, const Pilot *target,
+      double *dist )
 {
    double d, sense, tempmod;
 
@@ -71,6 +225,7 @@ int pilot_inRangePilot( const Pilot *p, const Pilot *target, double *dist)
          target->parent == p->id)
       return 1;
    
+   pilot_heatSettle( target );
    tempmod = (1 - ((target->heat_T-CONST_SPACE_STAR_TEMP)
             / (target->heat_C-CONST_SPACE_STAR_TEMP)));
 
@@ -131,7 +286,6 @@ int pilot_inRangePlanet( const Pilot *p, int target )
 int pilot_inRangeAsteroid( const Pilot *p, int ast, int fie )
 {
    double d;
-   Asteroid *as;
    AsteroidAnchor *f;
    double sense;
 
@@ -141,10 +295,10 @@ int pilot_inRangeAsteroid( const Pilot *p, int ast, int fie )
 
    /* Get the asteroid. */
    f = &cur_system->asteroids[fie];
-   as = &f->asteroids[ast];
 
    /* Get distance. */
-   d = vect_dist(&p->solid->pos, &as->pos);
+   d = MOD( p->solid->pos.x - f->motion.x[ast],
+         p->solid->pos.y - f->motion.y[ast] );
 
    sense = p->rdr_range * cur_system->rdr_range_mod;
    if (d < sense)
@@ -216,8 +370,10 @@ double pilot_weaponTrack(
    if ((p == NULL) || (t == NULL))
       return 0.;
 
-   d = vect_dist(&p->solid->pos, &t->solid->pos);
-   
+   /* The distance is usually already known from the sensor check. */
+   pilot_inRangePilot( p, t, &d );
+
+   pilot_heatSettle( t );
    tempmod = (1 - ((t->heat_T-CONST_SPACE_STAR_TEMP)
             / (t->heat_C-CONST_SPACE_STAR_TEMP)));
    mod = (cur_system->rdr_range_mod * p->stats.rdr_range_mod
@@ -20,6 +20,13 @@ int pilot_inRangePlanet( const Pilot *p, int target );
 int pilot_inRangeAsteroid( const Pilot *p, int ast, int fie );
 int pilot_inRangeJump( const Pilot *p, int target );
 
+/*
+ * Sensor cache.
+ */
+void pilot_ewCacheClear (void);
+void pilot_ewCacheFree (void);
+void pilot_ewCacheStats( unsigned long *hits, unsigned long *misses );
+
 /*
  * Weapon tracking.
  */
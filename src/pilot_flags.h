@@ -84,6 +84,7 @@ enum {
    PILOT_BRAKING,       /**< Pilot is braking. */
    PILOT_PERSIST,       /**< Persist pilot on jump. */
    PILOT_NOCLEAR,       /**< Pilot isn't removed by pilots_clear(). */
+   PILOT_LOD,           /**< Pilot is simulated in low detail. */
    /* Sentinal. */
    PILOT_FLAGS_MAX      /**< Maximum number of flags. */
 };
@@ -0,0 +1,362 @@
+/*
+ * See Licensing and Copyright notice in naev.h
+ */
+
+
+/**
+ * @file pilot_grid.c
+ *
+ * @brief Spatial index of the pilots for nearest and radius queries.
+ *
+ * The pilots are binned into a uniform grid covering their bounding box,
+ *  stored as one array of pilots sorted by cell plus the start of every
+ *  cell. The grid is rebuilt lazily by the first query after it was
+ *  marked dirty, which happens when pilots move, appear or disappear.
+ *
+ * Queries search the cells in rings of growing distance around the query
+ *  position and stop as soon as no pilot in the remaining rings can beat
+ *  the ones already found, so finding the nearest enemy in a crowded
+ *  system only looks at the pilots around it. Distances and filters
+ *  always use the current state of the pilots.
+ *
+ * While the pilots are updated one after the other, the grid isn't rebuilt.
+ *  Instead pilot_gridMoved() keeps track of how far the pilots moved since
+ *  it was built, and queries search that much farther so explosions and
+ *  the like still find every pilot in range.
+ */
+
+
+/** @cond */
+#include <math.h>
+
+#include "naev.h"
+/** @endcond */
+
+#include "pilot_grid.h"
+
+#include "array.h"
+#include "log.h"
+
+
+#define PGRID_CELL      2048. /**< Smallest size of a cell. */
+#define PGRID_MAXDIM    64 /**< Largest number of cells along an axis. */
+
+
+static int pgrid_dirty = 1; /**< Whether the grid has to be rebuilt. */
+static double pgrid_x0 = 0.; /**< Left edge of the grid. */
+static double pgrid_y0 = 0.; /**< Bottom edge of the grid. */
+static double pgrid_cell = PGRID_CELL; /**< Size of the cells. */
+static double pgrid_size = 0.; /**< Largest sprite width of the pilots. */
+static double pgrid_slack = 0.; /**< Farthest a pilot moved since the grid was built. */
+static int pgrid_w = 0; /**< Number of columns. */
+static int pgrid_h = 0; /**< Number of rows. */
+static int *pgrid_start = NULL; /**< Array (array.h): Start of each cell in pgrid_pilots, plus the end. */
+static int *pgrid_cellOf = NULL; /**< Array (array.h): Cell of each pilot in the stack during rebuilds. */
+static Pilot **pgrid_pilots = NULL; /**< Array (array.h): Pilots sorted by cell. */
+
+
+/*
+ * Prototypes.
+ */
+static void pilot_gridBuild (void);
+static int pilot_gridCoord( double v, double v0, int n );
+static int pilot_gridCmpId( const void *p1, const void *p2 );
+
+
+/**
+ * @brief Marks the grid as outdated so the next query rebuilds it.
+ *
+ * Must be called whenever pilots are added to or removed from the stack,
+ *  and should be called when they move.
+ */
+void pilot_gridDirty (void)
+{
+   pgrid_dirty = 1;
+}
+
+
+/**
+ * @brief Notes that a pilot was moved by its update.
+ *
+ * Must be called after each pilot update that doesn't mark the grid dirty,
+ *  with the position of the pilot at the start of the step still in
+ *  pos_prev.
+ *
+ *    @param p Pilot that moved.
+ */
+void pilot_gridMoved( const Pilot *p )
+{
+   double d;
+   if (pgrid_dirty)
+      return;
+   d = MOD( p->solid->pos.x - p->solid->pos_prev.x,
+         p->solid->pos.y - p->solid->pos_prev.y );
+   /* Also catches NaN positions. */
+   if (!(d <= pgrid_slack))
+      pgrid_slack = isfinite(d) ? d : INFINITY;
+}
+
+
+/**
+ * @brief Frees the grid.
+ */
+void pilot_gridFree (void)
+{
+   array_free( pgrid_start );
+   pgrid_start = NULL;
+   array_free( pgrid_cellOf );
+   pgrid_cellOf = NULL;
+   array_free( pgrid_pilots );
+   pgrid_pilots = NULL;
+   pgrid_dirty = 1;
+}
+
+
+/**
+ * @brief Gets the cell coordinate of a position along an axis.
+ */
+static int pilot_gridCoord( double v, double v0, int n )
+{
+   double c = floor( (v - v0) / pgrid_cell );
+   /* Also catches NaN positions. */
+   if (!(c >= 0.))
+      return 0;
+   if (c >= (double)n)
+      return n-1;
+   return (int)c;
+}
+
+
+/**
+ * @brief Rebuilds the grid from the pilot stack.
+ */
+static void pilot_gridBuild (void)
+{
+   int i, n, c, ncells;
+   double x0, y0, x1, y1, ext;
+   Pilot *const *pilot_stack;
+   const Vector2d *pos;
+
+   pilot_stack = pilot_getAll();
+   n = array_size( pilot_stack );
+
+   /* Bounding box. */
+   x0 = y0 = x1 = y1 = 0.;
+   pgrid_size = 0.;
+   for (i=0; i<n; i++) {
+      pgrid_size = MAX( pgrid_size, pilot_stack[i]->ship->gfx_space->sw );
+      pos = &pilot_stack[i]->solid->pos;
+      if (i==0) {
+         x0 = x1 = pos->x;
+         y0 = y1 = pos->y;
+         continue;
+      }
+      x0 = MIN( x0, pos->x );
+      x1 = MAX( x1, pos->x );
+      y0 = MIN( y0, pos->y );
+      y1 = MAX( y1, pos->y );
+   }
+   ext = MAX( x1-x0, y1-y0 );
+   pgrid_cell = isfinite(ext) ? MAX( PGRID_CELL, ext / PGRID_MAXDIM ) : PGRID_CELL;
+   pgrid_x0 = isfinite(x0) ? x0 : 0.;
+   pgrid_y0 = isfinite(y0) ? y0 : 0.;
+   pgrid_w = isfinite(ext) ? MIN( PGRID_MAXDIM, (int)((x1-x0) / pgrid_cell) + 1 ) : 1;
+   pgrid_h = isfinite(ext) ? MIN( PGRID_MAXDIM, (int)((y1-y0) / pgrid_cell) + 1 ) : 1;
+   ncells = pgrid_w * pgrid_h;
+
+   /* Counting sort of the pilots by cell. */
+   if (pgrid_start == NULL) {
+      pgrid_start = array_create( int );
+      pgrid_cellOf = array_create( int );
+      pgrid_pilots = array_create( Pilot* );
+   }
+   array_resize( &pgrid_start, ncells+1 );
+   array_resize( &pgrid_cellOf, n );
+   array_resize( &pgrid_pilots, n );
+   memset( pgrid_start, 0, (ncells+1) * sizeof(int) );
+   for (i=0; i<n; i++) {
+      pos = &pilot_stack[i]->solid->pos;
+      c = pilot_gridCoord( pos->y, pgrid_y0, pgrid_h ) * pgrid_w
+            + pilot_gridCoord( pos->x, pgrid_x0, pgrid_w );
+      pgrid_cellOf[i] = c;
+      pgrid_start[c+1]++;
+   }
+   for (c=0; c<ncells; c++)
+      pgrid_start[c+1] += pgrid_start[c];
+   /* Fill from the back so each cell stays in stack order. */
+   for (i=n-1; i>=0; i--)
+      pgrid_pilots[ --pgrid_start[ pgrid_cellOf[i]+1 ] ] = pilot_stack[i];
+   /* The starts ended up one entry late, move them back. */
+   for (c=0; c<ncells; c++)
+      pgrid_start[c] = pgrid_start[c+1];
+   pgrid_start[ncells] = n;
+
+   pgrid_dirty = 0;
+   pgrid_slack = 0.;
+}
+
+
+/**
+ * @brief Finds the pilots with the lowest cost around a position.
+ *
+ * The cost is usually the squared distance, but may be anything as long
+ *  as it's never lower than dscale times the squared distance, which is
+ *  what allows skipping far away cells. Ties are broken by lower ID, like
+ *  a linear scan of the stack would.
+ *
+ *    @param p Pilot doing the query, passed to the cost function.
+ *    @param x X position to search from.
+ *    @param y Y position to search from.
+ *    @param rmax Only consider pilots closer than this, negative for no
+ *           limit.
+ *    @param cost Cost function, also used to filter pilots.
+ *    @param data User data for the cost function.
+ *    @param dscale Lower bound of the cost relative to the squared
+ *           distance, 0 to search the whole grid.
+ *    @param[out] out IDs of the pilots found, from lowest cost.
+ *    @param[out] costs Costs of the pilots found (may be NULL if k is 1).
+ *    @param k Number of pilots to find.
+ *    @return Number of pilots found (at most k).
+ */
+int pilot_gridNearest( const Pilot *p, double x, double y, double rmax,
+      PilotCost cost, const void *data, double dscale,
+      pilotId_t *out, double *costs, int k )
+{
+   int r, rlim, i, j, l, m, n, cx, cy, step;
+   double lb, d2, c, cost1;
+   Pilot *t;
+
+   if (k <= 0)
+      return 0;
+   if (costs == NULL) {
+      if (k > 1) {
+         WARN( _("Nearest pilot query for %d pilots without costs!"), k );
+         k = 1;
+      }
+      costs = &cost1;
+   }
+   if (pgrid_dirty)
+      pilot_gridBuild();
+
+   n = 0;
+   cx = pilot_gridCoord( x, pgrid_x0, pgrid_w );
+   cy = pilot_gridCoord( y, pgrid_y0, pgrid_h );
+   rlim = MAX( MAX( cx, pgrid_w-1-cx ), MAX( cy, pgrid_h-1-cy ) );
+   for (r=0; r<=rlim; r++) {
+      /* Nothing in this ring can be closer than its inner edge. If the
+       * position is outside of the grid, its projection on the grid is in
+       * the centre cell and is closer to everything. */
+      lb = (r > 0) ? MAX( 0., (double)(r-1) * pgrid_cell - pgrid_slack ) : 0.;
+      if ((rmax >= 0.) && (lb > rmax))
+         break;
+      if ((n == k) && (dscale > 0.) && (costs[k-1] < dscale*lb*lb))
+         break;
+
+      for (j=MAX(cy-r,0); j<=MIN(cy+r,pgrid_h-1); j++) {
+         /* Whole row on the edges of the ring, just both ends otherwise. */
+         step = ((j == cy-r) || (j == cy+r)) ? 1 : 2*r;
+         for (i=cx-r; i<=cx+r; i+=step) {
+            if ((i < 0) || (i >= pgrid_w))
+               continue;
+            for (l=pgrid_start[j*pgrid_w+i]; l<pgrid_start[j*pgrid_w+i+1]; l++) {
+               t = pgrid_pilots[l];
+               d2 = pow2(x - t->solid->pos.x) + pow2(y - t->solid->pos.y);
+               if ((rmax >= 0.) && (d2 >= rmax*rmax))
+                  continue;
+               c = cost( p, t, d2, data );
+               if (!(c < INFINITY))
+                  continue;
+
+               /* Insert sorted by cost, then by ID. */
+               if ((n == k) && ((c > costs[k-1])
+                        || ((c == costs[k-1]) && (t->id > out[k-1]))))
+                  continue;
+               m = (n < k) ? n++ : k-1;
+               while ((m > 0) && ((c < costs[m-1])
+                        || ((c == costs[m-1]) && (t->id < out[m-1])))) {
+                  costs[m] = costs[m-1];
+                  out[m] = out[m-1];
+                  m--;
+               }
+               costs[m] = c;
+               out[m] = t->id;
+            }
+         }
+      }
+   }
+   return n;
+}
+
+
+/**
+ * @brief Gets the largest sprite width of the pilots in the grid.
+ *
+ * Useful to extend radius queries for tests that take the ship size into
+ *  account.
+ */
+double pilot_gridMaxSize (void)
+{
+   if (pgrid_dirty)
+      pilot_gridBuild();
+   return pgrid_size;
+}
+
+
+/**
+ * @brief Compares pilot IDs for qsort.
+ */
+static int pilot_gridCmpId( const void *p1, const void *p2 )
+{
+   pilotId_t id1, id2;
+   id1 = *(const pilotId_t*) p1;
+   id2 = *(const pilotId_t*) p2;
+   return (id1 > id2) - (id1 < id2);
+}
+
+
+/**
+ * @brief Finds all the pilots within a radius of a position.
+ *
+ *    @param p Pilot doing the query, passed to the filter.
+ *    @param x X position to search from.
+ *    @param y Y position to search from.
+ *    @param r Radius to search in.
+ *    @param filter Function rejecting pilots by returning INFINITY, or
+ *           NULL to get all the pilots.
+ *    @param data User data for the filter.
+ *    @return Array (array.h) of the IDs of the pilots found, sorted by ID
+ *            like the pilot stack. Caller must free.
+ */
+pilotId_t* pilot_gridRadius( const Pilot *p, double x, double y, double r,
+      PilotCost filter, const void *data )
+{
+   int i, j, l, i0, i1, j0, j1;
+   double d2;
+   pilotId_t *found;
+   Pilot *t;
+
+   if (pgrid_dirty)
+      pilot_gridBuild();
+
+   /* Pilots may have left the cells they were put in. */
+   found = array_create( pilotId_t );
+   i0 = pilot_gridCoord( x-r-pgrid_slack, pgrid_x0, pgrid_w );
+   i1 = pilot_gridCoord( x+r+pgrid_slack, pgrid_x0, pgrid_w );
+   j0 = pilot_gridCoord( y-r-pgrid_slack, pgrid_y0, pgrid_h );
+   j1 = pilot_gridCoord( y+r+pgrid_slack, pgrid_y0, pgrid_h );
+   for (j=j0; j<=j1; j++) {
+      for (i=i0; i<=i1; i++) {
+         for (l=pgrid_start[j*pgrid_w+i]; l<pgrid_start[j*pgrid_w+i+1]; l++) {
+            t = pgrid_pilots[l];
+            d2 = pow2(x - t->solid->pos.x) + pow2(y - t->solid->pos.y);
+            if (d2 >= r*r)
+               continue;
+            if ((filter != NULL) && !(filter( p, t, d2, data ) < INFINITY))
+               continue;
+            array_push_back( &found, t->id );
+         }
+      }
+   }
+   qsort( found, array_size(found), sizeof(pilotId_t), pilot_gridCmpId );
+   return found;
+}
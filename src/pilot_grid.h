@@ -0,0 +1,41 @@
+/*
+ * See Licensing and Copyright notice in naev.h
+ */
+
+
+#ifndef PILOT_GRID_H
+#  define PILOT_GRID_H
+
+
+#include "pilot.h"
+
+
+/**
+ * @brief Cost of a pilot in a spatial query.
+ *
+ *    @param p Pilot doing the query (may be NULL).
+ *    @param target Candidate pilot.
+ *    @param d2 Squared distance of the candidate from the query position.
+ *    @param data User data of the query.
+ *    @return Cost of the candidate (lower is better), or INFINITY to
+ *            reject it.
+ */
+typedef double (*PilotCost)( const Pilot *p, const Pilot *target, double d2,
+      const void *data );
+
+
+/*
+ * Spatial index.
+ */
+void pilot_gridDirty (void);
+void pilot_gridFree (void);
+void pilot_gridMoved( const Pilot *p );
+int pilot_gridNearest( const Pilot *p, double x, double y, double rmax,
+      PilotCost cost, const void *data, double dscale,
+      pilotId_t *out, double *costs, int k );
+double pilot_gridMaxSize (void);
+pilotId_t* pilot_gridRadius( const Pilot *p, double x, double y, double r,
+      PilotCost filter, const void *data );
+
+
+#endif /* PILOT_GRID_H */
@@ -7,6 +7,19 @@
  * @file pilot_heat.c
  *
  * @brief Handles the pilot heat stuff.
+ *
+ * The regular heat transfer of all the pilots is done at once at the end
+ *  of each update by pilots_heatUpdate(). The pilots queue themselves
+ *  during their update, then their slots and ships are copied into a
+ *  structure of arrays, simulated in a single pass and copied back. Each
+ *  pilot only depends on its own data, so large batches are split among
+ *  the worker threads.
+ *
+ * Until then the heat of a queued pilot is still what it was when queued.
+ *  Anything using the heat of a pilot in the meantime, such as firing or
+ *  the afterburner, calls pilot_heatSettle() first, which does the queued
+ *  update of that pilot on its own. The temperatures are thus the same as
+ *  updating every pilot where it queued itself.
  */
 
 
@@ -20,12 +33,67 @@
 
 #include "array.h"
 #include "log.h"
+#include "threadpool.h"
+
+
+#define HEAT_JOB_SLOTS     2048 /**< Slots simulated by each worker job. */
+
+
+/**
+ * @brief Pilot waiting for its heat update.
+ */
+typedef struct HeatQueued_ {
+   pilotId_t id; /**< ID of the pilot. */
+   double dt; /**< Time step of the pilot (includes time speedup). */
+} HeatQueued;
+
+
+/**
+ * @brief Heat data of many pilots as a structure of arrays.
+ *
+ * Slots are grouped by pilot, the slots of pilot i go from first[i] to
+ *  first[i+1].
+ */
+typedef struct HeatBatch_ {
+   /* Slots. */
+   PilotOutfitSlot **slots; /**< Array (array.h): Slots. */
+   int *owner; /**< Array (array.h): Index of the pilot of each slot. */
+   double *slot_T; /**< Array (array.h): Temperature of the slots. */
+   double *slot_C; /**< Array (array.h): Heat capacity of the slots. */
+   double *slot_area; /**< Array (array.h): Transfer area of the slots. */
+   double *slot_Q; /**< Array (array.h): Energy leaving each slot. */
+   /* Pilots. */
+   Pilot **pilots; /**< Array (array.h): Pilots. */
+   int *first; /**< Array (array.h): First slot of each pilot, plus the end. */
+   double *T; /**< Array (array.h): Temperature of the ships. */
+   double *C; /**< Array (array.h): Heat capacity of the ships. */
+   double *cond; /**< Array (array.h): Heat conductivity of the ships. */
+   double *area; /**< Array (array.h): Radiating area of the ships. */
+   double *emis; /**< Array (array.h): Emissivity of the ships. */
+   double *dt; /**< Array (array.h): Time step of each pilot. */
+} HeatBatch;
+
+
+/**
+ * @brief Range of pilots of a batch for a worker job.
+ */
+typedef struct HeatJob_ {
+   HeatBatch *hb; /**< Batch to simulate. */
+   int start; /**< First pilot. */
+   int end; /**< Pilot after the last. */
+} HeatJob;
+
+
+static HeatQueued *heat_queue = NULL; /**< Array (array.h): Pilots waiting for their heat update. */
+static HeatBatch heat_batch; /**< Reused batch of the heat update. */
 
 
 /*
  * Prototypes.
  */
 static double pilot_heatOutfitMod( const Pilot *p, const Outfit *o );
+static void pilot_heatBatchRun( HeatBatch *hb, int start, int end );
+static int pilot_heatJob( void *data );
 
 
 /**
@@ -38,6 +106,9 @@ static double pilot_heatOutfitMod( const Pilot *p, const Outfit *o );
 void pilot_heatCalc( Pilot *p )
 {
    double mass_kg;
+
+   /* The queued update uses the current parameters. */
+   pilot_heatSettle( p );
    mass_kg        = 1000. * p->base_mass;
    p->heat_emis   = 0.8; /**< @TODO make it influencable. */
    p->heat_cond   = STEEL_HEAT_CONDUCTIVITY;
@@ -111,6 +182,7 @@ void pilot_heatReset( Pilot *p )
 {
    int i;
 
+   pilot_heatSettle( p );
    p->heat_T = CONST_SPACE_STAR_TEMP;
    for (i=0; i<array_size(p->outfits); i++)
       p->outfits[i]->heat_T = CONST_SPACE_STAR_TEMP;
@@ -158,6 +230,7 @@ void pilot_heatAddSlot( const Pilot *p, PilotOutfitSlot *o )
     * this keeps numbers safe. */
    double hmod = pilot_heatOutfitMod( p, o->outfit );
 
+   pilot_heatSettle( p );
    o->heat_T += hmod * outfit_heat(o->outfit) / o->heat_C;
 
    /* Enforce a minimum value as a safety measure. */
@@ -176,6 +249,7 @@ void pilot_heatAddSlotTime( const Pilot *p, PilotOutfitSlot *o, double dt )
 {
    double hmod = pilot_heatOutfitMod( p, o->outfit );
 
+   pilot_heatSettle( p );
    o->heat_T += (hmod * outfit_heat(o->outfit) / o->heat_C) * dt;
 
    /* Enforce a minimum value as a safety measure. */
@@ -253,6 +327,255 @@ void pilot_heatUpdateShip( Pilot *p, double Q_cond, double dt )
 }
 
 
+/**
+ * @brief Queues a pilot for the batched heat update.
+ *
+ * The pilot's ship and its active slots will be updated by the next
+ *  pilots_heatUpdate() as by pilot_heatUpdateSlot() and
+ *  pilot_heatUpdateShip().
+ *
+ *    @param p Pilot to update.
+ *    @param dt Delta tick of the pilot.
+ */
+void pilot_heatQueue( Pilot *p, double dt )
+{
+   HeatQueued *q;
+
+   /* Updates are done in order. */
+   pilot_heatSettle( p );
+
+   if (heat_queue == NULL)
+      heat_queue = array_create( HeatQueued );
+   q = &array_grow( &heat_queue );
+   q->id = p->id;
+   q->dt = dt;
+   p->heat_queued = array_size( heat_queue );
+}
+
+
+/**
+ * @brief Does the queued heat update of a pilot right away.
+ *
+ * Must be called before using or changing the heat of a pilot that may be
+ *  queued, so it sees the same temperatures as if the update was done when
+ *  queued. Does nothing if the pilot isn't queued.
+ *
+ * The pilot is taken as const as only its pending update is applied.
+ *
+ *    @param p Pilot to update.
+ */
+void pilot_heatSettle( const Pilot *p )
+{
+   int i;
+   double Q, dt;
+   Pilot *pq;
+   PilotOutfitSlot *o;
+
+   if (p->heat_queued == 0)
+      return;
+
+   pq = (Pilot*) p;
+   dt = heat_queue[ p->heat_queued-1 ].dt;
+   pq->heat_queued = 0;
+   Q = 0.;
+   for (i=0; i<array_size(pq->outfits); i++) {
+      o = pq->outfits[i];
+      /* Same slots as pilots_heatUpdate(). */
+      if ((o->outfit == NULL) || !o->active)
+         continue;
+      Q += pilot_heatUpdateSlot( pq, o, dt );
+   }
+   pilot_heatUpdateShip( pq, Q, dt );
+}
+
+
+/**
+ * @brief Simulates heat transfer of a range of pilots of a batch.
+ *
+ * Only touches the data of the range, so disjoint ranges can be run in
+ *  parallel. The arithmetic is the same as pilot_heatUpdateSlot() and
+ *  pilot_heatUpdateShip(), with the slot energy summed in the same order,
+ *  so the temperatures are identical.
+ *
+ *    @param hb Batch to simulate.
+ *    @param start First pilot.
+ *    @param end Pilot after the last.
+ */
+static void pilot_heatBatchRun( HeatBatch *hb, int start, int end )
+{
+   int i, j, o;
+   double Q, Q_cond, Q_rad;
+
+   /* Conduction between the slots and the ships in a single pass. */
+   for (j=hb->first[start]; j<hb->first[end]; j++) {
+      o = hb->owner[j];
+      Q = -hb->cond[o] * (hb->slot_T[j] - hb->T[o]) * hb->slot_area[j] * hb->dt[o];
+      hb->slot_T[j] += Q / hb->slot_C[j];
+      hb->slot_Q[j] = Q;
+   }
+
+   /* Radiation of the ships. */
+   for (i=start; i<end; i++) {
+      Q_cond = 0.;
+      for (j=hb->first[i]; j<hb->first[i+1]; j++)
+         Q_cond += hb->slot_Q[j];
+      Q_rad = (CONST_STEFAN_BOLTZMANN * hb->area[i] * hb->emis[i]
+            * (CONST_SPACE_STAR_TEMP_4-pow(hb->T[i],4.)) * hb->dt[i]);
+      Q = Q_rad - Q_cond;
+      hb->T[i] += Q / hb->C[i];
+   }
+}
+
+
+/**
+ * @brief Worker thread job of the batched heat update.
+ */
+static int pilot_heatJob( void *data )
+{
+   HeatJob *job = data;
+   pilot_heatBatchRun( job->hb, job->start, job->end );
+   return 0;
+}
+
+
+/**
+ * @brief Runs the heat update of all the pilots queued by
+ *        pilot_heatQueue().
+ *
+ * Pilots that were settled since being queued are skipped.
+ */
+void pilots_heatUpdate (void)
+{
+   int i, j, n, nslots;
+   Pilot *p;
+   PilotOutfitSlot *o;
+   HeatBatch *hb;
+   HeatJob *jobs;
+   ThreadQueue *queue;
+
+   if (array_size(heat_queue) == 0)
+      return;
+
+   /* Gather. */
+   hb = &heat_batch;
+   if (hb->slots == NULL) {
+      hb->slots = array_create( PilotOutfitSlot* );
+      hb->owner = array_create( int );
+      hb->slot_T = array_create( double );
+      hb->slot_C = array_create( double );
+      hb->slot_area = array_create( double );
+      hb->slot_Q = array_create( double );
+      hb->pilots = array_create( Pilot* );
+      hb->first = array_create( int );
+      hb->T = array_create( double );
+      hb->C = array_create( double );
+      hb->cond = array_create( double );
+      hb->area = array_create( double );
+      hb->emis = array_create( double );
+      hb->dt = array_create( double );
+   }
+   for (i=0; i<array_size(heat_queue); i++) {
+      /* Pilot may have been removed by a hook or settled since. */
+      p = pilot_get( heat_queue[i].id );
+      if ((p == NULL) || (p->heat_queued != i+1))
+         continue;
+      p->heat_queued = 0;
+      n = array_size( hb->pilots );
+      array_push_back( &hb->pilots, p );
+      array_push_back( &hb->first, array_size(hb->slots) );
+      array_push_back( &hb->T, p->heat_T );
+      array_push_back( &hb->C, p->heat_C );
+      array_push_back( &hb->cond, p->heat_cond );
+      array_push_back( &hb->area, p->heat_area );
+      array_push_back( &hb->emis, p->heat_emis );
+      array_push_back( &hb->dt, heat_queue[i].dt );
+      for (j=0; j<array_size(p->outfits); j++) {
+         o = p->outfits[j];
+         /* Same slots as pilot_update() heats. */
+         if ((o->outfit == NULL) || !o->active)
+            continue;
+         array_push_back( &hb->slots, o );
+         array_push_back( &hb->owner, n );
+         array_push_back( &hb->slot_T, o->heat_T );
+         array_push_back( &hb->slot_C, o->heat_C );
+         array_push_back( &hb->slot_area, o->heat_area );
+      }
+   }
+   n = array_size( hb->pilots );
+   nslots = array_size( hb->slots );
+   array_push_back( &hb->first, nslots );
+   array_resize( &hb->slot_Q, nslots );
+
+   /* Simulate, on the worker threads if there's enough to do. */
+   if (nslots < 2*HEAT_JOB_SLOTS)
+      pilot_heatBatchRun( hb, 0, n );
+   else {
+      queue = vpool_create();
+      jobs = calloc( nslots / HEAT_JOB_SLOTS + 1, sizeof(HeatJob) );
+      j = 0;
+      for (i=0; i<n; ) {
+         jobs[j].hb = hb;
+         jobs[j].start = i;
+         while ((i < n) && (hb->first[i] - hb->first[jobs[j].start] < HEAT_JOB_SLOTS))
+            i++;
+         jobs[j].end = i;
+         vpool_enqueue( queue, pilot_heatJob, &jobs[j] );
+         j++;
+      }
+      vpool_wait( queue );
+      free( jobs );
+   }
+
+   /* Scatter. */
+   for (i=0; i<nslots; i++)
+      hb->slots[i]->heat_T = hb->slot_T[i];
+   for (i=0; i<n; i++)
+      hb->pilots[i]->heat_T = hb->T[i];
+
+   /* Clear for the next update. */
+   array_resize( &hb->slots, 0 );
+   array_resize( &hb->owner, 0 );
+   array_resize( &hb->slot_T, 0 );
+   array_resize( &hb->slot_C, 0 );
+   array_resize( &hb->slot_area, 0 );
+   array_resize( &hb->pilots, 0 );
+   array_resize( &hb->first, 0 );
+   array_resize( &hb->T, 0 );
+   array_resize( &hb->C, 0 );
+   array_resize( &hb->cond, 0 );
+   array_resize( &hb->area, 0 );
+   array_resize( &hb->emis, 0 );
+   array_resize( &hb->dt, 0 );
+   array_resize( &heat_queue, 0 );
+}
+
+
+/**
+ * @brief Frees the memory of the batched heat update.
+ */
+void pilots_heatFree (void)
+{
+   HeatBatch *hb = &heat_batch;
+   array_free( hb->slots );
+   array_free( hb->owner );
+   array_free( hb->slot_T );
+   array_free( hb->slot_C );
+   array_free( hb->slot_area );
+   array_free( hb->slot_Q );
+   array_free( hb->pilots );
+   array_free( hb->first );
+   array_free( hb->T );
+   array_free( hb->C );
+   array_free( hb->cond );
+   array_free( hb->area );
+   array_free( hb->emis );
+   array_free( hb->dt );
+   memset( hb, 0, sizeof(HeatBatch) );
+   array_free( heat_queue );
+   heat_queue = NULL;
+}
+
+
 /**
  * @brief Returns a 0:1 modifier representing efficiency (1. being normal).
  *
@@ -59,6 +59,10 @@ void pilot_heatAddSlotTime( const Pilot *p, PilotOutfitSlot *o, double dt );
 double pilot_heatUpdateSlot( const Pilot *p, PilotOutfitSlot *o, double dt );
 void pilot_heatUpdateShip( Pilot *p, double Q_cond, double dt );
 void pilot_heatUpdateCooldown( Pilot *p );
+void pilot_heatQueue( Pilot *p, double dt );
+void pilot_heatSettle( const Pilot *p );
+void pilots_heatUpdate (void);
+void pilots_heatFree (void);
 
 /*
  * Modifiers.
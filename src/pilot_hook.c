@@ -20,6 +20,7 @@
 
 #include "pilot_hook.h"
 
+#include "arena.h"
 #include "array.h"
 #include "hook.h"
 #include "log.h"
@@ -43,7 +44,7 @@ static int pilot_hookCleanup = 0; /**< Are hooks being removed from a pilot? */
 int pilot_runHookParam( Pilot* p, int hook_type, HookParam* param, int nparam )
 {
    int n, i, run, ret;
-   HookParam hstaparam[5], *hdynparam, *hparam;
+   HookParam hstaparam[5], *hparam;
 
    /* Set up hook parameters. */
    if (nparam <= 3) {
@@ -54,16 +55,14 @@ int pilot_runHookParam( Pilot* p, int hook_type, HookParam* param, int nparam )
          memcpy( &hstaparam[n], param, sizeof(HookParam)*nparam );
       n += nparam;
       hstaparam[n].type = HOOK_PARAM_SENTINEL;
-      hdynparam         = NULL;
       hparam            = hstaparam;
    }
    else {
-      hdynparam   = malloc( sizeof(HookParam) * (nparam+2) );
-      hdynparam[0].type       = HOOK_PARAM_PILOT;
-      hdynparam[0].u.lp       = p->id;
-      memcpy( &hdynparam[1], param, sizeof(HookParam)*nparam );
-      hdynparam[nparam+1].type  = HOOK_PARAM_SENTINEL;
-      hparam                  = hdynparam;
+      hparam      = arena_alloc( sizeof(HookParam) * (nparam+2) );
+      hparam[0].type          = HOOK_PARAM_PILOT;
+      hparam[0].u.lp          = p->id;
+      memcpy( &hparam[1], param, sizeof(HookParam)*nparam );
+      hparam[nparam+1].type   = HOOK_PARAM_SENTINEL;
    }
 
    /* Run pilot specific hooks. */
@@ -91,9 +90,6 @@ int pilot_runHookParam( Pilot* p, int hook_type, HookParam* param, int nparam )
          run++;
    }
 
-   /* Clean up. */
-   free( hdynparam );
-
    if (run > 0)
       claim_activateAll(); /* Reset claims. */
 
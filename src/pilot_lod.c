@@ -0,0 +1,260 @@
+/*
+ * See Licensing and Copyright notice in naev.h
+ */
+
+
+/**
+ * @file pilot_lod.c
+ *
+ * @brief Low detail simulation of the pilots far away from the player.
+ *
+ * When conf.lod_distance is set, pilots farther than it from the player
+ *  (or from the centre of the system if there is no player) stop running
+ *  their AI every frame and don't fire real projectiles. Their AI only
+ *  thinks every PILOT_LOD_THINK seconds, which is enough for it to pick
+ *  targets and head to where it's going. In between, they keep turning
+ *  towards the direction it last wanted to face, or stop turning if it
+ *  didn't face anything, so they don't overshoot. While they have a valid
+ *  enemy as target, they fly straight at it instead and every weapon in
+ *  range deals the damage its shot is expected to do each time it would
+ *  have fired. The damage goes through pilot_hit(), so disabling, deaths
+ *  and hooks work as usual. Movement, regeneration and heat are still done
+ *  by the regular pilot update.
+ *
+ * Pilots go back to full detail when they come within PILOT_LOD_HYSTERESIS
+ *  times the distance, or when they start fighting the player or the
+ *  player's escorts. Nothing depends on the frame rate of the renderer or
+ *  on anything but the state of the pilots, so runs stay deterministic for
+ *  a given seed.
+ */
+
+
+/** @cond */
+#include <math.h>
+
+#include "naev.h"
+/** @endcond */
+
+#include "pilot_lod.h"
+
+#include "array.h"
+#include "conf.h"
+#include "player.h"
+
+
+#define PILOT_LOD_ARC      (M_PI/8.) /**< Largest angle to the target forward weapons fire at. */
+#define PILOT_LOD_CLOSE    0.5 /**< Fraction of the weapon range pilots try to close in to. */
+
+
+/*
+ * Prototypes.
+ */
+static int pilot_lodEligible( const Pilot *p );
+static double pilot_lodFire( Pilot *p, Pilot *t, double d, double dir, double dt );
+
+
+/**
+ * @brief Checks whether a pilot may be simulated in low detail at all.
+ */
+static int pilot_lodEligible( const Pilot *p )
+{
+   const Pilot *t;
+
+   /* The player and everything the player controls stay in full detail. */
+   if ((p->id == PLAYER_ID) || pilot_isFlag( p, PILOT_PLAYER )
+         || (p->parent == PLAYER_ID))
+      return 0;
+
+   /* Missions and events expect their pilots to follow orders exactly. */
+   if (pilot_isFlag( p, PILOT_MANUAL_CONTROL ))
+      return 0;
+
+   /* Fighting the player must look right. */
+   t = pilot_get( p->target );
+   if ((t != NULL) && ((t->id == PLAYER_ID) || (t->parent == PLAYER_ID)))
+      return 0;
+
+   return 1;
+}
+
+
+/**
+ * @brief Updates whether a pilot is simulated in low detail.
+ *
+ *    @param p Pilot to check.
+ *    @return 1 if the pilot is in low detail.
+ */
+int pilot_lodCheck( Pilot *p )
+{
+   double d2, dist;
+   const Vector2d *ref;
+   Vector2d origin;
+
+   if ((conf.lod_distance <= 0.) || !pilot_lodEligible( p )) {
+      pilot_rmFlag( p, PILOT_LOD );
+      return 0;
+   }
+
+   if (player.p != NULL)
+      ref = &player.p->solid->pos;
+   else {
+      vectnull( &origin );
+      ref = &origin;
+   }
+   d2 = vect_dist2( &p->solid->pos, ref );
+
+   /* Leave some room between both switches so pilots on the edge don't
+    * flicker between them. */
+   dist = conf.lod_distance;
+   if (pilot_isFlag( p, PILOT_LOD ))
+      dist *= PILOT_LOD_HYSTERESIS;
+
+   if (d2 > pow2(dist)) {
+      if (!pilot_isFlag( p, PILOT_LOD )) {
+         pilot_setFlag( p, PILOT_LOD );
+         p->lod_timer = 0.;
+         p->lod_dir = INFINITY;
+      }
+      return 1;
+   }
+
+   pilot_rmFlag( p, PILOT_LOD );
+   return 0;
+}
+
+
+/**
+ * @brief Makes a pilot in low detail fire at its target.
+ *
+ *    @param p Pilot firing.
+ *    @param t Target of the pilot.
+ *    @param d Distance to the target.
+ *    @param dir Direction of the target.
+ *    @param dt Current delta tick.
+ *    @return Longest range of the weapons of the pilot.
+ */
+static double pilot_lodFire( Pilot *p, Pilot *t, double d, double dir, double dt )
+{
+   int i, turret;
+   double range, maxrange, rate_mod, energy_mod, energy, scale;
+   const Outfit *o, *ammo;
+   PilotOutfitSlot *w;
+   Damage dmg;
+
+   maxrange = 0.;
+   for (i=0; i<array_size(p->outfit_weapon); i++) {
+      w = &p->outfit_weapon[i];
+      o = w->outfit;
+      if (o == NULL)
+         continue;
+      if (!outfit_isBolt(o) && !outfit_isBeam(o) && !outfit_isLauncher(o))
+         continue;
+
+      /* Launchers need ammo. */
+      ammo = NULL;
+      if (outfit_isLauncher(o)) {
+         ammo = w->u.ammo.outfit;
+         if ((ammo == NULL) || (w->u.ammo.quantity <= 0))
+            continue;
+      }
+
+      /* Range and damage modifiers like the real projectiles would get. */
+      turret = outfit_isTurret(o);
+      range = outfit_range(o) * (turret ? p->stats.tur_range : p->stats.fwd_range);
+      scale = turret ? p->stats.tur_damage : p->stats.fwd_damage;
+      if (ammo != NULL) {
+         range *= p->stats.launch_range;
+         scale *= p->stats.launch_damage;
+      }
+      maxrange = MAX( maxrange, range );
+      if (d > range)
+         continue;
+      if (!turret && (FABS( angle_diff( p->solid->dir, dir ) ) > PILOT_LOD_ARC))
+         continue;
+
+      /* Pay for the shot like pilot_shootWeapon() does. */
+      pilot_getRateMod( &rate_mod, &energy_mod, p, o );
+      if (outfit_isBeam(o)) {
+         energy = outfit_energy(o) * energy_mod * dt;
+         if (energy > p->energy)
+            continue;
+         p->energy -= energy;
+         pilot_heatAddSlotTime( p, w, dt );
+         scale *= dt; /* Beam damage is per second. */
+      }
+      else {
+         if (w->timer > 0.)
+            continue;
+         energy = outfit_energy( (ammo != NULL) ? ammo : o ) * energy_mod;
+         if (energy > p->energy)
+            continue;
+         p->energy -= energy;
+         pilot_heatAddSlot( p, w );
+         w->timer += rate_mod * outfit_delay(o);
+         if (ammo != NULL)
+            pilot_rmAmmo( p, w, 1 );
+      }
+
+      /* Expected damage of the shot, missing more often from afar. */
+      scale *= PILOT_LOD_ACCURACY * (1. - 0.5*d/range);
+      dmg = *outfit_damage( (ammo != NULL) ? ammo : o );
+      dmg.damage *= scale;
+      dmg.disable *= scale;
+      pilot_hit( t, NULL, p->id, &dmg, 1 );
+
+      /* Stop shooting at the dead. */
+      if (pilot_isFlag( t, PILOT_DEAD ) || pilot_isDisabled( t ))
+         break;
+   }
+
+   return maxrange;
+}
+
+
+/**
+ * @brief Runs a pilot in low detail instead of its AI.
+ *
+ *    @param p Pilot to run.
+ *    @param dt Current delta tick.
+ */
+void pilot_lodThink( Pilot *p, double dt )
+{
+   Pilot *t;
+   double d, dir, range;
+
+   t = pilot_get( p->target );
+   if ((t == NULL) || (t == p) || !pilot_validEnemy( p, t )) {
+      /* Nothing to fight, let the AI steer every now and then. Its orders
+       * stay in effect until it thinks again. */
+      p->lod_timer -= dt;
+      if (p->lod_timer < 0.) {
+         p->lod_timer = PILOT_LOD_THINK;
+         p->think( p, dt );
+         /* Set by pilot_face() and only cleared by the next movement. */
+         p->lod_dir = p->solid->dir_dest;
+      }
+      /* The turn of the think was only meant for one frame. */
+      else if (isfinite( p->lod_dir ))
+         pilot_face( p, p->lod_dir );
+      else
+         pilot_setTurn( p, 0. );
+      return;
+   }
+
+   /* Think as soon as the fight is over. */
+   p->lod_timer = 0.;
+   p->lod_dir = INFINITY;
+
+   d = sqrt( vect_dist2( &p->solid->pos, &t->solid->pos ) );
+   dir = ANGLE( t->solid->pos.x - p->solid->pos.x,
+         t->solid->pos.y - p->solid->pos.y );
+   pilot_face( p, dir );
+   range = pilot_lodFire( p, t, d, dir, dt );
+
+   /* Close in until well within range. */
+   if ((d > PILOT_LOD_CLOSE*range)
+         && (FABS( angle_diff( p->solid->dir, dir ) ) < M_PI_4))
+      pilot_setThrust( p, 1. );
+   else
+      pilot_setThrust( p, 0. );
+}
@@ -0,0 +1,25 @@
+/*
+ * See Licensing and Copyright notice in naev.h
+ */
+
+
+#ifndef PILOT_LOD_H
+#  define PILOT_LOD_H
+
+
+#include "pilot.h"
+
+
+#define PILOT_LOD_HYSTERESIS  0.8 /**< Fraction of conf.lod_distance pilots must come within to leave low detail. */
+#define PILOT_LOD_THINK       0.5 /**< Time between AI thinks of pilots in low detail that aren't fighting. */
+#define PILOT_LOD_ACCURACY    0.6 /**< Fraction of the shots of pilots in low detail that hit at point blank. */
+
+
+/*
+ * Low detail simulation.
+ */
+int pilot_lodCheck( Pilot *p );
+void pilot_lodThink( Pilot *p, double dt );
+
+
+#endif /* PILOT_LOD_H */
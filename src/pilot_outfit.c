@@ -31,10 +31,16 @@
 #include "nlua_pilot.h"
 
 
+static unsigned long pilot_statsFull = 0; /**< Number of full stat recomputations. */
+static unsigned long pilot_statsActive = 0; /**< Number of stat recomputations of toggled outfits only. */
+
+
 /*
  * Prototypes.
  */
 static int pilot_hasOutfitLimit( Pilot *p, const char *limit );
+static int pilot_slotIsToggled( const PilotOutfitSlot *slot );
+static void pilot_calcStatsPassive( Pilot* pilot );
 
 
 /**
@@ -320,8 +326,12 @@ int pilot_addOutfitRaw( Pilot* pilot, const Outfit* outfit, PilotOutfitSlot *s )
 {
    const Outfit *o;
 
+   /* Slots that have outfits are heated. */
+   pilot_heatSettle( pilot );
+
    /* Set the outfit. */
    s->outfit   = outfit;
+   pilot->stats_passive_ok = 0;
 
    /* Set some default parameters. */
    s->timer    = 0.;
@@ -353,6 +363,13 @@ int pilot_addOutfitRaw( Pilot* pilot, const Outfit* outfit, PilotOutfitSlot *s )
    o = s->outfit;
    s->active = outfit_isActive(o);
 
+   /* Start loading the weapon graphics before they get fired. */
+   gl_texPrefetch( outfit_gfx( o ) );
+   if (outfit_isBolt(o))
+      gl_texPrefetch( o->u.blt.gfx_end );
+   else if (outfit_isLauncher(o) && (outfit_ammo(o) != NULL))
+      gl_texPrefetch( outfit_gfx( outfit_ammo(o) ) );
+
    /* Update heat. */
    pilot_heatCalcSlot( s );
 
@@ -431,6 +448,9 @@ int pilot_rmOutfitRaw( Pilot* pilot, PilotOutfitSlot *s )
 {
    int ret;
 
+   /* Slots that have outfits are heated. */
+   pilot_heatSettle( pilot );
+
    /* Force turn off if necessary. */
    if (s->state==PILOT_OUTFIT_ON)
       pilot_outfitOff( pilot, s );
@@ -448,6 +468,7 @@ int pilot_rmOutfitRaw( Pilot* pilot, PilotOutfitSlot *s )
    /* Remove the outfit. */
    ret         = (s->outfit==NULL);
    s->outfit   = NULL;
+   pilot->stats_passive_ok = 0;
 
    /* Remove secondary and such if necessary. */
    if (pilot->afterburner == s)
@@ -707,7 +728,7 @@ int pilot_addAmmo( Pilot* pilot, PilotOutfitSlot *s, const Outfit* ammo, int qua
    q = s->u.ammo.quantity - q; /* Amount actually added. */
    pilot->mass_outfit += q * s->u.ammo.outfit->mass;
    pilot_updateMass(pilot);
-   pilot_calcStats(pilot);
+   pilot_calcStatsActive(pilot);
 
    return q;
 }
@@ -746,7 +767,7 @@ int pilot_rmAmmo( Pilot* pilot, PilotOutfitSlot *s, int quantity )
    s->u.ammo.quantity -= q;
    pilot->mass_outfit -= q * s->u.ammo.outfit->mass;
    pilot_updateMass(pilot);
-   pilot_calcStats(pilot);
+   pilot_calcStatsActive(pilot);
    /* We don't set the outfit to null so it "remembers" old ammo. */
 
    return q;
@@ -834,6 +855,8 @@ void pilot_fillAmmo( Pilot* pilot )
    int i, ammo_threshold;
    const Outfit *o, *ammo;
 
+   /* Mass only has to be updated once at the end. */
+   pilot_calcStatsBegin( pilot );
    for (i=0; i<array_size(pilot->outfits); i++) {
       o = pilot->outfits[i]->outfit;
 
@@ -857,6 +880,7 @@ void pilot_fillAmmo( Pilot* pilot )
       pilot_addAmmo( pilot, pilot->outfits[i], ammo,
          ammo_threshold - pilot->outfits[i]->u.ammo.quantity );
    }
+   pilot_calcStatsEnd( pilot );
 }
 
 
@@ -893,12 +917,158 @@ char* pilot_getOutfits( const Pilot* pilot )
 }
 
 
+/**
+ * @brief Starts a batch of changes to the pilot's stats.
+ *
+ * Until the matching pilot_calcStatsEnd(), pilot_calcStats() and
+ *  pilot_calcStatsActive() only take note that the stats changed, and they
+ *  are recomputed once at the end. Batches may be nested. Stats read during
+ *  a batch may be outdated unless pilot_calcStatsFlush() is called first.
+ *
+ *    @param pilot Pilot to start batch for.
+ */
+void pilot_calcStatsBegin( Pilot *pilot )
+{
+   pilot->stats_batch++;
+}
+
+
+/**
+ * @brief Ends a batch of changes to the pilot's stats.
+ *
+ *    @param pilot Pilot to end batch for.
+ */
+void pilot_calcStatsEnd( Pilot *pilot )
+{
+   if (pilot->stats_batch <= 0) {
+      WARN(_("Pilot '%s': Ending stat batch that wasn't started."), pilot->name );
+      return;
+   }
+   pilot->stats_batch--;
+   if (pilot->stats_batch == 0)
+      pilot_calcStatsFlush( pilot );
+}
+
+
+/**
+ * @brief Recomputes the pilot's stats now if they changed during a batch.
+ *
+ *    @param pilot Pilot to update the stats of.
+ */
+void pilot_calcStatsFlush( Pilot *pilot )
+{
+   int batch;
+
+   if (!pilot->stats_dirty)
+      return;
+
+   batch = pilot->stats_batch;
+   pilot->stats_batch = 0;
+   pilot_calcStatsActive( pilot );
+   pilot->stats_batch = batch;
+}
+
+
+/**
+ * @brief Gets the number of times stats were recomputed.
+ *
+ *    @param[out] full Recomputations from all the outfits since the start.
+ *    @param[out] active Recomputations that only reapplied the outfits that
+ *                can be turned on and off since the start.
+ */
+void pilot_calcStatsCount( unsigned long *full, unsigned long *active )
+{
+   *full = pilot_statsFull;
+   *active = pilot_statsActive;
+}
+
+
+/**
+ * @brief Checks whether an outfit only affects the stats when turned on.
+ */
+static int pilot_slotIsToggled( const PilotOutfitSlot *slot )
+{
+   return slot->active && (outfit_isMod(slot->outfit)
+         || outfit_isAfterburner(slot->outfit));
+}
+
+
+/**
+ * @brief Computes the stats of the ship and the outfits that are always on.
+ *
+ *    @param pilot Pilot to compute the passive stats of.
+ */
+static void pilot_calcStatsPassive( Pilot* pilot )
+{
+   int i;
+   const Outfit* o;
+   PilotOutfitSlot *slot;
+   ShipStats *s;
+
+   s = &pilot->stats_passive;
+   *s = pilot->ship->stats_array;
+   pilot->base_mass     = pilot->ship->mass;
+   pilot->mass_outfit   = 0.;
+   for (i=0; i<array_size(pilot->outfits); i++) {
+      slot = pilot->outfits[i];
+      o    = slot->outfit;
+
+      /* Outfit must exist. */
+      if (o==NULL)
+         continue;
+
+      /* Add mass. */
+      pilot->mass_outfit += o->mass;
+
+      /* Keep a separate counter for required (core) outfits. */
+      if (sp_required( o->slot.spid ))
+         pilot->base_mass += o->mass;
+
+      /* Add ammo mass. */
+      if (outfit_ammo(o) != NULL)
+         if (slot->u.ammo.outfit != NULL)
+            pilot->mass_outfit += slot->u.ammo.quantity * slot->u.ammo.outfit->mass;
+
+      if (outfit_isAfterburner(o)) /* Afterburner */
+         pilot->afterburner = pilot->outfits[i]; /* Set afterburner */
+
+      /* Outfits that can be turned on and off are applied afterwards. */
+      if (pilot_slotIsToggled( slot ))
+         continue;
+
+      /* Add stats. */
+      ss_statsModFromOps( s, o->stats_ops );
+   }
+
+   pilot->stats_passive_ok = 1;
+   pilot_statsFull++;
+}
+
+
 /**
  * @brief Recalculates the pilot's stats based on his outfits.
  *
  *    @param pilot Pilot to recalculate his stats.
  */
 void pilot_calcStats( Pilot* pilot )
+{
+   pilot->stats_passive_ok = 0;
+   pilot_calcStatsActive( pilot );
+}
+
+
+/**
+ * @brief Recalculates the pilot's stats after outfits were only turned on
+ *        or off or ammo changed.
+ *
+ * The stats of the ship and the outfits that are always on are kept from
+ *  the last full recomputation, so only the outfits that can be turned on
+ *  and off are applied again. Falls back to a full recomputation when
+ *  outfits were added or removed since.
+ *
+ *    @param pilot Pilot to recalculate the stats of.
+ */
+void pilot_calcStatsActive( Pilot* pilot )
 {
    int i;
    const Outfit* o;
@@ -906,12 +1076,22 @@ void pilot_calcStats( Pilot* pilot )
    double tm;
    ShipStats *s;
 
+   /* Wait for the end of the batch. */
+   pilot->stats_dirty = 1;
+   if (pilot->stats_batch > 0)
+      return;
+   pilot->stats_dirty = 0;
+
+   if (!pilot->stats_passive_ok)
+      pilot_calcStatsPassive( pilot );
+   else
+      pilot_statsActive++;
+
    /*
     * set up the basic stuff
     */
    /* mass */
    pilot->solid->mass   = pilot->ship->mass;
-   pilot->base_mass     = pilot->solid->mass;
    /* movement */
    pilot->thrust_base   = pilot->ship->thrust;
    pilot->turn_base     = pilot->ship->turn;
@@ -938,12 +1118,11 @@ void pilot_calcStats( Pilot* pilot )
    /* Stats. */
    s = &pilot->stats;
    tm = s->time_mod;
-   *s = pilot->ship->stats_array;
+   *s = pilot->stats_passive;
 
    /*
-    * Now add outfit changes
+    * Now add the outfits that are turned on.
     */
-   pilot->mass_outfit   = 0.;
    for (i=0; i<array_size(pilot->outfits); i++) {
       slot = pilot->outfits[i];
       o    = slot->outfit;
@@ -952,42 +1131,21 @@ void pilot_calcStats( Pilot* pilot )
       if (o==NULL)
          continue;
 
-      /* Add mass. */
-      pilot->mass_outfit += o->mass;
-
-      /* Keep a separate counter for required (core) outfits. */
-      if (sp_required( o->slot.spid ))
-         pilot->base_mass += o->mass;
-
-      /* Add ammo mass. */
-      if (outfit_ammo(o) != NULL)
-         if (slot->u.ammo.outfit != NULL)
-            pilot->mass_outfit += slot->u.ammo.quantity * slot->u.ammo.outfit->mass;
+      /* Only modifications and afterburners can be turned on. */
+      if (!outfit_isMod(o) && !outfit_isAfterburner(o))
+         continue;
 
-      if (outfit_isAfterburner(o)) /* Afterburner */
-         pilot->afterburner = pilot->outfits[i]; /* Set afterburner */
+      /* Active outfits must be on to affect stuff. */
+      if (slot->active && !(slot->state==PILOT_OUTFIT_ON))
+         continue;
 
-      /* Apply modifications. */
-      if (outfit_isMod(o)) { /* Modification */
-         /* Active outfits must be on to affect stuff. */
-         if (slot->active && !(slot->state==PILOT_OUTFIT_ON))
-            continue;
-         /* Add stats. */
-         ss_statsModFromList( s, o->stats );
+      /* Add stats, the others are already in the passive stats. */
+      if (pilot_slotIsToggled( slot ))
+         ss_statsModFromOps( s, o->stats_ops );
 
-      }
-      else if (outfit_isAfterburner(o)) { /* Afterburner */
-         /* Active outfits must be on to affect stuff. */
-         if (slot->active && !(slot->state==PILOT_OUTFIT_ON))
-            continue;
-         /* Add stats. */
-         ss_statsModFromList( s, o->stats );
+      if (outfit_isAfterburner(o)) { /* Afterburner */
          pilot_setFlag( pilot, PILOT_AFTERBURNER ); /* We use old school flags for this still... */
-         pilot->energy_regen -= pilot->afterburner->outfit->u.afb.energy;
-      }
-      else {
-         /* Always add stats for non mod/afterburners. */
-         ss_statsModFromList( s, o->stats );
+         pilot->energy_regen -= o->u.afb.energy;
       }
    }
 
@@ -39,10 +39,17 @@ void pilot_lockClear( Pilot *p );
 
 /* Other. */
 char* pilot_getOutfits( const Pilot *pilot );
-void pilot_calcStats( Pilot *pilot );
 void pilot_updateMass( Pilot *pilot );
 void pilot_healLanded( Pilot *pilot );
 
+/* Stats. */
+void pilot_calcStats( Pilot *pilot );
+void pilot_calcStatsActive( Pilot *pilot );
+void pilot_calcStatsBegin( Pilot *pilot );
+void pilot_calcStatsEnd( Pilot *pilot );
+void pilot_calcStatsFlush( Pilot *pilot );
+void pilot_calcStatsCount( unsigned long *full, unsigned long *active );
+
 /* Special outfit stuff. */
 int pilot_getMount( const Pilot *p, const PilotOutfitSlot *w, Vector2d *v );
 int pilot_slotIsActive( const PilotOutfitSlot *o );
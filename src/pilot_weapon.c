@@ -79,6 +79,7 @@ static int pilot_weapSetFire( Pilot *p, PilotWeaponSet *ws, int level )
    Pilot *pt;
    AsteroidAnchor *field;
    Asteroid *ast;
+   Vector2d apos, avel;
    double time;
    const Outfit *o;
 
@@ -127,7 +128,9 @@ static int pilot_weapSetFire( Pilot *p, PilotWeaponSet *ws, int level )
       else if (p->nav_asteroid != -1) {
          field = &cur_system->asteroids[p->nav_anchor];
          ast = &field->asteroids[p->nav_asteroid];
-         time = pilot_weapFlyTime( o, p, &ast->pos, &ast->vel);
+         asteroid_getPos( ast, &apos );
+         asteroid_getVel( ast, &avel );
+         time = pilot_weapFlyTime( o, p, &apos, &avel );
       }
 
       /* Only "inrange" outfits. */
@@ -191,7 +194,7 @@ void pilot_weapSetPress( Pilot* p, int id, int type )
          else if (type < 0) {
             ws->active = 0;
             if (pilot_weaponSetShootStop( p, ws, -1 )) /* De-activate weapon set. */
-               pilot_calcStats( p ); /* Just in case there is a activated outfit here. */
+               pilot_calcStatsActive( p ); /* Just in case there is a activated outfit here. */
          }
          break;
 
@@ -239,7 +242,7 @@ void pilot_weapSetPress( Pilot* p, int id, int type )
          }
          /* Must recalculate stats. */
          if (n > 0)
-            pilot_calcStats( p );
+            pilot_calcStatsActive( p );
 
          break;
    }
@@ -833,7 +836,7 @@ void pilot_shootStop( Pilot* p, int level )
 
    /* Stop and see if must recalculate. */
    if (pilot_weaponSetShootStop( p, ws, level ))
-      pilot_calcStats( p );
+      pilot_calcStatsActive( p );
 }
 
 
@@ -921,6 +924,7 @@ void pilot_stopBeam( Pilot *p, PilotOutfitSlot *w )
 
    /* Beam duration used. Compensate for the fact it's duration might have
     * been shortened by heat. */
+   pilot_heatSettle( p );
    used = w->outfit->u.bem.duration - w->timer*(1.-pilot_heatAccuracyMod(w->heat_T));
 
    w->timer = rate_mod * (used / w->outfit->u.bem.duration) * outfit_delay( w->outfit );
@@ -1011,6 +1015,9 @@ static int pilot_shootWeaponSetOutfit( Pilot* p, PilotWeaponSet *ws, const Outfi
    /* Store number of shots. */
    ret = 0;
 
+   /* Slots are picked and fired by heat. */
+   pilot_heatSettle( p );
+
    /** @TODO Make beams not fire all at once. */
    if (outfit_isBeam(o)) {
       for (i=0; i<array_size(ws->slots); i++)
@@ -1103,6 +1110,9 @@ static int pilot_shootWeapon( Pilot* p, PilotOutfitSlot* w, double time )
    if (w->outfit == NULL)
       return 0;
 
+   /* The shot depends on heat. */
+   pilot_heatSettle( p );
+
    /* Reset beam shut-off if needed. */
    if (outfit_isBeam(w->outfit) && w->outfit->u.bem.min_duration)
       w->stimer = INFINITY;
@@ -1589,6 +1599,7 @@ void pilot_afterburn (Pilot *p)
       return;
 
    /* The afterburner only works if its efficiency is high enough. */
+   pilot_heatSettle( p );
    if (pilot_heatEfficiencyMod( p->afterburner->heat_T,
          p->afterburner->outfit->u.afb.heat_base,
          p->afterburner->outfit->u.afb.heat_cap ) < 0.3)
@@ -1598,7 +1609,7 @@ void pilot_afterburn (Pilot *p)
       p->afterburner->state  = PILOT_OUTFIT_ON;
       p->afterburner->stimer = outfit_duration( p->afterburner->outfit );
       pilot_setFlag(p,PILOT_AFTERBURNER);
-      pilot_calcStats( p );
+      pilot_calcStatsActive( p );
 
       /* @todo Make this part of a more dynamic activated outfit sound system. */
       sound_playPos(p->afterburner->outfit->u.afb.sound_on,
@@ -1620,7 +1631,7 @@ void pilot_afterburnOver (Pilot *p)
    if (p->afterburner->state == PILOT_OUTFIT_ON) {
       p->afterburner->state  = PILOT_OUTFIT_OFF;
       pilot_rmFlag(p,PILOT_AFTERBURNER);
-      pilot_calcStats( p );
+      pilot_calcStatsActive( p );
 
       /* @todo Make this part of a more dynamic activated outfit sound system. */
       sound_playPos(p->afterburner->outfit->u.afb.sound_off,
@@ -1109,6 +1109,7 @@ void player_think( Pilot* pplayer, const double dt )
    Pilot *target;
    AsteroidAnchor *field;
    Asteroid *ast;
+   Vector2d apos;
    double turn;
    int facing, fired;
 
@@ -1161,8 +1162,9 @@ void player_think( Pilot* pplayer, const double dt )
       else if (player.p->nav_asteroid != -1) {
          field = &cur_system->asteroids[player.p->nav_anchor];
          ast = &field->asteroids[player.p->nav_asteroid];
+         asteroid_getPos( ast, &apos );
          pilot_face( pplayer,
-               vect_angle( &player.p->solid->pos, &ast->pos ));
+               vect_angle( &player.p->solid->pos, &apos ));
          /* Disable turning. */
          facing = 1;
       }
@@ -0,0 +1,162 @@
+/*
+ * See Licensing and Copyright notice in naev.h
+ */
+
+/**
+ * @file pool.c
+ *
+ * @brief Slab pools of fixed size objects.
+ *
+ * Objects are carved out of large slabs that are only freed when the
+ *  pool is destroyed, so objects that are constantly created and
+ *  destroyed don't go through malloc() nor fragment the heap.
+ *
+ * The pool never touches the contents of the objects: a new object is
+ *  zeroed, and a reused one is exactly as it was when freed. This lets
+ *  objects keep buffers they own across reuse, which the cleanup
+ *  function given to pool_destroy() then frees.
+ */
+
+
+/** @cond */
+#include <stdlib.h>
+
+#include "naev.h"
+/** @endcond */
+
+#include "pool.h"
+
+#include "array.h"
+#include "log.h"
+
+
+#define POOL_ALIGN   16 /**< Alignment of the objects. */
+
+
+/**
+ * @brief Slab pool of fixed size objects.
+ */
+struct Pool_ {
+   size_t size; /**< Size of the objects, including alignment padding. */
+   int slab; /**< Objects per slab. */
+   char **slabs; /**< Array (array.h): Slabs of objects. */
+   void **free; /**< Array (array.h): Objects available for allocation. */
+   int live; /**< Objects allocated. */
+   int peak; /**< Most objects allocated at once. */
+};
+
+
+/*
+ * Prototypes.
+ */
+static void pool_grow( Pool *pool );
+
+
+/**
+ * @brief Creates a pool.
+ *
+ *    @param size Size of the objects.
+ *    @param slab Number of objects to allocate at once.
+ *    @return The new pool, destroy with pool_destroy().
+ */
+Pool* pool_create( size_t size, int slab )
+{
+   Pool *pool;
+
+   pool = calloc( 1, sizeof(Pool) );
+   pool->size = (size + POOL_ALIGN-1) & ~(size_t)(POOL_ALIGN-1);
+   pool->slab = MAX( slab, 1 );
+   pool->slabs = array_create( char* );
+   pool->free = array_create_size( void*, pool->slab );
+   return pool;
+}
+
+
+/**
+ * @brief Adds a slab of zeroed objects to a pool.
+ *
+ *    @param pool Pool to grow.
+ */
+static void pool_grow( Pool *pool )
+{
+   int i;
+   char *slab;
+
+   slab = calloc( pool->slab, pool->size );
+   if (slab == NULL)
+      ERR( _("Out of Memory") );
+   array_push_back( &pool->slabs, slab );
+
+   /* Backwards so the objects are handed out in address order. */
+   for (i=pool->slab-1; i>=0; i--)
+      array_push_back( &pool->free, &slab[ i*pool->size ] );
+}
+
+
+/**
+ * @brief Allocates an object from a pool.
+ *
+ *    @param pool Pool to allocate from.
+ *    @return An object, zeroed if new or as it was freed if reused.
+ */
+void* pool_alloc( Pool *pool )
+{
+   void *obj;
+   int n;
+
+   if (array_size(pool->free) == 0)
+      pool_grow( pool );
+
+   n = array_size(pool->free);
+   obj = pool->free[n-1];
+   array_resize( &pool->free, n-1 );
+
+   pool->live++;
+   pool->peak = MAX( pool->peak, pool->live );
+   return obj;
+}
+
+
+/**
+ * @brief Returns an object to its pool.
+ *
+ *    @param pool Pool the object was allocated from.
+ *    @param obj Object to free, may be NULL.
+ */
+void pool_free( Pool *pool, void *obj )
+{
+   if (obj == NULL)
+      return;
+   array_push_back( &pool->free, obj );
+   pool->live--;
+}
+
+
+/**
+ * @brief Destroys a pool.
+ *
+ *    @param pool Pool to destroy.
+ *    @param cleanup Function to free what unallocated objects still own,
+ *           or NULL.
+ */
+void pool_destroy( Pool *pool, void (*cleanup)( void *obj ) )
+{
+   int i;
+
+   if (pool == NULL)
+      return;
+
+   if (pool->live > 0)
+      WARN( _("Destroying pool with %d objects still allocated!"), pool->live );
+   if (cleanup != NULL)
+      for (i=0; i<array_size(pool->free); i++)
+         cleanup( pool->free[i] );
+   DEBUG( _("Pool of %lu byte objects peaked at %d objects in %d slabs"),
+         (unsigned long)pool->size, pool->peak, array_size(pool->slabs) );
+
+   for (i=0; i<array_size(pool->slabs); i++)
+      free( pool->slabs[i] );
+   array_free( pool->slabs );
+   array_free( pool->free );
+   free( pool );
+}
@@ -0,0 +1,24 @@
+/*
+ * See Licensing and Copyright notice in naev.h
+ */
+
+#ifndef POOL_H
+#  define POOL_H
+
+
+/** @cond */
+#include <stddef.h>
+/** @endcond */
+
+
+struct Pool_;
+typedef struct Pool_ Pool; /**< Slab pool of fixed size objects. */
+
+
+Pool* pool_create( size_t size, int slab );
+void* pool_alloc( Pool *pool );
+void pool_free( Pool *pool, void *obj );
+void pool_destroy( Pool *pool, void (*cleanup)( void *obj ) );
+
+
+#endif /* POOL_H */
@@ -0,0 +1,315 @@
+/*
+ * See Licensing and Copyright notice in naev.h
+ */
+
+/**
+ * @file profile.c
+ *
+ * @brief Frame profiler.
+ *
+ * Parts of the frame are wrapped in PROFILE_BEGIN() and PROFILE_END()
+ *  zones. While the breakdown is shown, the time spent in each zone is
+ *  added up every frame and displayed under the FPS. While tracing, the
+ *  start and end of every zone is stored and written as a Chrome trace
+ *  event file (viewable in chrome://tracing or Perfetto) once the
+ *  requested number of frames has passed.
+ *
+ * Zones may nest and recurse, only the outermost one of each zone is
+ *  added to the breakdown. All zones compile to nothing when the
+ *  profiler option is disabled.
+ */
+
+
+/** @cond */
+#include "physfs.h"
+
+#include "naev.h"
+/** @endcond */
+
+#include "profile.h"
+
+#if PROFILING
+
+#include "arena.h"
+#include "array.h"
+#include "font.h"
+#include "log.h"
+#include "nstring.h"
+#include "pilot.h"
+
+
+#define PROFILE_SMOOTH        0.1 /**< Weight of the latest frame in the displayed times. */
+#define PROFILE_TRACE_MAX     (1<<20) /**< Maximum events stored in a trace. */
+#define PROFILE_TRACE_PATH    "traces" /**< Directory traces are written to. */
+
+
+/**
+ * @brief Event stored in a trace.
+ */
+typedef struct ProfileEvent_ {
+   Uint64 t; /**< Performance counter of the event. */
+   int zone; /**< Zone of the event, or -1 for the start of a frame. */
+   char phase; /**< 'B' for the beginning of a zone, 'E' for the end. */
+} ProfileEvent;
+
+
+static const char *profile_names[PROFILE_ZONES] = {
+   "space",
+   "weapons",
+   "spfx",
+   "pilots",
+   "ai",
+   "hooks",
+   "render",
+   "render_bg",
+   "render_mid",
+   "render_fg",
+   "render_gui",
+   "lua",
+}; /**< Names of the zones. */
+static int profile_depth[PROFILE_ZONES]; /**< Nesting depth of each zone. */
+static Uint64 profile_start[PROFILE_ZONES]; /**< Start of the outermost zone, 0 if not timed. */
+static Uint64 profile_acc[PROFILE_ZONES]; /**< Time spent in each zone this frame. */
+static double profile_ms[PROFILE_ZONES]; /**< Smoothed ms spent in each zone per frame. */
+static int profile_shown = 0; /**< Whether the breakdown is shown. */
+
+static ProfileEvent *profile_events = NULL; /**< Array (array.h): Events of the trace. */
+static int profile_traceOpen[PROFILE_ZONES]; /**< Zones begun in the trace and not ended. */
+static int profile_traceFrames = 0; /**< Frames left to trace. */
+static Uint64 profile_traceStart = 0; /**< Performance counter when the trace started. */
+
+
+/*
+ * Prototypes.
+ */
+static void profile_traceWrite (void);
+
+
+/**
+ * @brief Starts timing a zone.
+ *
+ *    @param zone Zone to start.
+ */
+void profile_begin( ProfileZone zone )
+{
+   Uint64 t;
+
+   if (!profile_shown && (profile_events == NULL)) {
+      profile_depth[zone]++;
+      return;
+   }
+
+   t = SDL_GetPerformanceCounter();
+   if (profile_depth[zone]++ == 0)
+      profile_start[zone] = t;
+   if ((profile_events != NULL) && (array_size(profile_events) < PROFILE_TRACE_MAX)) {
+      ProfileEvent *e = &array_grow( &profile_events );
+      e->t = t;
+      e->zone = zone;
+      e->phase = 'B';
+      profile_traceOpen[zone]++;
+   }
+}
+
+
+/**
+ * @brief Stops timing a zone.
+ *
+ *    @param zone Zone to stop.
+ */
+void profile_end( ProfileZone zone )
+{
+   Uint64 t;
+
+   if (profile_depth[zone] <= 0)
+      return;
+   profile_depth[zone]--;
+   if (!profile_shown && (profile_events == NULL))
+      return;
+
+   t = SDL_GetPerformanceCounter();
+   if ((profile_depth[zone] == 0) && (profile_start[zone] != 0)) {
+      profile_acc[zone] += t - profile_start[zone];
+      profile_start[zone] = 0;
+   }
+   /* Only end what was begun in the trace, it may have started midway. */
+   if ((profile_events != NULL) && (profile_traceOpen[zone] > 0)) {
+      ProfileEvent *e = &array_grow( &profile_events );
+      e->t = t;
+      e->zone = zone;
+      e->phase = 'E';
+      profile_traceOpen[zone]--;
+   }
+}
+
+
+/**
+ * @brief Marks the start of a new frame.
+ */
+void profile_frame (void)
+{
+   int i;
+   double ms;
+
+   if (profile_shown) {
+      ms = 1000. / (double)SDL_GetPerformanceFrequency();
+      for (i=0; i<PROFILE_ZONES; i++) {
+         profile_ms[i] += PROFILE_SMOOTH * ((double)profile_acc[i]*ms - profile_ms[i]);
+         profile_acc[i] = 0;
+      }
+   }
+
+   if (profile_events == NULL)
+      return;
+
+   if (profile_traceFrames-- <= 0) {
+      profile_traceWrite();
+      return;
+   }
+   if (array_size(profile_events) < PROFILE_TRACE_MAX) {
+      ProfileEvent *e = &array_grow( &profile_events );
+      e->t = SDL_GetPerformanceCounter();
+      e->zone = -1;
+      e->phase = 'i';
+   }
+}
+
+
+/**
+ * @brief Renders the breakdown of the last frames.
+ *
+ *    @param x X position to render at.
+ *    @param y Y position of the first line.
+ *    @return Y position of the line after the breakdown.
+ */
+double profile_render( double x, double y )
+{
+   int i;
+   const ArenaStats *stats;
+   unsigned long hits, misses, full, active;
+
+   if (!profile_shown)
+      return y;
+
+   for (i=0; i<PROFILE_ZONES; i++) {
+      gl_print( &gl_smallFont, x, y, NULL, "%-10s %6.2f ms",
+            profile_names[i], profile_ms[i] );
+      y -= gl_smallFont.h + 3.;
+   }
+   stats = arena_stats();
+   gl_print( &gl_smallFont, x, y, NULL, "%-10s %6lu allocs %lu KiB", "arena",
+         stats->frame_allocs, (unsigned long)(stats->frame_bytes / 1024) );
+   y -= gl_smallFont.h + 3.;
+   pilot_ewCacheStats( &hits, &misses );
+   gl_print( &gl_smallFont, x, y, NULL, "%-10s %6.1f%% hits", "sensors",
+         100. * (double)hits / (double)MAX( hits+misses, 1 ) );
+   y -= gl_smallFont.h + 3.;
+   pilot_calcStatsCount( &full, &active );
+   gl_print( &gl_smallFont, x, y, NULL, "%-10s %6lu full %lu toggles", "stats",
+         full, active );
+   y -= gl_smallFont.h + 3.;
+   return y - 2.;
+}
+
+
+/**
+ * @brief Shows or hides the breakdown.
+ *
+ *    @param enable Whether to show it.
+ */
+void profile_show( int enable )
+{
+   int i;
+
+   profile_shown = enable;
+   for (i=0; i<PROFILE_ZONES; i++) {
+      profile_acc[i] = 0;
+      profile_ms[i] = 0.;
+   }
+}
+
+
+/**
+ * @brief Checks whether the breakdown is shown.
+ */
+int profile_isShown (void)
+{
+   return profile_shown;
+}
+
+
+/**
+ * @brief Starts tracing.
+ *
+ *    @param frames Number of frames to trace.
+ *    @return 0 on success, -1 if already tracing.
+ */
+int profile_trace( int frames )
+{
+   if (profile_events != NULL)
+      return -1;
+
+   profile_events = array_create_size( ProfileEvent, 4096 );
+   memset( profile_traceOpen, 0, sizeof(profile_traceOpen) );
+   profile_traceFrames = MAX( frames, 1 );
+   profile_traceStart = SDL_GetPerformanceCounter();
+   return 0;
+}
+
+
+/**
+ * @brief Writes the finished trace as Chrome trace event JSON.
+ */
+static void profile_traceWrite (void)
+{
+   int i, n;
+   char filename[PATH_MAX], buf[STRMAX_SHORT];
+   const char *name;
+   double us;
+   PHYSFS_File *f;
+
+   us = 1e6 / (double)SDL_GetPerformanceFrequency();
+
+   f = NULL;
+   if (PHYSFS_mkdir( PROFILE_TRACE_PATH ) != 0) {
+      for (i=0; i<1000; i++) {
+         snprintf( filename, sizeof(filename), PROFILE_TRACE_PATH"/trace%03d.json", i );
+         if (!PHYSFS_exists( filename ))
+            break;
+      }
+      if (i < 1000)
+         f = PHYSFS_openWrite( filename );
+   }
+   if (f == NULL) {
+      WARN( _("Unable to write profiler trace: %s"),
+            PHYSFS_getErrorByCode( PHYSFS_getLastErrorCode() ) );
+      array_free( profile_events );
+      profile_events = NULL;
+      return;
+   }
+
+   n = snprintf( buf, sizeof(buf), "{\"traceEvents\":[\n" );
+   PHYSFS_writeBytes( f, buf, n );
+   for (i=0; i<array_size(profile_events); i++) {
+      const ProfileEvent *e = &profile_events[i];
+      name = (e->zone < 0) ? "frame" : profile_names[e->zone];
+      n = snprintf( buf, sizeof(buf),
+            "%s{\"name\":\"%s\",\"ph\":\"%c\",\"ts\":%.3f,\"pid\":1,\"tid\":1%s}\n",
+            (i > 0) ? "," : "", name, e->phase,
+            (double)(e->t - profile_traceStart) * us,
+            (e->phase == 'i') ? ",\"s\":\"g\"" : "" );
+      PHYSFS_writeBytes( f, buf, n );
+   }
+   n = snprintf( buf, sizeof(buf), "]}\n" );
+   PHYSFS_writeBytes( f, buf, n );
+   PHYSFS_close( f );
+
+   LOG( _("Wrote profiler trace with %d events to '%s'"),
+         array_size(profile_events), filename );
+   if (array_size(profile_events) >= PROFILE_TRACE_MAX)
+      WARN( _("Profiler trace was cut short at %d events!"), PROFILE_TRACE_MAX );
+   array_free( profile_events );
+   profile_events = NULL;
+}
+
+#endif /* PROFILING */
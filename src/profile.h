@@ -0,0 +1,53 @@
+/*
+ * See Licensing and Copyright notice in naev.h
+ */
+
+#ifndef PROFILE_H
+#  define PROFILE_H
+
+
+#include "naev.h"
+
+
+/**
+ * @brief Parts of a frame that are timed by the profiler.
+ */
+typedef enum ProfileZone_ {
+   PROFILE_SPACE, /**< space_update() */
+   PROFILE_WEAPONS, /**< weapons_update() */
+   PROFILE_SPFX, /**< spfx_update() */
+   PROFILE_PILOTS, /**< pilots_update() */
+   PROFILE_AI, /**< Pilots thinking, part of PROFILE_PILOTS. */
+   PROFILE_HOOKS, /**< Update hooks. */
+   PROFILE_RENDER, /**< render_all() */
+   PROFILE_RENDER_BG, /**< Rendering the background, part of PROFILE_RENDER. */
+   PROFILE_RENDER_MID, /**< Rendering pilots and weapons, part of PROFILE_RENDER. */
+   PROFILE_RENDER_FG, /**< Rendering the foreground, part of PROFILE_RENDER. */
+   PROFILE_RENDER_GUI, /**< Rendering the GUI and toolkit, part of PROFILE_RENDER. */
+   PROFILE_LUA, /**< Lua calls through nlua_pcall(). */
+   PROFILE_ZONES /**< Number of zones. */
+} ProfileZone;
+
+
+#if PROFILING
+/** @brief Starts timing a zone, must be paired with PROFILE_END(). */
+#define PROFILE_BEGIN( zone )    profile_begin( zone )
+/** @brief Stops timing a zone started with PROFILE_BEGIN(). */
+#define PROFILE_END( zone )      profile_end( zone )
+
+void profile_begin( ProfileZone zone );
+void profile_end( ProfileZone zone );
+void profile_frame (void);
+double profile_render( double x, double y );
+void profile_show( int enable );
+int profile_isShown (void);
+int profile_trace( int frames );
+#else /* PROFILING */
+#define PROFILE_BEGIN( zone )
+#define PROFILE_END( zone )
+#define profile_frame()
+#define profile_render( x, y )   (y)
+#endif /* PROFILING */
+
+
+#endif /* PROFILE_H */
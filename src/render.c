@@ -15,6 +15,7 @@
 #include "opengl.h"
 #include "pause.h"
 #include "player.h"
+#include "profile.h"
 #include "space.h"
 #include "spfx.h"
 #include "toolkit.h"
@@ -102,6 +103,7 @@ static void render_fbo( double dt, GLuint fbo, GLuint tex, PPShader *shader )
 
    /* Draw. */
    glDrawArrays( GL_TRIANGLE_STRIP, 0, 4 );
+   gl_screen.draw_calls++;
 
    /* Clear state. */
    glDisableVertexAttribArray( shader->VertexPosition );
@@ -181,6 +183,12 @@ void render_all( double game_dt, double real_dt )
    int pp_final, pp_gui, pp_game;
    int cur = 0;
 
+   PROFILE_BEGIN( PROFILE_RENDER );
+
+   /* Start counting the draw calls of the new frame. */
+   gl_screen.draw_calls_last = gl_screen.draw_calls;
+   gl_screen.draw_calls = 0;
+
    /* See what post-processing is up. */
    pp_game  = (array_size(pp_shaders_list[PP_LAYER_GAME]) > 0);
    pp_gui   = (array_size(pp_shaders_list[PP_LAYER_GUI]) > 0);
@@ -212,28 +220,35 @@ void render_all( double game_dt, double real_dt )
    gl_defViewport();
 
    /* Background stuff */
+   PROFILE_BEGIN( PROFILE_RENDER_BG );
    space_render( real_dt ); /* Nebula looks really weird otherwise. */
    hooks_run( "renderbg" );
    planets_render();
    spfx_render(SPFX_LAYER_BACK);
    weapons_render(WEAPON_LAYER_BG, dt);
+   PROFILE_END( PROFILE_RENDER_BG );
    /* Middle stuff */
+   PROFILE_BEGIN( PROFILE_RENDER_MID );
    pilots_render(dt);
    weapons_render(WEAPON_LAYER_FG, dt);
    spfx_render(SPFX_LAYER_MIDDLE);
+   PROFILE_END( PROFILE_RENDER_MID );
    /* Foreground stuff */
+   PROFILE_BEGIN( PROFILE_RENDER_FG );
    player_render(dt);
    spfx_render(SPFX_LAYER_FRONT);
    space_renderOverlay(dt);
    gui_renderReticles(dt);
    pilots_renderOverlay(dt);
    hooks_run( "renderfg" );
+   PROFILE_END( PROFILE_RENDER_FG );
 
    /* Process game stuff only. */
    if (pp_game)
       render_fbo_list( dt, pp_shaders_list[PP_LAYER_GAME], &cur, !(pp_final || pp_gui) );
 
    /* GUi stuff. */
+   PROFILE_BEGIN( PROFILE_RENDER_GUI );
    gui_render(dt);
 
    if (pp_gui)
@@ -247,6 +262,7 @@ void render_all( double game_dt, double real_dt )
    gl_viewport(0, 0, gl_screen.nw, gl_screen.nh);
 
    toolkit_render();
+   PROFILE_END( PROFILE_RENDER_GUI );
 
    /* Restore viewport so it doesn't mess anything else up. */
    gl_defViewport();
@@ -257,6 +273,8 @@ void render_all( double game_dt, double real_dt )
 
    /* check error every loop */
    gl_checkErr();
+
+   PROFILE_END( PROFILE_RENDER );
 }
 
 
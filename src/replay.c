@@ -0,0 +1,340 @@
+/*
+ * See Licensing and Copyright notice in naev.h
+ */
+
+/**
+ * @file replay.c
+ *
+ * @brief Deterministic recording and replaying of runs.
+ *
+ * A recording holds the random seed the run was started with, followed
+ *  by the input events and the frame time of every frame in the order
+ *  the game consumed them. Replaying feeds these back to the game
+ *  instead of the real clock and input, so the simulation goes through
+ *  exactly the same states, and compares a checksum of all the pilots
+ *  at the end with the one stored in the recording.
+ *
+ * Recordings are only meant to be replayed by a build of the same
+ *  platform with the same data and window size, since events and
+ *  numbers are stored as raw native values.
+ *
+ * The file is laid out as:
+ *
+ *  - ReplayHeader
+ *  - Records, each a type byte followed by its payload:
+ *    - REPLAY_EVENT: SDL_Event
+ *    - REPLAY_FRAME: double frame time in seconds
+ *    - REPLAY_CHECKSUM: md5 of the pilots, written when the run ends
+ */
+
+
+/** @cond */
+#include <stdint.h>
+#include <stdio.h>
+#include "SDL.h"
+
+#include "naev.h"
+/** @endcond */
+
+#include "replay.h"
+
+#include "array.h"
+#include "conf.h"
+#include "log.h"
+#include "md5.h"
+#include "pilot.h"
+#include "rng.h"
+
+
+#define REPLAY_MAGIC       "NAIKRP1" /**< Magic string (including the NUL) identifying recordings. */
+
+#define REPLAY_EVENT       'E' /**< Record of an input event. */
+#define REPLAY_FRAME       'F' /**< Record of a frame time. */
+#define REPLAY_CHECKSUM    'C' /**< Record of the final checksum. */
+
+
+/**
+ * @brief Header of a recording.
+ */
+typedef struct ReplayHeader_ {
+   char magic[8]; /**< Must be REPLAY_MAGIC. */
+   uint32_t seed; /**< Random seed of the run. */
+   int32_t width; /**< Window width of the run. */
+   int32_t height; /**< Window height of the run. */
+   double scalefactor; /**< Scale factor of the run. */
+} ReplayHeader;
+
+
+/**
+ * @brief What is being done with the replay file.
+ */
+typedef enum ReplayMode_ {
+   REPLAY_NONE, /**< Not recording nor replaying. */
+   REPLAY_RECORD, /**< Recording a run. */
+   REPLAY_PLAY /**< Replaying a run. */
+} ReplayMode;
+
+
+static ReplayMode replay_mode = REPLAY_NONE; /**< Current mode. */
+static FILE *replay_file = NULL; /**< Recording being written or read. */
+static int replay_next = EOF; /**< Type of the next record when replaying. */
+static md5_byte_t replay_sum[16]; /**< Checksum stored in the recording. */
+static int replay_hasSum = 0; /**< Whether the recording had a checksum. */
+static unsigned long replay_frames = 0; /**< Frames recorded or replayed. */
+static Uint64 replay_start = 0; /**< Performance counter when the first frame started. */
+
+
+/*
+ * Prototypes.
+ */
+static void replay_advance (void);
+static void replay_end (void);
+static void replay_checksum( md5_byte_t sum[16] );
+static void replay_sumString( char str[33], const md5_byte_t sum[16] );
+
+
+/**
+ * @brief Starts recording or replaying as set in the configuration.
+ *
+ * Must be called after the random subsystem is initialized and before
+ *  the window is created, since replaying uses the recorded seed and
+ *  window size.
+ *
+ *    @return 0 on success.
+ */
+int replay_init (void)
+{
+   ReplayHeader hdr;
+
+   if (conf.replay != NULL) {
+      replay_file = fopen( conf.replay, "rb" );
+      if (replay_file == NULL) {
+         WARN( _("Unable to open recording '%s'!"), conf.replay );
+         return -1;
+      }
+      if ((fread( &hdr, sizeof(hdr), 1, replay_file ) != 1)
+            || (memcmp( hdr.magic, REPLAY_MAGIC, sizeof(hdr.magic) ) != 0)) {
+         WARN( _("'%s' is not a recording!"), conf.replay );
+         fclose( replay_file );
+         replay_file = NULL;
+         return -1;
+      }
+      replay_mode = REPLAY_PLAY;
+      conf.width = hdr.width;
+      conf.height = hdr.height;
+      conf.scalefactor = hdr.scalefactor;
+      replay_advance();
+      LOG( _("Replaying '%s' with seed %u"), conf.replay, (unsigned int)hdr.seed );
+   }
+   else if (conf.record != NULL) {
+      replay_file = fopen( conf.record, "wb" );
+      if (replay_file == NULL) {
+         WARN( _("Unable to open '%s' for recording!"), conf.record );
+         return -1;
+      }
+      memset( &hdr, 0, sizeof(hdr) );
+      memcpy( hdr.magic, REPLAY_MAGIC, sizeof(hdr.magic) );
+      hdr.seed = randint();
+      hdr.width = conf.width;
+      hdr.height = conf.height;
+      hdr.scalefactor = conf.scalefactor;
+      fwrite( &hdr, sizeof(hdr), 1, replay_file );
+      replay_mode = REPLAY_RECORD;
+      LOG( _("Recording to '%s' with seed %u"), conf.record, (unsigned int)hdr.seed );
+   }
+   else
+      return 0;
+
+   rng_seed( hdr.seed );
+   return 0;
+}
+
+
+/**
+ * @brief Reads the type of the next record when replaying.
+ *
+ * The checksum is read right away since it's only used at the end.
+ */
+static void replay_advance (void)
+{
+   replay_next = fgetc( replay_file );
+   if (replay_next == REPLAY_CHECKSUM) {
+      replay_hasSum = (fread( replay_sum, sizeof(replay_sum), 1, replay_file ) == 1);
+      replay_next = fgetc( replay_file );
+   }
+}
+
+
+/**
+ * @brief Ends the replay when the recording runs out.
+ */
+static void replay_end (void)
+{
+   if (replay_next != EOF)
+      WARN( _("Replay out of sync after %lu frames!"), replay_frames );
+   replay_next = EOF;
+   naev_quit();
+}
+
+
+/**
+ * @brief Gets the next input event, recording or replaying it.
+ *
+ * Replaces SDL_PollEvent() in the loops that feed the game input.
+ *
+ *    @param[out] event Event gotten.
+ *    @return 1 if there was an event, 0 otherwise.
+ */
+int replay_pollEvent( SDL_Event *event )
+{
+   int ret;
+   SDL_Event real;
+
+   switch (replay_mode) {
+      case REPLAY_RECORD:
+         ret = SDL_PollEvent( event );
+         /* Dropped files carry pointers, the game doesn't use them anyway. */
+         if (ret && (event->type != SDL_DROPFILE) && (event->type != SDL_DROPTEXT)) {
+            fputc( REPLAY_EVENT, replay_file );
+            fwrite( event, sizeof(SDL_Event), 1, replay_file );
+         }
+         return ret;
+
+      case REPLAY_PLAY:
+         /* Real input is ignored, but still allow stopping the replay. */
+         while (SDL_PollEvent( &real ))
+            if (real.type == SDL_QUIT)
+               naev_quit();
+         if (replay_next != REPLAY_EVENT)
+            return 0;
+         if (fread( event, sizeof(SDL_Event), 1, replay_file ) != 1) {
+            replay_next = EOF;
+            return 0;
+         }
+         replay_advance();
+         return 1;
+
+      default:
+         return SDL_PollEvent( event );
+   }
+}
+
+
+/**
+ * @brief Records or replays the time of a frame.
+ *
+ *    @param[in,out] dt Frame time measured, replaced by the recorded one
+ *           when replaying.
+ */
+void replay_frame( double *dt )
+{
+   if (replay_frames == 0)
+      replay_start = SDL_GetPerformanceCounter();
+
+   switch (replay_mode) {
+      case REPLAY_RECORD:
+         fputc( REPLAY_FRAME, replay_file );
+         fwrite( dt, sizeof(double), 1, replay_file );
+         break;
+
+      case REPLAY_PLAY:
+         if ((replay_next != REPLAY_FRAME)
+               || (fread( dt, sizeof(double), 1, replay_file ) != 1)) {
+            *dt = 0.;
+            replay_end();
+            return;
+         }
+         replay_advance();
+         break;
+
+      default:
+         return;
+   }
+   replay_frames++;
+}
+
+
+/**
+ * @brief Computes the checksum of the position and health of all pilots.
+ *
+ *    @param[out] sum Checksum.
+ */
+static void replay_checksum( md5_byte_t sum[16] )
+{
+   int i;
+   double v[6];
+   Pilot *const *pilots;
+   md5_state_t md5;
+
+   md5_init( &md5 );
+   pilots = pilot_getAll();
+   for (i=0; i<array_size(pilots); i++) {
+      v[0] = pilots[i]->solid->pos.x;
+      v[1] = pilots[i]->solid->pos.y;
+      v[2] = pilots[i]->solid->vel.x;
+      v[3] = pilots[i]->solid->vel.y;
+      v[4] = pilots[i]->armour;
+      v[5] = pilots[i]->shield;
+      md5_append( &md5, (md5_byte_t*)&pilots[i]->id, sizeof(pilots[i]->id) );
+      md5_append( &md5, (md5_byte_t*)v, sizeof(v) );
+   }
+   md5_finish( &md5, sum );
+}
+
+
+/**
+ * @brief Converts a checksum to hexadecimal.
+ */
+static void replay_sumString( char str[33], const md5_byte_t sum[16] )
+{
+   int i;
+   for (i=0; i<16; i++)
+      snprintf( &str[2*i], 3, "%02x", sum[i] );
+}
+
+
+/**
+ * @brief Finishes recording or replaying.
+ *
+ * Must be called while the pilots of the run still exist.
+ *
+ *    @return 0 on success, -1 if a replay didn't match its recording.
+ */
+int replay_exit (void)
+{
+   int ret;
+   md5_byte_t sum[16];
+   char str[33];
+   double t;
+
+   if (replay_mode == REPLAY_NONE)
+      return 0;
+
+   ret = 0;
+   replay_checksum( sum );
+   replay_sumString( str, sum );
+   t = (double)(SDL_GetPerformanceCounter() - replay_start)
+         / (double)SDL_GetPerformanceFrequency();
+
+   if (replay_mode == REPLAY_RECORD) {
+      fputc( REPLAY_CHECKSUM, replay_file );
+      fwrite( sum, sizeof(sum), 1, replay_file );
+      LOG( _("Recorded %lu frames, checksum %s"), replay_frames, str );
+   }
+   else {
+      LOG( _("Replayed %lu frames in %.3f s, checksum %s"),
+            replay_frames, t, str );
+      if (!replay_hasSum)
+         WARN( _("Recording has no checksum to compare with!") );
+      else if (memcmp( sum, replay_sum, sizeof(sum) ) != 0) {
+         replay_sumString( str, replay_sum );
+         WARN( _("Replay doesn't match the recording, which had checksum %s!"), str );
+         ret = -1;
+      }
+   }
+
+   fclose( replay_file );
+   replay_file = NULL;
+   replay_mode = REPLAY_NONE;
+   return ret;
+}
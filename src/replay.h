@@ -0,0 +1,20 @@
+/*
+ * See Licensing and Copyright notice in naev.h
+ */
+
+#ifndef REPLAY_H
+#  define REPLAY_H
+
+
+/** @cond */
+#include "SDL.h"
+/** @endcond */
+
+
+int replay_init (void);
+int replay_pollEvent( SDL_Event *event );
+void replay_frame( double *dt );
+int replay_exit (void);
+
+
+#endif /* REPLAY_H */
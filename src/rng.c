@@ -7,7 +7,15 @@
  *
  * @brief Handles all the random number logic.
  *
- * Random numbers are currently generated using the mersenne twister.
+ * Random numbers on the main thread are generated using the mersenne
+ *  twister.
+ *
+ * Code running on worker threads uses xoshiro256** streams instead. There
+ *  is a fixed set of streams derived from the main seed by jumping ahead
+ *  2^128 numbers each, so they never overlap and a given seed always
+ *  gives every worker the same numbers. A worker binds its stream with
+ *  rng_setThreadStream(), after which randint(), randfp() and the RNG
+ *  macros draw from it.
  */
 
 
@@ -44,6 +52,13 @@ static uint32_t mt_y; /**< Internal mersenne twister variable. */
 static int mt_pos = 0; /**< Current number being used. */
 
 
+/*
+ * xoshiro256** streams
+ */
+static RngStream rng_streams[RNG_STREAMS]; /**< Streams for the worker threads. */
+static _Thread_local RngStream *rng_local = NULL; /**< Stream of the current thread, NULL uses the mersenne twister. */
+
+
 /*
  * prototypes
  */
@@ -52,6 +67,8 @@ static uint32_t rng_timeEntropy (void);
 static void mt_initArray( uint32_t seed );
 static void mt_genArray (void);
 static uint32_t mt_getInt (void);
+/* streams */
+static void rng_seedStreams( uint64_t seed );
 
 
 /**
@@ -86,6 +103,28 @@ void rng_init (void)
       mt_initArray( i );
    for (i=0; i<10; i++) /* generate numbers to get away from poor initial values */
       mt_genArray();
+
+   rng_seedStreams( ((uint64_t)mt_getInt() << 32) | mt_getInt() );
+}
+
+
+/**
+ * @brief Reseeds the random subsystem with a known seed.
+ *
+ * The same seed always gives the same sequence of numbers, which is
+ *  used to make recorded runs replayable.
+ *
+ *    @param seed Seed to use.
+ */
+void rng_seed( uint32_t seed )
+{
+   int i;
+
+   mt_initArray( seed );
+   for (i=0; i<10; i++) /* generate numbers to get away from poor initial values */
+      mt_genArray();
+
+   rng_seedStreams( seed );
 }
 
 
@@ -180,6 +219,8 @@ static uint32_t mt_getInt (void)
  */
 unsigned int randint (void)
 {
+   if (rng_local != NULL)
+      return rngs_int( rng_local ) >> 32;
    return mt_getInt();
 }
 
@@ -194,11 +235,154 @@ unsigned int randint (void)
 static double m_div = (double)(0xFFFFFFFF); /**< Number to divide by. */
 double randfp (void)
 {
-   double m = (double)mt_getInt();
+   double m;
+   if (rng_local != NULL)
+      m = (double)(uint32_t)(rngs_int( rng_local ) >> 32);
+   else
+      m = (double)mt_getInt();
    return m / m_div;
 }
 
 
+/**
+ * @brief Seeds a stream.
+ *
+ * The seed is expanded with splitmix64 so that similar seeds still give
+ *  unrelated streams.
+ *
+ *    @param rs Stream to seed.
+ *    @param seed Seed to use.
+ */
+void rngs_seed( RngStream *rs, uint64_t seed )
+{
+   int i;
+   uint64_t z;
+
+   for (i=0; i<4; i++) {
+      seed += 0x9E3779B97F4A7C15ULL;
+      z = seed;
+      z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+      z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+      rs->s[i] = z ^ (z >> 31);
+   }
+}
+
+
+/**
+ * @brief Rotates a 64 bit integer left.
+ */
+static inline uint64_t rngs_rotl( uint64_t x, int k )
+{
+   return (x << k) | (x >> (64 - k));
+}
+
+
+/**
+ * @brief Gets the next number of a stream.
+ *
+ *    @param rs Stream to draw from.
+ *    @return A random 8 byte number.
+ */
+uint64_t rngs_int( RngStream *rs )
+{
+   uint64_t *s = rs->s;
+   uint64_t result, t;
+
+   result = rngs_rotl( s[1] * 5, 7 ) * 9;
+   t = s[1] << 17;
+   s[2] ^= s[0];
+   s[3] ^= s[1];
+   s[1] ^= s[2];
+   s[0] ^= s[3];
+   s[2] ^= t;
+   s[3] = rngs_rotl( s[3], 45 );
+   return result;
+}
+
+
+/**
+ * @brief Gets a random float between 0 and 1 (exclusive) from a stream.
+ *
+ *    @param rs Stream to draw from.
+ *    @return A random float in [0, 1).
+ */
+double rngs_float( RngStream *rs )
+{
+   return (double)(rngs_int( rs ) >> 11) * 0x1.0p-53;
+}
+
+
+/**
+ * @brief Advances a stream by 2^128 numbers.
+ *
+ * Used to split one seed into many non-overlapping streams.
+ *
+ *    @param rs Stream to advance.
+ */
+void rngs_jump( RngStream *rs )
+{
+   static const uint64_t jump[] = { 0x180EC6D33CFD0ABAULL,
+         0xD5A61266F0C9392CULL, 0xA9582618E03FC9AAULL, 0x39ABDC4529B1661CULL };
+   uint64_t s[4] = { 0, 0, 0, 0 };
+   int i, b, j;
+
+   for (i=0; i<4; i++) {
+      for (b=0; b<64; b++) {
+         if (jump[i] & (UINT64_C(1) << b))
+            for (j=0; j<4; j++)
+               s[j] ^= rs->s[j];
+         rngs_int( rs );
+      }
+   }
+   for (j=0; j<4; j++)
+      rs->s[j] = s[j];
+}
+
+
+/**
+ * @brief Derives the worker streams from a seed.
+ *
+ *    @param seed Seed of the first stream.
+ */
+static void rng_seedStreams( uint64_t seed )
+{
+   int i;
+
+   rngs_seed( &rng_streams[0], seed );
+   for (i=1; i<RNG_STREAMS; i++) {
+      rng_streams[i] = rng_streams[i-1];
+      rngs_jump( &rng_streams[i] );
+   }
+}
+
+
+/**
+ * @brief Gets one of the worker streams.
+ *
+ * Worker threads should always use the stream of the same index for the
+ *  same piece of work so results don't depend on scheduling.
+ *
+ *    @param id Index of the stream (0 <= id < RNG_STREAMS).
+ *    @return The stream.
+ */
+RngStream* rng_stream( int id )
+{
+   return &rng_streams[ id % RNG_STREAMS ];
+}
+
+
+/**
+ * @brief Sets the stream the current thread draws from.
+ *
+ *    @param rs Stream to use, or NULL to go back to the mersenne twister
+ *           (only valid on the main thread).
+ */
+void rng_setThreadStream( RngStream *rs )
+{
+   rng_local = rs;
+}
+
+
 /**
  * @fn double Normal( double x )
  *
@@ -8,6 +8,11 @@
 #  define RNG_H
 
 
+/** @cond */
+#include <stdint.h>
+/** @endcond */
+
+
 /**
  * @brief Gets a random number between L and H (L <= RNG <= H).
  *
@@ -44,13 +49,36 @@
 #define RNG_3SIGMA()       NormalInverse(0.0013498985 + RNGF()*(1.-0.0013498985*2.))
 
 
+#define RNG_STREAMS   16 /**< Number of independent streams for worker threads. */
+
+
+/**
+ * @brief State of a xoshiro256** random number stream.
+ *
+ * Streams are independent of each other and of the main generator, so
+ *  each worker thread can draw from its own without locking.
+ */
+typedef struct RngStream_ {
+   uint64_t s[4]; /**< Generator state, must not be all zero. */
+} RngStream;
+
+
 /* Init */
 void rng_init (void);
+void rng_seed( uint32_t seed );
 
 /* Random functions */
 unsigned int randint (void);
 double randfp (void);
 
+/* Streams */
+void rngs_seed( RngStream *rs, uint64_t seed );
+void rngs_jump( RngStream *rs );
+uint64_t rngs_int( RngStream *rs );
+double rngs_float( RngStream *rs );
+RngStream* rng_stream( int id );
+void rng_setThreadStream( RngStream *rs );
+
 /* Probability functions */
 double Normal( double x );
 double NormalInverse( double p );
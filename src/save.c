@@ -10,6 +10,7 @@
 
 /** @cond */
 #include <errno.h>
+#include <zlib.h>
 #include "physfs.h"
 
 #include "naev.h"
@@ -35,6 +36,7 @@
 #include "player.h"
 #include "shiplog.h"
 #include "start.h"
+#include "threadpool.h"
 #include "unidiff.h"
 
 int save_loaded   = 0; /**< Just loaded the saved game. */
@@ -62,6 +64,30 @@ extern int space_sysSave( xmlTextWriterPtr writer ); /**< Saves the space stuff.
 extern int diff_save( xmlTextWriterPtr writer ); /**< Saves the universe diffs. */
 /* static */
 static int save_data( xmlTextWriterPtr writer );
+static int save_document( xmlTextWriterPtr writer, const char *annotation );
+static xmlBufferPtr save_serialize( const char *annotation );
+static char* save_gzip( const char *data, size_t len, size_t *outlen );
+static int save_writeThread( void *data );
+static void save_finish( int block );
+
+
+/**
+ * @brief Saved game being written to disk.
+ */
+typedef struct SaveWrite_ {
+   xmlBufferPtr buf; /**< Serialized saved game. */
+   char *path; /**< Native path to write to. */
+   char *file; /**< Name of the file in the saves directory. */
+   char *backup; /**< Native path to keep the previous save at, or NULL. */
+   SDL_sem *done; /**< Posted when the write is done, NULL if synchronous. */
+   int compress; /**< Whether to gzip compress the saved game. */
+   size_t size; /**< Size written to disk. */
+   int ret; /**< Result of the write. */
+   int err; /**< errno if the write failed. */
+   double time; /**< Time the write took in seconds. */
+} SaveWrite;
+static SaveWrite *save_pending = NULL; /**< Save being written in the background. */
+static int save_failed = 0; /**< A background write failed and the player wasn't told yet. */
 
 
 /**
@@ -88,34 +114,14 @@ static int save_data( xmlTextWriterPtr writer )
 
 
 /**
- * @brief Saves the current game.
+ * @brief Writes the whole saved game document.
  *
+ *    @param writer XML writer to use.
+ *    @param annotation Annotation to give the saved game.
  *    @return 0 on success.
  */
-int save_all (void)
+static int save_document( xmlTextWriterPtr writer, const char *annotation )
 {
-   char file[PATH_MAX], buf[PATH_MAX];
-   xmlDocPtr doc;
-   xmlTextWriterPtr writer;
-   int ret;
-   int written;
-
-   /* Do not save if saving is off. */
-   if (player_isFlag(PLAYER_NOSAVE))
-      return 0;
-
-   /* Create the writer. */
-   writer = xmlNewTextWriterDoc(&doc, 0);
-   if (writer == NULL) {
-      ERR(_("testXmlwriterDoc: Error creating the xml writer"));
-      return -1;
-   }
-
-   ret = 0;
-
-   /* Set the writer parameters. */
-   xmlw_setParams(writer);
-
    /* Start element. */
    xmlw_start(writer);
    xmlw_startElem(writer,"naev_save");
@@ -125,74 +131,278 @@ int save_all (void)
    xmlw_elem(writer, "naev", "%s", VERSION);
    xmlw_elem(writer, "data", "%s", start_name());
    xmlw_elem(writer, "player_name", "%s", player.name);
-   xmlw_elem(writer, "annotation", "%s", player.name);
+   xmlw_elem(writer, "annotation", "%s", annotation);
    xmlw_endElem(writer); /* "version" */
 
    /* Save last played. */
    xmlw_saveTime( writer, "last_played", time(NULL) );
 
    /* Save the data. */
-   if (save_data(writer) < 0) {
-      ERR(_("Trying to save game data"));
-      ret = -1;
-      goto exit;
-   }
+   if (save_data(writer) < 0)
+      return -1;
 
    /* Finish element. */
    xmlw_endElem(writer); /* "naev_save" */
    xmlw_done(writer);
+   return 0;
+}
+
+
+/**
+ * @brief Serializes the game into a memory buffer.
+ *
+ *    @param annotation Annotation to give the saved game.
+ *    @return The serialized game, or NULL on error.
+ */
+static xmlBufferPtr save_serialize( const char *annotation )
+{
+   xmlBufferPtr buf;
+   xmlTextWriterPtr writer;
+   Uint64 start;
+   int ret;
+
+   start = SDL_GetPerformanceCounter();
+
+   /* Create the writer. */
+   buf = xmlBufferCreate();
+   writer = (buf != NULL) ? xmlNewTextWriterMemory(buf, 0) : NULL;
+   if (writer == NULL) {
+      ERR(_("testXmlwriterDoc: Error creating the xml writer"));
+      xmlBufferFree(buf);
+      return NULL;
+   }
+
+   /* Set the writer parameters. */
+   xmlw_setParams(writer);
+
+   ret = save_document( writer, annotation );
+
+   /* Freeing the writer flushes it into the buffer. */
+   xmlFreeTextWriter(writer);
+   if (ret != 0) {
+      ERR(_("Trying to save game data"));
+      xmlBufferFree(buf);
+      return NULL;
+   }
+
+   DEBUG(_("Serialized saved game (%d bytes) in %.1f ms"),
+         xmlBufferLength(buf), 1000. * (double)(SDL_GetPerformanceCounter()
+            - start) / (double)SDL_GetPerformanceFrequency());
+   return buf;
+}
+
+
+/**
+ * @brief Compresses a serialized game in the gzip format.
+ *
+ * The loader detects the format by its magic bytes, so saves can be
+ *  compressed or not independently of each other.
+ *
+ *    @param data Data to compress.
+ *    @param len Length of data.
+ *    @param[out] outlen Length of the compressed data.
+ *    @return The compressed data (free with free()), or NULL on error.
+ */
+static char* save_gzip( const char *data, size_t len, size_t *outlen )
+{
+   z_stream z;
+   uLong bound;
+   char *out;
+
+   if (len > UINT_MAX)
+      return NULL;
+
+   memset( &z, 0, sizeof(z) );
+   /* 16 added to the window bits selects the gzip wrapper. */
+   if (deflateInit2( &z, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 15+16, 8,
+            Z_DEFAULT_STRATEGY ) != Z_OK)
+      return NULL;
+
+   bound = deflateBound( &z, len );
+   out = malloc( bound );
+   z.next_in   = (Bytef*) data;
+   z.avail_in  = len;
+   z.next_out  = (Bytef*) out;
+   z.avail_out = bound;
+   if (deflate( &z, Z_FINISH ) != Z_STREAM_END) {
+      deflateEnd( &z );
+      free( out );
+      return NULL;
+   }
+   *outlen = z.total_out;
+   deflateEnd( &z );
+   return out;
+}
+
+
+/**
+ * @brief Writes a serialized game to disk.
+ *
+ * Runs on the threadpool for normal saves, so it must not log.
+ *
+ *    @param data Write to do.
+ *    @return 0 on success.
+ */
+static int save_writeThread( void *data )
+{
+   SaveWrite *sw;
+   Uint64 start;
+   const char *out;
+   char *gz;
+
+   sw = (SaveWrite*) data;
+   start = SDL_GetPerformanceCounter();
+   out = (const char*) xmlBufferContent(sw->buf);
+   sw->size = xmlBufferLength(sw->buf);
+   gz = NULL;
+   if (sw->compress) {
+      gz = save_gzip( out, sw->size, &sw->size );
+      /* Falls back to plain XML on failure, which loads just as well. */
+      if (gz != NULL)
+         out = gz;
+   }
+   sw->ret = nfile_writeFileAtomic( out, sw->size, sw->path, sw->backup );
+   sw->err = errno;
+   free( gz );
+   sw->time = (double)(SDL_GetPerformanceCounter() - start)
+         / (double)SDL_GetPerformanceFrequency();
+
+   if (sw->done != NULL)
+      SDL_SemPost( sw->done );
+   return sw->ret;
+}
+
+
+/**
+ * @brief Reports and cleans up the save being written in the background.
+ *
+ *    @param block Whether to wait for the write to finish.
+ */
+static void save_finish( int block )
+{
+   SaveWrite *sw = save_pending;
+
+   if (sw == NULL)
+      return;
+   if (block)
+      SDL_SemWait( sw->done );
+   else if (SDL_SemTryWait( sw->done ) != 0)
+      return;
+   save_pending = NULL;
+
+   if (sw->ret != 0) {
+      WARN(_("Failed to write saved game '%s': %s"), sw->path,
+            strerror(sw->err));
+      save_failed = 1;
+   }
+   else {
+      DEBUG(_("Wrote saved game (%lu bytes) in %.1f ms"),
+            (unsigned long)sw->size, 1000. * sw->time);
+      load_indexUpdate( sw->file, sw->backup != NULL,
+            (const char*)xmlBufferContent(sw->buf), xmlBufferLength(sw->buf) );
+   }
+
+   SDL_DestroySemaphore( sw->done );
+   xmlBufferFree( sw->buf );
+   free( sw->path );
+   free( sw->file );
+   free( sw->backup );
+   free( sw );
+}
+
+
+/**
+ * @brief Checks whether the save being written in the background is done.
+ *
+ * Should be called regularly from the main loop to report the result, the
+ *  player is alerted of failed writes here.
+ */
+void save_update (void)
+{
+   save_finish( 0 );
+
+   if (save_failed) {
+      save_failed = 0;
+      dialogue_alert( _("Failed to save game! You should exit and check the log to see what happened and then file a bug report!") );
+   }
+}
+
+
+/**
+ * @brief Waits until the save being written in the background is on disk.
+ *
+ * Must be called before reading saved games.
+ */
+void save_wait (void)
+{
+   save_finish( 1 );
+}
+
+
+/**
+ * @brief Saves the current game.
+ *
+ * The game is serialized right away, but written to disk in the
+ *  background. Use save_wait() to make sure it's done, failed writes are
+ *  reported to the player by save_update().
+ *
+ *    @return 0 on success.
+ */
+int save_all (void)
+{
+   char file[PATH_MAX], buf[PATH_MAX];
+   xmlBufferPtr save;
+   SaveWrite *sw;
+   int written;
+
+   /* Do not save if saving is off. */
+   if (player_isFlag(PLAYER_NOSAVE))
+      return 0;
+
+   /* Only one save may be written at a time. */
+   save_wait();
+
+   /* Serialize the game. */
+   save = save_serialize( player.name );
+   if (save == NULL)
+      return -1;
 
    /* Write to file. */
    if (PHYSFS_mkdir("saves") == 0) {
       snprintf(file, sizeof(file), "%s/saves", PHYSFS_getWriteDir());
       WARN(_("Dir '%s' does not exist and unable to create: %s"), file,
             PHYSFS_getErrorByCode(PHYSFS_getLastErrorCode()));
-      ret = -1;
-      goto exit;
+      xmlBufferFree(save);
+      return -1;
    }
    str2filename(buf, sizeof(buf), player.name);
-   written = snprintf(file, sizeof(file), "saves/%s.ns", buf);
-   if (written < 0) {
-      WARN(_("Error writing save file name."));
-      goto exit;
-   }
-   else if (written >= (int)sizeof(file))
-      WARN(_("Save file name was truncated: %s"), file);
-
-   /* Back up old saved game. */
-   if (!save_loaded) {
-      if (ndata_backupIfExists(file) < 0) {
-         WARN(_("Aborting save..."));
-         ret = -1;
-         goto exit;
-      }
-   }
-   save_loaded = 0;
-
-   /* Critical section, if crashes here player's game gets corrupted.
-    * Luckily we have a copy just in case... */
-   /* TODO: write via physfs */
    written = snprintf(file, sizeof(file), "%s/saves/%s.ns",
          PHYSFS_getWriteDir(), buf);
    if (written < 0) {
       WARN(_("Error writing save file name."));
-      goto exit;
+      xmlBufferFree(save);
+      return 0;
    }
    else if (written >= (int)sizeof(file))
       WARN(_("Save file name was truncated: %s"), file);
 
-   if (xmlSaveFileEnc(file, doc, "UTF-8") < 0) {
-      WARN(_("Failed to write saved game! You'll most likely have to"
-            " restore it by copying your backup saved game over your"
-            " current saved game."));
-      ret = -1;
-   }
+   sw = calloc( 1, sizeof(SaveWrite) );
+   sw->buf = save;
+   sw->path = strdup( file );
+   asprintf( &sw->file, "%s.ns", buf );
+   sw->compress = conf.save_compress;
+   /* Back up old saved game, unless it was just loaded. */
+   if (!save_loaded)
+      asprintf( &sw->backup, "%s.backup", file );
+   save_loaded = 0;
 
-exit:
-   xmlFreeTextWriter(writer);
-   xmlFreeDoc(doc);
+   /* The write replaces the saved game atomically, so crashing while it's
+    * in progress leaves the previous save intact. */
+   sw->done = SDL_CreateSemaphore( 0 );
+   save_pending = sw;
+   threadpool_newJob( save_writeThread, sw );
 
-   return ret;
+   return 0;
 }
 
 
@@ -206,10 +416,8 @@ exit:
 int save_snapshot(const char *annotation)
 {
    char buf[PATH_MAX], buf2[PATH_MAX];
-   char *snapfile;
-   char *path;
-   xmlDocPtr doc;
-   xmlTextWriterPtr writer;
+   char *snapfile, *fullname;
+   SaveWrite sw;
    int ret;
 
    /* Do not save if saving is off. */
@@ -218,49 +426,21 @@ int save_snapshot(const char *annotation)
       return 0;
    }
 
-   /* Create the writer. */
-   writer = xmlNewTextWriterDoc(&doc, 0);
-   if (writer == NULL) {
-      ERR(_("testXmlwriterDoc: Error creating the xml writer"));
+   /* Serialize the game. */
+   memset( &sw, 0, sizeof(sw) );
+   sw.compress = conf.save_compress;
+   asprintf(&fullname, p_("snapshot_name", "%s (%s)"), annotation,
+         player.name);
+   sw.buf = save_serialize( fullname );
+   free(fullname);
+   if (sw.buf == NULL)
       return -1;
-   }
 
    /* path and snapfile need to be NULL by default in case we exit
     * without using asprintf (otherwise we'd call free() on an arbitrary
     * location and cause problems). */
    ret = 0;
    snapfile = NULL;
-   path = NULL;
-
-   /* Set the writer parameters. */
-   xmlw_setParams(writer);
-
-   /* Start element. */
-   xmlw_start(writer);
-   xmlw_startElem(writer, "naev_save");
-
-   /* Save the version and such. */
-   xmlw_startElem(writer,"version");
-   xmlw_elem(writer, "naev", "%s", VERSION);
-   xmlw_elem(writer, "data", "%s", start_name());
-   xmlw_elem(writer, "player_name", "%s", player.name);
-   xmlw_elem(writer, "annotation",
-         p_("snapshot_name", "%s (%s)"), annotation, player.name);
-   xmlw_endElem(writer); /* "version" */
-
-   /* Save last played. */
-   xmlw_saveTime(writer, "last_played", time(NULL));
-
-   /* Save the data. */
-   if (save_data(writer) < 0) {
-      ERR(_("Error trying to save game data"));
-      ret = -1;
-      goto exit;
-   }
-
-   /* Finish element. */
-   xmlw_endElem(writer); /* "naev_save" */
-   xmlw_done(writer);
 
    /* Write to file. */
    if (PHYSFS_mkdir("saves") == 0) {
@@ -273,7 +453,7 @@ int save_snapshot(const char *annotation)
    str2filename(buf, sizeof(buf), player.name);
    str2filename(buf2, sizeof(buf2), annotation);
    asprintf(&snapfile, "saves/%s-%s.ns.snapshot", buf, buf2);
-   asprintf(&path, "%s/%s", PHYSFS_getWriteDir(), snapfile);
+   asprintf(&sw.path, "%s/%s", PHYSFS_getWriteDir(), snapfile);
 
    if (PHYSFS_exists(snapfile)
          && !dialogue_YesNo(_("Save Snapshot"),
@@ -282,20 +462,23 @@ int save_snapshot(const char *annotation)
       goto exit;
    }
 
-   /* TODO: write via physfs */
-   if (xmlSaveFileEnc(path, doc, "UTF-8") < 0) {
-      WARN(_("Failed to write snapshot."));
+   /* Snapshots are rare, so they're written right away. */
+   if (save_writeThread( &sw ) != 0) {
+      WARN(_("Failed to write snapshot: %s"), strerror(sw.err));
       ret = -1;
       goto exit;
    }
+   DEBUG(_("Wrote snapshot (%lu bytes) in %.1f ms"),
+         (unsigned long)sw.size, 1000. * sw.time);
+   load_indexUpdate( &snapfile[strlen("saves/")], 0,
+         (const char*)xmlBufferContent(sw.buf), xmlBufferLength(sw.buf) );
 
    dialogue_msg(_("Save Snapshot"), _("Snapshot '%s' saved."), annotation);
 
 exit:
-   xmlFreeTextWriter(writer);
-   xmlFreeDoc(doc);
+   xmlBufferFree(sw.buf);
    free(snapfile);
-   free(path);
+   free(sw.path);
 
    return ret;
 }
@@ -10,6 +10,8 @@
 int save_all (void);
 int save_snapshot(const char *annotation);
 void save_reload (void);
+void save_update (void);
+void save_wait (void);
 
 
 #endif /* SAVE_H */
@@ -101,6 +101,14 @@ SHADERS = [
       uniforms = ["projection", "color", "tex_mat"],
       subroutines = {},
    ),
+   Shader(
+      name = "texture_batch",
+      vs_path = "texture_batch.vert",
+      fs_path = "texture_batch.frag",
+      attributes = ["vertex", "vertex_tex", "vertex_color"],
+      uniforms = ["projection"],
+      subroutines = {},
+   ),
    Shader(
       name = "texture_interpolate",
       vs_path = "texture.vert",
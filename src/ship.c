@@ -11,8 +11,6 @@
 
 /** @cond */
 #include <limits.h>
-#include "physfsrwops.h"
-#include "SDL_image.h"
 
 #include "naev.h"
 /** @endcond */
@@ -222,67 +220,81 @@ glTexture* ship_loadCommGFX( const Ship* s )
 
 
 /**
- * @brief Generates a target graphic for a ship.
+ * @brief Crops the targeting sprite of a ship into a new surface.
+ *
+ *    @param surface Sprite sheet of the ship.
+ *    @param space Space graphic of the ship with the sprite layout.
+ *    @param w Width of the surface to create.
+ *    @param h Height of the surface to create.
+ *    @return The surface with the sprite centered on it.
  */
-static int ship_genTargetGFX( Ship *temp, SDL_Surface *surface, int sx, int sy )
+static SDL_Surface* ship_genGFX( SDL_Surface *surface,
+      const glTexture *space, int w, int h )
 {
-   SDL_Surface *gfx, *gfx_store;
+   SDL_Surface *gfx;
    int x, y, sw, sh;
    SDL_Rect rtemp, dstrect;
-   char buf[PATH_MAX];
 
    /* Get sprite size. */
-   sw = temp->gfx_space->w / sx;
-   sh = temp->gfx_space->h / sy;
+   sw = space->w / space->sx;
+   sh = space->h / space->sy;
 
    /* Create the surface. */
    SDL_SetSurfaceBlendMode(surface, SDL_BLENDMODE_NONE);
-
-   /* create the temp POT surface */
-   gfx = SDL_CreateRGBSurface( 0, sw, sh,
+   gfx = SDL_CreateRGBSurface( 0, w, h,
          surface->format->BytesPerPixel*8, RGBAMASK );
-   gfx_store = SDL_CreateRGBSurface( 0, SHIP_TARGET_W, SHIP_TARGET_H,
-         surface->format->BytesPerPixel*8, RGBAMASK );
-
-   if (gfx == NULL) {
-      WARN( _("Unable to create ship '%s' targeting surface."), temp->name );
-      return -1;
-   }
+   if (gfx == NULL)
+      return NULL;
 
-   /* Copy over for target. */
-   gl_getSpriteFromDir( &x, &y, temp->gfx_space, M_PI* 5./4. );
+   /* Copy over the sprite. */
+   gl_getSpriteFromDir( &x, &y, space, M_PI* 5./4. );
    rtemp.x = sw * x;
    rtemp.y = sh * y;
    rtemp.w = sw;
    rtemp.h = sh;
-   dstrect.x = 0;
-   dstrect.y = 0;
+   dstrect.x = (w - sw) / 2;
+   dstrect.y = (h - sh) / 2;
    dstrect.w = rtemp.w;
    dstrect.h = rtemp.h;
    SDL_BlitSurface( surface, &rtemp, gfx, &dstrect );
 
-   /* Copy over for store. */
-   dstrect.x = (SHIP_TARGET_W - sw) / 2;
-   dstrect.y = (SHIP_TARGET_H - sh) / 2;
-   dstrect.w = rtemp.w;
-   dstrect.h = rtemp.h;
-   SDL_BlitSurface( surface, &rtemp, gfx_store, &dstrect );
+   return gfx;
+}
 
-   /* Load the store surface. */
-   snprintf( buf, sizeof(buf), "%s_gfx_store", temp->name );
-   temp->gfx_store = gl_loadImagePad( buf, gfx_store, OPENGL_TEX_VFLIP, SHIP_TARGET_W, SHIP_TARGET_H, 1, 1, 1 );
 
-   /* Load the surface. */
-   snprintf( buf, sizeof(buf), "%s_gfx_target", temp->name );
-   temp->gfx_target = gl_loadImagePad( buf, gfx, OPENGL_TEX_VFLIP, sw, sh, 1, 1, 1 );
+/**
+ * @brief Texture filter generating the target graphic of a ship.
+ *
+ *    @param surface Sprite sheet of the ship.
+ *    @param data Space graphic of the ship.
+ */
+static SDL_Surface* ship_genTargetGFX( SDL_Surface *surface, void *data )
+{
+   const glTexture *space = (const glTexture*) data;
+   return ship_genGFX( surface, space, space->sw, space->sh );
+}
 
-   return 0;
+
+/**
+ * @brief Texture filter generating the store graphic of a ship.
+ *
+ *    @param surface Sprite sheet of the ship.
+ *    @param data Space graphic of the ship.
+ */
+static SDL_Surface* ship_genStoreGFX( SDL_Surface *surface, void *data )
+{
+   const glTexture *space = (const glTexture*) data;
+   return ship_genGFX( surface, space, SHIP_TARGET_W, SHIP_TARGET_H );
 }
 
 
 /**
  * @brief Loads the space graphics for a ship from an image.
  *
+ * The graphics are lazy, only the size of the image is read here. The
+ *  target and store graphics get cropped from the image when they're
+ *  first needed.
+ *
  *    @param temp Ship to load into.
  *    @param str Path of the image to use.
  *    @param sx Number of X sprites in image.
@@ -290,31 +302,26 @@ static int ship_genTargetGFX( Ship *temp, SDL_Surface *surface, int sx, int sy )
  */
 static int ship_loadSpaceImage( Ship *temp, char *str, int sx, int sy )
 {
-   SDL_RWops *rw;
-   SDL_Surface *surface;
-   int ret;
+   char buf[PATH_MAX];
 
    /* Load the space sprite. */
-   rw    = PHYSFSRWOPS_openRead( str );
-   if (rw==NULL) {
+   temp->gfx_space = gl_newSprite( str, sx, sy,
+         OPENGL_TEX_MAPTRANS | OPENGL_TEX_MIPMAPS | OPENGL_TEX_LAZY );
+   if (temp->gfx_space == NULL) {
       WARN(_("Unable to open '%s' for reading!"), str);
       return -1;
    }
-   surface = IMG_Load_RW( rw, 0 );
 
-   /* Load the texture. */
-   temp->gfx_space = gl_loadImagePadTrans( str, surface, rw,
-         OPENGL_TEX_MAPTRANS | OPENGL_TEX_MIPMAPS | OPENGL_TEX_VFLIP,
-         surface->w, surface->h, sx, sy, 0 );
+   /* Create the store graphic. */
+   snprintf( buf, sizeof(buf), "%s_gfx_store", temp->name );
+   temp->gfx_store = gl_newLazy( buf, str, SHIP_TARGET_W, SHIP_TARGET_H,
+         1, 1, OPENGL_TEX_VFLIP, ship_genStoreGFX, temp->gfx_space );
 
    /* Create the target graphic. */
-   ret = ship_genTargetGFX( temp, surface, sx, sy );
-   if (ret != 0)
-      return ret;
-
-   /* Free stuff. */
-   SDL_RWclose( rw );
-   SDL_FreeSurface( surface );
+   snprintf( buf, sizeof(buf), "%s_gfx_target", temp->name );
+   temp->gfx_target = gl_newLazy( buf, str,
+         temp->gfx_space->sw, temp->gfx_space->sh,
+         1, 1, OPENGL_TEX_VFLIP, ship_genTargetGFX, temp->gfx_space );
 
    /* Calculate mount angle. */
    temp->mangle  = 2.*M_PI;
@@ -333,11 +340,38 @@ static int ship_loadSpaceImage( Ship *temp, char *str, int sx, int sy )
  */
 static int ship_loadEngineImage( Ship *temp, char *str, int sx, int sy )
 {
-   temp->gfx_engine = gl_newSprite( str, sx, sy, OPENGL_TEX_MIPMAPS );
+   temp->gfx_engine = gl_newSprite( str, sx, sy,
+         OPENGL_TEX_MIPMAPS | OPENGL_TEX_LAZY );
    return (temp->gfx_engine != NULL);
 }
 
 
+/**
+ * @brief Starts loading the graphics a ship needs in space.
+ *
+ *    @param s Ship to prefetch graphics of.
+ */
+void ship_gfxPrefetch( const Ship *s )
+{
+   gl_texPrefetch( s->gfx_space );
+   gl_texPrefetch( s->gfx_engine );
+   gl_texPrefetch( s->gfx_target );
+}
+
+
+/**
+ * @brief Loads the graphics a ship needs in space right away.
+ *
+ *    @param s Ship to load graphics of.
+ */
+void ship_gfxLoad( const Ship *s )
+{
+   gl_texLoad( s->gfx_space );
+   gl_texLoad( s->gfx_engine );
+   gl_texLoad( s->gfx_target );
+}
+
+
 /**
  * @brief Loads the graphics for a ship.
  *
@@ -396,9 +430,6 @@ static int ship_loadGFX( Ship *temp, const char *buf, int sx, int sy, int engine
 static int ship_loadPLG( Ship *temp, const char *buf, int size_hint )
 {
    char *file;
-   CollPoly *polygon;
-   xmlDocPtr doc;
-   xmlNodePtr node, cur;
 
    asprintf( &file, "%s%s.xml", SHIP_POLYGON_PATH, buf );
 
@@ -412,38 +443,10 @@ static int ship_loadPLG( Ship *temp, const char *buf, int size_hint )
       return 0;
    }
 
-   /* Load the XML. */
-   doc  = xml_parsePhysFS( file );
-
-   if (doc == NULL) {
-      free(file);
-      return 0;
-   }
-
-   node = doc->xmlChildrenNode; /* First polygon node */
-   if (node == NULL) {
-      xmlFreeDoc(doc);
-      WARN(_("Malformed %s file: does not contain elements"), file);
-      free(file);
-      return 0;
-   }
+   /* Load the polygons. */
+   temp->polygon = LoadPolygonFile( file, size_hint );
 
    free(file);
-
-   do { /* load the polygon data */
-      if (xml_isNode(node,"polygons")) {
-         cur = node->children;
-         temp->polygon = array_create_size( CollPoly, size_hint );
-         do {
-            if (xml_isNode(cur,"polygon")) {
-               polygon = &array_grow( &temp->polygon );
-               LoadPolygon( polygon, cur );
-            }
-         } while (xml_nextNode(cur));
-      }
-   } while (xml_nextNode(node));
-
-   xmlFreeDoc(doc);
    return 0;
 }
 
@@ -652,7 +655,8 @@ static int ship_parse( Ship *temp, xmlNodePtr parent )
             xml_onlyNodes(cur);
             if (xml_isNode(cur,"gfx_overlay"))
                array_push_back( &temp->gfx_overlays,
-                     xml_parseTexture( cur, OVERLAY_GFX_PATH"%s", 1, 1, OPENGL_TEX_MIPMAPS ) );
+                     xml_parseTexture( cur, OVERLAY_GFX_PATH"%s", 1, 1,
+                        OPENGL_TEX_MIPMAPS | OPENGL_TEX_LAZY ) );
          } while (xml_nextNode(cur));
          continue;
       }
@@ -844,10 +848,10 @@ static int ship_parse( Ship *temp, xmlNodePtr parent )
 int ships_load (void)
 {
    size_t nfiles;
-   char **ship_files, *file;
+   char **ship_files, **xml_files, *file;
    int i;
    xmlNodePtr node;
-   xmlDocPtr doc;
+   XmlFile *docs;
 
    /* Validity. */
    ss_check();
@@ -859,41 +863,49 @@ int ships_load (void)
    if (ship_stack == NULL)
       ship_stack = array_create_size(Ship, nfiles);
 
+   /* Get the file names, sorted so load order doesn't depend on
+    * the enumeration order. */
+   xml_files = array_create_size( char*, nfiles );
    for (i=0; ship_files[i]!=NULL; i++) {
-      if (naev_pollQuit())
-         break;
-
       if (!ndata_matchExt( ship_files[i], "xml" ))
          continue;
-
-      /* Get the file name .*/
       asprintf( &file, "%s%s", SHIP_DATA_PATH, ship_files[i] );
+      array_push_back( &xml_files, file );
+   }
+   qsort( xml_files, array_size(xml_files), sizeof(char*), strsort );
 
-      /* Load the XML. */
-      doc  = xml_parsePhysFS( file );
+   /* Read and parse the XML in parallel, then load in file order. */
+   docs = xml_parsePhysFSList( xml_files, NULL );
+   for (i=0; i<array_size(docs); i++) {
+      if (naev_pollQuit())
+         break;
 
-      if (doc == NULL) {
-         free(file);
+      if (docs[i].status == XMLFILE_NOREAD) {
+         WARN( _("Unable to read data from '%s': %s"), docs[i].filename,
+               docs[i].error );
+         continue;
+      }
+      else if (docs[i].status != XMLFILE_OK) {
+         WARN( _("Unable to parse document '%s'"), docs[i].filename );
          continue;
       }
 
-      node = doc->xmlChildrenNode; /* First ship node */
+      node = docs[i].doc->xmlChildrenNode; /* First ship node */
       if (node == NULL) {
-         xmlFreeDoc(doc);
-         WARN(_("Malformed %s file: does not contain elements"), file);
-         free(file);
+         WARN(_("Malformed %s file: does not contain elements"),
+               docs[i].filename);
          continue;
       }
 
-      free(file);
-
       if (xml_isNode(node, XML_SHIP))
          /* Load the ship. */
          ship_parse( &array_grow(&ship_stack), node );
-
-      /* Clean up. */
-      xmlFreeDoc(doc);
    }
+   xml_freeFileList( docs );
+
+   for (i=0; i<array_size(xml_files); i++)
+      free( xml_files[i] );
+   array_free( xml_files );
 
    /* Shrink stack. */
    array_shrink(&ship_stack);
@@ -941,10 +953,10 @@ void ships_free (void)
 
       /* Free graphics. */
       object_free(s->gfx_3d);
-      gl_freeTexture(s->gfx_space);
-      gl_freeTexture(s->gfx_engine);
       gl_freeTexture(s->gfx_target);
       gl_freeTexture(s->gfx_store);
+      gl_freeTexture(s->gfx_space); /* After target and store which use it. */
+      gl_freeTexture(s->gfx_engine);
       free(s->gfx_comm);
       for (j=0; j<array_size(s->gfx_overlays); j++)
          gl_freeTexture(s->gfx_overlays[j]);
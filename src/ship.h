@@ -186,6 +186,8 @@ const Ship* ship_getAll (void);
 credits_t ship_basePrice( const Ship* s );
 credits_t ship_buyPrice( const Ship* s );
 glTexture* ship_loadCommGFX( const Ship* s );
+void ship_gfxPrefetch( const Ship *s );
+void ship_gfxLoad( const Ship *s );
 
 
 /*
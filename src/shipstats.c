@@ -15,6 +15,7 @@
 
 #include "shipstats.h"
 
+#include "array.h"
 #include "log.h"
 #include "nstring.h"
 
@@ -789,6 +790,45 @@ int ss_statsModFromList( ShipStats *stats, const ShipStatList* list )
 }
 
 
+/**
+ * @brief Updates a stat structure from a compiled stat list.
+ *
+ *    @param stats Stats to update.
+ *    @param ops Operations compiled with ss_listCompile() (may be NULL).
+ */
+void ss_statsModFromOps( ShipStats *stats, const ShipStatOp *ops )
+{
+   int i, n;
+   char *ptr;
+   double *dbl;
+
+   ptr = (char*) stats;
+   n = array_size( ops );
+   for (i=0; i<n; i++) {
+      switch (ops[i].op) {
+         case SS_OP_MULTIPLY:
+            dbl = (double*) &ptr[ ops[i].offset ];
+            *dbl *= ops[i].d.d;
+            if (*dbl < 0.) /* Don't let the values go negative. */
+               *dbl = 0.;
+            break;
+
+         case SS_OP_ADD:
+            *(double*) &ptr[ ops[i].offset ] += ops[i].d.d;
+            break;
+
+         case SS_OP_ADD_INT:
+            *(int*) &ptr[ ops[i].offset ] += ops[i].d.i;
+            break;
+
+         case SS_OP_SET:
+            *(int*) &ptr[ ops[i].offset ] = 1;
+            break;
+      }
+   }
+}
+
+
 /**
  * @brief Gets the name from type.
  *
@@ -1120,6 +1160,61 @@ int ss_statsDesc(const ShipStats *s, char *buf, int len, int newline,
 }
 
 
+/**
+ * @brief Compiles a list of ship stats into a flat array of operations.
+ *
+ * The operations give exactly the same results as ss_statsModFromList()
+ *  when applied with ss_statsModFromOps().
+ *
+ *    @param ll List to compile.
+ *    @return Array (array.h) of operations in the order of the list, or
+ *            NULL if the list is empty. Free with array_free().
+ */
+ShipStatOp* ss_listCompile( const ShipStatList *ll )
+{
+   int n;
+   const ShipStatList *l;
+   const ShipStatsLookup *sl;
+   ShipStatOp *ops, *op;
+
+   n = 0;
+   for (l=ll; l!=NULL; l=l->next)
+      n++;
+   if (n == 0)
+      return NULL;
+
+   ops = array_create_size( ShipStatOp, n );
+   for (l=ll; l!=NULL; l=l->next) {
+      sl = &ss_lookup[ l->type ];
+      op = &array_grow( &ops );
+      op->offset = sl->offset;
+      switch (sl->data) {
+         case SS_DATA_TYPE_DOUBLE:
+            op->op = SS_OP_MULTIPLY;
+            op->d.d = 1.0+l->d.d;
+            break;
+
+         case SS_DATA_TYPE_DOUBLE_ABSOLUTE:
+         case SS_DATA_TYPE_DOUBLE_ABSOLUTE_PERCENT:
+            op->op = SS_OP_ADD;
+            op->d.d = l->d.d;
+            break;
+
+         case SS_DATA_TYPE_INTEGER:
+            op->op = SS_OP_ADD_INT;
+            op->d.i = l->d.i;
+            break;
+
+         case SS_DATA_TYPE_BOOLEAN:
+            op->op = SS_OP_SET;
+            op->d.i = 1;
+            break;
+      }
+   }
+   return ops;
+}
+
+
 /**
  * @brief Frees a list of ship stats.
  *
@@ -200,6 +200,33 @@ typedef struct ShipStatList_ {
 } ShipStatList;
 
 
+/**
+ * @brief Operations of a compiled stat list.
+ */
+typedef enum ShipStatOpType_ {
+   SS_OP_MULTIPLY, /**< Multiplies a double by the value without going below 0. */
+   SS_OP_ADD, /**< Adds the value to a double. */
+   SS_OP_ADD_INT, /**< Adds the value to an integer. */
+   SS_OP_SET /**< Sets an integer to 1. */
+} ShipStatOpType;
+
+
+/**
+ * @brief Single operation of a compiled stat list.
+ *
+ * Compiled with ss_listCompile() so applying the list doesn't have to
+ *  follow pointers or look up the type of every stat.
+ */
+typedef struct ShipStatOp_ {
+   size_t offset; /**< Offset of the stat in ShipStats. */
+   ShipStatOpType op; /**< Operation to do. */
+   union {
+      double d; /**< Floating point value, already 1+x for multiplications. */
+      int    i; /**< Integer value. */
+   } d; /**< Value of the operation. */
+} ShipStatOp;
+
+
 /**
  * @brief Represents ship statistics, properties ship can use.
  *
@@ -377,6 +404,7 @@ int ss_check (void);
  * Loading.
  */
 ShipStatList* ss_listFromXML( xmlNodePtr node );
+ShipStatOp* ss_listCompile( const ShipStatList *ll );
 void ss_free( ShipStatList *ll );
 
 /*
@@ -386,6 +414,7 @@ int ss_statsInit( ShipStats *stats );
 int ss_statsMerge( ShipStats *dest, const ShipStats *src );
 int ss_statsModSingle( ShipStats *stats, const ShipStatList* list );
 int ss_statsModFromList( ShipStats *stats, const ShipStatList* list );
+void ss_statsModFromOps( ShipStats *stats, const ShipStatOp *ops );
 
 /*
  * Lookup.
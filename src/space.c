@@ -74,6 +74,8 @@
 
 #define ASTEROID_EXPLODE_INTERVAL 5. /**< Interval of asteroids randomly exploding */
 #define ASTEROID_EXPLODE_CHANCE   0.1 /**< Chance of asteroid exploding each interval */
+#define ASTEROID_FADE_TIME        2. /**< Time asteroids take to appear or disappear */
+#define ASTEROID_EXPLODE_DELAY    .5 /**< Time between destroying an asteroid and its explosion */
 
 /*
  * planet <-> system name stack
@@ -128,7 +130,9 @@ static int space_parseAssets( xmlNodePtr parent, StarSystem* sys );
 /* system load */
 static void system_init( StarSystem *sys );
 static void asteroid_init( Asteroid *ast, AsteroidAnchor *field );
-static void debris_init( Debris *deb );
+static void debris_init( AsteroidAnchor *field, int i );
+static void motion_alloc( AsteroidMotion *m, int n );
+static void motion_free( AsteroidMotion *m );
 static int systems_load (void);
 static int asteroidTypes_load (void);
 static StarSystem* system_parse( StarSystem *system, const xmlNodePtr parent );
@@ -141,11 +145,15 @@ static void system_parseAsteroids( const xmlNodePtr parent, StarSystem *sys );
 static int getPresenceIndex(StarSystem *sys, factionId_t faction);
 static void system_scheduler( double dt, int init );
 static void asteroid_explode ( Asteroid *a, AsteroidAnchor *field, int give_reward );
+static void asteroid_setState( Asteroid *a, AsteroidAnchor *field, int state );
+static void asteroid_updateState( Asteroid *a, AsteroidAnchor *field );
+static void asteroids_update( AsteroidAnchor *field, double dt );
 /* Render. */
 static void space_renderJumpPoint( const JumpPoint *jp, int i );
 static void space_renderPlanet( const Planet *p );
-static void space_renderAsteroid( const Asteroid *a );
-static void space_renderDebris( const Debris *d, double x, double y );
+static void space_renderAsteroid( const Asteroid *a, const AsteroidAnchor *field );
+static void space_renderDebris( const AsteroidAnchor *field, int i,
+      double x, double y );
 /*
  * Externed prototypes.
  */
@@ -553,7 +561,7 @@ double system_getClosest( const StarSystem *sys, int *pnt, int *jp, int *ast, in
          if (!pilot_inRangeAsteroid( player.p, k, i ))
             continue;
 
-         td = pow2(x-as->pos.x) + pow2(y-as->pos.y);
+         td = pow2(x-f->motion.x[k]) + pow2(y-f->motion.y[k]);
          if (td < d) {
             *pnt  = -1; /* We must clear planet target as asteroid is closer. */
             *ast  = k;
@@ -630,7 +638,7 @@ double system_getClosestAng( const StarSystem *sys, int *pnt, int *jp, int *ast,
          if (as->appearing == ASTEROID_INVISIBLE)
             continue;
 
-         ta = atan2( y - as->pos.y, x - as->pos.x);
+         ta = atan2( y - f->motion.y[k], x - f->motion.x[k] );
          if ( ABS(angle_diff(ang, ta)) < ABS(angle_diff(ang, a))) {
             *pnt  = -1; /* We must clear planet target as asteroid is closer. */
             *ast  = k;
@@ -1206,12 +1214,10 @@ void space_checkLand (void)
 void space_update( const double dt )
 {
    int i, j;
-   double x, y;
+   double x, y, *dx, *dy;
    Damage dmg;
    HookParam hparam[3];
    AsteroidAnchor *ast;
-   Asteroid *a;
-   Debris *d;
    Pilot *pplayer;
    Solid *psolid;
    int found_something;
@@ -1301,85 +1307,165 @@ void space_update( const double dt )
    gatherable_update(dt);
 
    /* Asteroids/Debris update */
+   x = 0;
+   y = 0;
+   pplayer = pilot_get( PLAYER_ID );
+   if (pplayer != NULL) {
+      psolid  = pplayer->solid;
+      x = psolid->vel.x;
+      y = psolid->vel.y;
+   }
    for (i=0; i<array_size(cur_system->asteroids); i++) {
       ast = &cur_system->asteroids[i];
+      asteroids_update( ast, dt );
 
-      for (j=0; j<ast->nb; j++) {
-         a = &ast->asteroids[j];
+      /* Debris move with the player's view. */
+      asteroid_motionUpdate( &ast->debris_motion, ast->ndebris, x, y, dt );
+      for (j=0; j<ast->ndebris; j++) {
+         dx = &ast->debris_motion.x[j];
+         dy = &ast->debris_motion.y[j];
 
-         /* Skip invisible asteroids */
-         if (a->appearing == ASTEROID_INVISIBLE)
-            continue;
+         /* Check boundaries */
+         if (*dx > SCREEN_W + DEBRIS_BUFFER)
+            *dx -= SCREEN_W + 2*DEBRIS_BUFFER;
+         else if (*dx < -DEBRIS_BUFFER)
+            *dx += SCREEN_W + 2*DEBRIS_BUFFER;
+         if (*dy > SCREEN_H + DEBRIS_BUFFER)
+            *dy -= SCREEN_H + 2*DEBRIS_BUFFER;
+         else if (*dy < -DEBRIS_BUFFER)
+            *dy += SCREEN_H + 2*DEBRIS_BUFFER;
+      }
+   }
+}
 
-         a->pos.x += a->vel.x * dt;
-         a->pos.y += a->vel.y * dt;
-
-         if (a->appearing == ASTEROID_VISIBLE) {
-            /* Random explosions */
-            a->timer += dt;
-            if (a->timer >= ASTEROID_EXPLODE_INTERVAL) {
-               a->timer = 0.;
-               if ( (RNGF() < ASTEROID_EXPLODE_CHANCE)
-                     || (space_isInField(&a->pos) < 0) ) {
-                  asteroid_explode( a, ast,
-                        (a->armour < asteroid_types[a->type].armour) );
-               }
-            }
-         }
-         else if (a->appearing == ASTEROID_GROWING) {
-            /* Grow */
-            a->timer += dt;
-            if (a->timer >= 2.) {
-               a->timer = 0.;
-               a->appearing = ASTEROID_VISIBLE;
-            }
-         }
-         else if (a->appearing == ASTEROID_SHRINKING) {
-            /* Shrink */
-            a->timer += dt;
-            if (a->timer >= 2.) {
-               /* Remove the asteroid target to any pilot. */
-               pilot_untargetAsteroid( a->parent, a->id );
-               /* reinit any disappeared asteroid */
-               asteroid_init( a, ast );
-            }
-         }
-         else if (a->appearing == ASTEROID_EXPLODING) {
-            /* Exploding asteroid */
-            a->timer += dt;
-            if (a->timer >= .5) {
-               /* Make it explode */
-               asteroid_explode( a, ast, 1 );
-            }
+
+/**
+ * @brief Moves a set of asteroids or debris.
+ *
+ * Kept free of branches so the compiler can vectorize it.
+ *
+ *    @param m Motion to update.
+ *    @param n Number of bodies.
+ *    @param vx X velocity of the frame of reference.
+ *    @param vy Y velocity of the frame of reference.
+ *    @param dt Current delta tick.
+ */
+void asteroid_motionUpdate( AsteroidMotion *m, int n, double vx, double vy,
+      double dt )
+{
+   int i;
+   double *x, *y;
+   const double *mvx, *mvy;
+
+   x = m->x;
+   y = m->y;
+   mvx = m->vx;
+   mvy = m->vy;
+   for (i=0; i<n; i++) {
+      x[i] += (mvx[i]-vx) * dt;
+      y[i] += (mvy[i]-vy) * dt;
+   }
+}
+
+
+/**
+ * @brief Updates the asteroids of a field.
+ *
+ * All the asteroids are moved and their timers advanced in one sweep, then
+ *  the few whose timer reached the time of their next change of state are
+ *  handled one by one.
+ *
+ *    @param field Field to update.
+ *    @param dt Current delta tick.
+ */
+static void asteroids_update( AsteroidAnchor *field, double dt )
+{
+   int i;
+   double *timer;
+   const double *due;
+
+   asteroid_motionUpdate( &field->motion, field->nb, 0., 0., dt );
+
+   timer = field->timer;
+   due = field->due;
+   for (i=0; i<field->nb; i++)
+      timer[i] += dt;
+   for (i=0; i<field->nb; i++)
+      if (timer[i] >= due[i])
+         asteroid_updateState( &field->asteroids[i], field );
+}
+
+
+/**
+ * @brief Changes the state of an asteroid whose timer ran out.
+ *
+ *    @param a Asteroid to update.
+ *    @param field Asteroid field the asteroid belongs to.
+ */
+static void asteroid_updateState( Asteroid *a, AsteroidAnchor *field )
+{
+   Vector2d pos;
+
+   switch (a->appearing) {
+      case ASTEROID_VISIBLE:
+         /* Random explosions */
+         asteroid_setState( a, field, ASTEROID_VISIBLE );
+         asteroid_getPos( a, &pos );
+         if ( (RNGF() < ASTEROID_EXPLODE_CHANCE)
+               || (space_isInField(&pos) < 0) ) {
+            asteroid_explode( a, field,
+                  (a->armour < asteroid_types[a->type].armour) );
          }
-      }
+         break;
 
-      x = 0;
-      y = 0;
-      pplayer = pilot_get( PLAYER_ID );
-      if (pplayer != NULL) {
-         psolid  = pplayer->solid;
-         x = psolid->vel.x;
-         y = psolid->vel.y;
-      }
+      case ASTEROID_GROWING:
+         /* Grow */
+         asteroid_setState( a, field, ASTEROID_VISIBLE );
+         break;
 
-      for (j=0; j<ast->ndebris; j++) {
-         d = &ast->debris[j];
+      case ASTEROID_SHRINKING:
+         /* Remove the asteroid target to any pilot. */
+         pilot_untargetAsteroid( a->parent, a->id );
+         /* reinit any disappeared asteroid */
+         asteroid_init( a, field );
+         break;
 
-         d->pos.x += (d->vel.x-x) * dt;
-         d->pos.y += (d->vel.y-y) * dt;
+      case ASTEROID_EXPLODING:
+         /* Make it explode */
+         asteroid_explode( a, field, 1 );
+         break;
+
+      default:
+         break;
+   }
+}
 
-         /* Check boundaries */
-         if (d->pos.x > SCREEN_W + DEBRIS_BUFFER)
-            d->pos.x -= SCREEN_W + 2*DEBRIS_BUFFER;
-         else if (d->pos.y > SCREEN_H + DEBRIS_BUFFER)
-            d->pos.y -= SCREEN_H + 2*DEBRIS_BUFFER;
-         else if (d->pos.x < -DEBRIS_BUFFER)
-            d->pos.x += SCREEN_W + 2*DEBRIS_BUFFER;
-         else if (d->pos.y < -DEBRIS_BUFFER)
-            d->pos.y += SCREEN_H + 2*DEBRIS_BUFFER;
-      }
 
+/**
+ * @brief Sets the state of an asteroid and restarts its timer.
+ *
+ *    @param a Asteroid to set.
+ *    @param field Asteroid field the asteroid belongs to.
+ *    @param state State to set (ASTEROID_VISIBLE, etc.).
+ */
+static void asteroid_setState( Asteroid *a, AsteroidAnchor *field, int state )
+{
+   a->appearing = state;
+   field->timer[a->id] = 0.;
+   switch (state) {
+      case ASTEROID_VISIBLE:
+         field->due[a->id] = ASTEROID_EXPLODE_INTERVAL;
+         break;
+      case ASTEROID_GROWING:
+      case ASTEROID_SHRINKING:
+         field->due[a->id] = ASTEROID_FADE_TIME;
+         break;
+      case ASTEROID_EXPLODING:
+         field->due[a->id] = ASTEROID_EXPLODE_DELAY;
+         break;
+      default:
+         field->due[a->id] = INFINITY;
+         break;
    }
 }
 
@@ -1405,7 +1491,6 @@ void space_init( const char* sysname )
    Planet *pnt;
    AsteroidAnchor *ast;
    Asteroid *a;
-   Debris *d;
    Damage dmg;
    double dshield, darmor;
 
@@ -1482,6 +1567,9 @@ void space_init( const char* sysname )
 
       /* Add the asteroids to the anchor */
       ast->asteroids = realloc( ast->asteroids, (ast->nb) * sizeof(Asteroid) );
+      motion_alloc( &ast->motion, ast->nb );
+      ast->timer = realloc( ast->timer, (ast->nb) * sizeof(double) );
+      ast->due = realloc( ast->due, (ast->nb) * sizeof(double) );
       for (j=0; j<ast->nb; j++) {
          a = &ast->asteroids[j];
          a->id = j;
@@ -1490,10 +1578,9 @@ void space_init( const char* sysname )
       }
       /* Add the debris to the anchor */
       ast->debris = realloc( ast->debris, (ast->ndebris) * sizeof(Debris) );
-      for (j=0; j<ast->ndebris; j++) {
-         d = &ast->debris[j];
-         debris_init(d);
-      }
+      motion_alloc( &ast->debris_motion, ast->ndebris );
+      for (j=0; j<ast->ndebris; j++)
+         debris_init( ast, j );
    }
 
    /* Reset music to ambient. */
@@ -1612,6 +1699,7 @@ void asteroid_init( Asteroid *ast, AsteroidAnchor *field )
    double mod, theta;
    double angle, radius;
    AsteroidType *at;
+   Vector2d pos;
    int attempts = 0;
 
    ast->parent = field->id;
@@ -1627,47 +1715,56 @@ void asteroid_init( Asteroid *ast, AsteroidAnchor *field )
    do {
       angle = RNGF() * 2 * M_PI;
       radius = RNGF() * field->radius;
-      ast->pos.x = radius * cos(angle) + field->pos.x;
-      ast->pos.y = radius * sin(angle) + field->pos.y;
+      vect_csetmin( &pos, radius * cos(angle) + field->pos.x,
+            radius * sin(angle) + field->pos.y );
+      field->motion.x[ast->id] = pos.x;
+      field->motion.y[ast->id] = pos.y;
 
       /* If this is the first time and it's spawned outside the field,
        * we get rid of it so that density remains roughly consistent. */
       if ( (ast->appearing == ASTEROID_INIT) &&
-            (space_isInField(&ast->pos) < 0) ) {
-         ast->appearing = ASTEROID_INVISIBLE;
+            (space_isInField(&pos) < 0) ) {
+         field->motion.vx[ast->id] = 0.;
+         field->motion.vy[ast->id] = 0.;
+         asteroid_setState( ast, field, ASTEROID_INVISIBLE );
          return;
       }
 
       attempts++;
-   } while ( (space_isInField(&ast->pos) < 0) && (attempts < 1000) );
+   } while ( (space_isInField(&pos) < 0) && (attempts < 1000) );
 
    /* And a random velocity */
    theta = RNGF()*2.*M_PI;
    mod = RNGF() * 20;
-   vect_pset( &ast->vel, mod, theta );
+   field->motion.vx[ast->id] = mod * cos(theta);
+   field->motion.vy[ast->id] = mod * sin(theta);
 
    /* Grow effect stuff */
-   ast->appearing = ASTEROID_GROWING;
-   ast->timer = 0.;
+   asteroid_setState( ast, field, ASTEROID_GROWING );
 }
 
 
 /**
  * @brief Initializes a debris.
- *    @param deb Debris to initialize.
+ *    @param field Asteroid field the debris belongs to.
+ *    @param i Index of the debris to initialize.
  */
-void debris_init( Debris *deb )
+void debris_init( AsteroidAnchor *field, int i )
 {
    double theta, mod;
+   Debris *deb;
+
+   deb = &field->debris[i];
 
    /* Position */
-   deb->pos.x = (double)RNG(-DEBRIS_BUFFER, SCREEN_W + DEBRIS_BUFFER);
-   deb->pos.y = (double)RNG(-DEBRIS_BUFFER, SCREEN_H + DEBRIS_BUFFER);
+   field->debris_motion.x[i] = (double)RNG(-DEBRIS_BUFFER, SCREEN_W + DEBRIS_BUFFER);
+   field->debris_motion.y[i] = (double)RNG(-DEBRIS_BUFFER, SCREEN_H + DEBRIS_BUFFER);
 
    /* And a random velocity */
    theta = RNGF()*2.*M_PI;
    mod = RNGF() * 20;
-   vect_pset( &deb->vel, mod, theta );
+   field->debris_motion.vx[i] = mod * cos(theta);
+   field->debris_motion.vy[i] = mod * sin(theta);
 
    /* Randomly init the gfx ID */
    deb->gfxID = RNG(0,(int)nasterogfx-1);
@@ -1677,6 +1774,36 @@ void debris_init( Debris *deb )
 }
 
 
+/**
+ * @brief Allocates the arrays of a motion.
+ *
+ *    @param m Motion to allocate.
+ *    @param n Number of bodies.
+ */
+static void motion_alloc( AsteroidMotion *m, int n )
+{
+   m->x = realloc( m->x, n * sizeof(double) );
+   m->y = realloc( m->y, n * sizeof(double) );
+   m->vx = realloc( m->vx, n * sizeof(double) );
+   m->vy = realloc( m->vy, n * sizeof(double) );
+}
+
+
+/**
+ * @brief Frees the arrays of a motion.
+ *
+ *    @param m Motion to free.
+ */
+static void motion_free( AsteroidMotion *m )
+{
+   free( m->x );
+   free( m->y );
+   free( m->vx );
+   free( m->vy );
+   memset( m, 0, sizeof(AsteroidMotion) );
+}
+
+
 /**
  * @brief Creates a new planet.
  */
@@ -3286,15 +3413,17 @@ void space_renderOverlay( const double dt )
    pplayer = pilot_get( PLAYER_ID );
    if (pplayer != NULL) {
       psolid  = pplayer->solid;
+      gl_batchBegin();
       for (i=0; i < array_size(cur_system->asteroids); i++) {
          ast = &cur_system->asteroids[i];
          x = psolid->pos.x - SCREEN_W/2;
          y = psolid->pos.y - SCREEN_H/2;
          for (j=0; j < ast->ndebris; j++) {
            if (ast->debris[j].height > 1.)
-              space_renderDebris( &ast->debris[j], x, y );
+              space_renderDebris( ast, j, x, y );
          }
       }
+      gl_batchEnd();
    }
 
    /* Render overlay if necessary. */
@@ -3336,20 +3465,22 @@ void planets_render (void)
       psolid  = pplayer->solid;
 
    /* Render the asteroids & debris. */
+   gl_batchBegin();
    for (i=0; i < array_size(cur_system->asteroids); i++) {
       ast = &cur_system->asteroids[i];
       for (j=0; j < ast->nb; j++)
-        space_renderAsteroid( &ast->asteroids[j] );
+        space_renderAsteroid( &ast->asteroids[j], ast );
 
       if (pplayer != NULL) {
          x = psolid->pos.x - SCREEN_W/2;
          y = psolid->pos.y - SCREEN_H/2;
          for (j=0; j < ast->ndebris; j++) {
            if (ast->debris[j].height < 1.)
-              space_renderDebris( &ast->debris[j], x, y );
+              space_renderDebris( ast, j, x, y );
          }
       }
    }
+   gl_batchEnd();
 
    /* Render gatherable stuff. */
    gatherable_render();
@@ -3397,10 +3528,10 @@ static void space_renderPlanet( const Planet *p )
 /**
  * @brief Renders an asteroid.
  */
-static void space_renderAsteroid( const Asteroid *a )
+static void space_renderAsteroid( const Asteroid *a, const AsteroidAnchor *field )
 {
    int i;
-   double scale, nx, ny;
+   double scale, nx, ny, x, y, timer;
    AsteroidType *at;
    Commodity *com;
    char c[20];
@@ -3411,17 +3542,20 @@ static void space_renderAsteroid( const Asteroid *a )
       return;
 
    /* Check if needs scaling. */
+   timer = field->timer[a->id];
    if (a->appearing == ASTEROID_GROWING)
-      scale = CLAMP( 0., 1., a->timer / 2. );
+      scale = CLAMP( 0., 1., timer / ASTEROID_FADE_TIME );
    else if (a->appearing == ASTEROID_SHRINKING)
-      scale = CLAMP( 0., 1., 1. - a->timer / 2. );
+      scale = CLAMP( 0., 1., 1. - timer / ASTEROID_FADE_TIME );
    else
       scale = 1.;
 
    at = &asteroid_types[a->type];
+   x = field->motion.x[a->id];
+   y = field->motion.y[a->id];
 
    gl_blitSpriteInterpolateScale( at->gfxs[a->gfxID], at->gfxs[a->gfxID], 1,
-                                  a->pos.x, a->pos.y, scale, scale, 0, 0, NULL );
+                                  x, y, scale, scale, 0, 0, NULL );
 
    /* Add the commodities if player has an asteroid scanner. */
    if ((player.p == NULL) || (!player.p->stats.misc_asteroid_scan))
@@ -3429,10 +3563,10 @@ static void space_renderAsteroid( const Asteroid *a )
 
    /* Add a buffer to font height to give space for the outline. */
    fh = gl_smallFont.h + 2;
-   gl_gameToScreenCoords(&nx, &ny, a->pos.x, a->pos.y);
+   gl_gameToScreenCoords(&nx, &ny, x, y);
    for (i=0; i<array_size(at->material); i++) {
       com = at->material[i];
-      gl_blitSprite(com->gfx_space, a->pos.x, a->pos.y - fh*i, 0, 0, NULL);
+      gl_blitSprite(com->gfx_space, x, y - fh*i, 0, 0, NULL);
       snprintf(c, sizeof(c), "×%d", at->quantity[i]);
       gl_printRaw(&gl_smallFont, nx + 10, ny - fh/2 - fh*i,
             &cFontWhite, -1., c);
@@ -3443,16 +3577,19 @@ static void space_renderAsteroid( const Asteroid *a )
 /**
  * @brief Renders a debris.
  */
-static void space_renderDebris( const Debris *d, double x, double y )
+static void space_renderDebris( const AsteroidAnchor *field, int i,
+      double x, double y )
 {
    double scale;
+   const Debris *d;
    Vector2d *testVect;
 
    scale = .5;
+   d = &field->debris[i];
 
    testVect = malloc(sizeof(Vector2d));
-   testVect->x = d->pos.x + x;
-   testVect->y = d->pos.y + y;
+   testVect->x = field->debris_motion.x[i] + x;
+   testVect->y = field->debris_motion.y[i] + y;
 
    if ( space_isInField( testVect ) == 0 )
       gl_blitSpriteInterpolateScale(
@@ -3538,7 +3675,11 @@ void space_exit (void)
       for (j=0; j < array_size(sys->asteroids); j++) {
          ast = &sys->asteroids[j];
          free(ast->asteroids);
+         motion_free(&ast->motion);
+         free(ast->timer);
+         free(ast->due);
          free(ast->debris);
+         motion_free(&ast->debris_motion);
          free(ast->type);
       }
       array_free(sys->asteroids);
@@ -4119,10 +4260,34 @@ void asteroid_hit( Asteroid *a, const Damage *dmg )
 
    a->armour -= darmour;
    if (a->armour <= 0)
-   {
-      a->appearing = ASTEROID_EXPLODING;
-      a->timer = 0.;
-   }
+      asteroid_setState( a, &cur_system->asteroids[a->parent],
+            ASTEROID_EXPLODING );
+}
+
+
+/**
+ * @brief Gets the position of an asteroid of the current system.
+ *
+ *    @param a Asteroid to get the position of.
+ *    @param[out] pos Position of the asteroid.
+ */
+void asteroid_getPos( const Asteroid *a, Vector2d *pos )
+{
+   const AsteroidAnchor *field = &cur_system->asteroids[a->parent];
+   vect_cset( pos, field->motion.x[a->id], field->motion.y[a->id] );
+}
+
+
+/**
+ * @brief Gets the velocity of an asteroid of the current system.
+ *
+ *    @param a Asteroid to get the velocity of.
+ *    @param[out] vel Velocity of the asteroid.
+ */
+void asteroid_getVel( const Asteroid *a, Vector2d *vel )
+{
+   const AsteroidAnchor *field = &cur_system->asteroids[a->parent];
+   vect_cset( vel, field->motion.vx[a->id], field->motion.vy[a->id] );
 }
 
 
@@ -4139,9 +4304,12 @@ static void asteroid_explode ( Asteroid *a, AsteroidAnchor *field, int give_rewa
    Damage dmg;
    AsteroidType *at;
    Commodity *com;
-   Vector2d pos, vel;
+   Vector2d apos, avel, pos, vel;
    char buf[16];
 
+   asteroid_getPos( a, &apos );
+   asteroid_getVel( a, &avel );
+
    /* Manage the explosion */
    dmg.type = dtype_get("explosion_splash");
    dmg.penetration = 1.; /* Full penetration. */
@@ -4149,12 +4317,12 @@ static void asteroid_explode ( Asteroid *a, AsteroidAnchor *field, int give_rewa
    dmg.disable = 0.;
    dtype_raw(dmg.type, &dmg.shield_pct, &dmg.armor_pct, &dmg.knockback_pct,
          &dmg.recoil_pct);
-   expl_explode(a->pos.x, a->pos.y, a->vel.x, a->vel.y,
+   expl_explode(apos.x, apos.y, avel.x, avel.y,
          50., &dmg, NULL, EXPL_MODE_SHIP);
 
    /* Play random explosion sound. */
    snprintf(buf, sizeof(buf), "explosion%d", RNG(0,2));
-   sound_playPos( sound_get(buf), a->pos.x, a->pos.y, a->vel.x, a->vel.y );
+   sound_playPos( sound_get(buf), apos.x, apos.y, avel.x, avel.y );
 
    if ( give_reward ) {
       /* Release commodity. */
@@ -4164,8 +4332,8 @@ static void asteroid_explode ( Asteroid *a, AsteroidAnchor *field, int give_rewa
          nb = RNG(0,at->quantity[i]);
          com = at->material[i];
          for (j=0; j < nb; j++) {
-            pos = a->pos;
-            vel = a->vel;
+            pos = apos;
+            vel = avel;
             pos.x += (RNGF()*30.-15.);
             pos.y += (RNGF()*30.-15.);
             vel.x += (RNGF()*20.-10.);
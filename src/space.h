@@ -229,10 +229,10 @@ typedef struct AsteroidType_ {
 
 /**
  * @brief Represents a small player-rendered debris.
+ *
+ * Its position and velocity are in the debris_motion of its field.
  */
 typedef struct Debris_ {
-   Vector2d pos; /**< Position. */
-   Vector2d vel; /**< Velocity. */
    int gfxID; /**< ID of the asteroid gfx. */
    double height; /**< height vs player */
 } Debris;
@@ -240,20 +240,34 @@ typedef struct Debris_ {
 
 /**
  * @brief Represents a single asteroid.
+ *
+ * Its position, velocity and timer are in the arrays of its field at the
+ *  index of its ID, use asteroid_getPos() and asteroid_getVel() to get
+ *  them.
  */
 typedef struct Asteroid_ {
    int id; /**< ID of the asteroid, for targeting. */
    int parent; /**< ID of the anchor parent. */
-   Vector2d pos; /**< Position. */
-   Vector2d vel; /**< Velocity. */
    int gfxID; /**< ID of the asteroid gfx. */
-   double timer; /**< Internal timer for animations. */
    int appearing; /**< 1: appearing, 2: disappaering, 3: exploding, 0 otherwise. */
    int type; /**< The ID of the asteroid type */
    double armour; /**< Current "armour" of the asteroid. */
 } Asteroid;
 
 
+/**
+ * @brief Motion of the asteroids or debris of a field.
+ *
+ * Stored by component so a whole field can be moved in a single sweep.
+ */
+typedef struct AsteroidMotion_ {
+   double *x; /**< X positions. */
+   double *y; /**< Y positions. */
+   double *vx; /**< X velocities. */
+   double *vy; /**< Y velocities. */
+} AsteroidMotion;
+
+
 
 /**
  * @brief Represents an asteroid field anchor.
@@ -263,8 +277,12 @@ typedef struct AsteroidAnchor_ {
    Vector2d pos; /**< Position in the system (from center). */
    double density; /**< Density of the field. */
    Asteroid *asteroids; /**< Asteroids belonging to the field. */
+   AsteroidMotion motion; /**< Motion of the asteroids. */
+   double *timer; /**< Internal timers of the asteroids for animations. */
+   double *due; /**< Timer values at which the asteroids change state. */
    int nb; /**< Number of asteroids. */
    Debris *debris; /**< Debris belonging to the field. */
+   AsteroidMotion debris_motion; /**< Motion of the debris. */
    int ndebris; /**< Number of debris. */
    double radius; /**< Radius of the anchor. */
    double area; /**< Field's area. */
@@ -471,6 +489,10 @@ int space_calcJumpInPos( StarSystem *in, StarSystem *out, Vector2d *pos, Vector2
  * Asteroids
  */
 void asteroid_hit( Asteroid *a, const Damage *dmg );
+void asteroid_getPos( const Asteroid *a, Vector2d *pos );
+void asteroid_getVel( const Asteroid *a, Vector2d *vel );
+void asteroid_motionUpdate( AsteroidMotion *m, int n, double vx, double vy,
+      double dt );
 int space_isInField ( const Vector2d *p );
 AsteroidType *space_getType ( int ID );
 
@@ -29,6 +29,7 @@
 #include "pause.h"
 #include "perlin.h"
 #include "physics.h"
+#include "pool.h"
 #include "render.h"
 #include "rng.h"
 #include "space.h"
@@ -51,6 +52,7 @@
 #define TRAIL_UPDATE_DT       0.05  /**< Rate (in seconds) at which trail is updated. */
 static TrailSpec* trail_spec_stack; /**< Trail specifications. */
 static Trail_spfx** trail_spfx_stack; /**< Active trail effects. */
+static Pool *trail_spfx_pool = NULL; /**< Memory of the trail effects. */
 
 
 /*
@@ -155,6 +157,7 @@ static void spfx_hapticRumble( double mod );
 static void spfx_update_trails( double dt );
 static void spfx_trail_update( Trail_spfx* trail, double dt );
 static void spfx_trail_free( Trail_spfx* trail );
+static void spfx_trail_cleanup( void *obj );
 
 
 /**
@@ -443,6 +446,9 @@ void spfx_free (void)
    for (i=0; i<array_size(trail_spfx_stack); i++)
       spfx_trail_free( trail_spfx_stack[i] );
    array_free( trail_spfx_stack );
+   trail_spfx_stack = NULL;
+   pool_destroy( trail_spfx_pool, spfx_trail_cleanup );
+   trail_spfx_pool = NULL;
 
    /* Free the trail styles. */
    for (i=0; i<array_size(trail_spec_stack); i++)
@@ -653,12 +659,18 @@ Trail_spfx* spfx_trail_create( const TrailSpec* spec )
 {
    Trail_spfx *trail;
 
-   trail = calloc( 1, sizeof(Trail_spfx) );
+   if (trail_spfx_pool == NULL)
+      trail_spfx_pool = pool_create( sizeof(Trail_spfx), 128 );
+   trail = pool_alloc( trail_spfx_pool );
    trail->spec = spec;
-   trail->capacity = 1;
+   /* Reuse the ring buffer of a previous trail if there is one. */
+   if (trail->point_ringbuf == NULL) {
+      trail->capacity = 1;
+      trail->point_ringbuf = calloc( trail->capacity, sizeof(TrailPoint) );
+   }
    trail->iread = trail->iwrite = 0;
-   trail->point_ringbuf = calloc( trail->capacity, sizeof(TrailPoint) );
    trail->refcount = 1;
+   trail->dt = 0.;
    trail->r = RNGF();
    trail->ontop = 0;
 
@@ -777,8 +789,18 @@ void spfx_trail_remove( Trail_spfx* trail )
 static void spfx_trail_free( Trail_spfx* trail )
 {
    assert(trail->refcount == 0);
+   /* The ring buffer is kept for the next trail. */
+   pool_free( trail_spfx_pool, trail );
+}
+
+
+/**
+ * @brief Frees the ring buffer kept by a trail in the pool.
+ */
+static void spfx_trail_cleanup( void *obj )
+{
+   Trail_spfx *trail = obj;
    free(trail->point_ringbuf);
-   free(trail);
 }
 
 
@@ -801,6 +823,7 @@ void spfx_trail_draw( const Trail_spfx* trail )
    styles = trail->spec->style;
 
    /* Stuff that doesn't change for the entire trail. */
+   gl_batchFlush();
    glUseProgram( shaders.trail.program );
    if (gl_has( OPENGL_SUBROUTINES ))
       glUniformSubroutinesuiv( GL_FRAGMENT_SHADER, 1, &trail->spec->type );
@@ -845,6 +868,7 @@ void spfx_trail_draw( const Trail_spfx* trail )
 
       /* Draw. */
       glDrawArrays( GL_TRIANGLE_STRIP, 0, 4 );
+      gl_screen.draw_calls++;
    }
 
    /* Clear state. */
@@ -1007,6 +1031,7 @@ void spfx_render( const int layer )
       }
 
    /* Now render the layer */
+   gl_batchBegin();
    for (i=array_size(spfx_stack)-1; i>=0; i--) {
       spfx   = &spfx_stack[i];
       effect = &spfx_effects[ spfx->effect ];
@@ -1029,6 +1054,7 @@ void spfx_render( const int layer )
             continue;
 
          /* Let's get to business. */
+         gl_batchFlush();
          glUseProgram( effect->shader );
 
          /* Set up the vertex. */
@@ -1047,6 +1073,7 @@ void spfx_render( const int layer )
 
          /* Draw. */
          glDrawArrays( GL_TRIANGLE_STRIP, 0, 4 );
+         gl_screen.draw_calls++;
 
          /* Clear state. */
          glDisableVertexAttribArray( shaders.texture.vertex );
@@ -1076,6 +1103,7 @@ void spfx_render( const int layer )
                NULL );
       }
    }
+   gl_batchEnd();
 }
 
 
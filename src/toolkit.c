@@ -1243,6 +1243,7 @@ void toolkit_drawOutlineThick( int x, int y, int w, int h, int b,
    gl_vboActivateAttribOffset( toolkit_vbo, shaders.smooth.vertex_color,
          toolkit_vboColourOffset, 4, GL_FLOAT, 0 );
    glDrawArrays( GL_TRIANGLE_STRIP, 0, 10 );
+   gl_screen.draw_calls++;
    gl_endSmoothProgram();
 }
 
@@ -1296,6 +1297,7 @@ void toolkit_drawOutline( int x, int y, int w, int h, int b,
    gl_vboActivateAttribOffset( toolkit_vbo, shaders.smooth.vertex_color,
          toolkit_vboColourOffset, 4, GL_FLOAT, 0 );
    glDrawArrays( GL_LINE_LOOP, 0, 4 );
+   gl_screen.draw_calls++;
    gl_endSmoothProgram();
 }
 /**
@@ -1344,6 +1346,7 @@ void toolkit_drawRect( int x, int y, int w, int h,
    gl_vboActivateAttribOffset( toolkit_vbo, shaders.smooth.vertex_color,
          toolkit_vboColourOffset, 4, GL_FLOAT, 0 );
    glDrawArrays( GL_TRIANGLE_STRIP, 0, 4 );
+   gl_screen.draw_calls++;
    gl_endSmoothProgram();
 }
 
@@ -1387,6 +1390,7 @@ void toolkit_drawTriangle( int x1, int y1, int x2, int y2, int x3, int y3,
    gl_vboActivateAttribOffset( toolkit_vbo, shaders.smooth.vertex_color,
          toolkit_vboColourOffset, 4, GL_FLOAT, 0 );
    glDrawArrays( GL_TRIANGLE_STRIP, 0, 3 );
+   gl_screen.draw_calls++;
    gl_endSmoothProgram();
 }
 
@@ -9,6 +9,14 @@
  *
  * Weapons are what gets created when a pilot shoots.  They are based
  * on the outfit that created them.
+ *
+ * Each layer is updated in phases. Expired weapons are removed first.
+ *  Then the collisions of all the weapons are looked for, split among the
+ *  worker threads when there are many weapons, which only reads the
+ *  pilots and asteroids. The hits found are then applied one weapon at a
+ *  time in layer order on the main thread, where damage, hooks and
+ *  effects happen, so the outcome doesn't depend on the threads. Finally
+ *  the surviving weapons are moved, also on the worker threads.
  */
 
 
@@ -23,6 +31,7 @@
 
 #include "array.h"
 #include "ai.h"
+#include "arena.h"
 #include "camera.h"
 #include "collision.h"
 #include "damagetype.h"
@@ -36,6 +45,7 @@
 #include "player.h"
 #include "rng.h"
 #include "spfx.h"
+#include "threadpool.h"
 
 
 #define weapon_isSmart(w)     (w->think != NULL) /**< Checks if the weapon w is smart. */
@@ -46,6 +56,9 @@
 #define weapon_setFlag(w,f)   ((w)->flags |= (f))
 #define weapon_rmFlag(w,f)    ((w)->flags &= ~(f))
 
+#define WEAPON_JOB_DETECT     256 /**< Weapons checked for collisions by each worker job. */
+#define WEAPON_JOB_MOVE       4096 /**< Weapons moved by each worker job. */
+
 
 /**
  * @struct Weapon
@@ -84,12 +97,48 @@ typedef struct Weapon_ {
    int sy; /**< Current Y sprite to use. */
    Trail_spfx *trail; /**< Trail graphic if applicable, else NULL. */
 
-   /* position update and render */
-   void (*update)(struct Weapon_*, const double, WeaponLayer); /**< Updates the weapon */
    void (*think)(struct Weapon_*, const double); /**< for the smart missiles */
 } Weapon;
 
 
+/**
+ * @brief Collision found during the weapon update, applied afterwards.
+ */
+typedef struct WeaponHit_ {
+   int weapon; /**< Index of the weapon in its layer. */
+   pilotId_t pilot; /**< Pilot hit, 0 if an asteroid was hit. */
+   Asteroid *ast; /**< Asteroid hit, NULL if a pilot was hit. */
+   Vector2d crash[2]; /**< Collision points. */
+} WeaponHit;
+
+
+/**
+ * @brief Part of a layer updated by a worker job.
+ */
+typedef struct WeaponJob_ {
+   Weapon **wlayer; /**< Layer being updated. */
+   Solid **solids; /**< Solids being moved. */
+   int start; /**< First weapon or solid of the job. */
+   int end; /**< One past the last weapon or solid of the job. */
+   double dt; /**< Current delta tick. */
+   WeaponHit *hits; /**< Array (array.h): Collisions found, in weapon order. */
+} WeaponJob;
+
+
+/**
+ * @brief Standing of a faction with the player.
+ *
+ * Finding out may run the faction's Lua, which the worker threads can't
+ *  do, so it's looked up for every faction with pilots or weapons before
+ *  the collisions are checked.
+ */
+typedef struct WeaponFaction_ {
+   factionId_t faction; /**< Faction looked up. */
+   int enemy; /**< Whether the faction is an enemy of the player. */
+   int friend; /**< Whether the faction is a friend of the player. */
+} WeaponFaction;
+
+
 /* behind player layer */
 static Weapon** wbackLayer = NULL; /**< behind pilots */
 /* behind player layer */
@@ -103,6 +152,8 @@ static size_t weapon_vboSize   = 0; /**< Size of the VBO. */
 
 /* Internal stuff. */
 static unsigned int beam_idgen = 0; /**< Beam identifier generator. */
+static WeaponJob *weapon_jobs = NULL; /**< Array (array.h): Jobs of the weapon update, kept between updates. */
+static WeaponFaction *weapon_factions = NULL; /**< Array (array.h): Factions looked up for the current weapon update. */
 
 
 /*
@@ -122,11 +173,20 @@ static Weapon* weapon_create(const PilotOutfitSlot *slot,
       const Pilot* parent, const pilotId_t target, double time);
 /* Updating. */
 static void weapon_render( Weapon* w, const double dt );
+static void weapons_lookupFaction( factionId_t faction );
+static void weapons_lookupFactions( Weapon **wlayer );
 static void weapons_updateLayer( const double dt, const WeaponLayer layer );
-static int weapon_checkPilCollide(Weapon* w, const double dt,
-      WeaponLayer layer, Pilot* p, int beam, int canPoly, CollPoly* polygon,
-      glTexture* gfx);
-static void weapon_update( Weapon* w, const double dt, WeaponLayer layer );
+static int weapons_runJobs( Weapon **wlayer, Solid **solids, int n,
+      int size, double dt, int (*func)( void* ) );
+static int weapon_detectJob( void *data );
+static int weapon_moveJob( void *data );
+static int weapon_checkPilCollide( Weapon* w, Pilot* p, int beam, int canPoly,
+      CollPoly* polygon, glTexture* gfx, Vector2d crash[2] );
+static void weapon_addHit( WeaponHit **hits, int idx, const Pilot *p,
+      Asteroid *a, const Vector2d crash[2] );
+static void weapon_detect( Weapon* w, int idx, WeaponHit **hits );
+static void weapon_update( Weapon* w, const double dt, WeaponLayer layer,
+      const WeaponHit *hits, int nhits );
 static void weapon_sample_trail( Weapon* w );
 /* Destruction. */
 static void weapon_destroy( Weapon* w );
@@ -137,6 +197,9 @@ static void weapon_explodeLayer( WeaponLayer layer,
 static void weapons_purgeLayer( Weapon** layer );
 /* Hitting. */
 static int weapon_checkCanHit( const Weapon* w, const Pilot *p );
+static const WeaponFaction* weapon_getFaction( factionId_t faction );
+static int weapon_isHostile( const Pilot *p );
+static int weapon_isPlayerEnemy( factionId_t faction );
 static void weapon_hit( Weapon* w, Pilot* p, Vector2d* pos );
 static void weapon_hitAst( Weapon* w, Asteroid* a, WeaponLayer layer, Vector2d* pos );
 static void weapon_hitBeam( Weapon* w, Pilot* p, WeaponLayer layer,
@@ -287,6 +350,7 @@ void weapon_minimap( const double res, const double w,
       gl_vboActivateAttribOffset( weapon_vbo, shaders.smooth.vertex, 0, 2, GL_FLOAT, 0 );
       gl_vboActivateAttribOffset( weapon_vbo, shaders.smooth.vertex_color, offset * sizeof(GLfloat), 4, GL_FLOAT, 0 );
       glDrawArrays( GL_POINTS, 0, p );
+      gl_screen.draw_calls++;
       gl_endSmoothProgram();
    }
 }
@@ -366,7 +430,7 @@ static void think_beam( Weapon* w, const double dt )
    Asteroid *ast;
    double opt_angle;
    double diff, mod;
-   Vector2d v;
+   Vector2d v, apos;
 
    /* Get pilot, if pilot is dead beam is destroyed. */
    p = pilot_get(w->parent);
@@ -405,7 +469,8 @@ static void think_beam( Weapon* w, const double dt )
          field = &cur_system->asteroids[p->nav_anchor];
          ast = &field->asteroids[p->nav_asteroid];
 
-         opt_angle = vect_angle(&w->solid->pos, &ast->pos);
+         asteroid_getPos( ast, &apos );
+         opt_angle = vect_angle(&w->solid->pos, &apos);
       }
    }
    else
@@ -440,6 +505,51 @@ static void think_beam( Weapon* w, const double dt )
 }
 
 
+/**
+ * @brief Looks up the standing of a faction with the player if it wasn't
+ *        already.
+ *
+ *    @param faction Faction to look up.
+ */
+static void weapons_lookupFaction( factionId_t faction )
+{
+   WeaponFaction *wf;
+
+   if (weapon_getFaction( faction ) != NULL)
+      return;
+   wf = &array_grow( &weapon_factions );
+   wf->faction = faction;
+   wf->enemy = faction_isPlayerEnemy( faction );
+   wf->friend = faction_isPlayerFriend( faction );
+}
+
+
+/**
+ * @brief Looks up the standings the worker threads may need to check the
+ *        collisions of a layer.
+ *
+ * Hooks run while applying the hits of a layer may add pilots or change
+ *  standings, so it has to be done again right before each layer looks
+ *  for collisions.
+ *
+ *    @param wlayer Layer that will look for collisions.
+ */
+static void weapons_lookupFactions( Weapon **wlayer )
+{
+   int i;
+   Pilot *const *pilot_stack;
+
+   if (weapon_factions == NULL)
+      weapon_factions = array_create( WeaponFaction );
+   array_resize( &weapon_factions, 0 );
+   pilot_stack = pilot_getAll();
+   for (i=0; i<array_size(pilot_stack); i++)
+      weapons_lookupFaction( pilot_stack[i]->faction );
+   for (i=0; i<array_size(wlayer); i++)
+      weapons_lookupFaction( wlayer[i]->faction );
+}
+
+
 /**
  * @brief Updates all the weapon layers.
  *
@@ -451,6 +561,9 @@ void weapons_update( const double dt )
    weapons_updateLayer(dt,WEAPON_LAYER_BG);
    weapons_updateLayer(dt,WEAPON_LAYER_FG);
 
+   /* Standings may change before the next update. */
+   array_resize( &weapon_factions, 0 );
+
    /* Actually purge and remove weapons. */
    weapons_purgeLayer( wbackLayer );
    weapons_purgeLayer( wfrontLayer );
@@ -467,10 +580,12 @@ static void weapons_updateLayer( const double dt, const WeaponLayer layer )
 {
    Weapon **wlayer;
    Weapon *w;
-   int i;
+   Solid **solids;
+   int i, j, k, h, n, njobs;
    int spfx;
    int s;
    Pilot *p;
+   const WeaponJob *job;
 
    /* Choose layer. */
    switch (layer) {
@@ -594,10 +709,48 @@ static void weapons_updateLayer( const double dt, const WeaponLayer layer )
                   w->outfit->name);
             break;
       }
+   }
 
-      /* Only increment if weapon wasn't destroyed. */
-      if (!weapon_isFlag(w, WEAPON_FLAG_DESTROYED))
-         weapon_update(w,dt,layer);
+   /* Look for the collisions of the remaining weapons. Every pilot and
+    * weapon faction is looked up beforehand, so the workers never have to
+    * run faction Lua. */
+   weapons_lookupFactions( wlayer );
+   njobs = weapons_runJobs( wlayer, NULL, array_size(wlayer),
+         WEAPON_JOB_DETECT, dt, weapon_detectJob );
+
+   /* Apply them in layer order, no matter how the jobs were split. */
+   for (j=0; j<njobs; j++) {
+      job = &weapon_jobs[j];
+      k = 0;
+      for (i=job->start; i<job->end; i++) {
+         for (h=k; (h<array_size(job->hits)) && (job->hits[h].weapon == i); h++);
+         /* Weapons may have been destroyed by explosions since. */
+         if (!weapon_isFlag(wlayer[i], WEAPON_FLAG_DESTROYED))
+            weapon_update( wlayer[i], dt, layer, &job->hits[k], h-k );
+         k = h;
+      }
+   }
+
+   /* Move the surviving weapons all at once. */
+   solids = arena_alloc( array_size(wlayer) * sizeof(Solid*) );
+   n = 0;
+   for (i=0; i<array_size(wlayer); i++)
+      if (!weapon_isFlag(wlayer[i], WEAPON_FLAG_DESTROYED))
+         solids[n++] = wlayer[i]->solid;
+   weapons_runJobs( NULL, solids, n, WEAPON_JOB_MOVE, dt, weapon_moveJob );
+
+   for (i=0; i<array_size(wlayer); i++) {
+      w = wlayer[i];
+      if (weapon_isFlag(w, WEAPON_FLAG_DESTROYED))
+         continue;
+
+      /* Update the sound. */
+      sound_updatePos(w->voice, w->solid->pos.x, w->solid->pos.y,
+            w->solid->vel.x, w->solid->vel.y);
+
+      /* Update the trail. */
+      if (w->trail != NULL)
+         weapon_sample_trail( w );
    }
 }
 
@@ -620,6 +773,34 @@ static void weapons_purgeLayer( Weapon** layer )
 }
 
 
+/**
+ * @brief Remembers where all the weapons are before an update.
+ */
+void weapons_savePrev (void)
+{
+   int i;
+   for (i=0; i<array_size(wbackLayer); i++)
+      solid_savePrev( wbackLayer[i]->solid );
+   for (i=0; i<array_size(wfrontLayer); i++)
+      solid_savePrev( wfrontLayer[i]->solid );
+}
+
+
+/**
+ * @brief Moves all the weapons between their last two updates for drawing.
+ *
+ *    @param alpha Fraction of the way from the previous update to the last.
+ */
+void weapons_interpolate( double alpha )
+{
+   int i;
+   for (i=0; i<array_size(wbackLayer); i++)
+      solid_interpolate( wbackLayer[i]->solid, alpha );
+   for (i=0; i<array_size(wfrontLayer); i++)
+      solid_interpolate( wfrontLayer[i]->solid, alpha );
+}
+
+
 /**
  * @brief Renders all the weapons in a layer.
  *
@@ -644,8 +825,10 @@ void weapons_render( const WeaponLayer layer, const double dt )
          return;
    }
 
+   gl_batchBegin();
    for (i=0; i<array_size(wlayer); i++)
       weapon_render( wlayer[i], dt );
+   gl_batchEnd();
 }
 
 
@@ -657,6 +840,7 @@ static void weapon_renderBeam( Weapon* w, const double dt ) {
    w->anim += dt;
 
    /* Load GLSL program */
+   gl_batchFlush();
    glUseProgram(shaders.beam.program);
 
    /* Zoom. */
@@ -690,6 +874,7 @@ static void weapon_renderBeam( Weapon* w, const double dt ) {
 
    /* Draw. */
    glDrawArrays( GL_TRIANGLE_STRIP, 0, 4 );
+   gl_screen.draw_calls++;
 
    /* Clear state. */
    glDisableVertexAttribArray( shaders.beam.vertex );
@@ -824,7 +1009,7 @@ static int weapon_checkCanHit( const Weapon* w, const Pilot *p )
    /* Player behaves differently. */
    if ((w->faction == FACTION_PLAYER) || (leader_id == PLAYER_ID)) {
       /* Always hit hostiles. */
-      if (pilot_isHostile(p))
+      if (weapon_isHostile(p))
          return 1;
 
       /* Miss rest; can be neutral/ally. */
@@ -834,10 +1019,12 @@ static int weapon_checkCanHit( const Weapon* w, const Pilot *p )
 
    /* Let hostiles hit player. */
    if (((p->faction == FACTION_PLAYER) || (p->parent == PLAYER_ID))
-         && (parent != NULL) && pilot_isHostile(parent))
+         && (parent != NULL) && weapon_isHostile(parent))
       return 1;
 
    /* Hit enemies. */
+   if (p->faction == FACTION_PLAYER)
+      return weapon_isPlayerEnemy( w->faction );
    if (areEnemies(w->faction, p->faction))
       return 1;
 
@@ -845,28 +1032,171 @@ static int weapon_checkCanHit( const Weapon* w, const Pilot *p )
 }
 
 
+/**
+ * @brief Gets the standing of a faction looked up for the weapon update.
+ *
+ *    @param faction Faction to get.
+ *    @return The standing, or NULL if it wasn't looked up.
+ */
+static const WeaponFaction* weapon_getFaction( factionId_t faction )
+{
+   int i;
+   for (i=0; i<array_size(weapon_factions); i++)
+      if (weapon_factions[i].faction == faction)
+         return &weapon_factions[i];
+   return NULL;
+}
+
+
+/**
+ * @brief Checks whether a faction is an enemy of the player.
+ *
+ * Like areEnemies() with the player, but safe to call from the worker
+ *  threads for the pilots and weapons being updated.
+ *
+ *    @param faction Faction to check.
+ *    @return 1 if the faction is an enemy of the player.
+ */
+static int weapon_isPlayerEnemy( factionId_t faction )
+{
+   const WeaponFaction *wf = weapon_getFaction( faction );
+   /* Only pilots added by the hooks of the hits can be missing, and
+    * those are only checked again on the main thread. */
+   if (wf == NULL)
+      return areEnemies( faction, FACTION_PLAYER );
+   return wf->enemy;
+}
+
+
+/**
+ * @brief Checks whether a pilot is hostile to the player.
+ *
+ * Like pilot_isHostile(), but safe to call from the worker threads for the
+ *  pilots being updated.
+ *
+ *    @param p Pilot to check.
+ *    @return 1 if the pilot is hostile to the player.
+ */
+static int weapon_isHostile( const Pilot *p )
+{
+   const WeaponFaction *wf = weapon_getFaction( p->faction );
+   /* Only on the main thread, see weapon_isPlayerEnemy(). */
+   if (wf == NULL)
+      return pilot_isHostile( p );
+
+   /* Friendly. */
+   if (pilot_isFlag(p, PILOT_FRIENDLY)
+         || (wf->friend && !pilot_isFlag(p, PILOT_HOSTILE)))
+      return 0;
+   return !pilot_isFlag(p, PILOT_BRIBED)
+         && (pilot_isFlag(p, PILOT_HOSTILE) || wf->enemy);
+}
+
+
+/**
+ * @brief Runs a part of the weapon update split into jobs.
+ *
+ * Small batches are run directly on the main thread, larger ones are
+ *  split among the worker threads. Either way each job only writes to
+ *  its own weapons and hits.
+ *
+ *    @param wlayer Layer being updated, or NULL.
+ *    @param solids Solids being moved, or NULL.
+ *    @param n Number of weapons or solids.
+ *    @param size Number of weapons or solids per job.
+ *    @param dt Current delta tick.
+ *    @param func Job function, gets a WeaponJob.
+ *    @return Number of jobs run, their results are in weapon_jobs.
+ */
+static int weapons_runJobs( Weapon **wlayer, Solid **solids, int n,
+      int size, double dt, int (*func)( void* ) )
+{
+   int i, njobs;
+   WeaponJob *job;
+   ThreadQueue *queue;
+
+   njobs = (n < 2*size) ? 1 : (n + size-1) / size;
+   if (weapon_jobs == NULL)
+      weapon_jobs = array_create( WeaponJob );
+   while (array_size(weapon_jobs) < njobs) {
+      job = &array_grow( &weapon_jobs );
+      memset( job, 0, sizeof(WeaponJob) );
+      job->hits = array_create( WeaponHit );
+   }
+   for (i=0; i<njobs; i++) {
+      job = &weapon_jobs[i];
+      job->wlayer = wlayer;
+      job->solids = solids;
+      job->start = i*n / njobs;
+      job->end = (i+1)*n / njobs;
+      job->dt = dt;
+      array_resize( &job->hits, 0 );
+   }
+
+   if (njobs == 1)
+      func( &weapon_jobs[0] );
+   else {
+      queue = vpool_create();
+      for (i=0; i<njobs; i++)
+         vpool_enqueue( queue, func, &weapon_jobs[i] );
+      vpool_wait( queue );
+   }
+   return njobs;
+}
+
+
+/**
+ * @brief Looks for the collisions of part of a layer.
+ *
+ *    @param data Job to run (WeaponJob).
+ *    @return 0, always.
+ */
+static int weapon_detectJob( void *data )
+{
+   int i;
+   WeaponJob *job = (WeaponJob*) data;
+
+   for (i=job->start; i<job->end; i++)
+      if (!weapon_isFlag(job->wlayer[i], WEAPON_FLAG_DESTROYED))
+         weapon_detect( job->wlayer[i], i, &job->hits );
+   return 0;
+}
+
+
+/**
+ * @brief Moves part of the solids of a layer.
+ *
+ *    @param data Job to run (WeaponJob).
+ *    @return 0, always.
+ */
+static int weapon_moveJob( void *data )
+{
+   WeaponJob *job = (WeaponJob*) data;
+   solid_updateBatch( &job->solids[job->start], job->end - job->start, job->dt );
+   return 0;
+}
+
+
 /**
  * @brief Checks for collision between a weapon and a pilot.
  *
+ * Doesn't change anything, so it's safe to call from the worker threads.
+ *
  *    @param w Weapon to check collision for.
- *    @param dt Current delta tick.
- *    @param layer Layer to which the weapon belongs.
  *    @param p Pilot to check collision with.
  *    @param beam Whether the weapon is a beam.
  *    @param canPoly Whether the weapon can do polygon collision.
  *    @param polygon The weapon's collision polygon if applicable.
  *    @param gfx The weapon's texture.
- *    @return Whether or not the weapon is to be destroyed.
+ *    @param[out] crash Collision points.
+ *    @return Whether or not the weapon hits the pilot.
  */
-static int weapon_checkPilCollide(Weapon* w, const double dt,
-      WeaponLayer layer, Pilot* p, int beam, int canPoly, CollPoly* polygon,
-      glTexture* gfx)
+static int weapon_checkPilCollide( Weapon* w, Pilot* p, int beam, int canPoly,
+      CollPoly* polygon, glTexture* gfx, Vector2d crash[2] )
 {
    int psx, psy;
    int k;
    int usePoly;
-   Vector2d crash[2];
-   int coll;
 
    /* Cannot collide with self. */
    if (w->parent == p->id)
@@ -886,77 +1216,74 @@ static int weapon_checkPilCollide(Weapon* w, const double dt,
 
    /* Beam weapons have special collisions. */
    if (beam) {
-      /* Check for collision. */
       if (usePoly) {
          k = p->ship->gfx_space->sx * psy + psx;
-         coll = CollideLinePolygon(&w->solid->pos, w->solid->dir,
+         return CollideLinePolygon(&w->solid->pos, w->solid->dir,
                w->length, &p->ship->polygon[k],
                &p->solid->pos, crash);
       }
-      else {
-         coll = CollideLineSprite(&w->solid->pos, w->solid->dir,
-               w->length, p->ship->gfx_space, psx, psy,
-               &p->solid->pos, crash);
-      }
-      if (coll) {
-         weapon_hitBeam(w, p, layer, crash, dt);
-         return 0;
-      }
+      return CollideLineSprite(&w->solid->pos, w->solid->dir,
+            w->length, p->ship->gfx_space, psx, psy,
+            &p->solid->pos, crash);
    }
+
    /* Smart weapons only collide with their target. */
-   else if (weapon_isSmart(w)) {
-      if (p->id == w->target) {
-         if (usePoly) {
-            k = p->ship->gfx_space->sx * psy + psx;
-            coll = CollidePolygon(&p->ship->polygon[k], &p->solid->pos,
-                  polygon, &w->solid->pos, crash);
-         }
-         else {
-            coll = CollideSprite(gfx, w->sx, w->sy, &w->solid->pos,
-                  p->ship->gfx_space, psx, psy, &p->solid->pos, crash);
-         }
-         if (coll) {
-            weapon_hit(w, p, crash);
-            return 1;
-         }
-      }
-   }
-   /* Unguided weapons hit any valid pilot. */
-   else {
-      if (usePoly) {
-         k = p->ship->gfx_space->sx * psy + psx;
-         coll = CollidePolygon(&p->ship->polygon[k], &p->solid->pos,
-               polygon, &w->solid->pos, crash);
-      }
-      else {
-         coll = CollideSprite(gfx, w->sx, w->sy, &w->solid->pos,
-               p->ship->gfx_space, psx, psy, &p->solid->pos, crash);
-      }
+   if (weapon_isSmart(w) && (p->id != w->target))
+      return 0;
 
-      if (coll) {
-         weapon_hit(w, p, crash);
-         return 1;
-      }
+   /* Unguided weapons hit any valid pilot. */
+   if (usePoly) {
+      k = p->ship->gfx_space->sx * psy + psx;
+      return CollidePolygon(&p->ship->polygon[k], &p->solid->pos,
+            polygon, &w->solid->pos, crash);
    }
+   return CollideSprite(gfx, w->sx, w->sy, &w->solid->pos,
+         p->ship->gfx_space, psx, psy, &p->solid->pos, crash);
+}
 
-   return 0;
+
+/**
+ * @brief Adds a collision to a list of hits.
+ *
+ *    @param hits Array (array.h) to add the hit to.
+ *    @param idx Index of the weapon in its layer.
+ *    @param p Pilot hit, or NULL.
+ *    @param a Asteroid hit if p is NULL.
+ *    @param crash Collision points.
+ */
+static void weapon_addHit( WeaponHit **hits, int idx, const Pilot *p,
+      Asteroid *a, const Vector2d crash[2] )
+{
+   WeaponHit *h;
+
+   h = &array_grow( hits );
+   h->weapon = idx;
+   h->pilot = (p != NULL) ? p->id : 0;
+   h->ast = (p != NULL) ? NULL : a;
+   h->crash[0] = crash[0];
+   h->crash[1] = crash[1];
 }
 
 
 /**
- * @brief Updates an individual weapon.
+ * @brief Looks for what a weapon hits.
  *
- *    @param w Weapon to update.
- *    @param dt Current delta tick.
- *    @param layer Layer to which the weapon belongs.
+ * Only reads the pilots and asteroids, the hits are applied afterwards by
+ *  weapon_update(). Everything the weapon overlaps is recorded in the order
+ *  it would have been hit in, since what a weapon hits first may be gone
+ *  by the time its hits are applied.
+ *
+ *    @param w Weapon to check.
+ *    @param idx Index of the weapon in its layer.
+ *    @param[out] hits Array (array.h) to add the hits to.
  */
-static void weapon_update( Weapon* w, const double dt, WeaponLayer layer )
+static void weapon_detect( Weapon* w, int idx, WeaponHit **hits )
 {
    int i, j, b, n;
    int canPoly;
    glTexture *gfx;
    CollPoly *plg, *polygon;
-   Vector2d crash[2];
+   Vector2d crash[2], apos;
    Pilot *p;
    Pilot *parent;
    AsteroidAnchor *ast;
@@ -1025,74 +1352,97 @@ static void weapon_update( Weapon* w, const double dt, WeaponLayer layer )
        * parent. This offers performance benefits at the cost of
        * simplifying combat the player isn't involved in. */
       p = pilot_get(w->target);
-      if (p != NULL) {
-         if (weapon_checkPilCollide(w, dt, layer, p, b, canPoly, polygon, gfx))
-            return;
-      }
-      if (parent != NULL) {
+      if ((p != NULL)
+            && weapon_checkPilCollide(w, p, b, canPoly, polygon, gfx, crash))
+         weapon_addHit( hits, idx, p, NULL, crash );
+      if ((parent != NULL) && (parent->target != w->target)) {
          p = pilot_get(parent->target);
-         if (p != NULL) {
-            if (weapon_checkPilCollide(
-                  w, dt, layer, p, b, canPoly, polygon, gfx))
-               return;
-         }
+         if ((p != NULL)
+               && weapon_checkPilCollide(w, p, b, canPoly, polygon, gfx, crash))
+            weapon_addHit( hits, idx, p, NULL, crash );
       }
    }
    else {
       for (i=0; i<array_size(pilot_stack); i++) {
          p = pilot_stack[i];
-         if (weapon_checkPilCollide(w, dt, layer, p, b, canPoly, polygon, gfx))
-            return;
+         if (weapon_checkPilCollide(w, p, b, canPoly, polygon, gfx, crash))
+            weapon_addHit( hits, idx, p, NULL, crash );
       }
    }
 
    /* Collide with asteroids*/
-   if (outfit_isAmmo(w->outfit)) {
-      for (i=0; i<array_size(cur_system->asteroids); i++) {
-         ast = &cur_system->asteroids[i];
-         for (j=0; j<ast->nb; j++) {
-            a = &ast->asteroids[j];
-            at = space_getType ( a->type );
-            if ( ((a->appearing == ASTEROID_VISIBLE)||(a->appearing == ASTEROID_EXPLODING)) &&
-                  CollideSprite( gfx, w->sx, w->sy, &w->solid->pos,
-                        at->gfxs[a->gfxID], 0, 0, &a->pos,
-                        &crash[0] ) ) {
-               weapon_hitAst( w, a, layer, &crash[0] );
-               return; /* Weapon is destroyed. */
-            }
+   for (i=0; i<array_size(cur_system->asteroids); i++) {
+      ast = &cur_system->asteroids[i];
+      for (j=0; j<ast->nb; j++) {
+         a = &ast->asteroids[j];
+         if ((a->appearing != ASTEROID_VISIBLE)
+               && (a->appearing != ASTEROID_EXPLODING))
+            continue;
+         at = space_getType ( a->type );
+         vect_csetmin( &apos, ast->motion.x[j], ast->motion.y[j] );
+         if (b) {
+            /* Beams can still hit more asteroids. */
+            if (CollideLineSprite(&w->solid->pos, w->solid->dir,
+                     w->length, at->gfxs[a->gfxID], 0, 0, &apos, crash))
+               weapon_addHit( hits, idx, NULL, a, crash );
          }
+         else if ((outfit_isAmmo(w->outfit) || outfit_isBolt(w->outfit))
+               && CollideSprite( gfx, w->sx, w->sy, &w->solid->pos,
+                     at->gfxs[a->gfxID], 0, 0, &apos, &crash[0] ))
+            weapon_addHit( hits, idx, NULL, a, crash );
       }
    }
-   else if (outfit_isBolt(w->outfit)) {
-      for (i=0; i<array_size(cur_system->asteroids); i++) {
-         ast = &cur_system->asteroids[i];
-         for (j=0; j<ast->nb; j++) {
-            a = &ast->asteroids[j];
-            at = space_getType ( a->type );
-            if ( ((a->appearing == ASTEROID_VISIBLE)||(a->appearing == ASTEROID_EXPLODING)) &&
-                  CollideSprite( gfx, w->sx, w->sy, &w->solid->pos,
-                        at->gfxs[a->gfxID], 0, 0, &a->pos,
-                        &crash[0] ) ) {
-               weapon_hitAst( w, a, layer, &crash[0] );
-               return; /* Weapon is destroyed. */
-            }
+}
+
+
+/**
+ * @brief Updates an individual weapon.
+ *
+ * Applies the hits found by weapon_detect(). What the weapon hit may have
+ *  changed since because of the weapons applied before it, so each hit is
+ *  checked again. Beams apply all the hits still valid, other weapons only
+ *  the first one, like if they had been checked in order.
+ *
+ *    @param w Weapon to update.
+ *    @param dt Current delta tick.
+ *    @param layer Layer to which the weapon belongs.
+ *    @param hits Hits of the weapon.
+ *    @param nhits Number of hits.
+ */
+static void weapon_update( Weapon* w, const double dt, WeaponLayer layer,
+      const WeaponHit *hits, int nhits )
+{
+   int i, b;
+   Pilot *p;
+   Asteroid *a;
+   Vector2d crash[2];
+
+   b = outfit_isBeam(w->outfit);
+   for (i=0; i<nhits; i++) {
+      crash[0] = hits[i].crash[0];
+      crash[1] = hits[i].crash[1];
+      if (hits[i].ast == NULL) {
+         /* Pilots killed meanwhile are gone through. */
+         p = pilot_get( hits[i].pilot );
+         if ((p == NULL) || !weapon_checkCanHit( w, p ))
+            continue;
+         if (b)
+            weapon_hitBeam( w, p, layer, crash, dt );
+         else {
+            weapon_hit( w, p, crash );
+            return; /* Weapon is destroyed. */
          }
       }
-   }
-   else if (b) { /* Beam */
-      for (i=0; i<array_size(cur_system->asteroids); i++) {
-         ast = &cur_system->asteroids[i];
-         for (j=0; j<ast->nb; j++) {
-            a = &ast->asteroids[j];
-            at = space_getType ( a->type );
-            if (((a->appearing == ASTEROID_VISIBLE)
-                     || (a->appearing == ASTEROID_EXPLODING))
-                  && CollideLineSprite(&w->solid->pos, w->solid->dir,
-                        w->length, at->gfxs[a->gfxID], 0, 0, &a->pos, crash)) {
-               weapon_hitAstBeam(w, a, layer, crash, dt);
-               /* No return because beam can still think, it's not
-                * destroyed like the other weapons.*/
-            }
+      else {
+         a = hits[i].ast;
+         if ((a->appearing != ASTEROID_VISIBLE)
+               && (a->appearing != ASTEROID_EXPLODING))
+            continue;
+         if (b)
+            weapon_hitAstBeam( w, a, layer, crash, dt );
+         else {
+            weapon_hitAst( w, a, layer, crash );
+            return; /* Weapon is destroyed. */
          }
       }
    }
@@ -1101,16 +1451,8 @@ static void weapon_update( Weapon* w, const double dt, WeaponLayer layer )
    if (weapon_isSmart(w))
       (*w->think)(w,dt);
 
-   /* Update the solid position. */
-   (*w->solid->update)(w->solid, dt);
-
-   /* Update the sound. */
-   sound_updatePos(w->voice, w->solid->pos.x, w->solid->pos.y,
-         w->solid->vel.x, w->solid->vel.y);
-
-   /* Update the trail. */
-   if (w->trail != NULL)
-      weapon_sample_trail( w );
+   /* The solid, sound and trail are updated for the whole layer by
+    * weapons_updateLayer(). */
 }
 
 
@@ -1290,6 +1632,7 @@ static void weapon_hitAst( Weapon* w, Asteroid* a, WeaponLayer layer, Vector2d*
    double dmg_shield;
    double dmg_armor;
    Damage dmg;
+   Vector2d avel;
    const Damage *odmg;
 
    /* Get general details. */
@@ -1325,7 +1668,8 @@ static void weapon_hitAst( Weapon* w, Asteroid* a, WeaponLayer layer, Vector2d*
 
    /* Add the spfx */
    spfx = outfit_spfxArmour(w->outfit);
-   spfx_add( spfx, pos->x, pos->y,VX(a->vel), VY(a->vel), layer );
+   asteroid_getVel( a, &avel );
+   spfx_add( spfx, pos->x, pos->y,VX(avel), VY(avel), layer );
 
    weapon_destroy(w);
 
@@ -1453,6 +1797,7 @@ static void weapon_hitAstBeam( Weapon* w, Asteroid* a, WeaponLayer layer,
    double dmg_shield;
    double dmg_armor;
    Damage dmg;
+   Vector2d avel;
    const Damage *odmg;
 
    /* Get general details. */
@@ -1484,10 +1829,11 @@ static void weapon_hitAstBeam( Weapon* w, Asteroid* a, WeaponLayer layer,
       spfx = outfit_spfxArmour(w->outfit);
 
       /* Add graphic. */
+      asteroid_getVel( a, &avel );
       spfx_add( spfx, pos[0].x, pos[0].y,
-            VX(a->vel), VY(a->vel), SPFX_LAYER_MIDDLE );
+            VX(avel), VY(avel), SPFX_LAYER_MIDDLE );
       spfx_add( spfx, pos[1].x, pos[1].y,
-            VX(a->vel), VY(a->vel), SPFX_LAYER_MIDDLE );
+            VX(avel), VY(avel), SPFX_LAYER_MIDDLE );
       w->exp_timer = -2;
    }
 }
@@ -1514,6 +1860,7 @@ static double weapon_aimTurret(const Pilot *parent, const Pilot *pilot_target,
    Asteroid *ast;
    Vector2d *target_pos;
    Vector2d *target_vel;
+   Vector2d apos, avel;
    double rdir, adir, lead;
    double rx, ry, x, y, t;
    double off;
@@ -1528,8 +1875,10 @@ static double weapon_aimTurret(const Pilot *parent, const Pilot *pilot_target,
 
       field = &cur_system->asteroids[parent->nav_anchor];
       ast = &field->asteroids[parent->nav_asteroid];
-      target_pos = &ast->pos;
-      target_vel = &ast->vel;
+      asteroid_getPos( ast, &apos );
+      asteroid_getVel( ast, &avel );
+      target_pos = &apos;
+      target_vel = &avel;
    }
 
    /* Get the vector : shooter -> target */
@@ -1869,6 +2218,7 @@ static Weapon* weapon_create(const PilotOutfitSlot *slot,
    Pilot *pilot_target;
    AsteroidAnchor *field;
    Asteroid *ast;
+   Vector2d apos;
 
    Weapon* w;
 
@@ -1888,7 +2238,6 @@ static Weapon* weapon_create(const PilotOutfitSlot *slot,
    }
    else
       w->outfit = slot->outfit; /* non-changeable */
-   w->update = weapon_update;
    w->strength = 1.;
 
    /* Inform the target. */
@@ -1916,7 +2265,8 @@ static Weapon* weapon_create(const PilotOutfitSlot *slot,
             else if (parent->nav_asteroid >= 0) {
                field = &cur_system->asteroids[parent->nav_anchor];
                ast = &field->asteroids[parent->nav_asteroid];
-               rdir = vect_angle(pos, &ast->pos);
+               asteroid_getPos( ast, &apos );
+               rdir = vect_angle(pos, &apos);
             }
          }
 
@@ -2320,6 +2670,8 @@ void weapon_clear (void)
  */
 void weapon_exit (void)
 {
+   int i;
+
    weapon_clear();
 
    /* Destroy front layer. */
@@ -2328,6 +2680,14 @@ void weapon_exit (void)
    /* Destroy back layer. */
    array_free(wfrontLayer);
 
+   /* Destroy the update jobs. */
+   for (i=0; i<array_size(weapon_jobs); i++)
+      array_free( weapon_jobs[i].hits );
+   array_free( weapon_jobs );
+   weapon_jobs = NULL;
+   array_free( weapon_factions );
+   weapon_factions = NULL;
+
    /* Destroy VBO. */
    free( weapon_vboData );
    weapon_vboData = NULL;
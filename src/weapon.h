@@ -52,6 +52,8 @@ void weapon_explode( double x, double y, double radius,
  * update
  */
 void weapons_update( const double dt );
+void weapons_savePrev (void);
+void weapons_interpolate( double alpha );
 void weapons_render( const WeaponLayer layer, const double dt );
 
 